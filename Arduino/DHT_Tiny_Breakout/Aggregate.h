@@ -0,0 +1,230 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef AGGREGATE_H
+#define AGGREGATE_H
+
+#include <util/atomic.h>
+#include "Features.h"
+#include "Registers.h"
+
+// ***
+// *** Running totals for the current aggregation window of one
+// *** channel, kept in the int16 units of the aggregate block
+// *** so a latch copies them without converting.
+// ***
+struct Aggregate
+{
+  uint16_t count;
+  int16_t temperatureMin;
+  int16_t temperatureMax;
+  int32_t temperatureSum;
+  int16_t humidityMin;
+  int16_t humidityMax;
+  int32_t humiditySum;
+
+  // ***
+  // *** The time the current aggregation window started.
+  // ***
+  uint32_t start;
+};
+
+Aggregate _aggregate[DHT_CHANNEL_COUNT];
+
+// ***
+// *** The totals in the aggregate block that the master has not
+// *** acked yet. A latch adds the running totals to them, so a
+// *** master that lost a read and reads the block again gets
+// *** those readings back along with the new ones.
+// ***
+Aggregate _aggregateLatched[DHT_CHANNEL_COUNT];
+
+void resetAggregate()
+{
+  Aggregate& aggregate = _aggregate[_channel];
+
+  aggregate.count = 0;
+  aggregate.temperatureSum = 0;
+  aggregate.humiditySum = 0;
+  aggregate.start = millis();
+}
+
+void addToAggregate(int16_t temperature, int16_t humidity)
+{
+  Aggregate& aggregate = _aggregate[_channel];
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    // ***
+    // *** The first reading in the window sets the
+    // *** minimum and maximum values.
+    // ***
+    if (aggregate.count == 0)
+    {
+      aggregate.temperatureMin = aggregate.temperatureMax = temperature;
+      aggregate.humidityMin = aggregate.humidityMax = humidity;
+    }
+    else
+    {
+      aggregate.temperatureMin = min(aggregate.temperatureMin, temperature);
+      aggregate.temperatureMax = max(aggregate.temperatureMax, temperature);
+      aggregate.humidityMin = min(aggregate.humidityMin, humidity);
+      aggregate.humidityMax = max(aggregate.humidityMax, humidity);
+    }
+
+    // ***
+    // *** Once the count is full the window stops taking
+    // *** readings so the mean stays correct.
+    // ***
+    if (aggregate.count < UINT16_MAX)
+    {
+      aggregate.temperatureSum += temperature;
+      aggregate.humiditySum += humidity;
+      aggregate.count++;
+    }
+  }
+}
+
+int16_t getAggregateMean(int32_t sum, uint16_t count)
+{
+  int16_t returnValue = 0;
+
+  if (count > 0)
+  {
+    // ***
+    // *** Round to the nearest tenth.
+    // ***
+    int32_t half = (sum < 0) ? -(int32_t)(count / 2) : (int32_t)(count / 2);
+    returnValue = (sum + half) / (int32_t)count;
+  }
+
+  return returnValue;
+}
+
+void mergeAggregate(Aggregate& into, const Aggregate& from)
+{
+  if (from.count > 0)
+  {
+    if (into.count == 0)
+    {
+      into.temperatureMin = from.temperatureMin;
+      into.temperatureMax = from.temperatureMax;
+      into.humidityMin = from.humidityMin;
+      into.humidityMax = from.humidityMax;
+    }
+    else
+    {
+      into.temperatureMin = min(into.temperatureMin, from.temperatureMin);
+      into.temperatureMax = max(into.temperatureMax, from.temperatureMax);
+      into.humidityMin = min(into.humidityMin, from.humidityMin);
+      into.humidityMax = max(into.humidityMax, from.humidityMax);
+    }
+
+    // ***
+    // *** Like a full window, a full count takes no more
+    // *** readings so the mean stays correct.
+    // ***
+    if ((uint32_t)into.count + from.count <= UINT16_MAX)
+    {
+      into.temperatureSum += from.temperatureSum;
+      into.humiditySum += from.humiditySum;
+      into.count += from.count;
+    }
+  }
+}
+
+void latchAggregate()
+{
+  // ***
+  // *** Add the running totals to the ones not yet acked, copy
+  // *** them to the aggregate block and start a new window.
+  // *** This is done with interrupts disabled so a master never
+  // *** reads a partially updated block.
+  // ***
+  Aggregate& latched = _aggregateLatched[_channel];
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    mergeAggregate(latched, _aggregate[_channel]);
+    bool hasReadings = (latched.count > 0);
+
+    writeUint16(REGISTER_AGGREGATE_COUNT, latched.count);
+    writeInt16(REGISTER_TEMPERATURE_MIN, hasReadings ? latched.temperatureMin : 0);
+    writeInt16(REGISTER_TEMPERATURE_MAX, hasReadings ? latched.temperatureMax : 0);
+    writeInt16(REGISTER_TEMPERATURE_MEAN, getAggregateMean(latched.temperatureSum, latched.count));
+    writeInt16(REGISTER_HUMIDITY_MIN, hasReadings ? latched.humidityMin : 0);
+    writeInt16(REGISTER_HUMIDITY_MAX, hasReadings ? latched.humidityMax : 0);
+    writeInt16(REGISTER_HUMIDITY_MEAN, getAggregateMean(latched.humiditySum, latched.count));
+
+    resetAggregate();
+  }
+}
+
+void ackAggregate()
+{
+  // ***
+  // *** The master has the block, so the next latch starts
+  // *** from the running totals alone.
+  // ***
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    Aggregate& latched = _aggregateLatched[_channel];
+
+    latched.count = 0;
+    latched.temperatureSum = 0;
+    latched.humiditySum = 0;
+  }
+}
+
+void checkAggregateWindow()
+{
+  // ***
+  // *** A window of 0 means the block is latched each
+  // *** time a master reads it instead of on a timer.
+  // ***
+  uint32_t window = readUint32(REGISTER_AGGREGATE_WINDOW);
+
+  if (window > 0 && (millis() - _aggregate[_channel].start) >= window)
+  {
+    // ***
+    // *** A timed window replaces the block whether or not
+    // *** the master read it.
+    // ***
+    ackAggregate();
+    latchAggregate();
+  }
+}
+
+bool handleAggregateWrite(uint8_t registerPosition, uint8_t value)
+{
+  bool returnValue = false;
+
+  if (registerPosition == REGISTER_AGGREGATE_CONTROL)
+  {
+    if (Features::aggregate && value == AGGREGATE_COMMAND_ACK)
+    {
+      ackAggregate();
+    }
+
+    returnValue = true;
+  }
+
+  return returnValue;
+}
+
+#endif
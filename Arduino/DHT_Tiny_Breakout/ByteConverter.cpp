@@ -74,6 +74,7 @@ float ByteConverter::bytesToDouble(uint8_t* data)
   return uvalue.value;
 }
 
+#if DHT_FEATURE_INT64
 // *********************
 // ***
 // *** int64_t
@@ -129,6 +130,7 @@ uint64_t ByteConverter::bytesToUint64(uint8_t* data)
 
   return uvalue.value;
 }
+#endif
 
 // *********************
 // ***
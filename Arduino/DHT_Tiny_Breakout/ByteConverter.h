@@ -20,6 +20,7 @@
 #define BYTE_CONVERTER_H
 
 #include <Arduino.h>
+#include "Features.h"
 
 #define SIZE_FLOAT    4
 #define SIZE_DOUBLE   4
@@ -44,6 +45,7 @@ union u_double
   double value;
 };
 
+#if DHT_FEATURE_INT64
 union u_int64
 {
   uint8_t bytes[SIZE_INT64];
@@ -55,6 +57,7 @@ union u_uint64
   uint8_t bytes[SIZE_UINT64];
   uint64_t value;
 };
+#endif
 
 union u_int32
 {
@@ -89,10 +92,12 @@ class ByteConverter
     static void doubleToBytes(double value, uint8_t* data);
     static float bytesToDouble(uint8_t* data);
 
+#if DHT_FEATURE_INT64
     static int64_t bytesToInt64(uint8_t* data);
     static void int64ToBytes(int64_t value, uint8_t* data);
     static uint64_t bytesToUint64(uint8_t* data);
     static void uint64ToBytes(uint64_t value, uint8_t* data);
+#endif
 
     static int32_t bytesToInt32(uint8_t* data);
     static void int32ToBytes(int32_t value, uint8_t* data);
@@ -100,7 +105,7 @@ class ByteConverter
     static void uint32ToBytes(uint32_t value, uint8_t* data);
 
     static int16_t bytesToInt16(uint8_t* data);
-    static void int16ToBytes(int value, uint8_t* data);
+    static void int16ToBytes(int16_t value, uint8_t* data);
     static uint16_t bytesToUint16(uint8_t* data);
     static void uint16ToBytes(uint16_t value, uint8_t* data);
 };
@@ -0,0 +1,37 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include "Register_Defs.h"
+
+// ***
+// *** Applies a calibration to a reading in tenths. The gain is
+// *** fixed point with CALIBRATION_GAIN_SHIFT fractional bits and
+// *** the product is rounded to the nearest tenth before the
+// *** offset is added. The result is clamped to the given range.
+// ***
+int16_t calibrate(int16_t value, int16_t offset, uint16_t gain, int16_t minimum, int16_t maximum)
+{
+  int32_t result = (((int32_t)value * gain + (CALIBRATION_GAIN_ONE / 2)) >> CALIBRATION_GAIN_SHIFT) + offset;
+
+  return (result < minimum) ? minimum : ((result > maximum) ? maximum : (int16_t)result);
+}
+
+#endif
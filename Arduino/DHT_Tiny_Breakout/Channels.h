@@ -0,0 +1,111 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef CHANNELS_H
+#define CHANNELS_H
+
+#include <Arduino.h>
+#include "Registers.h"
+#include "Pins.h"
+
+// ***
+// *** A breakout built for a larger AVR reads several sensors,
+// *** one per channel. Each channel has a data pin, a power pin
+// *** and a bank of registers of its own, so a channel has its
+// *** own model, interval, thresholds, filter and calibration.
+// ***
+// *** The master writes the channel number to REGISTER_CHANNEL
+// *** and every read and write after that goes to the bank of
+// *** that channel, until another channel is selected. Reading
+// *** REGISTER_CHANNEL returns the selected channel and
+// *** REGISTER_CHANNEL_COUNT the number of channels. A write of
+// *** a channel that does not exist is ignored.
+// ***
+const uint8_t _readingPins[] = DHT_READING_PINS;
+const uint8_t _powerPins[] = DHT_POWER_PINS;
+
+static_assert(sizeof(_readingPins) >= DHT_CHANNEL_COUNT && sizeof(_powerPins) >= DHT_CHANNEL_COUNT,
+              "Each channel needs a data pin and a power pin");
+
+// ***
+// *** The channel selected by the master.
+// ***
+volatile uint8_t _selectedChannel = 0;
+
+// ***
+// *** The time of the last sensor read on any channel and the
+// *** channel it was on. The scheduler starts looking for the
+// *** next channel to read after this one.
+// ***
+uint32_t _lastSensorRead = 0;
+uint8_t _lastSensorChannel = 0;
+
+bool handleChannelWrite(uint8_t registerPosition, uint8_t value)
+{
+  bool returnValue = false;
+
+  if (registerPosition == REGISTER_CHANNEL)
+  {
+    if (value < DHT_CHANNEL_COUNT)
+    {
+      _selectedChannel = value;
+    }
+
+    returnValue = true;
+  }
+
+  return returnValue;
+}
+
+void syncSharedRegisters()
+{
+#if DHT_CHANNEL_COUNT > 1
+  // ***
+  // *** Copy the registers that are the same in every bank
+  // *** from the bank that was written to the others.
+  // ***
+  for (uint8_t channel = 0; channel < DHT_CHANNEL_COUNT; channel++)
+  {
+    volatile uint8_t* bank = _registerBanks[channel];
+
+    if (bank != _registers)
+    {
+      bank[REGISTER_DEVICE_ADDRESS] = _registers[REGISTER_DEVICE_ADDRESS];
+
+      for (uint8_t i = SHARED_BLOCK_START; i < SHARED_BLOCK_END; i++)
+      {
+        bank[i] = _registers[i];
+      }
+
+      bitWrite(bank[REGISTER_CONFIG], CONFIG_BIT_PEC_ENABLED, getRegisterBit(REGISTER_CONFIG, CONFIG_BIT_PEC_ENABLED));
+    }
+  }
+#endif
+}
+
+uint8_t getScheduledChannel(uint8_t index)
+{
+  // ***
+  // *** Channels are visited round-robin starting with the
+  // *** one after the channel that was read last, so a channel
+  // *** that is due is never passed over for long.
+  // ***
+  return (_lastSensorChannel + 1 + index) % DHT_CHANNEL_COUNT;
+}
+
+#endif
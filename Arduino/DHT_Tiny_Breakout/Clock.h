@@ -0,0 +1,173 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <Arduino.h>
+#include <util/atomic.h>
+#include "Registers.h"
+#include "Features.h"
+
+// ***
+// *** The breakout does almost nothing between readings. Define
+// *** DHT_CLOCK_SCALING to have an ATtiny run at F_CPU >>
+// *** CLOCK_IDLE_SHIFT while it is idle and at F_CPU while it
+// *** reads the sensor or serves the I2C bus. The handlers and
+// *** readSensor() raise the clock and the end of each loop pass
+// *** drops it again once the bus has been quiet for
+// *** CLOCK_BUS_HOLD milliseconds.
+// ***
+// *** Timer 0 keeps millis(), micros() and delay(). Its prescaler
+// *** is lowered by the same factor as the clock so they keep
+// *** time at either clock, which limits the idle shift to 3
+// *** (/8) or 6 (/64). Delays and timeouts counted in cycles are
+// *** scaled with getClockShift(). The USI stretches the bus
+// *** clock until the handlers catch up, so keep the idle clock
+// *** at 1 MHz or more for masters that do not wait long.
+// ***
+// *** The hold does not block the bus. The handlers run from the
+// *** USI interrupts throughout and WireDelay() keeps checking
+// *** for a stop, so only the first transfer after an idle
+// *** period is stretched. A master that times out on it and
+// *** drops the breakout stalls the trace ring (see Trace.h).
+// ***
+// #define DHT_CLOCK_SCALING
+
+#if defined(DHT_CLOCK_SCALING) && defined( __AVR_ATtiny85__ )
+#define CLOCK_SCALING
+#include <avr/power.h>
+#endif
+
+#ifndef CLOCK_IDLE_SHIFT
+#define CLOCK_IDLE_SHIFT      3
+#endif
+
+#define CLOCK_BUS_HOLD        20
+
+#define CLOCK_FULL            0
+#define CLOCK_IDLE            1
+
+#if defined(CLOCK_SCALING)
+static_assert(CLOCK_IDLE_SHIFT == 3 || CLOCK_IDLE_SHIFT == 6, "Timer 0 can only make up for an idle shift of 3 or 6");
+
+#define CLOCK_TIMER_MASK      (_BV(CS02) | _BV(CS01) | _BV(CS00))
+#define CLOCK_TIMER_FULL      (_BV(CS01) | _BV(CS00))
+#if CLOCK_IDLE_SHIFT == 3
+#define CLOCK_TIMER_IDLE      _BV(CS01)
+#else
+#define CLOCK_TIMER_IDLE      _BV(CS00)
+#endif
+#endif
+
+// ***
+// *** The current rate, when it was set and the milliseconds
+// *** spent at each rate before that.
+// ***
+volatile uint8_t _clockRate = CLOCK_FULL;
+volatile uint32_t _clockSince = 0;
+volatile uint32_t _clockTime[2] = { 0, 0 };
+
+// ***
+// *** The last time one of the I2C handlers ran.
+// ***
+volatile uint32_t _clockBusActivity = 0;
+
+uint8_t getClockShift()
+{
+  return _clockRate == CLOCK_IDLE ? CLOCK_IDLE_SHIFT : 0;
+}
+
+void setClockRate(uint8_t rate)
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    uint32_t now = millis();
+    _clockTime[_clockRate] += now - _clockSince;
+    _clockSince = now;
+
+#if defined(CLOCK_SCALING)
+    if (rate != _clockRate)
+    {
+      clock_prescale_set(rate == CLOCK_IDLE ? (clock_div_t)CLOCK_IDLE_SHIFT : clock_div_1);
+      TCCR0B = (TCCR0B & ~CLOCK_TIMER_MASK) | (rate == CLOCK_IDLE ? CLOCK_TIMER_IDLE : CLOCK_TIMER_FULL);
+    }
+#endif
+
+    _clockRate = rate;
+  }
+}
+
+void raiseClock()
+{
+#if defined(CLOCK_SCALING)
+  if (_clockRate != CLOCK_FULL)
+  {
+    setClockRate(CLOCK_FULL);
+  }
+#endif
+}
+
+void raiseClockForBus()
+{
+#if defined(CLOCK_SCALING)
+  _clockBusActivity = millis();
+  raiseClock();
+#endif
+}
+
+void dropClock()
+{
+#if defined(CLOCK_SCALING)
+  // ***
+  // *** A handler that runs between the check and the change
+  // *** would be left at the idle clock.
+  // ***
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    if (_clockRate != CLOCK_IDLE && (millis() - _clockBusActivity) >= CLOCK_BUS_HOLD)
+    {
+      setClockRate(CLOCK_IDLE);
+    }
+  }
+#endif
+}
+
+void updateClockTime()
+{
+  // ***
+  // *** Add the time at the current rate so far.
+  // ***
+  uint32_t time[2];
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    time[CLOCK_FULL] = _clockTime[CLOCK_FULL];
+    time[CLOCK_IDLE] = _clockTime[CLOCK_IDLE];
+    time[_clockRate] += millis() - _clockSince;
+  }
+
+#if defined(CLOCK_SCALING)
+  _registers[REGISTER_CLOCK_IDLE_SHIFT] = CLOCK_IDLE_SHIFT;
+#else
+  _registers[REGISTER_CLOCK_IDLE_SHIFT] = 0;
+#endif
+  writeUint32(REGISTER_CLOCK_FULL_TIME, time[CLOCK_FULL]);
+  writeUint32(REGISTER_CLOCK_IDLE_TIME, time[CLOCK_IDLE]);
+}
+#endif
@@ -22,16 +22,9 @@
 #include <Arduino.h>
 #include <EEPROM.h>
 #include "Registers.h"
-
-// ***
-// *** Supported DHT Models
-// ***
-#define DHT_MODEL_11          11
-#define DHT_MODEL_21          21
-#define DHT_MODEL_22          22
-#define DHT_MODEL_33          33
-#define DHT_MODEL_44          44
-#define DHT_MODEL_DEFAULT     DHT_MODEL_22
+#include "DhtDecoder.h"
+#include "Trace.h"
+#include "Features.h"
 
 // ***
 // *** Default slave address.
@@ -49,7 +42,7 @@
 // *** Not all of the configuration bits can be saved. This
 // *** will mask out the bits that should not be saved.
 // ***
-#define CONFIG_MASK   B00000011
+#define CONFIG_MASK   B00001011
 
 // ***
 // *** Locations of the configuration.
@@ -65,10 +58,76 @@
 #define MODEL_SIGNATURE     TOTAL_LENGTH + 4
 #define DHT_MODEL           TOTAL_LENGTH + 5
 
+// ***
+// *** Locations of the extended configuration. Registers added
+// *** after REGISTER_DHT_MODEL are saved here, in the order they
+// *** appear in _extendedRegisters, following a signature and the
+// *** number of registers that were saved.
+// ***
+#define EXTENDED_SIGNATURE  TOTAL_LENGTH + 6
+#define EXTENDED_COUNT      TOTAL_LENGTH + 7
+#define EXTENDED_START      TOTAL_LENGTH + 8
+
+// ***
+// *** Location of the serial number. It is kept at the end of
+// *** the EEPROM so it does not move as the configuration grows,
+// *** and resetting the configuration does not clear it.
+// ***
+#define SERIAL_SIGNATURE    E2END - SIZE_UINT32
+#define SERIAL_START        E2END - SIZE_UINT32 + 1
+
+// ***
+// *** Each channel saves its configuration, model and extended
+// *** registers with the layout above, starting at its own base.
+// *** Channel 0 starts at 0 so a configuration saved before there
+// *** were channels is restored to it. The device address and
+// *** the serial number belong to the breakout and are only kept
+// *** at the locations above.
+// ***
+#define CONFIGURATION_SIZE  64
+#define CONFIGURATION_BASE  (_channel * CONFIGURATION_SIZE)
+
+// ***
+// *** The extended registers that are saved to EEPROM. New
+// *** registers must be added to the end of this list so that
+// *** a configuration saved by older firmware can be restored.
+// ***
+const uint8_t _extendedRegisters[] =
+{
+  REGISTER_MIN_INTERVAL,
+  REGISTER_SLOPE_THRESHOLD,
+  REGISTER_AGGREGATE_WINDOW,
+  REGISTER_FILTER_MODE,
+  REGISTER_TEMPERATURE_SLEW,
+  REGISTER_HUMIDITY_SLEW,
+  REGISTER_TEMPERATURE_OFFSET,
+  REGISTER_TEMPERATURE_GAIN,
+  REGISTER_HUMIDITY_OFFSET,
+  REGISTER_HUMIDITY_GAIN,
+  REGISTER_LOG_DECIMATION
+};
+
+#define EXTENDED_REGISTER_COUNT (uint8_t)sizeof(_extendedRegisters)
+
+static_assert(DHT_CHANNEL_COUNT * CONFIGURATION_SIZE < SERIAL_SIGNATURE,
+              "The channel configurations must fit below the serial number");
+
+// ***
+// *** The model of each channel when it is not saved to EEPROM.
+// *** It is kept XOR the default model so the array starts out
+// *** holding the default without an initializer.
+// ***
+uint8_t _dhtModel[DHT_CHANNEL_COUNT];
+
 uint8_t getDeviceAddress()
 {
   uint8_t returnValue = I2C_SLAVE_ADDRESS;
 
+  if (!Features::persistence)
+  {
+    return returnValue;
+  }
+
   // ***
   // *** If the memory at address ADDRESS_SIGNATURE has the
   // *** SIGNATURE byte, then we know the next position has a valid
@@ -89,6 +148,11 @@ uint8_t getDeviceAddress()
 
 void setDeviceAddress(byte address)
 {
+  if (!Features::persistence)
+  {
+    return;
+  }
+
   EEPROM.update(ADDRESS_SIGNATURE, SIGNATURE);
   EEPROM.update(DEVICE_ADDRESS, address);
 }
@@ -101,36 +165,87 @@ void resetDeviceAddress()
 
 uint8_t getDhtModel()
 {
+#if defined(DHT_FIXED_MODEL)
+  // ***
+  // *** The firmware only supports one model.
+  // ***
+  return DHT_FIXED_MODEL;
+#else
   uint8_t returnValue = DHT_MODEL_DEFAULT;
 
+  if (!Features::persistence)
+  {
+    return _dhtModel[_channel] ^ DHT_MODEL_DEFAULT;
+  }
+
   // ***
   // *** If the memory at address ADDRESS_SIGNATURE has the
   // *** SIGNATURE byte, then we know the next position has a valid
   // *** address.
   // ***
-  if (EEPROM.read(MODEL_SIGNATURE) == SIGNATURE)
+  if (EEPROM.read(CONFIGURATION_BASE + MODEL_SIGNATURE) == SIGNATURE)
   {
-    returnValue = EEPROM.read(DHT_MODEL);
+    returnValue = EEPROM.read(CONFIGURATION_BASE + DHT_MODEL);
   }
   else
   {
-    EEPROM.update(MODEL_SIGNATURE, SIGNATURE);
-    EEPROM.update(DHT_MODEL, DHT_MODEL_DEFAULT);
+    EEPROM.update(CONFIGURATION_BASE + MODEL_SIGNATURE, SIGNATURE);
+    EEPROM.update(CONFIGURATION_BASE + DHT_MODEL, DHT_MODEL_DEFAULT);
   }
 
   return returnValue;
+#endif
 }
 
 void setDhtModel(byte model)
 {
-  EEPROM.update(MODEL_SIGNATURE, SIGNATURE);
-  EEPROM.update(DHT_MODEL, model);
+  if (!Features::persistence)
+  {
+    _dhtModel[_channel] = model ^ DHT_MODEL_DEFAULT;
+    return;
+  }
+
+  EEPROM.update(CONFIGURATION_BASE + MODEL_SIGNATURE, SIGNATURE);
+  EEPROM.update(CONFIGURATION_BASE + DHT_MODEL, model);
 }
 
 void resetDhtModel()
 {
-  EEPROM.update(MODEL_SIGNATURE, 0);
-  EEPROM.update(DHT_MODEL, 0);
+  EEPROM.update(CONFIGURATION_BASE + MODEL_SIGNATURE, 0);
+  EEPROM.update(CONFIGURATION_BASE + DHT_MODEL, 0);
+}
+
+uint32_t getDeviceSerial()
+{
+  uint32_t returnValue = 0;
+
+  // ***
+  // *** A serial number of 0 indicates that one
+  // *** has not been generated yet.
+  // ***
+  if (EEPROM.read(SERIAL_SIGNATURE) == SIGNATURE)
+  {
+    for (uint8_t i = 0 ; i < SIZE_UINT32 ; i++)
+    {
+      returnValue |= (uint32_t)EEPROM.read(SERIAL_START + i) << (8 * i);
+    }
+  }
+
+  return returnValue;
+}
+
+void setDeviceSerial(uint32_t serial)
+{
+  for (uint8_t i = 0 ; i < SIZE_UINT32 ; i++)
+  {
+    EEPROM.update(SERIAL_START + i, (uint8_t)(serial >> (8 * i)));
+  }
+
+  // ***
+  // *** The signature is written last so a serial number
+  // *** that was only partly written is not used.
+  // ***
+  EEPROM.update(SERIAL_SIGNATURE, SIGNATURE);
 }
 
 void resetConfiguration()
@@ -140,41 +255,101 @@ void resetConfiguration()
   // ***
   for (uint16_t i = 0 ; i < (TOTAL_LENGTH + 1) ; i++)
   {
-    EEPROM.update(i, 0);
+    EEPROM.update(CONFIGURATION_BASE + i, 0);
   }
 
+  EEPROM.update(CONFIGURATION_BASE + EXTENDED_SIGNATURE, 0);
+
   // ***
   // *** Set the status bit.
   // ***
   setRegisterBit(REGISTER_STATUS, STATUS_CONFIG_SAVED, 0);
 }
 
+void saveExtendedConfiguration()
+{
+  uint16_t address = CONFIGURATION_BASE + EXTENDED_START;
+
+  EEPROM.update(CONFIGURATION_BASE + EXTENDED_SIGNATURE, SIGNATURE);
+  EEPROM.update(CONFIGURATION_BASE + EXTENDED_COUNT, EXTENDED_REGISTER_COUNT);
+
+  // ***
+  // *** Write each register one after the other.
+  // ***
+  for (uint8_t i = 0 ; i < EXTENDED_REGISTER_COUNT ; i++)
+  {
+    uint8_t registerId = _extendedRegisters[i];
+
+    for (uint8_t j = 0 ; j < getRegisterSize(registerId) ; j++)
+    {
+      EEPROM.update(address++, _registers[registerId + j]);
+    }
+  }
+}
+
+void restoreExtendedConfiguration()
+{
+  // ***
+  // *** The extended configuration is optional since it
+  // *** may have been saved by older firmware.
+  // ***
+  if (EEPROM.read(CONFIGURATION_BASE + EXTENDED_SIGNATURE) == SIGNATURE)
+  {
+    uint16_t address = CONFIGURATION_BASE + EXTENDED_START;
+
+    // ***
+    // *** Only restore the registers that were saved. The others
+    // *** keep their default values.
+    // ***
+    uint8_t count = min(EEPROM.read(CONFIGURATION_BASE + EXTENDED_COUNT), EXTENDED_REGISTER_COUNT);
+
+    for (uint8_t i = 0 ; i < count ; i++)
+    {
+      uint8_t registerId = _extendedRegisters[i];
+
+      for (uint8_t j = 0 ; j < getRegisterSize(registerId) ; j++)
+      {
+        _registers[registerId + j] = EEPROM.read(address++);
+      }
+    }
+  }
+}
+
 void saveConfiguration()
 {
+  TRACE_CHANNEL(TRACE_EVENT_SAVE_START);
+
   // ***
   // *** Write the signature to the first byte of memory to indicate
   // *** that the configuration was saved.
   // ***
-  EEPROM.update(0, SIGNATURE);
+  EEPROM.update(CONFIGURATION_BASE, SIGNATURE);
 
   // ***
   // *** Copy a portion of the registers to the ERPROM.
   // ***
   for (uint16_t i = 1 ; i < TOTAL_LENGTH - 1 ; i++)
   {
-    EEPROM.update(i, _registers[START_REGISTER + (i - 1)]);
+    EEPROM.update(CONFIGURATION_BASE + i, _registers[START_REGISTER + (i - 1)]);
   }
 
   // ***
   // *** Save the config bits.
   // ***
-  EEPROM.update(TOTAL_LENGTH - 1, _registers[REGISTER_CONFIG] & CONFIG_MASK);
+  EEPROM.update(CONFIGURATION_BASE + TOTAL_LENGTH - 1, _registers[REGISTER_CONFIG] & CONFIG_MASK);
+
+  // ***
+  // *** Save the extended registers.
+  // ***
+  saveExtendedConfiguration();
 
   // ***
   // *** Set the status bit to indicate that there
   // *** is a valid saved confgiuration.
   // ***
   setRegisterBit(REGISTER_STATUS, STATUS_CONFIG_SAVED, 1);
+
+  TRACE_CHANNEL(TRACE_EVENT_SAVE_END);
 }
 
 bool restoreConfiguration()
@@ -184,7 +359,7 @@ bool restoreConfiguration()
   // ***
   // *** Check the EEPROM for the signature.
   // ***
-  uint8_t signature = EEPROM.read(0);
+  uint8_t signature = EEPROM.read(CONFIGURATION_BASE);
 
   if (signature == SIGNATURE)
   {
@@ -193,13 +368,18 @@ bool restoreConfiguration()
     // ***
     for (uint16_t i = 1 ; i < TOTAL_LENGTH - 1 ; i++)
     {
-      _registers[START_REGISTER + (i - 1)] = EEPROM.read(i);
+      _registers[START_REGISTER + (i - 1)] = EEPROM.read(CONFIGURATION_BASE + i);
     }
 
     // ***
     // *** Restore the config bits.
     // ***
-    _registers[REGISTER_CONFIG] = EEPROM.read(TOTAL_LENGTH - 1);
+    _registers[REGISTER_CONFIG] = EEPROM.read(CONFIGURATION_BASE + TOTAL_LENGTH - 1);
+
+    // ***
+    // *** Restore the extended registers.
+    // ***
+    restoreExtendedConfiguration();
 
     // ***
     // *** Set the status bit.
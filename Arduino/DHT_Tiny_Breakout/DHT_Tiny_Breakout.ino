@@ -28,13 +28,25 @@
 // ********************************************************************************
 // ********************************************************************************
 
+#include "Features.h"
 #include "Version.h"
 #include "dht.h"
 #include "ByteConverter.h"
 #include "Registers.h"
 #include "Register_Defs.h"
 #include "Configuration.h"
+#include "Aggregate.h"
+#include "Filter.h"
+#include "Calibration.h"
+#include "Derived.h"
 #include "MyWire.h"
+#include "Enumeration.h"
+#include "Channels.h"
+#include "Sensor.h"
+#include "Pec.h"
+#include "Trace.h"
+#include "Clock.h"
+#include "SpillLog.h"
 #include "Pins.h"
 #include "Debug.h"
 
@@ -45,21 +57,31 @@
 #define DEFAULT_UPDATE_INTERVAL 2000
 
 // ***
-// *** DHT
+// *** Default minimum interval (in milliseconds) and slope
+// *** threshold (change per minute) used by the adaptive interval.
 // ***
-dht _dht;
+#define DEFAULT_MIN_INTERVAL    2000
+#define DEFAULT_SLOPE_THRESHOLD 0.5
 
 // ***
-// *** Stores the last time a sensor reading was taken.
+// *** Default filter. The slew limits are in tenths per second;
+// *** a DHT11 moves in whole degrees so the temperature limit
+// *** must allow at least 10 tenths between readings.
 // ***
-uint32_t _lastReading = millis();
+#define DEFAULT_FILTER_MODE       0
+#define DEFAULT_TEMPERATURE_SLEW  5
+#define DEFAULT_HUMIDITY_SLEW     20
 
 // ***
-// *** Indicates if the thresholds are currently enabled. This flag is
-// *** used to track the last value of the threshold bit to prevent the
-// *** need write to the interrupt pin on every loop.
+// *** Stores the last time a sensor reading was taken
+// *** on each channel.
 // ***
-volatile bool _thresholdsEnabled = false;
+uint32_t _lastReading[DHT_CHANNEL_COUNT];
+
+// ***
+// *** Outlier filter state for the readings of each channel.
+// ***
+Filter _filter[DHT_CHANNEL_COUNT];
 
 // ***
 // *** The number of bytes to return in the next request.
@@ -68,11 +90,131 @@ volatile uint8_t _requestCount = 0;
 
 void setup()
 {
+  // ***
+  // *** Each channel has its own bank of registers
+  // *** and its own saved configuration.
+  // ***
+  for (uint8_t channel = 0; channel < DHT_CHANNEL_COUNT; channel++)
+  {
+    setChannel(channel);
+    setupChannel(channel);
+  }
+
+  setChannel(0);
+
+  // ***
+  // *** The serial number is generated the first time the
+  // *** breakout starts and kept in EEPROM after that.
+  // ***
+  uint32_t serial = getDeviceSerial();
+
+  if (serial == 0)
+  {
+    serial = generateSerial();
+    setDeviceSerial(serial);
+  }
+
+  writeUint32(REGISTER_SERIAL, serial);
+
+#if defined(DHT_SPILL_LOG)
+  // ***
+  // *** Find the spill log left in EEPROM.
+  // ***
+  setupLog();
+#endif
+
+  // ***
+  // *** Set the interrupt pin for output.
+  // ***
+  pinMode(INTERRUPT_PIN, OUTPUT);
+  digitalWrite(INTERRUPT_PIN, LOW);
+
+  // ***
+  // *** Setup the I2C bus.
+  // ***
+  byte deviceAddress = getDeviceAddress();
+
+  // ***
+  // *** Put the current device address into the register.
+  // ***
+  _registers[REGISTER_DEVICE_ADDRESS] = deviceAddress;
+
+  // ***
+  // *** The serial number and device address are
+  // *** the same in every bank.
+  // ***
+  syncSharedRegisters();
+
+  WireBegin(deviceAddress);
+  Wire.onReceive(receiveEvent);
+  Wire.onRequest(requestEvent);
+
+  // ***
+  // *** Debug information.
+  // ***
+  if (Features::debug)
+  {
+    initDebug();
+    displayRegisters();
+    displayConfiguration();
+    displayDeviceAddress();
+  }
+}
+
+void setupChannel(uint8_t channel)
+{
+  // ***
+  // *** Set the defaults for the adaptive interval. These are
+  // *** replaced when a saved configuration includes them.
+  // ***
+  writeUint32(REGISTER_MIN_INTERVAL, DEFAULT_MIN_INTERVAL);
+  writeFloat(REGISTER_SLOPE_THRESHOLD, DEFAULT_SLOPE_THRESHOLD);
+
+  // ***
+  // *** Aggregation is latched on read by default.
+  // ***
+  writeUint32(REGISTER_AGGREGATE_WINDOW, 0);
+
+  // ***
+  // *** The outlier filter is off by default.
+  // ***
+  _registers[REGISTER_FILTER_MODE] = DEFAULT_FILTER_MODE;
+  writeUint16(REGISTER_TEMPERATURE_SLEW, DEFAULT_TEMPERATURE_SLEW);
+  writeUint16(REGISTER_HUMIDITY_SLEW, DEFAULT_HUMIDITY_SLEW);
+  writeUint16(REGISTER_FILTER_REJECTS, 0);
+
+  if (Features::filter)
+  {
+    resetFilter(_filter[channel]);
+  }
+
+  // ***
+  // *** No calibration until one is written and saved.
+  // ***
+  writeInt16(REGISTER_TEMPERATURE_OFFSET, 0);
+  writeUint16(REGISTER_TEMPERATURE_GAIN, CALIBRATION_GAIN_ONE);
+  writeInt16(REGISTER_HUMIDITY_OFFSET, 0);
+  writeUint16(REGISTER_HUMIDITY_GAIN, CALIBRATION_GAIN_ONE);
+
+  // ***
+  // *** Missed readings are not logged until a decimation
+  // *** is written.
+  // ***
+  _registers[REGISTER_LOG_DECIMATION] = 0;
+
+  // ***
+  // *** Publish the capture scaling so the master can
+  // *** convert the pulse widths back to loop counts.
+  // ***
+  writeUint16(REGISTER_CAPTURE_TIMEOUT, DHTLIB_TIMEOUT);
+  _registers[REGISTER_CAPTURE_SHIFT] = DHTLIB_CAPTURE_SHIFT;
+
   // ***
   // *** Restore the configuration from EEPROM. If the configuration
-  // *** could not be restord, set the default values.
+  // *** could not be restord, or the build does not save it, set
+  // *** the default values.
   // ***
-  if (!restoreConfiguration())
+  if (!Features::persistence || !restoreConfiguration())
   {
     // ***
     // *** Set the default interval in the registers.
@@ -84,6 +226,12 @@ void setup()
     // ***
     writeUint32(REGISTER_READING_ID, 0);
 
+    // ***
+    // *** No reading has been taken yet.
+    // ***
+    writeUint32(REGISTER_READING_TIME, 0);
+    writeUint32(REGISTER_READING_AGE, READING_AGE_NONE);
+
     // ***
     // *** The start delay is the amount of time to wait
     // *** after power-up to take a reading from the sensor.
@@ -100,9 +248,9 @@ void setup()
     setRegisterBit(REGISTER_CONFIG, CONFIG_BIT_SENSOR_ENABLED, 1);
     setRegisterBit(REGISTER_CONFIG, CONFIG_BIT_THRESHOLD_ENABLED, 0);
     setRegisterBit(REGISTER_CONFIG, CONFIG_BIT_TRIGGER_READING, 0);
-    setRegisterBit(REGISTER_CONFIG, CONFIG_BIT_RESERVED_1, 0);
-    setRegisterBit(REGISTER_CONFIG, CONFIG_BIT_RESERVED_2, 0);
-    setRegisterBit(REGISTER_CONFIG, CONFIG_BIT_RESERVED_3, 0);
+    setRegisterBit(REGISTER_CONFIG, CONFIG_BIT_ADAPTIVE_INTERVAL, 0);
+    setRegisterBit(REGISTER_CONFIG, CONFIG_BIT_CAPTURE, 0);
+    setRegisterBit(REGISTER_CONFIG, CONFIG_BIT_PEC_ENABLED, 0);
     setRegisterBit(REGISTER_CONFIG, CONFIG_BIT_WRITE_CONFIG, 0);
     setRegisterBit(REGISTER_CONFIG, CONFIG_BIT_RESET_CONFIG, 0);
 
@@ -131,30 +279,16 @@ void setup()
   _registers[REGISTER_ID] = 0x2D;
 
   // ***
-  // *** The ground of the pin is supplied
-  // *** by the pin DHT_POWER_PIN. This
-  // *** allows the DHT to be turned off
-  // *** over I2C to conserve power.
+  // *** Each bank holds its own channel number so a read of
+  // *** REGISTER_CHANNEL returns the channel that is selected.
   // ***
-  pinMode(DHT_POWER_PIN, OUTPUT);
-  digitalWrite(DHT_POWER_PIN, LOW);
-  setRegisterBit(REGISTER_STATUS, STATUS_SENSOR_IS_ENABLED, 1);
+  _registers[REGISTER_CHANNEL] = channel;
+  _registers[REGISTER_CHANNEL_COUNT] = DHT_CHANNEL_COUNT;
 
   // ***
-  // *** Setup the DHT data pin.
+  // *** The sensor starts out enabled.
   // ***
-  pinMode(DHT_READING_PIN, INPUT);
-
-  // ***
-  // *** Set the interrupt pin for output.
-  // ***
-  pinMode(INTERRUPT_PIN, OUTPUT);
-  digitalWrite(INTERRUPT_PIN, LOW);
-
-  // ***
-  // *** Setup the I2C bus.
-  // ***
-  byte deviceAddress = getDeviceAddress();
+  setRegisterBit(REGISTER_STATUS, STATUS_SENSOR_IS_ENABLED, 1);
 
   // ***
   // *** Write the DHT model to the register.
@@ -162,60 +296,114 @@ void setup()
   _registers[REGISTER_DHT_MODEL] = getDhtModel();
 
   // ***
-  // *** Put the current device address into the register.
-  // ***
-  _registers[REGISTER_DEVICE_ADDRESS] = deviceAddress;
-
-  Wire.begin(deviceAddress);
-  Wire.onReceive(receiveEvent);
-  Wire.onRequest(requestEvent);
-
-  // ***
-  // *** Debug information.
+  // *** Set up the pins for the model and power the sensor.
   // ***
-  initDebug();
-  displayRegisters();
-  displayConfiguration();
-  displayDeviceAddress();
+  beginSensor(_registers[REGISTER_DHT_MODEL], channel);
+  powerSensor(_registers[REGISTER_DHT_MODEL], channel, true);
 }
 
 void loop()
 {
+  TRACE_LOOP();
+
   // ***
   // *** Check the I2C bus.
   // ***
   WireLoopCheck;
 
   // ***
-  // *** Check the sensor interval to determine if
-  // *** is it time to take another sensor reading.
+  // *** The interrupt pin is set when any channel
+  // *** is outside of its thresholds.
+  // ***
+  bool thresholdExceeded = false;
+
+  // ***
+  // *** Work through the channels in turn.
   // ***
-  checkSensorInterval();
+  for (uint8_t i = 0; i < DHT_CHANNEL_COUNT; i++)
+  {
+    setChannel(getScheduledChannel(i));
+
+    // ***
+    // *** Check the sensor interval to determine if
+    // *** is it time to take another sensor reading.
+    // ***
+    checkSensorInterval();
+
+    // ***
+    // *** Check to see if a manual read was
+    // *** triggered. Manual reads can be triggered
+    // *** when the interval is set to 0.
+    // ***
+    checkForManualSensorRead();
+
+    // ***
+    // *** Fetch the reading of a sensor that has
+    // *** finished its conversion.
+    // ***
+    checkSensorConversion();
+
+    // ***
+    // *** Check if the aggregation window has ended.
+    // ***
+    if (Features::aggregate)
+    {
+      checkAggregateWindow();
+    }
+
+    // ***
+    // *** Check the thresholds.
+    // ***
+    if (Features::thresholds)
+    {
+      thresholdExceeded |= checkThresholds();
+    }
+
+    // ***
+    // *** Check for configuration changes
+    // ***
+    checkForSensorEnabledChange();
+    checkForResetConfiguration();
+    checkForWriteConfiguration();
+    checkForDhtModelChange();
+  }
+
+  setChannel(0);
+  digitalWrite(INTERRUPT_PIN, thresholdExceeded ? HIGH : LOW);
 
   // ***
-  // *** Check to see if a manual read was
-  // *** triggered. Manual reads can be triggered
-  // *** when the interval is set to 0.
+  // *** Check for a new device address. Without persistence
+  // *** there is nowhere to keep it.
   // ***
-  checkForManualSensorRead();
+  if (Features::persistence)
+  {
+    checkForDeviceAddressChange();
+  }
 
   // ***
-  // *** Check the thresholds.
+  // *** Move the bus to a new address during enumeration.
   // ***
-  checkThresholds();
+  checkForEnumeration();
 
+#if defined(DHT_SPILL_LOG)
   // ***
-  // *** Check for configuration changes
+  // *** Erase the spill log blocks the master acknowledged
+  // *** and copy the block it reads next.
+  // ***
+  checkLogCommand();
+  prepareLogDrain();
+#endif
+
   // ***
-  checkForSensorEnabledChange();
-  checkForResetConfiguration();
-  checkForWriteConfiguration();
-  checkForDeviceAddressChange();
-  checkForDhtModelChange();
+  // *** Run at the idle clock until there is work to do.
+  // ***
+  dropClock();
 }
 
 void receiveEvent(uint8_t byteCount)
 {
+  raiseClockForBus();
+
   // ***
   // *** Read all of the bytes from the wire.
   // ***
@@ -225,6 +413,18 @@ void receiveEvent(uint8_t byteCount)
     buffer[i] = WireRead;
   }
 
+  // ***
+  // *** Draining the trace is not traced.
+  // ***
+  TRACE_BUS(TRACE_EVENT_RECEIVE, byteCount > 0 ? buffer[0] : 0);
+
+  // ***
+  // *** The master works with the bank of the channel it
+  // *** selected, whichever channel the loop is on.
+  // ***
+  uint8_t channel = _channel;
+  setChannel(_selectedChannel);
+
   // ***
   // *** Process the data.
   // ***
@@ -236,6 +436,18 @@ void receiveEvent(uint8_t byteCount)
     // ***
     uint8_t registerPosition = buffer[0];
 
+    // ***
+    // *** With PEC enabled a read that wants a PEC is
+    // *** PEC_READ_COMMAND, the register position and a byte
+    // *** count. It can not be mistaken for a write.
+    // ***
+    bool pecRead = byteCount == 3 && buffer[0] == PEC_READ_COMMAND && getRegisterBit(REGISTER_CONFIG, CONFIG_BIT_PEC_ENABLED);
+
+    if (pecRead)
+    {
+      registerPosition = buffer[1];
+    }
+
     // ***
     // *** Ensure the register position is within bounds.
     // ***
@@ -246,10 +458,15 @@ void receiveEvent(uint8_t byteCount)
       // ***
       _registerPosition = registerPosition;
 
+      // ***
+      // *** With PEC enabled a write ends with a PEC.
+      // ***
+      bool pecRequired = isPecRequired(_registerPosition);
+
       // ***
       // *** Determine if this is a write operation or a read operation.
       // ***
-      bool isWriteOperation = (byteCount > 1);
+      bool isWriteOperation = !pecRead && byteCount > 1;
 
       // ***
       // *** Determine if there are bytes to write.
@@ -259,22 +476,55 @@ void receiveEvent(uint8_t byteCount)
         // ***
         // *** Get the expected write count for this register position.
         // ***
-        uint8_t expectedWriteCount = _registerSize[_registerPosition];
+        uint8_t expectedWriteCount = getRegisterSize(_registerPosition);
+        uint8_t writeCount = byteCount - 1;
+        bool pecValid = true;
 
-        if ((byteCount - 1) == expectedWriteCount && isWriteableRegisterPosition(_registerPosition))
+        if (pecRequired && !isPecDisableWrite(buffer, byteCount))
         {
           // ***
-          // *** Read the remaining bytes and write them to the registers.
+          // *** The PEC covers the address, the register
+          // *** position and the data. A write of a single
+          // *** byte has none and is rejected.
+          // ***
+          writeCount--;
+          uint8_t pec = updatePec(updatePec(0, _wireAddress << 1), buffer, byteCount - 1);
+          pecValid = byteCount > 2 && pec == buffer[byteCount - 1];
+          setRegisterBit(REGISTER_STATUS, STATUS_PEC_ERROR, !pecValid);
+        }
+
+        if (pecValid && writeCount == expectedWriteCount && isWriteableRegisterPosition(_registerPosition))
+        {
           // ***
-          for (uint8_t i = 1; i < byteCount; i++)
+          // *** Enumeration commands, the channel, trace, log and
+          // *** aggregate commands are acted on rather than stored.
+          // *** Other writes go to the registers.
+          // ***
+          if (!handleEnumerationWrite(_registerPosition, buffer[1]) &&
+              !handleChannelWrite(_registerPosition, buffer[1]) &&
+              !handleTraceWrite(_registerPosition, buffer[1]) &&
+              !handleLogWrite(_registerPosition, buffer[1]) &&
+              !handleAggregateWrite(_registerPosition, buffer[1]))
           {
             // ***
-            // *** Read the next byte from the wire.
+            // *** Read the remaining bytes and write them to the registers.
             // ***
-            _registers[_registerPosition] = buffer[i];
-            advanceRegisterPosition();
+            for (uint8_t i = 1; i <= writeCount; i++)
+            {
+              // ***
+              // *** Read the next byte from the wire.
+              // ***
+              _registers[_registerPosition] = buffer[i];
+              advanceRegisterPosition();
+            }
           }
 
+          // ***
+          // *** Keep the registers that are the same
+          // *** in every bank the same.
+          // ***
+          syncSharedRegisters();
+
           // ***
           // *** Set the write error status bit to success.
           // ***
@@ -301,9 +551,94 @@ void receiveEvent(uint8_t byteCount)
       else
       {
         // ***
-        // *** Set the number of bytes to read in the request
+        // *** Set the number of bytes to read in the request. Reads
+        // *** within the measurement block continue to the end of
+        // *** the block so the age is served with the values. Only
+        // *** a read that starts at the temperature or the humidity
+        // *** fetches the reading; a poll of the status does not.
         // ***
-        _requestCount = _registerSize[_registerPosition];
+        if (isMeasurementRegisterPosition(_registerPosition))
+        {
+          if (_registerPosition < REGISTER_STATUS)
+          {
+            noteReadingFetched();
+          }
+
+          updateReadingAge();
+          _requestCount = MEASUREMENT_BLOCK_END - _registerPosition;
+        }
+        else if (isAggregateRegisterPosition(_registerPosition))
+        {
+          // ***
+          // *** Without a window the aggregate is latched by
+          // *** reading the block. The readings in it are kept
+          // *** until the master acks them with
+          // *** AGGREGATE_COMMAND_ACK, so a read that is retried
+          // *** loses none.
+          // ***
+          if (Features::aggregate && _registerPosition == AGGREGATE_BLOCK_START && readUint32(REGISTER_AGGREGATE_WINDOW) == 0)
+          {
+            latchAggregate();
+          }
+
+          _requestCount = AGGREGATE_BLOCK_END - _registerPosition;
+        }
+        else if (isCaptureRegisterPosition(_registerPosition))
+        {
+          _requestCount = CAPTURE_BLOCK_END - _registerPosition;
+        }
+        else if (isDerivedRegisterPosition(_registerPosition))
+        {
+          _requestCount = DERIVED_BLOCK_END - _registerPosition;
+        }
+        else if (isClockRegisterPosition(_registerPosition))
+        {
+          updateClockTime();
+          _requestCount = CLOCK_BLOCK_END - _registerPosition;
+        }
+        else if (_registerPosition == REGISTER_ENUM_CONTROL)
+        {
+          _requestCount = ENUM_BITMAP_SIZE;
+        }
+#if defined(DHT_TRACE)
+        else if (_registerPosition == REGISTER_TRACE)
+        {
+          startTraceDrain();
+          _requestCount = TRACE_DRAIN_SIZE;
+        }
+#endif
+        else if (_registerPosition == REGISTER_LOG_CONTROL)
+        {
+          _registers[REGISTER_LOG_CONTROL] = getLogBlockCount();
+          _requestCount = SIZE_UINT8;
+        }
+#if defined(DHT_SPILL_LOG)
+        else if (_registerPosition == REGISTER_LOG_DATA)
+        {
+          startLogDrain();
+          _requestCount = LOG_DRAIN_SIZE;
+        }
+#endif
+        else
+        {
+          _requestCount = getRegisterSize(_registerPosition);
+        }
+
+        // ***
+        // *** A PEC read returns no more than the byte count
+        // *** asked for followed by the PEC, which starts with
+        // *** the address, the three command bytes and the
+        // *** address again with the read bit set.
+        // ***
+        _requestHasPec = pecRead;
+
+        if (_requestHasPec)
+        {
+          _requestCount = min(_requestCount, buffer[2]);
+          _requestPec = updatePec(updatePec(0, _wireAddress << 1), buffer, 3);
+          _requestPec = updatePec(_requestPec, (_wireAddress << 1) | 1);
+          _requestCount++;
+        }
 
         // ***
         // *** Set the read/write error status bits.
@@ -317,8 +652,8 @@ void receiveEvent(uint8_t byteCount)
       // ***
       // *** Set the read/write error status bits.
       // ***
-      setRegisterBit(REGISTER_STATUS, STATUS_READ_ERROR, byteCount == 1);
-      setRegisterBit(REGISTER_STATUS, STATUS_WRITE_ERROR, byteCount > 1);
+      setRegisterBit(REGISTER_STATUS, STATUS_READ_ERROR, byteCount == 1 || pecRead);
+      setRegisterBit(REGISTER_STATUS, STATUS_WRITE_ERROR, byteCount > 1 && !pecRead);
     }
   }
   else
@@ -329,6 +664,8 @@ void receiveEvent(uint8_t byteCount)
     setRegisterBit(REGISTER_STATUS, STATUS_READ_ERROR, 1);
     setRegisterBit(REGISTER_STATUS, STATUS_WRITE_ERROR, 0);
   }
+
+  setChannel(channel);
 }
 
 void clearBuffer()
@@ -346,31 +683,138 @@ bool isStartableRegisterPosition(uint8_t registerPosition)
 {
   return registerPosition >= 0 &&
          registerPosition < REGISTER_TOTAL_SIZE &&
-         (_registerProtection[registerPosition] == 0 || _registerProtection[registerPosition] == 2);
+         (getRegisterProtection(registerPosition) == 0 || getRegisterProtection(registerPosition) == 2);
 }
 
 bool isWriteableRegisterPosition(uint8_t registerPosition)
 {
   return registerPosition >= 0 &&
          registerPosition < REGISTER_TOTAL_SIZE &&
-         (_registerProtection[registerPosition] == 0);
+         (getRegisterProtection(registerPosition) == 0);
+}
+
+bool isMeasurementRegisterPosition(uint8_t registerPosition)
+{
+  return registerPosition >= MEASUREMENT_BLOCK_START &&
+         registerPosition < MEASUREMENT_BLOCK_END;
+}
+
+bool isAggregateRegisterPosition(uint8_t registerPosition)
+{
+  return registerPosition >= AGGREGATE_BLOCK_START &&
+         registerPosition < AGGREGATE_BLOCK_END;
+}
+
+bool isCaptureRegisterPosition(uint8_t registerPosition)
+{
+  return registerPosition >= CAPTURE_BLOCK_START &&
+         registerPosition < CAPTURE_BLOCK_END;
+}
+
+bool isDerivedRegisterPosition(uint8_t registerPosition)
+{
+  return registerPosition >= DERIVED_BLOCK_START &&
+         registerPosition < DERIVED_BLOCK_END;
+}
+
+bool isClockRegisterPosition(uint8_t registerPosition)
+{
+  return registerPosition >= CLOCK_BLOCK_START &&
+         registerPosition < CLOCK_BLOCK_END;
 }
 
 void requestEvent()
 {
+  raiseClockForBus();
+
+  uint8_t channel = _channel;
+  setChannel(_selectedChannel);
+
+  // ***
+  // *** Send as many of the requested bytes as the
+  // *** wire library will take in this call.
+  // ***
+  uint8_t count = min(_requestCount, WireTxChunk);
+
+  for (uint8_t i = 0; i < count; i++)
+  {
+    if (isEnumerationMuted())
+    {
+      // ***
+      // *** A breakout that is not selected during an
+      // *** enumeration sends 0xFF, which leaves SDA to
+      // *** the selected ones.
+      // ***
+      WireSend(0xFF);
+    }
+    else if (_registerPosition == REGISTER_ENUM_CONTROL)
+    {
+      WireSend(getEnumerationBitmap(ENUM_BITMAP_SIZE - _requestCount + i));
+    }
+    else if (_requestHasPec && (_requestCount - i) == 1)
+    {
+      WireSend(_requestPec);
+    }
+#if defined(DHT_TRACE)
+    else if (_registerPosition == REGISTER_TRACE)
+    {
+      uint8_t value = drainTraceByte();
+      WireSend(value);
+      _requestPec = updatePec(_requestPec, value);
+    }
+#endif
+#if defined(DHT_SPILL_LOG)
+    else if (_registerPosition == REGISTER_LOG_DATA)
+    {
+      uint8_t value = drainLogByte();
+      WireSend(value);
+      _requestPec = updatePec(_requestPec, value);
+    }
+#endif
+    else
+    {
+      uint8_t value = _registers[_registerPosition];
+      WireSend(value);
+      _requestPec = updatePec(_requestPec, value);
+      advanceRegisterPosition();
+    }
+  }
+
   // ***
-  // *** Send the next byte in the registers.
+  // *** Reduce the request count by the bytes sent.
   // ***
-  for (uint8_t i = 0; i < _requestCount; i++)
+  _requestCount -= count;
+
+  if (_requestCount == 0)
   {
-    WireSend(_registers[_registerPosition]);
-    advanceRegisterPosition();
+#if defined(DHT_SPILL_LOG)
+    if (_registerPosition == REGISTER_LOG_DATA)
+    {
+      endLogDrain();
+    }
+#endif
+    TRACE_BUS(TRACE_EVENT_REQUEST, _registerPosition);
   }
 
+  setChannel(channel);
+}
+
+void updateReadingAge()
+{
   // ***
-  // *** Reset the request count to 0.
+  // *** The age is the time elapsed since the
+  // *** last successful reading was committed.
+  // *** Until there is one the time is 0 and
+  // *** millis() would pass for an age.
   // ***
-  _requestCount = 0;
+  if (readUint32(REGISTER_READING_ID) == 0)
+  {
+    writeUint32(REGISTER_READING_AGE, READING_AGE_NONE);
+  }
+  else
+  {
+    writeUint32(REGISTER_READING_AGE, millis() - readUint32(REGISTER_READING_TIME));
+  }
 }
 
 void checkSensorInterval()
@@ -382,15 +826,101 @@ void checkSensorInterval()
 
   if (interval > 0)
   {
+    // ***
+    // *** In adaptive mode REGISTER_INTERVAL is the longest
+    // *** interval allowed and the interval in effect is
+    // *** adjusted after each reading.
+    // ***
+    if (Features::adaptiveInterval && getRegisterBit(REGISTER_CONFIG, CONFIG_BIT_ADAPTIVE_INTERVAL))
+    {
+      interval = constrain(readUint32(REGISTER_CURRENT_INTERVAL), getMinimumInterval(interval), interval);
+    }
+
+    writeUint32(REGISTER_CURRENT_INTERVAL, interval);
+
     // ***
     // *** Check the interval. Read the sensor once
     // *** every interval period.
     // ***
-    if ((millis() - _lastReading) > interval)
+    if ((millis() - _lastReading[_channel]) > interval && isSensorReadAllowed())
     {
       readSensor();
     }
   }
+  else
+  {
+    writeUint32(REGISTER_CURRENT_INTERVAL, 0);
+  }
+}
+
+bool isSensorReadAllowed()
+{
+  uint32_t now = millis();
+  uint16_t spacing = getSensorMinimumSpacing(_registers[REGISTER_DHT_MODEL]);
+
+  // ***
+  // *** A sensor is never read sooner than its model allows,
+  // *** whatever the interval is set to, or while its last
+  // *** conversion is still pending.
+  // ***
+  bool returnValue = (now - _lastReading[_channel]) >= spacing && !isSensorPending(_channel);
+
+#if DHT_CHANNEL_COUNT > 1
+  // ***
+  // *** A DHT read blocks the loop until the sensor has sent its
+  // *** frame. Spreading the reads of the channels across the
+  // *** minimum spacing keeps those windows apart so the bus
+  // *** is answered between them and each channel stays on
+  // *** its own interval.
+  // ***
+  returnValue = returnValue && (now - _lastSensorRead) >= (spacing / DHT_CHANNEL_COUNT);
+#endif
+
+  return returnValue;
+}
+
+uint32_t getMinimumInterval(uint32_t maximumInterval)
+{
+  // ***
+  // *** The minimum interval can never be shorter than the
+  // *** sensor allows or longer than the maximum.
+  // ***
+  uint32_t minimumInterval = max(readUint32(REGISTER_MIN_INTERVAL), (uint32_t)getSensorMinimumSpacing(_registers[REGISTER_DHT_MODEL]));
+  return min(minimumInterval, maximumInterval);
+}
+
+void updateAdaptiveInterval(float previousTemperature, float previousHumidity, uint32_t elapsed)
+{
+  uint32_t maximumInterval = readUint32(REGISTER_INTERVAL);
+  uint32_t minimumInterval = getMinimumInterval(maximumInterval);
+  uint32_t currentInterval = readUint32(REGISTER_CURRENT_INTERVAL);
+
+  // ***
+  // *** The slope threshold is the change allowed per minute. Scale
+  // *** it to the time between the readings rather than dividing
+  // *** the change by the time.
+  // ***
+  float allowedChange = readFloat(REGISTER_SLOPE_THRESHOLD) * (elapsed / 60000.0);
+
+  bool isChanging = fabs(readFloat(REGISTER_TEMPERATURE) - previousTemperature) > allowedChange ||
+                    fabs(readFloat(REGISTER_HUMIDITY) - previousHumidity) > allowedChange;
+
+  if (isChanging)
+  {
+    // ***
+    // *** Readings are changing, sample as fast as allowed.
+    // ***
+    currentInterval = minimumInterval;
+  }
+  else
+  {
+    // ***
+    // *** Readings are stable, back off toward the maximum.
+    // ***
+    currentInterval = (currentInterval > maximumInterval / 2) ? maximumInterval : currentInterval * 2;
+  }
+
+  writeUint32(REGISTER_CURRENT_INTERVAL, constrain(currentInterval, minimumInterval, maximumInterval));
 }
 
 void checkForManualSensorRead()
@@ -408,6 +938,15 @@ void checkForManualSensorRead()
 
   if (interval == 0 && manualReadTriggered)
   {
+    // ***
+    // *** Leave the trigger set until the sensor can
+    // *** be read.
+    // ***
+    if (!isSensorReadAllowed())
+    {
+      return;
+    }
+
     // ***
     // *** Read the sensor.
     // ***
@@ -428,20 +967,69 @@ void readSensor()
   bool sensorIsEnabled = getRegisterBit(REGISTER_STATUS, STATUS_SENSOR_IS_ENABLED);
 
   if (sensorIsEnabled)
+  {
+    // ***
+    // *** Note the read for the scheduler whatever the result.
+    // ***
+    _lastSensorRead = millis();
+    _lastSensorChannel = _channel;
+
+    // ***
+    // *** Start a conversion. The bit-banged bus of an
+    // *** SHT3x runs at the full clock.
+    // ***
+    raiseClock();
+    TRACE_CHANNEL(TRACE_EVENT_READ_START);
+    startSensor(_registers[REGISTER_DHT_MODEL], _channel);
+
+    // ***
+    // *** A DHT is always ready and is read right away.
+    // ***
+    checkSensorConversion();
+  }
+}
+
+void checkSensorConversion()
+{
+  uint8_t sensorModel = _registers[REGISTER_DHT_MODEL];
+
+  if (isSensorPending(_channel) && isSensorReady(sensorModel, _channel))
   {
     // ***
     // *** This index tracks the number of readings taken. This gives
     // *** the master device the ability to "know" if the reading has
     // *** been updated since the last time it checked.
     // ***
-    static uint32_t index = 0;
+    uint32_t index = readUint32(REGISTER_READING_ID);
 
     // ***
-    // *** Update the temperature and humidity registers
-    // *** on the DHT.
+    // *** Only a DHT fills the capture block.
     // ***
-    uint8_t dhtModel = _registers[REGISTER_DHT_MODEL];
-    uint8_t result = updateDht(dhtModel, DHT_READING_PIN);
+    bool capture = Features::capture && getRegisterBit(REGISTER_CONFIG, CONFIG_BIT_CAPTURE);
+    _dht.setCapture(capture ? (uint8_t*)&_registers[REGISTER_CAPTURE_FRAME] : NULL);
+
+    // ***
+    // *** The decode counts loop cycles, so it runs at the full
+    // *** clock and its timeout follows the clock it runs at.
+    // ***
+    raiseClock();
+    _dht.setClockShift(getClockShift());
+
+    int16_t temperature = 0;
+    int16_t humidity = 0;
+    uint8_t result = fetchSensor(sensorModel, _channel, temperature, humidity);
+    TRACE_CHANNEL(result == DHTLIB_OK ? TRACE_EVENT_READ_OK : TRACE_EVENT_READ_ERROR);
+
+    // ***
+    // *** When capturing, the raw frame and pulse widths were
+    // *** written to the capture block; record the result
+    // *** that goes with them.
+    // ***
+    if (capture)
+    {
+      _registers[REGISTER_CAPTURE_RESULT] = result;
+      writeUint16(REGISTER_CAPTURE_TIMEOUT, _dht.getTimeout());
+    }
 
     // ***
     // *** Check for a valid read from the sensor.
@@ -454,15 +1042,87 @@ void readSensor()
       // ***
       setRegisterBit(REGISTER_STATUS, STATUS_DHT_READING_ERROR, 0);
 
+      // ***
+      // *** Apply the calibration of this device so the
+      // *** registers, the aggregate and the threshold
+      // *** checks all see corrected values.
+      // ***
+      if (Features::calibration)
+      {
+        temperature = calibrate(temperature, readInt16(REGISTER_TEMPERATURE_OFFSET),
+                                readUint16(REGISTER_TEMPERATURE_GAIN), INT16_MIN, INT16_MAX);
+        humidity = calibrate(humidity, readInt16(REGISTER_HUMIDITY_OFFSET),
+                             readUint16(REGISTER_HUMIDITY_GAIN), 0, 1000);
+      }
+
+      // ***
+      // *** Pass the reading through the outlier filter. A
+      // *** rejected reading is counted and not committed, so
+      // *** it cannot trip a threshold or change the reading ID.
+      // ***
+      if (Features::filter && !filterReading(_filter[_channel], _registers[REGISTER_FILTER_MODE], readUint16(REGISTER_TEMPERATURE_SLEW),
+                                             readUint16(REGISTER_HUMIDITY_SLEW), temperature, humidity, millis()))
+      {
+        uint16_t rejects = readUint16(REGISTER_FILTER_REJECTS);
+
+        if (rejects < UINT16_MAX)
+        {
+          writeUint16(REGISTER_FILTER_REJECTS, rejects + 1);
+        }
+
+        _lastReading[_channel] = millis();
+        return;
+      }
+
+      // ***
+      // *** Keep the previous reading for the adaptive interval.
+      // ***
+      float previousTemperature = readFloat(REGISTER_TEMPERATURE);
+      float previousHumidity = readFloat(REGISTER_HUMIDITY);
+      uint32_t elapsed = millis() - _lastReading[_channel];
+
+      // ***
+      // *** A reading the master never fetched goes to
+      // *** the spill log before it is replaced.
+      // ***
+      spillMissedReading();
+
       // ***
       // *** Write the temperature to the register buffers.
       // ***
-      writeFloat(REGISTER_TEMPERATURE, _dht.temperature);
+      writeFloat(REGISTER_TEMPERATURE, temperature / 10.0);
 
       // ***
       // *** Write the humidity to the register buffers.
       // ***
-      writeFloat(REGISTER_HUMIDITY, _dht.humidity);
+      writeFloat(REGISTER_HUMIDITY, humidity / 10.0);
+
+      // ***
+      // *** Add the reading to the aggregation window.
+      // ***
+      if (Features::aggregate)
+      {
+        addToAggregate(temperature, humidity);
+      }
+
+      // ***
+      // *** Update the derived values. They are written with
+      // *** interrupts disabled so a master reading the block
+      // *** never sees values from two different readings.
+      // ***
+      if (Features::derived)
+      {
+        int16_t dewPoint = getDewPoint(temperature, humidity);
+        uint16_t absoluteHumidity = getAbsoluteHumidity(temperature, humidity);
+        int16_t heatIndex = getHeatIndex(temperature, humidity);
+
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+          writeInt16(REGISTER_DEW_POINT, dewPoint);
+          writeUint16(REGISTER_ABSOLUTE_HUMIDITY, absoluteHumidity);
+          writeInt16(REGISTER_HEAT_INDEX, heatIndex);
+        }
+      }
 
       // ***
       // *** Update the reading index.
@@ -471,9 +1131,22 @@ void readSensor()
       writeUint32(REGISTER_READING_ID, index);
 
       // ***
-      // *** Mark the last update.
+      // *** Mark the last update and record the time
+      // *** the reading was committed.
+      // ***
+      _lastReading[_channel] = millis();
+      writeUint32(REGISTER_READING_TIME, _lastReading[_channel]);
+      writeUint32(REGISTER_READING_AGE, 0);
+
+      // ***
+      // *** Adjust the interval based on how fast the readings
+      // *** are changing. The first reading has nothing to
+      // *** compare against.
       // ***
-      _lastReading = millis();
+      if (Features::adaptiveInterval && index > 1 && getRegisterBit(REGISTER_CONFIG, CONFIG_BIT_ADAPTIVE_INTERVAL))
+      {
+        updateAdaptiveInterval(previousTemperature, previousHumidity, elapsed);
+      }
     }
     else
     {
@@ -486,30 +1159,6 @@ void readSensor()
   }
 }
 
-uint8_t updateDht(uint8_t dhtModel, uint8_t dhtDataPin)
-{
-  uint8_t returnValue = -1;
-
-  switch (dhtModel)
-  {
-    case DHT_MODEL_11:
-      returnValue = _dht.read11(dhtDataPin);
-      break;
-    case DHT_MODEL_21:
-    case DHT_MODEL_22:
-      returnValue = _dht.read22(dhtDataPin);
-      break;
-    case DHT_MODEL_33:
-      returnValue = _dht.read33(dhtDataPin);
-      break;
-    case DHT_MODEL_44:
-      returnValue = _dht.read44(dhtDataPin);
-      break;
-  }
-
-  return returnValue;
-}
-
 void checkForSensorEnabledChange()
 {
   // ***
@@ -522,10 +1171,9 @@ void checkForSensorEnabledChange()
   if (expectedSensorIsEnabled)
   {
     // ***
-    // *** Make sure the sensor is enabled. Setting
-    // *** the output of the digital port to LOW
-    // *** turns the sensor on since the GND pin
-    // *** of the sensor is connected to the digital pin.
+    // *** Make sure the sensor is enabled. A DHT is
+    // *** turned on by setting its power pin LOW since
+    // *** the GND pin of the sensor is connected to it.
     // ***
     if (!currentSensorIsEnabled)
     {
@@ -533,7 +1181,7 @@ void checkForSensorEnabledChange()
       // *** The sensor is currently off and
       // *** needs to be turned on.
       // ***
-      digitalWrite(DHT_POWER_PIN, LOW);
+      powerSensor(_registers[REGISTER_DHT_MODEL], _channel, true);
 
       // ***
       // *** Update the status register to indicate that
@@ -541,6 +1189,15 @@ void checkForSensorEnabledChange()
       // ***
       setRegisterBit(REGISTER_STATUS, STATUS_SENSOR_IS_ENABLED, 1);
 
+      // ***
+      // *** Samples from before the sensor was turned
+      // *** off say nothing about the next one.
+      // ***
+      if (Features::filter)
+      {
+        resetFilter(_filter[_channel]);
+      }
+
       // ***
       // *** Before attempting a reading, wait for
       // *** the sensor to stabilize.
@@ -556,7 +1213,12 @@ void checkForSensorEnabledChange()
       // *** The sensor is currently on and
       // *** should be turned off.
       // ***
-      digitalWrite(DHT_POWER_PIN, HIGH);
+      powerSensor(_registers[REGISTER_DHT_MODEL], _channel, false);
+
+      // ***
+      // *** A conversion in progress is dropped.
+      // ***
+      cancelSensor(_channel);
 
       // ***
       // *** Update the status register to indicate that
@@ -567,8 +1229,10 @@ void checkForSensorEnabledChange()
   }
 }
 
-void checkThresholds()
+bool checkThresholds()
 {
+  bool returnValue = false;
+
   // ***
   // *** Check if thresholds are enabled. Bit 1 of the configuration
   // *** will be set to 1 (1 - enabled, 0 = disabled).
@@ -577,11 +1241,6 @@ void checkThresholds()
 
   if (thresholdsEnabled)
   {
-    // ***
-    // *** Set the enabled flag.
-    // ***
-    _thresholdsEnabled = true;
-
     // ***
     // *** Get the current temperature.
     // ***
@@ -594,37 +1253,24 @@ void checkThresholds()
     // ***
     if (currentTemperature <= lowerThreshold)
     {
-      // ***
-      // *** Set the interrupt pin.
-      // ***
-      digitalWrite(INTERRUPT_PIN, HIGH);
-
       // ***
       // *** Set/reset the appropriate status bits.
       // ***
       setRegisterBit(REGISTER_STATUS, STATUS_UPPER_THRESHOLD_EXCEEDED, 0);
       setRegisterBit(REGISTER_STATUS, STATUS_LOWER_THRESHOLD_EXCEEDED, 1);
+      returnValue = true;
     }
     else if (currentTemperature >= upperThreshold)
     {
-      // ***
-      // *** Set the interrupt pin.
-      // ***
-      digitalWrite(INTERRUPT_PIN, HIGH);
-
       // ***
       // *** Set/reset the appropriate status bits.
       // ***
       setRegisterBit(REGISTER_STATUS, STATUS_UPPER_THRESHOLD_EXCEEDED, 1);
       setRegisterBit(REGISTER_STATUS, STATUS_LOWER_THRESHOLD_EXCEEDED, 0);
+      returnValue = true;
     }
     else
     {
-      // ***
-      // *** Reset the interrupt pin.
-      // ***
-      digitalWrite(INTERRUPT_PIN, LOW);
-
       // ***
       // *** Reset the status bits.
       // ***
@@ -634,22 +1280,18 @@ void checkThresholds()
   }
   else
   {
-    // ***
-    // *** Reset the flag.
-    // ***
-    _thresholdsEnabled = false;
-
-    // ***
-    // *** Ensure the interrupt pin is reset.
-    // ***
-    digitalWrite(INTERRUPT_PIN, LOW);
-
     // ***
     // *** Reset the status bits.
     // ***
     setRegisterBit(REGISTER_STATUS, STATUS_UPPER_THRESHOLD_EXCEEDED, 0);
     setRegisterBit(REGISTER_STATUS, STATUS_LOWER_THRESHOLD_EXCEEDED, 0);
   }
+
+  // ***
+  // *** The caller sets the interrupt pin when this
+  // *** or any other channel is outside its thresholds.
+  // ***
+  return returnValue;
 }
 
 void checkForResetConfiguration()
@@ -665,7 +1307,10 @@ void checkForResetConfiguration()
     // ***
     // *** Reset the configuration.
     // ***
-    resetConfiguration();
+    if (Features::persistence)
+    {
+      resetConfiguration();
+    }
 
     // ***
     // *** Reset the configuration bit.
@@ -690,9 +1335,13 @@ void checkForWriteConfiguration()
   if (writeConfig)
   {
     // ***
-    // *** Save the configuration to EEPROM.
+    // *** Save the configuration to EEPROM. A build without
+    // *** persistence clears the bit and reports nothing saved.
     // ***
-    saveConfiguration();
+    if (Features::persistence)
+    {
+      saveConfiguration();
+    }
 
     // ***
     // *** Reset the configuration bit.
@@ -702,7 +1351,7 @@ void checkForWriteConfiguration()
     // ***
     // *** Set the status bit.
     // ***
-    setRegisterBit(REGISTER_STATUS, STATUS_CONFIG_SAVED , 1);
+    setRegisterBit(REGISTER_STATUS, STATUS_CONFIG_SAVED , Features::persistence);
   }
 }
 
@@ -724,6 +1373,22 @@ void checkForDhtModelChange()
 
   if (newValue != currentValue)
   {
+#if defined(DHT_FIXED_MODEL)
+    // ***
+    // *** The model cannot be changed in a single model build.
+    // ***
+    _registers[REGISTER_DHT_MODEL] = currentValue;
+#else
     setDhtModel(newValue);
+
+    // ***
+    // *** A conversion started for the old model is dropped
+    // *** and the pins are set up for the new one, which is
+    // *** powered if the sensor is enabled.
+    // ***
+    cancelSensor(_channel);
+    beginSensor(newValue, _channel);
+    powerSensor(newValue, _channel, getRegisterBit(REGISTER_STATUS, STATUS_SENSOR_IS_ENABLED));
+#endif
   }
 }
@@ -20,8 +20,13 @@
 #define DEBUG_H
 
 #include "Version.h"
+#include "Features.h"
 
-#if defined( __AVR_ATtiny85__ )
+// ***
+// *** Without a serial port or the debug feature the
+// *** calls compile to nothing.
+// ***
+#if defined( __AVR_ATtiny85__ ) || !DHT_FEATURE_DEBUG
 void initDebug() {}
 void displayRegisters() {}
 void displayDeviceAddress() { }
@@ -49,6 +54,8 @@ void displayRegisters()
   Serial.print("private const byte REGISTER_HUMIDITY = "); Serial.print(REGISTER_HUMIDITY); Serial.println(";");
   Serial.print("private const byte REGISTER_STATUS = "); Serial.print(REGISTER_STATUS); Serial.println(";");
   Serial.print("private const byte REGISTER_READING_ID = "); Serial.print(REGISTER_READING_ID); Serial.println(";");
+  Serial.print("private const byte REGISTER_READING_TIME = "); Serial.print(REGISTER_READING_TIME); Serial.println(";");
+  Serial.print("private const byte REGISTER_READING_AGE = "); Serial.print(REGISTER_READING_AGE); Serial.println(";");
   Serial.print("private const byte REGISTER_INTERVAL = "); Serial.print(REGISTER_INTERVAL); Serial.println(";");
   Serial.print("private const byte REGISTER_UPPER_THRESHOLD = "); Serial.print(REGISTER_UPPER_THRESHOLD); Serial.println(";");
   Serial.print("private const byte REGISTER_LOWER_THRESHOLD = "); Serial.print(REGISTER_LOWER_THRESHOLD); Serial.println(";");
@@ -56,6 +63,47 @@ void displayRegisters()
   Serial.print("private const byte REGISTER_CONFIG = "); Serial.print(REGISTER_CONFIG); Serial.println(";");
   Serial.print("private const byte REGISTER_DEVICE_ADDRESS = "); Serial.print(REGISTER_DEVICE_ADDRESS); Serial.println(";");
   Serial.print("private const byte REGISTER_DHT_MODEL = "); Serial.print(REGISTER_DHT_MODEL); Serial.println(";");
+  Serial.print("private const byte REGISTER_MIN_INTERVAL = "); Serial.print(REGISTER_MIN_INTERVAL); Serial.println(";");
+  Serial.print("private const byte REGISTER_SLOPE_THRESHOLD = "); Serial.print(REGISTER_SLOPE_THRESHOLD); Serial.println(";");
+  Serial.print("private const byte REGISTER_CURRENT_INTERVAL = "); Serial.print(REGISTER_CURRENT_INTERVAL); Serial.println(";");
+  Serial.print("private const byte REGISTER_AGGREGATE_WINDOW = "); Serial.print(REGISTER_AGGREGATE_WINDOW); Serial.println(";");
+  Serial.print("private const byte REGISTER_AGGREGATE_COUNT = "); Serial.print(REGISTER_AGGREGATE_COUNT); Serial.println(";");
+  Serial.print("private const byte REGISTER_TEMPERATURE_MIN = "); Serial.print(REGISTER_TEMPERATURE_MIN); Serial.println(";");
+  Serial.print("private const byte REGISTER_TEMPERATURE_MAX = "); Serial.print(REGISTER_TEMPERATURE_MAX); Serial.println(";");
+  Serial.print("private const byte REGISTER_TEMPERATURE_MEAN = "); Serial.print(REGISTER_TEMPERATURE_MEAN); Serial.println(";");
+  Serial.print("private const byte REGISTER_HUMIDITY_MIN = "); Serial.print(REGISTER_HUMIDITY_MIN); Serial.println(";");
+  Serial.print("private const byte REGISTER_HUMIDITY_MAX = "); Serial.print(REGISTER_HUMIDITY_MAX); Serial.println(";");
+  Serial.print("private const byte REGISTER_HUMIDITY_MEAN = "); Serial.print(REGISTER_HUMIDITY_MEAN); Serial.println(";");
+  Serial.print("private const byte REGISTER_CAPTURE_RESULT = "); Serial.print(REGISTER_CAPTURE_RESULT); Serial.println(";");
+  Serial.print("private const byte REGISTER_CAPTURE_TIMEOUT = "); Serial.print(REGISTER_CAPTURE_TIMEOUT); Serial.println(";");
+  Serial.print("private const byte REGISTER_CAPTURE_SHIFT = "); Serial.print(REGISTER_CAPTURE_SHIFT); Serial.println(";");
+  Serial.print("private const byte REGISTER_CAPTURE_FRAME = "); Serial.print(REGISTER_CAPTURE_FRAME); Serial.println(";");
+  Serial.print("private const byte REGISTER_CAPTURE_PULSES = "); Serial.print(REGISTER_CAPTURE_PULSES); Serial.println(";");
+  Serial.print("private const byte REGISTER_SERIAL = "); Serial.print(REGISTER_SERIAL); Serial.println(";");
+  Serial.print("private const byte REGISTER_ENUM_CONTROL = "); Serial.print(REGISTER_ENUM_CONTROL); Serial.println(";");
+  Serial.print("private const byte REGISTER_ENUM_SELECT = "); Serial.print(REGISTER_ENUM_SELECT); Serial.println(";");
+  Serial.print("private const byte REGISTER_ENUM_ASSIGN = "); Serial.print(REGISTER_ENUM_ASSIGN); Serial.println(";");
+  Serial.print("private const byte REGISTER_FILTER_MODE = "); Serial.print(REGISTER_FILTER_MODE); Serial.println(";");
+  Serial.print("private const byte REGISTER_TEMPERATURE_SLEW = "); Serial.print(REGISTER_TEMPERATURE_SLEW); Serial.println(";");
+  Serial.print("private const byte REGISTER_HUMIDITY_SLEW = "); Serial.print(REGISTER_HUMIDITY_SLEW); Serial.println(";");
+  Serial.print("private const byte REGISTER_FILTER_REJECTS = "); Serial.print(REGISTER_FILTER_REJECTS); Serial.println(";");
+  Serial.print("private const byte REGISTER_TEMPERATURE_OFFSET = "); Serial.print(REGISTER_TEMPERATURE_OFFSET); Serial.println(";");
+  Serial.print("private const byte REGISTER_TEMPERATURE_GAIN = "); Serial.print(REGISTER_TEMPERATURE_GAIN); Serial.println(";");
+  Serial.print("private const byte REGISTER_HUMIDITY_OFFSET = "); Serial.print(REGISTER_HUMIDITY_OFFSET); Serial.println(";");
+  Serial.print("private const byte REGISTER_HUMIDITY_GAIN = "); Serial.print(REGISTER_HUMIDITY_GAIN); Serial.println(";");
+  Serial.print("private const byte REGISTER_DEW_POINT = "); Serial.print(REGISTER_DEW_POINT); Serial.println(";");
+  Serial.print("private const byte REGISTER_ABSOLUTE_HUMIDITY = "); Serial.print(REGISTER_ABSOLUTE_HUMIDITY); Serial.println(";");
+  Serial.print("private const byte REGISTER_HEAT_INDEX = "); Serial.print(REGISTER_HEAT_INDEX); Serial.println(";");
+  Serial.print("private const byte REGISTER_CHANNEL = "); Serial.print(REGISTER_CHANNEL); Serial.println(";");
+  Serial.print("private const byte REGISTER_CHANNEL_COUNT = "); Serial.print(REGISTER_CHANNEL_COUNT); Serial.println(";");
+  Serial.print("private const byte REGISTER_TRACE = "); Serial.print(REGISTER_TRACE); Serial.println(";");
+  Serial.print("private const byte REGISTER_CLOCK_IDLE_SHIFT = "); Serial.print(REGISTER_CLOCK_IDLE_SHIFT); Serial.println(";");
+  Serial.print("private const byte REGISTER_CLOCK_FULL_TIME = "); Serial.print(REGISTER_CLOCK_FULL_TIME); Serial.println(";");
+  Serial.print("private const byte REGISTER_CLOCK_IDLE_TIME = "); Serial.print(REGISTER_CLOCK_IDLE_TIME); Serial.println(";");
+  Serial.print("private const byte REGISTER_LOG_DECIMATION = "); Serial.print(REGISTER_LOG_DECIMATION); Serial.println(";");
+  Serial.print("private const byte REGISTER_LOG_CONTROL = "); Serial.print(REGISTER_LOG_CONTROL); Serial.println(";");
+  Serial.print("private const byte REGISTER_LOG_DATA = "); Serial.print(REGISTER_LOG_DATA); Serial.println(";");
+  Serial.print("private const byte REGISTER_AGGREGATE_CONTROL = "); Serial.print(REGISTER_AGGREGATE_CONTROL); Serial.println(";");
   Serial.println();
   Serial.print("private const byte REGISTER_TOTAL_SIZE = "); Serial.print(REGISTER_TOTAL_SIZE); Serial.println(";");
 }
@@ -67,8 +115,17 @@ void displayConfiguration()
   Serial.print("Upper Threshold = "); Serial.println(readFloat(REGISTER_UPPER_THRESHOLD));
   Serial.print("Lower Threshold = "); Serial.println(readFloat(REGISTER_LOWER_THRESHOLD));
   Serial.print("Start Delay = "); Serial.println(readUint32(REGISTER_START_DELAY));
+  Serial.print("Minimum Interval = "); Serial.println(readUint32(REGISTER_MIN_INTERVAL));
+  Serial.print("Slope Threshold = "); Serial.println(readFloat(REGISTER_SLOPE_THRESHOLD));
+  Serial.print("Aggregate Window = "); Serial.println(readUint32(REGISTER_AGGREGATE_WINDOW));
+  Serial.print("Filter Mode = "); Serial.println(_registers[REGISTER_FILTER_MODE]);
+  Serial.print("Temperature Slew = "); Serial.println(readUint16(REGISTER_TEMPERATURE_SLEW));
+  Serial.print("Humidity Slew = "); Serial.println(readUint16(REGISTER_HUMIDITY_SLEW));
+  Serial.print("Temperature Calibration = "); Serial.print(readInt16(REGISTER_TEMPERATURE_OFFSET)); Serial.print(", "); Serial.println(readUint16(REGISTER_TEMPERATURE_GAIN));
+  Serial.print("Humidity Calibration = "); Serial.print(readInt16(REGISTER_HUMIDITY_OFFSET)); Serial.print(", "); Serial.println(readUint16(REGISTER_HUMIDITY_GAIN));
   Serial.print("Configuration = "); Serial.println(_registers[REGISTER_CONFIG]);
   Serial.print("DHT = "); Serial.println(_registers[REGISTER_DHT_MODEL]);
+  Serial.print("Channels = "); Serial.println(DHT_CHANNEL_COUNT);
 }
 
 void displayDeviceAddress()
@@ -0,0 +1,285 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef DERIVED_H
+#define DERIVED_H
+
+#include "Register_Defs.h"
+
+// ***
+// *** Dew point, absolute humidity and heat index computed from a
+// *** committed reading with integer math only. Temperatures are in
+// *** tenths of a degree Celsius, relative humidity in tenths of a
+// *** percent and absolute humidity in hundredths of a g/m^3.
+// ***
+// *** The saturation vapour pressure (Magnus, over water) is the only
+// *** transcendental part. It is kept in a table with one entry per
+// *** degree from DERIVED_MINIMUM to DERIVED_MAXIMUM, in hundredths of
+// *** a hPa, that the compiler fills in from the constexpr functions
+// *** below; nothing here calls exp() or log() at run time. The dew
+// *** point is found by searching the same table backwards.
+// ***
+// *** The loop calls them once per committed reading, outside any
+// *** atomic block, and writes the three results together. A reading
+// *** outside the table range is clamped to its ends.
+// ***
+#define DERIVED_MINIMUM         -40
+#define DERIVED_MAXIMUM         80
+#define DERIVED_TABLE_SIZE      (DERIVED_MAXIMUM - DERIVED_MINIMUM + 1)
+
+#define MAGNUS_PRESSURE         6.112
+#define MAGNUS_B                17.62
+#define MAGNUS_C                243.12
+
+// ***
+// *** Compile time exp(). Halving the argument until it is small
+// *** and squaring the Taylor series back up keeps the error well
+// *** under one table count over the Magnus range.
+// ***
+constexpr double taylorExp(double x, int n, double term, double sum)
+{
+  return (n > 12) ? sum : taylorExp(x, n + 1, term * x / n, sum + term * x / n);
+}
+
+constexpr double square(double x)
+{
+  return x * x;
+}
+
+constexpr double compileTimeExp(double x, int halvings)
+{
+  return (halvings == 0) ? taylorExp(x, 1, 1.0, 1.0) : square(compileTimeExp(x / 2, halvings - 1));
+}
+
+constexpr uint16_t saturationPressure(int temperature)
+{
+  return (uint16_t)(MAGNUS_PRESSURE * 100 * compileTimeExp(MAGNUS_B * temperature / (MAGNUS_C + temperature), 4) + 0.5);
+}
+
+#define SATURATION_1(t)         saturationPressure(t)
+#define SATURATION_2(t)         SATURATION_1(t), SATURATION_1(t + 1)
+#define SATURATION_4(t)         SATURATION_2(t), SATURATION_2(t + 2)
+#define SATURATION_8(t)         SATURATION_4(t), SATURATION_4(t + 4)
+#define SATURATION_16(t)        SATURATION_8(t), SATURATION_8(t + 8)
+#define SATURATION_32(t)        SATURATION_16(t), SATURATION_16(t + 16)
+#define SATURATION_64(t)        SATURATION_32(t), SATURATION_32(t + 32)
+
+// ***
+// *** A constexpr function that could not be evaluated by the
+// *** compiler would quietly become a run time initializer, which
+// *** does not work for a table in flash.
+// ***
+static_assert(saturationPressure(0) == 611,
+              "The saturation table must be computed at compile time");
+
+const uint16_t _saturationTable[DERIVED_TABLE_SIZE] PROGMEM =
+{
+  SATURATION_64(DERIVED_MINIMUM),
+  SATURATION_32(DERIVED_MINIMUM + 64),
+  SATURATION_16(DERIVED_MINIMUM + 96),
+  SATURATION_8(DERIVED_MINIMUM + 112),
+  SATURATION_1(DERIVED_MINIMUM + 120)
+};
+
+static_assert(DERIVED_TABLE_SIZE == 64 + 32 + 16 + 8 + 1, "The saturation table initializer does not match its size");
+
+uint16_t readSaturationTable(uint8_t index)
+{
+  return pgm_read_word(&_saturationTable[index]);
+}
+
+// ***
+// *** Saturation vapour pressure in hundredths of a hPa at a
+// *** temperature in tenths, interpolated between whole degrees.
+// ***
+uint16_t getSaturationPressure(int16_t temperature)
+{
+  int16_t offset = temperature - DERIVED_MINIMUM * 10;
+
+  if (offset <= 0)
+  {
+    return readSaturationTable(0);
+  }
+  else if (offset >= (DERIVED_TABLE_SIZE - 1) * 10)
+  {
+    return readSaturationTable(DERIVED_TABLE_SIZE - 1);
+  }
+
+  uint8_t index = offset / 10;
+  uint16_t low = readSaturationTable(index);
+  uint16_t high = readSaturationTable(index + 1);
+
+  return low + ((uint32_t)(high - low) * (offset % 10) + 5) / 10;
+}
+
+// ***
+// *** Vapour pressure in hundredths of a hPa.
+// ***
+uint16_t getVapourPressure(int16_t temperature, int16_t humidity)
+{
+  return ((uint32_t)getSaturationPressure(temperature) * humidity + 500) / 1000;
+}
+
+int16_t getDewPoint(int16_t temperature, int16_t humidity)
+{
+  uint16_t pressure = getVapourPressure(temperature, humidity);
+
+  if (pressure <= readSaturationTable(0))
+  {
+    return DERIVED_MINIMUM * 10;
+  }
+
+  // ***
+  // *** The table is increasing, so find the last entry at or
+  // *** below the vapour pressure and interpolate to the next.
+  // ***
+  uint8_t low = 0;
+  uint8_t high = DERIVED_TABLE_SIZE - 1;
+
+  while (high - low > 1)
+  {
+    uint8_t middle = (low + high) / 2;
+
+    if (readSaturationTable(middle) <= pressure)
+    {
+      low = middle;
+    }
+    else
+    {
+      high = middle;
+    }
+  }
+
+  uint16_t lowPressure = readSaturationTable(low);
+  uint16_t highPressure = readSaturationTable(high);
+  uint16_t tenths = ((uint32_t)(pressure - lowPressure) * 10 + (highPressure - lowPressure) / 2) / (highPressure - lowPressure);
+
+  return (DERIVED_MINIMUM + low) * 10 + (tenths > 10 ? 10 : tenths);
+}
+
+// ***
+// *** Absolute humidity = 216.7 * e / T(K), e in hPa. With e in
+// *** hundredths of a hPa and T in tenths of a kelvin the result is
+// *** in hundredths of a g/m^3.
+// ***
+uint16_t getAbsoluteHumidity(int16_t temperature, int16_t humidity)
+{
+  uint32_t kelvin = temperature + 2732;
+
+  return ((uint32_t)getVapourPressure(temperature, humidity) * 21674 + kelvin * 5) / (kelvin * 10);
+}
+
+// ***
+// *** Integer square root, used by the heat index adjustment.
+// ***
+uint16_t integerRoot(uint32_t value)
+{
+  uint32_t root = 0;
+  uint32_t bit = 1UL << 30;
+
+  while (bit > value)
+  {
+    bit >>= 2;
+  }
+
+  while (bit != 0)
+  {
+    if (value >= root + bit)
+    {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    }
+    else
+    {
+      root >>= 1;
+    }
+
+    bit >>= 2;
+  }
+
+  return root;
+}
+
+// ***
+// *** Heat index by the NOAA method: Steadman's simple formula, and
+// *** the Rothfusz regression with its two adjustments when that
+// *** comes out at 80F or more. Worked in tenths of a degree F with
+// *** each coefficient scaled so no product overflows 32 bits.
+// ***
+int16_t getHeatIndex(int16_t temperature, int16_t humidity)
+{
+  // ***
+  // *** Keep the products below in range.
+  // ***
+  if (temperature > DERIVED_MAXIMUM * 10)
+  {
+    temperature = DERIVED_MAXIMUM * 10;
+  }
+
+  // ***
+  // *** In hundredths of a degree F the temperature is exact.
+  // ***
+  int32_t hundredths = (int32_t)temperature * 18 + 3200;
+  int32_t t = (hundredths + (hundredths < 0 ? -5 : 5)) / 10;
+  int32_t r = humidity;
+
+  // ***
+  // *** 0.5 * (T + 61 + (T - 68) * 1.2 + RH * 0.094), kept exact
+  // *** (in 1/10000 of a degree F) through the test against 80F so
+  // *** the choice of formula is not thrown off by rounding.
+  // ***
+  int32_t simple = 50 * hundredths + 305000 + 60 * (hundredths - 6800) + 47 * r;
+  int32_t index = (simple + (simple < 0 ? -500 : 500)) / 1000;
+
+  if (simple + 100 * hundredths >= 1600000)
+  {
+    // ***
+    // *** -42.379 + 2.04901523 T + 10.14333127 RH - 0.22475541 T RH
+    // *** - 6.83783e-3 T^2 - 5.481717e-2 RH^2 + 1.22874e-3 T^2 RH
+    // *** + 8.5282e-4 T RH^2 - 1.99e-6 T^2 RH^2
+    // ***
+    // *** The terms with T RH in them share the factor T RH, which
+    // *** is taken out and applied last, in units of 1e-6.
+    // ***
+    int32_t product = (t * r + 50) / 100;
+    int32_t inner = -224755 + t * 122874 / 1000 + r * 85282 / 1000 - product * 199 / 100;
+
+    index = -424 + t * 204902 / 100000 + r * 1014333 / 100000 - (t * t / 100) * 68378 / 1000000 -
+            (r * r / 100) * 54817 / 100000 + (product * inner + (product * inner < 0 ? -50000 : 50000)) / 100000;
+
+    if (r < 130 && t > 800 && t < 1120)
+    {
+      // ***
+      // *** ((13 - RH) / 4) * sqrt((17 - |T - 95|) / 17)
+      // ***
+      int32_t distance = 170 - (t > 950 ? t - 950 : 950 - t);
+      index -= (130 - r) * integerRoot(distance * 10000 / 170) / 400;
+    }
+    else if (r > 850 && t > 800 && t < 870)
+    {
+      // ***
+      // *** ((RH - 85) / 10) * ((87 - T) / 5)
+      // ***
+      index += (r - 850) * (870 - t) / 500;
+    }
+  }
+
+  return (index - 320) * 5 / 9;
+}
+
+#endif
@@ -0,0 +1,93 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef DHT_BITS_H
+#define DHT_BITS_H
+
+#include <stdint.h>
+
+// ***
+// *** The bit decision of a DHT frame. The sensor sends each bit
+// *** as a low phase of a fixed length followed by a high phase
+// *** of about 26 us for a zero and 70 us for a one; the width is
+// *** the high phase in loop counts of dht::_readSensor(). The
+// *** leading bits of every frame are zeros and the widest of
+// *** them is taken as the width of a zero. A one is nearly
+// *** three zeros wide, so the bit is split near the midpoint:
+// *** twice the zero width less 1 / divisor of it, about 49 us
+// *** with the default divisor. DhtCapture replays captured
+// *** widths through these same functions.
+// ***
+#define DHT_BITS_FRAME_SIZE       5
+#define DHT_BITS_COUNT            40
+#define DHT_BITS_DIVISOR          8
+
+struct DhtBits
+{
+  uint8_t leadingZeroBits;
+  uint8_t divisor;
+  uint16_t zeroWidth;
+  uint8_t index;
+  uint8_t frame[DHT_BITS_FRAME_SIZE];
+};
+
+inline void beginDhtBits(DhtBits& bits, uint8_t leadingZeroBits, uint8_t divisor)
+{
+  bits.leadingZeroBits = leadingZeroBits;
+  bits.divisor = divisor;
+  bits.zeroWidth = 0;
+  bits.index = 0;
+
+  for (uint8_t i = 0; i < DHT_BITS_FRAME_SIZE; i++)
+  {
+    bits.frame[i] = 0;
+  }
+}
+
+// ***
+// *** Adds the next bit of the frame.
+// ***
+inline void addDhtBit(DhtBits& bits, uint16_t width)
+{
+  if (bits.index < bits.leadingZeroBits)
+  {
+    if (width > bits.zeroWidth) bits.zeroWidth = width;
+  }
+  else if (width >= 2 * bits.zeroWidth - bits.zeroWidth / bits.divisor)
+  {
+    bits.frame[bits.index >> 3] |= 0x80 >> (bits.index & 7);
+  }
+
+  bits.index++;
+}
+
+// ***
+// *** Masks the bits that are always zero, which reduces errors,
+// *** and tests the checksum. A low resolution frame (DHT11) has
+// *** only the integer bytes.
+// ***
+inline bool checkDhtFrame(uint8_t* frame, uint8_t humidityMask, uint8_t temperatureMask, bool highResolution)
+{
+  frame[0] &= humidityMask;
+  frame[2] &= temperatureMask;
+
+  uint8_t sum = highResolution ? frame[0] + frame[1] + frame[2] + frame[3] : frame[0] + frame[2];
+  return frame[4] == sum;
+}
+
+#endif
@@ -0,0 +1,74 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef DHT_DECODER_H
+#define DHT_DECODER_H
+
+#include "dht.h"
+#include "Features.h"
+
+// ***
+// *** Supported DHT Models
+// ***
+#define DHT_MODEL_11          11
+#define DHT_MODEL_21          21
+#define DHT_MODEL_22          22
+#define DHT_MODEL_33          33
+#define DHT_MODEL_44          44
+#define DHT_MODEL_DEFAULT     DHT_MODEL_22
+
+// ***
+// *** Define DHT_FIXED_MODEL (for example with
+// *** -DDHT_FIXED_MODEL=22) to build the firmware for a single
+// *** model. Only that model's backend is compiled and writes to
+// *** REGISTER_DHT_MODEL are ignored. Without it every model is
+// *** available through the table of sensor backends in
+// *** Sensor.h, which also has the models that are not DHTs.
+// ***
+// #define DHT_FIXED_MODEL DHT_MODEL_22
+
+// ***
+// *** Describes the frame of a DHT model at compile time. The
+// *** DHT21, DHT22, DHT33 and DHT44 all use the same frame.
+// ***
+template <uint8_t MODEL> struct DhtTraits
+{
+  static const uint8_t wakeupDelay = DHTLIB_DHT_WAKEUP;
+  static const uint8_t leadingZeroBits = DHTLIB_DHT_LEADING_ZEROS;
+  static const uint8_t humidityMask = 0x03;
+  static const uint8_t temperatureMask = 0x83;
+  static const bool highResolution = true;
+  static const uint16_t minimumSpacing = 2000;
+};
+
+template <> struct DhtTraits<DHT_MODEL_11>
+{
+  static const uint8_t wakeupDelay = DHTLIB_DHT11_WAKEUP;
+  static const uint8_t leadingZeroBits = DHTLIB_DHT11_LEADING_ZEROS;
+  static const uint8_t humidityMask = 0x7F;
+  static const uint8_t temperatureMask = 0x7F;
+  static const bool highResolution = false;
+  static const uint16_t minimumSpacing = 1000;
+};
+
+template <uint8_t MODEL> int8_t decodeDhtModel(dht& sensor, uint8_t pin)
+{
+  return sensor.readModel<DhtTraits<MODEL> >(pin);
+}
+
+#endif
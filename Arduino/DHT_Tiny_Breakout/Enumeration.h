@@ -0,0 +1,245 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef ENUMERATION_H
+#define ENUMERATION_H
+
+#include <Arduino.h>
+#include <util/atomic.h>
+#include "Registers.h"
+#include "Configuration.h"
+#include "MyWire.h"
+
+// ***
+// *** Enumeration lets a master find every breakout on a bus in
+// *** a few transactions per breakout, and gives factory fresh
+// *** breakouts, which all start at I2C_SLAVE_ADDRESS, an address
+// *** of their own.
+// ***
+// *** 1. The master writes ENUM_START to the control register
+// ***    with a general call. Every breakout still at the setup
+// ***    address, I2C_SLAVE_ADDRESS, takes part; one that was given
+// ***    an address of its own stays out of the way. ENUM_START_ALL
+// ***    brings those to the setup address as well, and the master
+// ***    may then move any of them.
+// *** 2. The master writes a depth and a serial number prefix to
+// ***    the select register. A breakout whose serial number starts
+// ***    with the prefix is selected; the others answer every read
+// ***    with 0xFF, which leaves the bus to the selected ones.
+// *** 3. A read of the control register returns a 256 bit map in
+// ***    which each selected breakout clears the bit of the next
+// ***    byte of its serial number. SDA is a wired AND so the master
+// ***    sees the bits of all of them at once.
+// *** 4. Once a full serial number is selected only one breakout
+// ***    answers. The master reads its address and writes the
+// ***    address it should use to the assign register. The breakout
+// ***    saves it and moves to it.
+// *** 5. ENUM_END, also with a general call, sends any breakout
+// ***    still taking part back to its own address.
+// ***
+#define ENUM_STATE_IDLE       0
+#define ENUM_STATE_ACTIVE     1
+#define ENUM_STATE_ASSIGNED   2
+
+volatile uint8_t _enumerationState = ENUM_STATE_IDLE;
+
+// ***
+// *** The address the I2C bus is moved to by loop(). Changing
+// *** the address is not done in the receive handler since it
+// *** restarts the bus. 0 when there is nothing to do.
+// ***
+volatile uint8_t _enumerationAddress = 0;
+
+uint8_t readNoise()
+{
+#if defined( __AVR_ATtiny85__ )
+  // ***
+  // *** Convert the internal temperature sensor against the
+  // *** 1.1V reference. The low bits of the result are noise.
+  // ***
+  ADMUX = _BV(REFS1) | _BV(MUX3) | _BV(MUX2) | _BV(MUX1) | _BV(MUX0);
+  ADCSRA |= _BV(ADEN) | _BV(ADSC);
+  while (ADCSRA & _BV(ADSC));
+
+  uint8_t returnValue = ADCL;
+  (void)ADCH;
+
+  return returnValue;
+#elif defined( __AVR_ATmega328P__ )
+  // ***
+  // *** The same with the internal temperature sensor of the
+  // *** ATmega328P (ADC8).
+  // ***
+  ADMUX = _BV(REFS1) | _BV(REFS0) | _BV(MUX3);
+  ADCSRA |= _BV(ADEN) | _BV(ADSC);
+  while (ADCSRA & _BV(ADSC));
+
+  uint8_t returnValue = ADCL;
+  (void)ADCH;
+
+  return returnValue;
+#else
+  // ***
+  // *** A weak source: an unconnected A0 often sits at a rail,
+  // *** leaving little but the timing generateSerial() mixes in.
+  // ***
+  return analogRead(A0);
+#endif
+}
+
+uint32_t generateSerial()
+{
+  uint32_t returnValue = 0;
+
+  // ***
+  // *** Mix the noise of many conversions with the
+  // *** time taken by them.
+  // ***
+  for (uint8_t i = 0; i < 128; i++)
+  {
+    returnValue = ((returnValue << 3) | (returnValue >> 29)) ^ readNoise() ^ (uint8_t)micros();
+  }
+
+  // ***
+  // *** 0 indicates no serial number and 0xFFFFFFFF
+  // *** is erased EEPROM.
+  // ***
+  if (returnValue == 0 || returnValue == 0xFFFFFFFF)
+  {
+    returnValue = 1;
+  }
+
+  return returnValue;
+}
+
+bool isEnumerationSelected()
+{
+  uint8_t depth = _registers[REGISTER_ENUM_SELECT];
+
+  if (_enumerationState != ENUM_STATE_ACTIVE || depth > SIZE_UINT32)
+  {
+    return false;
+  }
+
+  // ***
+  // *** The first depth bytes of the serial
+  // *** number must match the prefix.
+  // ***
+  for (uint8_t i = 0; i < depth; i++)
+  {
+    if (_registers[REGISTER_SERIAL + i] != _registers[REGISTER_ENUM_SELECT + 1 + i])
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool isEnumerationMuted()
+{
+  return (_enumerationState == ENUM_STATE_ACTIVE && !isEnumerationSelected()) ||
+         _enumerationState == ENUM_STATE_ASSIGNED;
+}
+
+uint8_t getEnumerationBitmap(uint8_t index)
+{
+  uint8_t returnValue = 0xFF;
+  uint8_t depth = _registers[REGISTER_ENUM_SELECT];
+
+  if (depth < SIZE_UINT32 && isEnumerationSelected())
+  {
+    uint8_t next = _registers[REGISTER_SERIAL + depth];
+
+    if ((next >> 3) == index)
+    {
+      returnValue &= ~(1 << (next & 7));
+    }
+  }
+
+  return returnValue;
+}
+
+bool handleEnumerationWrite(uint8_t registerPosition, uint8_t value)
+{
+  bool returnValue = true;
+
+  if (registerPosition == REGISTER_ENUM_CONTROL)
+  {
+    if (value == ENUM_START_ALL || (value == ENUM_START && _registers[REGISTER_DEVICE_ADDRESS] == I2C_SLAVE_ADDRESS))
+    {
+      _registers[REGISTER_ENUM_SELECT] = 0;
+      _enumerationState = ENUM_STATE_ACTIVE;
+      _enumerationAddress = I2C_SLAVE_ADDRESS;
+    }
+    else if (value == ENUM_END && _enumerationState == ENUM_STATE_ACTIVE)
+    {
+      _enumerationState = ENUM_STATE_IDLE;
+      _enumerationAddress = _registers[REGISTER_DEVICE_ADDRESS];
+    }
+  }
+  else if (registerPosition == REGISTER_ENUM_ASSIGN)
+  {
+    // ***
+    // *** Only the breakout with the selected serial
+    // *** number takes the address.
+    // ***
+    if (_registers[REGISTER_ENUM_SELECT] == SIZE_UINT32 && isEnumerationSelected())
+    {
+      _registers[REGISTER_DEVICE_ADDRESS] = value;
+      _enumerationState = ENUM_STATE_ASSIGNED;
+      _enumerationAddress = value;
+    }
+  }
+  else
+  {
+    returnValue = false;
+  }
+
+  return returnValue;
+}
+
+void checkForEnumeration()
+{
+  uint8_t address = 0;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    address = _enumerationAddress;
+    _enumerationAddress = 0;
+  }
+
+  if (address != 0)
+  {
+    WireBegin(address);
+
+    // ***
+    // *** An assigned breakout is done once it
+    // *** has moved to its address.
+    // ***
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      if (_enumerationState == ENUM_STATE_ASSIGNED)
+      {
+        _enumerationState = ENUM_STATE_IDLE;
+      }
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,166 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef FEATURES_H
+#define FEATURES_H
+
+// ***
+// *** Selects the build profile. Each profile is a header that
+// *** turns the optional subsystems on or off and may define the
+// *** build switches of the other headers (DHT_TRACE,
+// *** DHT_SPILL_LOG, DHT_CLOCK_SCALING and DHT_FIXED_MODEL). Pick
+// *** one with -DDHT_PROFILE_MINIMAL, -DDHT_PROFILE_LOGGER or
+// *** -DDHT_PROFILE_FULL, or uncomment it below. Without one the
+// *** ATtiny builds the minimal profile, since the full one does
+// *** not fit its 8 KB of flash, and every other board builds
+// *** every feature.
+// ***
+// *** A single feature can also be set from the compiler flags,
+// *** for example -DDHT_FEATURE_FILTER=0, which is how
+// *** Tools/size_report.sh measures each one.
+// ***
+// #define DHT_PROFILE_MINIMAL
+
+#if defined(DHT_PROFILE_MINIMAL)
+#include "Profile_Minimal.h"
+#elif defined(DHT_PROFILE_LOGGER)
+#include "Profile_Logger.h"
+#elif defined(__AVR_ATtiny85__) && !defined(DHT_PROFILE_FULL)
+#include "Profile_Minimal.h"
+#else
+#include "Profile_Full.h"
+#endif
+
+// ***
+// *** A feature the profile does not mention is built.
+// ***
+#ifndef DHT_FEATURE_THRESHOLDS
+#define DHT_FEATURE_THRESHOLDS    1
+#endif
+
+#ifndef DHT_FEATURE_PERSISTENCE
+#define DHT_FEATURE_PERSISTENCE   1
+#endif
+
+#ifndef DHT_FEATURE_FILTER
+#define DHT_FEATURE_FILTER        1
+#endif
+
+#ifndef DHT_FEATURE_CALIBRATION
+#define DHT_FEATURE_CALIBRATION   1
+#endif
+
+#ifndef DHT_FEATURE_DERIVED
+#define DHT_FEATURE_DERIVED       1
+#endif
+
+#ifndef DHT_FEATURE_AGGREGATE
+#define DHT_FEATURE_AGGREGATE     1
+#endif
+
+#ifndef DHT_FEATURE_ADAPTIVE
+#define DHT_FEATURE_ADAPTIVE      1
+#endif
+
+#ifndef DHT_FEATURE_CAPTURE
+#define DHT_FEATURE_CAPTURE       1
+#endif
+
+#ifndef DHT_FEATURE_INT64
+#define DHT_FEATURE_INT64         1
+#endif
+
+// ***
+// *** The ATtiny has no serial port to debug on.
+// ***
+#ifndef DHT_FEATURE_DEBUG
+#if defined( __AVR_ATtiny85__ )
+#define DHT_FEATURE_DEBUG         0
+#else
+#define DHT_FEATURE_DEBUG         1
+#endif
+#endif
+
+// ***
+// *** The features as constants. Code for a feature is guarded
+// *** with if (Features::name) rather than #if so it is still
+// *** compiled in every profile; the optimizer drops the branch
+// *** and the linker drops the functions and variables that are
+// *** left unused (-ffunction-sections, -fdata-sections and
+// *** --gc-sections in the Arduino build). The registers of a
+// *** feature that is not built stay in the map and read as 0
+// *** so the register layout is the same in every profile.
+// ***
+struct Features
+{
+  // ***
+  // *** Threshold checks that drive the interrupt pin.
+  // ***
+  static constexpr bool thresholds = DHT_FEATURE_THRESHOLDS;
+
+  // ***
+  // *** Saving the configuration, device address and model to
+  // *** EEPROM. Without it the breakout starts with the defaults,
+  // *** a new device address only lasts until the next reset
+  // *** and a model written to REGISTER_DHT_MODEL is kept in
+  // *** RAM. The serial number is always kept in EEPROM.
+  // ***
+  static constexpr bool persistence = DHT_FEATURE_PERSISTENCE;
+
+  // ***
+  // *** The outlier filter (Filter.h).
+  // ***
+  static constexpr bool filter = DHT_FEATURE_FILTER;
+
+  // ***
+  // *** The offset and gain calibration (Calibration.h).
+  // ***
+  static constexpr bool calibration = DHT_FEATURE_CALIBRATION;
+
+  // ***
+  // *** Dew point, absolute humidity and heat index (Derived.h).
+  // ***
+  static constexpr bool derived = DHT_FEATURE_DERIVED;
+
+  // ***
+  // *** The minimum, maximum and mean of a window (Aggregate.h).
+  // ***
+  static constexpr bool aggregate = DHT_FEATURE_AGGREGATE;
+
+  // ***
+  // *** Shortening the interval while the readings change.
+  // ***
+  static constexpr bool adaptiveInterval = DHT_FEATURE_ADAPTIVE;
+
+  // ***
+  // *** The raw frame and pulse width capture of a DHT.
+  // ***
+  static constexpr bool capture = DHT_FEATURE_CAPTURE;
+
+  // ***
+  // *** The int64 and uint64 conversions of ByteConverter.
+  // ***
+  static constexpr bool int64 = DHT_FEATURE_INT64;
+
+  // ***
+  // *** The serial output of Debug.h.
+  // ***
+  static constexpr bool debug = DHT_FEATURE_DEBUG;
+};
+
+#endif
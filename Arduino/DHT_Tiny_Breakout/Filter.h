@@ -0,0 +1,156 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef FILTER_H
+#define FILTER_H
+
+#include "Register_Defs.h"
+
+// ***
+// *** Outlier filter applied to a reading before it is committed
+// *** to the registers: a median of three that drops a single bad
+// *** frame and a slew gate that holds back a jump no sensor can
+// *** make. It works on the calibrated tenths of the sensor. Recorded
+// *** traces are replayed through it by Linux/DhtFilterReplay.
+// ***
+
+// ***
+// *** After this many readings in a row fail the slew gate the
+// *** next one is taken to be a real step change and is accepted.
+// ***
+#define FILTER_MAX_REJECTS    3
+
+struct FilterChannel
+{
+  // ***
+  // *** The last three samples, oldest first, and
+  // *** the last value that was committed.
+  // ***
+  int16_t history[3];
+  int16_t committed;
+};
+
+struct Filter
+{
+  FilterChannel temperature;
+  FilterChannel humidity;
+  uint32_t lastCommit;
+  uint8_t samples;
+  uint8_t rejects;
+};
+
+void resetFilter(Filter& filter)
+{
+  filter.samples = 0;
+  filter.rejects = 0;
+}
+
+int16_t getMedian(int16_t a, int16_t b, int16_t c)
+{
+  if (a > b)
+  {
+    int16_t t = a; a = b; b = t;
+  }
+
+  return (c < a) ? a : ((c > b) ? b : c);
+}
+
+int16_t addFilterSample(FilterChannel& channel, int16_t sample, bool first, bool median)
+{
+  // ***
+  // *** The first sample fills the history so the median
+  // *** does not lag while the filter starts up.
+  // ***
+  if (first)
+  {
+    channel.history[0] = channel.history[1] = sample;
+  }
+  else
+  {
+    channel.history[0] = channel.history[1];
+    channel.history[1] = channel.history[2];
+  }
+
+  channel.history[2] = sample;
+
+  return median ? getMedian(channel.history[0], channel.history[1], channel.history[2]) : sample;
+}
+
+bool isWithinSlew(const FilterChannel& channel, int16_t value, uint16_t slew, uint32_t elapsed)
+{
+  // ***
+  // *** The slew limit is in tenths per second. Compare the
+  // *** change against the limit scaled to the time since the
+  // *** last commit rather than dividing the change by the time.
+  // *** The product fits in 32 bits for the first 65 s; after
+  // *** that whole seconds are enough, and after 65535 s any
+  // *** change passes.
+  // ***
+  int32_t change = (int32_t)value - channel.committed;
+  uint32_t allowed = elapsed <= UINT16_MAX ? (uint32_t)slew * elapsed / 1000 :
+                     (uint32_t)slew * (elapsed / 1000 < UINT16_MAX ? elapsed / 1000 : UINT16_MAX);
+
+  return (uint32_t)(change < 0 ? -change : change) <= allowed;
+}
+
+// ***
+// *** Adds a reading to the filter. Returns true if the reading
+// *** should be committed, in which case temperature and humidity
+// *** hold the filtered values. A reading rejected by the slew
+// *** gate does not change the committed values.
+// ***
+bool filterReading(Filter& filter, uint8_t mode, uint16_t temperatureSlew, uint16_t humiditySlew,
+                   int16_t& temperature, int16_t& humidity, uint32_t now)
+{
+  bool returnValue = true;
+  bool first = (filter.samples == 0);
+  bool median = (mode >> FILTER_BIT_MEDIAN) & 1;
+
+  temperature = addFilterSample(filter.temperature, temperature, first, median);
+  humidity = addFilterSample(filter.humidity, humidity, first, median);
+
+  if (!first && ((mode >> FILTER_BIT_SLEW) & 1))
+  {
+    uint32_t elapsed = now - filter.lastCommit;
+
+    returnValue = isWithinSlew(filter.temperature, temperature, temperatureSlew, elapsed) &&
+                  isWithinSlew(filter.humidity, humidity, humiditySlew, elapsed);
+
+    if (!returnValue && filter.rejects++ >= FILTER_MAX_REJECTS)
+    {
+      returnValue = true;
+    }
+  }
+
+  if (returnValue)
+  {
+    filter.temperature.committed = temperature;
+    filter.humidity.committed = humidity;
+    filter.lastCommit = now;
+    filter.rejects = 0;
+  }
+
+  if (filter.samples < UINT8_MAX)
+  {
+    filter.samples++;
+  }
+
+  return returnValue;
+}
+
+#endif
@@ -19,6 +19,11 @@
 #ifndef MY_WIRE_H
 #define MY_WIRE_H
 
+// ***
+// *** The address the bus was last started on.
+// ***
+volatile uint8_t _wireAddress = 0;
+
 #if defined( __AVR_ATtiny85__ )
 
 // ***
@@ -27,22 +32,38 @@
 #include <TinyWireS.h>
 USI_TWI_S Wire;
 
+#define WireBegin(a)    { _wireAddress = (a); Wire.begin(a); }
 #define WireLoopCheck   TinyWireS_stop_check();
 #define WireRead        Wire.receive()
 #define WireSend(a)     Wire.send(a)
 #define WireDelay(a)    tws_delay(a);
 
+// ***
+// *** TinyWireS invokes the request handler once for
+// *** every byte the master clocks out.
+// ***
+#define WireTxChunk     1
+
 #else
 
 // ***
-// *** Use the standard Wire library.
+// *** Use the standard Wire library. TinyWireS answers the
+// *** general call address, the TWI hardware only does
+// *** once it is enabled.
 // ***
 #include <Wire.h>
 
-#define WireLoopCheck   void
+#define WireBegin(a)    { _wireAddress = (a); Wire.begin(a); TWAR |= _BV(TWGCE); }
+#define WireLoopCheck
 #define WireRead        Wire.read()
 #define WireSend(a)     Wire.write(a)
 #define WireDelay(a)    delay(a);
 
+// ***
+// *** The Wire library invokes the request handler once
+// *** per transaction, so fill as much of the buffer as we can.
+// ***
+#define WireTxChunk     BUFFER_LENGTH
+
 #endif
 #endif
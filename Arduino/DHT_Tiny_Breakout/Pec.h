@@ -0,0 +1,83 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef PEC_H
+#define PEC_H
+
+#include "Registers.h"
+
+// ***
+// *** SMBus packet error code: a CRC-8 with the polynomial
+// *** x^8 + x^2 + x + 1, an initial value of 0 and no final
+// *** xor. It is computed one nibble at a time from a 16
+// *** byte table in flash rather than a 256 byte one.
+// ***
+const uint8_t _pecTable[16] PROGMEM = { 0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+                                        0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D };
+
+// ***
+// *** The PEC of the read in progress. It is updated as each
+// *** byte is sent and is itself sent after the last one.
+// ***
+volatile uint8_t _requestPec = 0;
+volatile bool _requestHasPec = false;
+
+uint8_t updatePec(uint8_t pec, uint8_t value)
+{
+  pec ^= value;
+  pec = (pec << 4) ^ pgm_read_byte(&_pecTable[pec >> 4]);
+  pec = (pec << 4) ^ pgm_read_byte(&_pecTable[pec >> 4]);
+
+  return pec;
+}
+
+uint8_t updatePec(uint8_t pec, const uint8_t* buffer, uint8_t count)
+{
+  for (uint8_t i = 0; i < count; i++)
+  {
+    pec = updatePec(pec, buffer[i]);
+  }
+
+  return pec;
+}
+
+// ***
+// *** Once enabled every write must end with a PEC. The
+// *** enumeration registers are exempt; they are written
+// *** to many breakouts at once over the general call.
+// ***
+bool isPecRequired(uint8_t registerPosition)
+{
+  return getRegisterBit(REGISTER_CONFIG, CONFIG_BIT_PEC_ENABLED) &&
+         (registerPosition < REGISTER_ENUM_CONTROL || registerPosition > REGISTER_ENUM_ASSIGN);
+}
+
+// ***
+// *** A two byte write can not carry a PEC, so with PEC
+// *** enabled it is rejected. The exception is a write of
+// *** the configuration that only clears the PEC enabled bit,
+// *** which lets a master that does not know about PEC turn
+// *** it off.
+// ***
+bool isPecDisableWrite(const uint8_t* buffer, uint8_t byteCount)
+{
+  return byteCount == 2 && buffer[0] == REGISTER_CONFIG &&
+         buffer[1] == (uint8_t)(_registers[REGISTER_CONFIG] & ~(1 << CONFIG_BIT_PEC_ENABLED));
+}
+
+#endif
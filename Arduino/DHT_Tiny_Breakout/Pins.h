@@ -21,15 +21,20 @@
 
 #if defined( __AVR_ATtiny85__ )
 
+// ***
+// *** The ATtiny has the pins and memory for one sensor.
+// ***
+#define DHT_CHANNEL_COUNT 1
+
 // ***
 // *** The pin on which the DHT Data pin is connected.
 // ***
-#define DHT_READING_PIN 3
+#define DHT_READING_PINS { 3 }
 
 // ***
 // *** The pin on which the DHT GND pin is connected.
 // ***
-#define DHT_POWER_PIN 1
+#define DHT_POWER_PINS { 1 }
 
 // ***
 // *** Interrupt pin.
@@ -39,14 +44,29 @@
 #else
 
 // ***
-// *** The pin on which the DHT Data pin is connected.
+// *** The number of sensors read by one breakout. Each
+// *** channel has its own data and power pin and its own
+// *** bank of registers, selected through REGISTER_CHANNEL.
+// *** A breakout has one sensor on pins 3 and 2 unless it is
+// *** built for more, for example with -DDHT_CHANNEL_COUNT=4;
+// *** a channel with no sensor on it would time out on every
+// *** read.
 // ***
-#define DHT_READING_PIN 3
+#ifndef DHT_CHANNEL_COUNT
+#define DHT_CHANNEL_COUNT 1
+#endif
 
 // ***
-// *** The pin on which the DHT GND pin is connected.
+// *** The pins on which the DHT Data pin of each channel
+// *** is connected, in channel order.
+// ***
+#define DHT_READING_PINS { 3, 5, 7, 9 }
+
+// ***
+// *** The pins on which the DHT GND pin of each channel
+// *** is connected.
 // ***
-#define DHT_POWER_PIN 2
+#define DHT_POWER_PINS { 2, 6, 8, 10 }
 
 // ***
 // *** Interrupt pin.
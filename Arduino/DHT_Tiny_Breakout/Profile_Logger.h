@@ -0,0 +1,58 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef PROFILE_LOGGER_H
+#define PROFILE_LOGGER_H
+
+// ***
+// *** A breakout that is read now and then by a master that
+// *** may miss readings. The configuration is kept in EEPROM,
+// *** readings are calibrated, filtered and aggregated, and
+// *** missed readings go to the spill log. Thresholds, derived
+// *** values, the adaptive interval and the capture are left out
+// *** to make room for the log.
+// ***
+#ifndef DHT_SPILL_LOG
+#define DHT_SPILL_LOG
+#endif
+
+#ifndef DHT_FEATURE_THRESHOLDS
+#define DHT_FEATURE_THRESHOLDS    0
+#endif
+
+#ifndef DHT_FEATURE_DERIVED
+#define DHT_FEATURE_DERIVED       0
+#endif
+
+#ifndef DHT_FEATURE_ADAPTIVE
+#define DHT_FEATURE_ADAPTIVE      0
+#endif
+
+#ifndef DHT_FEATURE_CAPTURE
+#define DHT_FEATURE_CAPTURE       0
+#endif
+
+#ifndef DHT_FEATURE_INT64
+#define DHT_FEATURE_INT64         0
+#endif
+
+#ifndef DHT_FEATURE_DEBUG
+#define DHT_FEATURE_DEBUG         0
+#endif
+
+#endif
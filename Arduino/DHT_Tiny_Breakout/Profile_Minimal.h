@@ -0,0 +1,71 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef PROFILE_MINIMAL_H
+#define PROFILE_MINIMAL_H
+
+// ***
+// *** Only the readings of a single DHT22 are served. This is
+// *** the smallest build and the default on the ATtiny. The
+// *** model can be changed with -DDHT_FIXED_MODEL.
+// ***
+#ifndef DHT_FIXED_MODEL
+#define DHT_FIXED_MODEL           22
+#endif
+
+#ifndef DHT_FEATURE_THRESHOLDS
+#define DHT_FEATURE_THRESHOLDS    0
+#endif
+
+#ifndef DHT_FEATURE_PERSISTENCE
+#define DHT_FEATURE_PERSISTENCE   0
+#endif
+
+#ifndef DHT_FEATURE_FILTER
+#define DHT_FEATURE_FILTER        0
+#endif
+
+#ifndef DHT_FEATURE_CALIBRATION
+#define DHT_FEATURE_CALIBRATION   0
+#endif
+
+#ifndef DHT_FEATURE_DERIVED
+#define DHT_FEATURE_DERIVED       0
+#endif
+
+#ifndef DHT_FEATURE_AGGREGATE
+#define DHT_FEATURE_AGGREGATE     0
+#endif
+
+#ifndef DHT_FEATURE_ADAPTIVE
+#define DHT_FEATURE_ADAPTIVE      0
+#endif
+
+#ifndef DHT_FEATURE_CAPTURE
+#define DHT_FEATURE_CAPTURE       0
+#endif
+
+#ifndef DHT_FEATURE_INT64
+#define DHT_FEATURE_INT64         0
+#endif
+
+#ifndef DHT_FEATURE_DEBUG
+#define DHT_FEATURE_DEBUG         0
+#endif
+
+#endif
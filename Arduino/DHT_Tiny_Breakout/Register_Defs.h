@@ -21,6 +21,26 @@
 
 #include "ByteConverter.h"
 
+// ***
+// *** Size of the raw frame capture. A DHT frame is 40 bits
+// *** (5 bytes) and the width of the high phase of each bit,
+// *** which decides it, is kept as its pulse width.
+// ***
+#define CAPTURE_FRAME_SIZE          5
+#define CAPTURE_PULSE_COUNT         40
+
+// ***
+// *** Enumeration. The select register holds a depth followed by
+// *** a serial number prefix, and a read of the control register
+// *** returns a 256 bit map of the next serial byte of the selected
+// *** devices. See Enumeration.h.
+// ***
+#define ENUM_SELECT_SIZE            5
+#define ENUM_BITMAP_SIZE            32
+#define ENUM_START                  1
+#define ENUM_END                    2
+#define ENUM_START_ALL              3
+
 // ***
 // *** Address of each variable
 // *** within the registers.
@@ -33,18 +53,133 @@
 #define REGISTER_HUMIDITY           REGISTER_TEMPERATURE      + SIZE_FLOAT     // *** float
 #define REGISTER_STATUS             REGISTER_HUMIDITY         + SIZE_FLOAT     // *** uint8
 #define REGISTER_READING_ID         REGISTER_STATUS           + SIZE_UINT8     // *** uint32
-#define REGISTER_INTERVAL           REGISTER_READING_ID       + SIZE_UINT32    // *** uint32
+#define REGISTER_READING_TIME       REGISTER_READING_ID       + SIZE_UINT32    // *** uint32
+#define REGISTER_READING_AGE        REGISTER_READING_TIME     + SIZE_UINT32    // *** uint32
+#define REGISTER_INTERVAL           REGISTER_READING_AGE      + SIZE_UINT32    // *** uint32
 #define REGISTER_UPPER_THRESHOLD    REGISTER_INTERVAL         + SIZE_UINT32    // *** float
 #define REGISTER_LOWER_THRESHOLD    REGISTER_UPPER_THRESHOLD  + SIZE_FLOAT     // *** float
 #define REGISTER_START_DELAY        REGISTER_LOWER_THRESHOLD  + SIZE_FLOAT     // *** uint32
 #define REGISTER_CONFIG             REGISTER_START_DELAY      + SIZE_UINT32    // *** uint8
 #define REGISTER_DEVICE_ADDRESS     REGISTER_CONFIG           + SIZE_UINT8     // *** uint8
 #define REGISTER_DHT_MODEL          REGISTER_DEVICE_ADDRESS   + SIZE_UINT8     // *** uint8
+#define REGISTER_MIN_INTERVAL       REGISTER_DHT_MODEL        + SIZE_UINT8     // *** uint32
+#define REGISTER_SLOPE_THRESHOLD    REGISTER_MIN_INTERVAL     + SIZE_UINT32    // *** float
+#define REGISTER_CURRENT_INTERVAL   REGISTER_SLOPE_THRESHOLD  + SIZE_FLOAT     // *** uint32
+#define REGISTER_AGGREGATE_WINDOW   REGISTER_CURRENT_INTERVAL + SIZE_UINT32    // *** uint32
+#define REGISTER_AGGREGATE_COUNT    REGISTER_AGGREGATE_WINDOW + SIZE_UINT32    // *** uint16
+#define REGISTER_TEMPERATURE_MIN    REGISTER_AGGREGATE_COUNT  + SIZE_UINT16    // *** int16
+#define REGISTER_TEMPERATURE_MAX    REGISTER_TEMPERATURE_MIN  + SIZE_INT16     // *** int16
+#define REGISTER_TEMPERATURE_MEAN   REGISTER_TEMPERATURE_MAX  + SIZE_INT16     // *** int16
+#define REGISTER_HUMIDITY_MIN       REGISTER_TEMPERATURE_MEAN + SIZE_INT16     // *** int16
+#define REGISTER_HUMIDITY_MAX       REGISTER_HUMIDITY_MIN     + SIZE_INT16     // *** int16
+#define REGISTER_HUMIDITY_MEAN      REGISTER_HUMIDITY_MAX     + SIZE_INT16     // *** int16
+#define REGISTER_CAPTURE_RESULT     REGISTER_HUMIDITY_MEAN    + SIZE_INT16     // *** int8
+#define REGISTER_CAPTURE_TIMEOUT    REGISTER_CAPTURE_RESULT   + SIZE_INT8      // *** uint16
+#define REGISTER_CAPTURE_SHIFT      REGISTER_CAPTURE_TIMEOUT  + SIZE_UINT16    // *** uint8
+#define REGISTER_CAPTURE_FRAME      REGISTER_CAPTURE_SHIFT    + SIZE_UINT8     // *** uint8[5]
+#define REGISTER_CAPTURE_PULSES     REGISTER_CAPTURE_FRAME    + CAPTURE_FRAME_SIZE  // *** uint8[40]
+#define REGISTER_SERIAL             REGISTER_CAPTURE_PULSES   + CAPTURE_PULSE_COUNT // *** uint32
+#define REGISTER_ENUM_CONTROL       REGISTER_SERIAL           + SIZE_UINT32    // *** uint8
+#define REGISTER_ENUM_SELECT        REGISTER_ENUM_CONTROL     + SIZE_UINT8     // *** uint8[5]
+#define REGISTER_ENUM_ASSIGN        REGISTER_ENUM_SELECT      + ENUM_SELECT_SIZE    // *** uint8
+#define REGISTER_FILTER_MODE        REGISTER_ENUM_ASSIGN      + SIZE_UINT8     // *** uint8
+#define REGISTER_TEMPERATURE_SLEW   REGISTER_FILTER_MODE      + SIZE_UINT8     // *** uint16
+#define REGISTER_HUMIDITY_SLEW      REGISTER_TEMPERATURE_SLEW + SIZE_UINT16    // *** uint16
+#define REGISTER_FILTER_REJECTS     REGISTER_HUMIDITY_SLEW    + SIZE_UINT16    // *** uint16
+#define REGISTER_TEMPERATURE_OFFSET REGISTER_FILTER_REJECTS   + SIZE_UINT16    // *** int16
+#define REGISTER_TEMPERATURE_GAIN   REGISTER_TEMPERATURE_OFFSET + SIZE_INT16   // *** uint16
+#define REGISTER_HUMIDITY_OFFSET    REGISTER_TEMPERATURE_GAIN + SIZE_UINT16    // *** int16
+#define REGISTER_HUMIDITY_GAIN      REGISTER_HUMIDITY_OFFSET  + SIZE_INT16     // *** uint16
+#define REGISTER_DEW_POINT          REGISTER_HUMIDITY_GAIN    + SIZE_UINT16    // *** int16
+#define REGISTER_ABSOLUTE_HUMIDITY  REGISTER_DEW_POINT        + SIZE_INT16     // *** uint16
+#define REGISTER_HEAT_INDEX         REGISTER_ABSOLUTE_HUMIDITY + SIZE_UINT16   // *** int16
+#define REGISTER_CHANNEL            REGISTER_HEAT_INDEX       + SIZE_INT16     // *** uint8
+#define REGISTER_CHANNEL_COUNT      REGISTER_CHANNEL          + SIZE_UINT8     // *** uint8
+#define REGISTER_TRACE              REGISTER_CHANNEL_COUNT    + SIZE_UINT8     // *** uint8
+#define REGISTER_CLOCK_IDLE_SHIFT   REGISTER_TRACE            + SIZE_UINT8     // *** uint8
+#define REGISTER_CLOCK_FULL_TIME    REGISTER_CLOCK_IDLE_SHIFT + SIZE_UINT8     // *** uint32
+#define REGISTER_CLOCK_IDLE_TIME    REGISTER_CLOCK_FULL_TIME  + SIZE_UINT32    // *** uint32
+#define REGISTER_LOG_DECIMATION     REGISTER_CLOCK_IDLE_TIME  + SIZE_UINT32    // *** uint8
+#define REGISTER_LOG_CONTROL        REGISTER_LOG_DECIMATION   + SIZE_UINT8     // *** uint8
+#define REGISTER_LOG_DATA           REGISTER_LOG_CONTROL      + SIZE_UINT8     // *** uint8
+#define REGISTER_AGGREGATE_CONTROL  REGISTER_LOG_DATA         + SIZE_UINT8     // *** uint8
 
 // ***
 // *** Total size of the registers in bytes.
 // ***
-#define REGISTER_TOTAL_SIZE         REGISTER_DHT_MODEL        + SIZE_UINT8
+#define REGISTER_TOTAL_SIZE         REGISTER_AGGREGATE_CONTROL + SIZE_UINT8
+
+// ***
+// *** The measurement block is the range of registers from the
+// *** temperature through the reading age. A read that starts
+// *** within this block continues through the end of it so a
+// *** master can get the values and their age in one burst.
+// ***
+#define MEASUREMENT_BLOCK_START     REGISTER_TEMPERATURE
+#define MEASUREMENT_BLOCK_END       REGISTER_READING_AGE      + SIZE_UINT32
+
+// ***
+// *** The reading age until the first reading is taken; there
+// *** is nothing to be that old.
+// ***
+#define READING_AGE_NONE            0xFFFFFFFF
+
+// ***
+// *** The aggregate block holds the count, minimum, maximum and
+// *** mean of the readings in the last aggregation window, in
+// *** tenths of a degree and tenths of a percent. Like the
+// *** measurement block, it is read in one burst. Writing
+// *** AGGREGATE_COMMAND_ACK to REGISTER_AGGREGATE_CONTROL acks the
+// *** block; without a window the readings latched by a read are
+// *** reported again by the next read until then.
+// ***
+#define AGGREGATE_BLOCK_START       REGISTER_AGGREGATE_COUNT
+#define AGGREGATE_BLOCK_END         REGISTER_HUMIDITY_MEAN    + SIZE_INT16
+#define AGGREGATE_COMMAND_ACK       1
+
+// ***
+// *** The capture block holds the result, timing constants, raw
+// *** frame and pulse widths of the last sensor read when capture
+// *** is enabled. Every byte is startable so a master with a small
+// *** buffer can read the block in pieces.
+// ***
+#define CAPTURE_BLOCK_START         REGISTER_CAPTURE_RESULT
+#define CAPTURE_BLOCK_END           REGISTER_CAPTURE_PULSES   + CAPTURE_PULSE_COUNT
+
+// ***
+// *** The derived block holds the dew point and heat index in
+// *** tenths of a degree and the absolute humidity in hundredths
+// *** of a g/m^3, computed by the breakout from each committed
+// *** reading. Like the measurement block, it is read in one burst.
+// ***
+#define DERIVED_BLOCK_START         REGISTER_DEW_POINT
+#define DERIVED_BLOCK_END           REGISTER_HEAT_INDEX       + SIZE_INT16
+
+// ***
+// *** The clock block holds the idle clock shift and the time,
+// *** in milliseconds, spent at the full and the idle clock.
+// *** The times are brought up to date when a read starts in
+// *** the block, which is read in one burst.
+// ***
+#define CLOCK_BLOCK_START           REGISTER_CLOCK_IDLE_SHIFT
+#define CLOCK_BLOCK_END             REGISTER_CLOCK_IDLE_TIME  + SIZE_UINT32
+
+// ***
+// *** A breakout with more than one sensor keeps a bank of
+// *** registers for each channel. REGISTER_CHANNEL selects the
+// *** bank the master reads and writes; the registers below are
+// *** the same in every bank.
+// ***
+// *** REGISTER_ID through REGISTER_VER_BUILD
+// *** REGISTER_DEVICE_ADDRESS
+// *** REGISTER_SERIAL through REGISTER_ENUM_ASSIGN
+// *** REGISTER_CHANNEL_COUNT
+// ***
+// *** The PEC enabled bit of REGISTER_CONFIG is also the
+// *** same in every bank.
+// ***
+#define SHARED_BLOCK_START          REGISTER_SERIAL
+#define SHARED_BLOCK_END            REGISTER_ENUM_ASSIGN      + SIZE_UINT8
 
 // ***
 // *** This array indicates the number of bytes to return when a read
@@ -52,7 +187,7 @@
 // *** startable address, then the correct number of bytes will be
 // *** returned. If not, the byte count returned is zero.
 // ***
-const uint8_t _registerSize[REGISTER_TOTAL_SIZE] = 
+const uint8_t _registerSize[REGISTER_TOTAL_SIZE] PROGMEM =
                                       {
                                         SIZE_UINT8,
                                         SIZE_UINT8,
@@ -63,9 +198,59 @@ const uint8_t _registerSize[REGISTER_TOTAL_SIZE] =
                                         SIZE_UINT8,
                                         SIZE_UINT32, 0, 0, 0,
                                         SIZE_UINT32, 0, 0, 0,
+                                        SIZE_UINT32, 0, 0, 0,
+                                        SIZE_UINT32, 0, 0, 0,
+                                        SIZE_FLOAT, 0, 0, 0,
                                         SIZE_FLOAT, 0, 0, 0,
+                                        SIZE_UINT32, 0, 0, 0,
+                                        SIZE_UINT8,
+                                        SIZE_UINT8,
+                                        SIZE_UINT8,
+                                        SIZE_UINT32, 0, 0, 0,
                                         SIZE_FLOAT, 0, 0, 0,
                                         SIZE_UINT32, 0, 0, 0,
+                                        SIZE_UINT32, 0, 0, 0,
+                                        SIZE_UINT16, 0,
+                                        SIZE_INT16, 0,
+                                        SIZE_INT16, 0,
+                                        SIZE_INT16, 0,
+                                        SIZE_INT16, 0,
+                                        SIZE_INT16, 0,
+                                        SIZE_INT16, 0,
+                                        SIZE_INT8,
+                                        SIZE_UINT16, 0,
+                                        SIZE_UINT8,
+                                        SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8,
+                                        SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8,
+                                        SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8,
+                                        SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8,
+                                        SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8,
+                                        SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8,
+                                        SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8,
+                                        SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8,
+                                        SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8, SIZE_UINT8,
+                                        SIZE_UINT32, 0, 0, 0,
+                                        SIZE_UINT8,
+                                        ENUM_SELECT_SIZE, 0, 0, 0, 0,
+                                        SIZE_UINT8,
+                                        SIZE_UINT8,
+                                        SIZE_UINT16, 0,
+                                        SIZE_UINT16, 0,
+                                        SIZE_UINT16, 0,
+                                        SIZE_INT16, 0,
+                                        SIZE_UINT16, 0,
+                                        SIZE_INT16, 0,
+                                        SIZE_UINT16, 0,
+                                        SIZE_INT16, 0,
+                                        SIZE_UINT16, 0,
+                                        SIZE_INT16, 0,
+                                        SIZE_UINT8,
+                                        SIZE_UINT8,
+                                        SIZE_UINT8,
+                                        SIZE_UINT8,
+                                        SIZE_UINT32, 0, 0, 0,
+                                        SIZE_UINT32, 0, 0, 0,
+                                        SIZE_UINT8,
                                         SIZE_UINT8,
                                         SIZE_UINT8,
                                         SIZE_UINT8
@@ -77,9 +262,9 @@ const uint8_t _registerSize[REGISTER_TOTAL_SIZE] =
 #define CONFIG_BIT_SENSOR_ENABLED           0
 #define CONFIG_BIT_THRESHOLD_ENABLED        1
 #define CONFIG_BIT_TRIGGER_READING          2
-#define CONFIG_BIT_RESERVED_1               3
-#define CONFIG_BIT_RESERVED_2               4
-#define CONFIG_BIT_RESERVED_3               5
+#define CONFIG_BIT_ADAPTIVE_INTERVAL        3
+#define CONFIG_BIT_CAPTURE                  4
+#define CONFIG_BIT_PEC_ENABLED              5
 #define CONFIG_BIT_WRITE_CONFIG             6
 #define CONFIG_BIT_RESET_CONFIG             7
 
@@ -90,11 +275,34 @@ const uint8_t _registerSize[REGISTER_TOTAL_SIZE] =
 #define STATUS_UPPER_THRESHOLD_EXCEEDED     1
 #define STATUS_LOWER_THRESHOLD_EXCEEDED     2
 #define STATUS_DHT_READING_ERROR            3
-#define STATUS_RESERVED_2                   4
+#define STATUS_PEC_ERROR                    4
 #define STATUS_CONFIG_SAVED                 5
 #define STATUS_READ_ERROR                   6
 #define STATUS_WRITE_ERROR                  7
 
+// ***
+// *** The first byte of a PEC read, which is followed by the
+// *** register and the byte count. No register has it.
+// ***
+#define PEC_READ_COMMAND                    0xFE
+
+// ***
+// *** Filter mode bits. Readings pass through the median of
+// *** the last three samples and/or a gate that rejects a change
+// *** faster than the slew limit (tenths per second) before they
+// *** are committed.
+// ***
+#define FILTER_BIT_MEDIAN                   0
+#define FILTER_BIT_SLEW                     1
+
+// ***
+// *** Calibration. A reading in tenths is corrected to
+// *** (value * gain / CALIBRATION_GAIN_ONE) + offset, so a gain
+// *** of CALIBRATION_GAIN_ONE and an offset of 0 leave it as is.
+// ***
+#define CALIBRATION_GAIN_ONE                4096
+#define CALIBRATION_GAIN_SHIFT              12
+
 // ***
 // *** This array indicates the protection status
 // *** for each byte in the register array.
@@ -104,7 +312,7 @@ const uint8_t _registerSize[REGISTER_TOTAL_SIZE] =
 // *** 2: Read-only, indicates a startable position
 // *** 3: Read-only, indicates a non-startable position
 // ***
-const uint8_t _registerProtection[REGISTER_TOTAL_SIZE] =
+const uint8_t _registerProtection[REGISTER_TOTAL_SIZE] PROGMEM =
 {
   2,          //REGISTER_ID (read-only)
   2,          //REGISTER_VER_MAJOR (read-only)
@@ -114,13 +322,60 @@ const uint8_t _registerProtection[REGISTER_TOTAL_SIZE] =
   2, 3, 3, 3, //REGISTER_HUMIDITY (read-only)
   2,          //REGISTER_STATUS (read-only)
   2, 3, 3, 3, //REGISTER_READING_ID (read-only)
+  2, 3, 3, 3, //REGISTER_READING_TIME (read-only)
+  2, 3, 3, 3, //REGISTER_READING_AGE (read-only)
   0, 1, 1, 1, //REGISTER_INTERVAL
   0, 1, 1, 1, //REGISTER_UPPER_THRESHOLD
   0, 1, 1, 1, //REGISTER_LOWER_THRESHOLD
   0, 1, 1, 1, //REGISTER_START_DELAY
   0,          //REGISTER_CONFIG
   0,          //REGISTER_DEVICE_ADDRESS
-  0           //REGISTER_DHT_MODEL
+  0,          //REGISTER_DHT_MODEL
+  0, 1, 1, 1, //REGISTER_MIN_INTERVAL
+  0, 1, 1, 1, //REGISTER_SLOPE_THRESHOLD
+  2, 3, 3, 3, //REGISTER_CURRENT_INTERVAL (read-only)
+  0, 1, 1, 1, //REGISTER_AGGREGATE_WINDOW
+  2, 3,       //REGISTER_AGGREGATE_COUNT (read-only)
+  2, 3,       //REGISTER_TEMPERATURE_MIN (read-only)
+  2, 3,       //REGISTER_TEMPERATURE_MAX (read-only)
+  2, 3,       //REGISTER_TEMPERATURE_MEAN (read-only)
+  2, 3,       //REGISTER_HUMIDITY_MIN (read-only)
+  2, 3,       //REGISTER_HUMIDITY_MAX (read-only)
+  2, 3,       //REGISTER_HUMIDITY_MEAN (read-only)
+  2,          //REGISTER_CAPTURE_RESULT (read-only)
+  2, 3,       //REGISTER_CAPTURE_TIMEOUT (read-only)
+  2,          //REGISTER_CAPTURE_SHIFT (read-only)
+  2, 2, 2, 2, 2, //REGISTER_CAPTURE_FRAME (read-only)
+  2, 2, 2, 2, 2, 2, 2, 2, //REGISTER_CAPTURE_PULSES (read-only)
+  2, 2, 2, 2, 2, 2, 2, 2,
+  2, 2, 2, 2, 2, 2, 2, 2,
+  2, 2, 2, 2, 2, 2, 2, 2,
+  2, 2, 2, 2, 2, 2, 2, 2,
+  2, 3, 3, 3, //REGISTER_SERIAL (read-only)
+  0,          //REGISTER_ENUM_CONTROL
+  0, 1, 1, 1, 1, //REGISTER_ENUM_SELECT
+  0,          //REGISTER_ENUM_ASSIGN
+  0,          //REGISTER_FILTER_MODE
+  0, 1,       //REGISTER_TEMPERATURE_SLEW
+  0, 1,       //REGISTER_HUMIDITY_SLEW
+  2, 3,       //REGISTER_FILTER_REJECTS (read-only)
+  0, 1,       //REGISTER_TEMPERATURE_OFFSET
+  0, 1,       //REGISTER_TEMPERATURE_GAIN
+  0, 1,       //REGISTER_HUMIDITY_OFFSET
+  0, 1,       //REGISTER_HUMIDITY_GAIN
+  2, 3,       //REGISTER_DEW_POINT (read-only)
+  2, 3,       //REGISTER_ABSOLUTE_HUMIDITY (read-only)
+  2, 3,       //REGISTER_HEAT_INDEX (read-only)
+  0,          //REGISTER_CHANNEL
+  2,          //REGISTER_CHANNEL_COUNT (read-only)
+  0,          //REGISTER_TRACE
+  2,          //REGISTER_CLOCK_IDLE_SHIFT (read-only)
+  2, 3, 3, 3, //REGISTER_CLOCK_FULL_TIME (read-only)
+  2, 3, 3, 3, //REGISTER_CLOCK_IDLE_TIME (read-only)
+  0,          //REGISTER_LOG_DECIMATION
+  0,          //REGISTER_LOG_CONTROL
+  2,          //REGISTER_LOG_DATA (read-only)
+  0           //REGISTER_AGGREGATE_CONTROL
 };
 
 #endif
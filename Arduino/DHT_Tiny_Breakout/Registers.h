@@ -25,13 +25,49 @@
 // *** REGISTER_TOTAL_SIZE.
 // ***
 #include "Register_Defs.h"
+#include "Pins.h"
 
+#if DHT_CHANNEL_COUNT > 1
 // ***
-// *** Registers.
+// *** One bank of registers per channel. _registers points to
+// *** the bank of the channel being worked on and _channel is
+// *** its index; both are changed with setChannel().
+// ***
+volatile uint8_t _registerBanks[DHT_CHANNEL_COUNT][REGISTER_TOTAL_SIZE];
+volatile uint8_t* _registers = _registerBanks[0];
+uint8_t _channel = 0;
+
+void setChannel(uint8_t channel)
+{
+  _channel = channel;
+  _registers = _registerBanks[channel];
+}
+#else
+// ***
+// *** Registers. With a single channel there is nothing to
+// *** select and _channel folds to a constant.
 // ***
 volatile uint8_t _registers[REGISTER_TOTAL_SIZE];
+const uint8_t _channel = 0;
+
+inline void setChannel(uint8_t channel) {}
+#endif
+
 volatile uint8_t _registerPosition = 0;
 
+// ***
+// *** The size and protection tables are kept in flash.
+// ***
+uint8_t getRegisterSize(uint8_t registerId)
+{
+  return pgm_read_byte(&_registerSize[registerId]);
+}
+
+uint8_t getRegisterProtection(uint8_t registerId)
+{
+  return pgm_read_byte(&_registerProtection[registerId]);
+}
+
 void advanceRegisterPosition()
 {
   _registerPosition++;
@@ -90,4 +126,36 @@ void writeUint32(uint8_t registerId, uint32_t value)
   _registers[registerId + 2] = data[2];
   _registers[registerId + 3] = data[3];
 }
+
+int16_t readInt16(uint8_t registerId)
+{
+  byte data[2];
+  data[0] = _registers[registerId + 0];
+  data[1] = _registers[registerId + 1];
+  return ByteConverter::bytesToInt16(data);
+}
+
+void writeInt16(uint8_t registerId, int16_t value)
+{
+  byte data[2];
+  ByteConverter::int16ToBytes(value, data);
+  _registers[registerId + 0] = data[0];
+  _registers[registerId + 1] = data[1];
+}
+
+uint16_t readUint16(uint8_t registerId)
+{
+  byte data[2];
+  data[0] = _registers[registerId + 0];
+  data[1] = _registers[registerId + 1];
+  return ByteConverter::bytesToUint16(data);
+}
+
+void writeUint16(uint8_t registerId, uint16_t value)
+{
+  byte data[2];
+  ByteConverter::uint16ToBytes(value, data);
+  _registers[registerId + 0] = data[0];
+  _registers[registerId + 1] = data[1];
+}
 #endif
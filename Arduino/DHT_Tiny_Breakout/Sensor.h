@@ -0,0 +1,306 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef SENSOR_H
+#define SENSOR_H
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include "dht.h"
+#include "DhtDecoder.h"
+#include "Sht3x.h"
+#include "Channels.h"
+
+// ***
+// *** Models that are not DHTs. They are selected through
+// *** REGISTER_DHT_MODEL like the DHT models.
+// ***
+#define SENSOR_MODEL_SHT3X    31
+
+// ***
+// *** A reading is taken in four steps so that a sensor that
+// *** converts on its own does not hold up the loop:
+// ***
+// ***   begin   sets up the pins at start-up and after the model
+// ***           of the channel is changed
+// ***   power   turns the supply of the sensor on or off; it is
+// ***           called after begin and when the sensor is
+// ***           enabled or disabled
+// ***   start   starts a conversion
+// ***   ready   returns true once the conversion is done; the
+// ***           loop polls it while the reading is pending
+// ***   fetch   reads the result in tenths and returns DHTLIB_OK
+// ***           or one of the DHTLIB errors
+// ***
+// *** A DHT frame is timed by the CPU from the wakeup pulse to
+// *** the last bit, so the DHT starts nothing, is always ready
+// *** and does the whole read in fetch. An SHT3x is started,
+// *** left alone while the loop serves the bus and fetched
+// *** when its conversion time has passed.
+// ***
+// *** The SHT3x is wired to the bit-banged master with SDA on
+// *** the data pin of the channel and SCL on the power pin. Its
+// *** ground and supply go to the board, so disabling the
+// *** sensor only stops the readings and its power does not
+// *** touch the pins. A DHT has its ground on the power pin,
+// *** which begin makes an output again after an SHT3x left it
+// *** as a bus line.
+// ***
+dht _dht;
+
+// ***
+// *** The channels with a conversion in progress and the time
+// *** each one was started.
+// ***
+uint8_t _sensorPending = 0;
+uint32_t _sensorStarted[DHT_CHANNEL_COUNT];
+
+static_assert(DHT_CHANNEL_COUNT <= 8, "The pending conversions are kept in one byte");
+
+template <uint8_t MODEL> struct SensorTraits
+{
+  static const uint16_t minimumSpacing = DhtTraits<MODEL>::minimumSpacing;
+
+  static void begin(uint8_t channel)
+  {
+    pinMode(_powerPins[channel], OUTPUT);
+    pinMode(_readingPins[channel], INPUT);
+  }
+
+  // ***
+  // *** The GND pin of the DHT is on the power pin, so
+  // *** LOW turns it on.
+  // ***
+  static void power(uint8_t channel, bool on)
+  {
+    digitalWrite(_powerPins[channel], on ? LOW : HIGH);
+  }
+
+  static void start(uint8_t channel) {}
+  static bool ready(uint8_t channel) { return true; }
+
+  static int8_t fetch(uint8_t channel, int16_t& temperature, int16_t& humidity)
+  {
+    int8_t returnValue = decodeDhtModel<MODEL>(_dht, _readingPins[channel]);
+    temperature = _dht.temperature;
+    humidity = _dht.humidity;
+    return returnValue;
+  }
+};
+
+template <> struct SensorTraits<SENSOR_MODEL_SHT3X>
+{
+  static const uint16_t minimumSpacing = SHT3X_MINIMUM_SPACING;
+
+  static void begin(uint8_t channel)
+  {
+    SoftI2c bus(_readingPins[channel], _powerPins[channel]);
+    beginSht3x(bus);
+  }
+
+  static void power(uint8_t channel, bool on) {}
+
+  static void start(uint8_t channel)
+  {
+    SoftI2c bus(_readingPins[channel], _powerPins[channel]);
+    startSht3x(bus);
+  }
+
+  static bool ready(uint8_t channel)
+  {
+    return (millis() - _sensorStarted[channel]) > SHT3X_CONVERSION_TIME;
+  }
+
+  static int8_t fetch(uint8_t channel, int16_t& temperature, int16_t& humidity)
+  {
+    SoftI2c bus(_readingPins[channel], _powerPins[channel]);
+    return fetchSht3x(bus, temperature, humidity);
+  }
+};
+
+#if !defined(DHT_FIXED_MODEL)
+// ***
+// *** One entry per supported model. Models that share a
+// *** frame share a backend so each frame is compiled once.
+// ***
+typedef void (*SensorBegin)(uint8_t channel);
+typedef void (*SensorPower)(uint8_t channel, bool on);
+typedef void (*SensorStart)(uint8_t channel);
+typedef bool (*SensorReady)(uint8_t channel);
+typedef int8_t (*SensorFetch)(uint8_t channel, int16_t& temperature, int16_t& humidity);
+
+struct SensorBackend
+{
+  uint8_t model;
+  uint16_t minimumSpacing;
+  SensorBegin begin;
+  SensorPower power;
+  SensorStart start;
+  SensorReady ready;
+  SensorFetch fetch;
+};
+
+#define SENSOR_BACKEND(model, traits) { model, traits::minimumSpacing, traits::begin, traits::power, traits::start, traits::ready, traits::fetch }
+
+const SensorBackend _sensorBackends[] PROGMEM =
+{
+  SENSOR_BACKEND(DHT_MODEL_11, SensorTraits<DHT_MODEL_11>),
+  SENSOR_BACKEND(DHT_MODEL_21, SensorTraits<DHT_MODEL_22>),
+  SENSOR_BACKEND(DHT_MODEL_22, SensorTraits<DHT_MODEL_22>),
+  SENSOR_BACKEND(DHT_MODEL_33, SensorTraits<DHT_MODEL_22>),
+  SENSOR_BACKEND(DHT_MODEL_44, SensorTraits<DHT_MODEL_22>),
+  SENSOR_BACKEND(SENSOR_MODEL_SHT3X, SensorTraits<SENSOR_MODEL_SHT3X>)
+};
+
+#define SENSOR_BACKEND_COUNT (sizeof(_sensorBackends) / sizeof(SensorBackend))
+
+int8_t findSensorBackend(uint8_t model)
+{
+  int8_t returnValue = -1;
+
+  for (uint8_t i = 0; i < SENSOR_BACKEND_COUNT; i++)
+  {
+    if (pgm_read_byte(&_sensorBackends[i].model) == model)
+    {
+      returnValue = i;
+      break;
+    }
+  }
+
+  return returnValue;
+}
+#endif
+
+void beginSensor(uint8_t model, uint8_t channel)
+{
+#if defined(DHT_FIXED_MODEL)
+  SensorTraits<DHT_FIXED_MODEL>::begin(channel);
+#else
+  int8_t index = findSensorBackend(model);
+
+  if (index >= 0)
+  {
+    SensorBegin begin = (SensorBegin)pgm_read_ptr(&_sensorBackends[index].begin);
+    begin(channel);
+  }
+#endif
+}
+
+void powerSensor(uint8_t model, uint8_t channel, bool on)
+{
+#if defined(DHT_FIXED_MODEL)
+  SensorTraits<DHT_FIXED_MODEL>::power(channel, on);
+#else
+  int8_t index = findSensorBackend(model);
+
+  if (index >= 0)
+  {
+    SensorPower power = (SensorPower)pgm_read_ptr(&_sensorBackends[index].power);
+    power(channel, on);
+  }
+#endif
+}
+
+void startSensor(uint8_t model, uint8_t channel)
+{
+  _sensorStarted[channel] = millis();
+  bitSet(_sensorPending, channel);
+
+#if defined(DHT_FIXED_MODEL)
+  SensorTraits<DHT_FIXED_MODEL>::start(channel);
+#else
+  int8_t index = findSensorBackend(model);
+
+  if (index >= 0)
+  {
+    SensorStart start = (SensorStart)pgm_read_ptr(&_sensorBackends[index].start);
+    start(channel);
+  }
+#endif
+}
+
+bool isSensorPending(uint8_t channel)
+{
+  return bitRead(_sensorPending, channel);
+}
+
+void cancelSensor(uint8_t channel)
+{
+  bitClear(_sensorPending, channel);
+}
+
+bool isSensorReady(uint8_t model, uint8_t channel)
+{
+#if defined(DHT_FIXED_MODEL)
+  return SensorTraits<DHT_FIXED_MODEL>::ready(channel);
+#else
+  bool returnValue = true;
+  int8_t index = findSensorBackend(model);
+
+  if (index >= 0)
+  {
+    SensorReady ready = (SensorReady)pgm_read_ptr(&_sensorBackends[index].ready);
+    returnValue = ready(channel);
+  }
+
+  return returnValue;
+#endif
+}
+
+int8_t fetchSensor(uint8_t model, uint8_t channel, int16_t& temperature, int16_t& humidity)
+{
+  cancelSensor(channel);
+
+#if defined(DHT_FIXED_MODEL)
+  return SensorTraits<DHT_FIXED_MODEL>::fetch(channel, temperature, humidity);
+#else
+  int8_t returnValue = -1;
+  int8_t index = findSensorBackend(model);
+
+  if (index >= 0)
+  {
+    SensorFetch fetch = (SensorFetch)pgm_read_ptr(&_sensorBackends[index].fetch);
+    returnValue = fetch(channel, temperature, humidity);
+  }
+
+  return returnValue;
+#endif
+}
+
+// ***
+// *** Returns the shortest time, in milliseconds, the
+// *** model allows between two readings.
+// ***
+uint16_t getSensorMinimumSpacing(uint8_t model)
+{
+#if defined(DHT_FIXED_MODEL)
+  return SensorTraits<DHT_FIXED_MODEL>::minimumSpacing;
+#else
+  uint16_t returnValue = SensorTraits<DHT_MODEL_DEFAULT>::minimumSpacing;
+  int8_t index = findSensorBackend(model);
+
+  if (index >= 0)
+  {
+    returnValue = pgm_read_word(&_sensorBackends[index].minimumSpacing);
+  }
+
+  return returnValue;
+#endif
+}
+
+#endif
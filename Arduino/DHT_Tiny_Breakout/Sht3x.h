@@ -0,0 +1,132 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef SHT3X_H
+#define SHT3X_H
+
+#include <Arduino.h>
+#include "SoftI2c.h"
+#include "dht.h"
+
+// ***
+// *** The SHT30, SHT31 and SHT35 converts on its own once it has
+// *** been sent a command, so it is started, left alone for
+// *** SHT3X_CONVERSION_TIME milliseconds and then read. The
+// *** single shot command with high repeatability and without
+// *** clock stretching is used; the sensor does not answer its
+// *** address until the conversion is done.
+// ***
+#define SHT3X_ADDRESS           0x44
+#define SHT3X_MEASURE           0x2400
+#define SHT3X_SOFT_RESET        0x30A2
+#define SHT3X_CONVERSION_TIME   16
+#define SHT3X_MINIMUM_SPACING   100
+
+// ***
+// *** Each 16-bit word of the result is followed by a CRC-8
+// *** (polynomial 0x31, initial value 0xFF).
+// ***
+#define SHT3X_CRC_POLYNOMIAL    0x31
+#define SHT3X_CRC_INITIAL       0xFF
+#define SHT3X_RESULT_SIZE       6
+
+uint8_t getSht3xCrc(const uint8_t* data)
+{
+  uint8_t crc = SHT3X_CRC_INITIAL;
+
+  for (uint8_t i = 0; i < 2; i++)
+  {
+    crc ^= data[i];
+
+    for (uint8_t bit = 0; bit < 8; bit++)
+    {
+      crc = (crc & 0x80) ? (crc << 1) ^ SHT3X_CRC_POLYNOMIAL : crc << 1;
+    }
+  }
+
+  return crc;
+}
+
+bool sendSht3xCommand(SoftI2c& bus, uint16_t command)
+{
+  bool returnValue = bus.start(SHT3X_ADDRESS, false) &&
+                     bus.write(command >> 8) &&
+                     bus.write(command & 0xFF);
+  bus.stop();
+  return returnValue;
+}
+
+void beginSht3x(SoftI2c& bus)
+{
+  // ***
+  // *** The sensor is ready for a command one millisecond
+  // *** after the reset, long before the first is sent.
+  // ***
+  bus.begin();
+  sendSht3xCommand(bus, SHT3X_SOFT_RESET);
+}
+
+bool startSht3x(SoftI2c& bus)
+{
+  return sendSht3xCommand(bus, SHT3X_MEASURE);
+}
+
+// ***
+// *** Reads the result of the last conversion in tenths of a
+// *** degree Celsius and tenths of a percent.
+// ***
+int8_t fetchSht3x(SoftI2c& bus, int16_t& temperature, int16_t& humidity)
+{
+  uint8_t data[SHT3X_RESULT_SIZE];
+
+  // ***
+  // *** A sensor that is missing, or that never received the
+  // *** command, does not acknowledge its address.
+  // ***
+  if (!bus.start(SHT3X_ADDRESS, true))
+  {
+    bus.stop();
+    return DHTLIB_ERROR_CONNECT;
+  }
+
+  for (uint8_t i = 0; i < SHT3X_RESULT_SIZE; i++)
+  {
+    data[i] = bus.read(i < SHT3X_RESULT_SIZE - 1);
+  }
+
+  bus.stop();
+
+  if (getSht3xCrc(&data[0]) != data[2] || getSht3xCrc(&data[3]) != data[5])
+  {
+    return DHTLIB_ERROR_CHECKSUM;
+  }
+
+  // ***
+  // *** T = -45 + 175 * raw / 65535 and RH = 100 * raw / 65535,
+  // *** rounded to tenths in integer arithmetic.
+  // ***
+  uint16_t rawTemperature = (data[0] << 8) | data[1];
+  uint16_t rawHumidity = (data[3] << 8) | data[4];
+
+  temperature = (int16_t)((1750UL * rawTemperature + 32767) / 65535) - 450;
+  humidity = (int16_t)((1000UL * rawHumidity + 32767) / 65535);
+
+  return DHTLIB_OK;
+}
+
+#endif
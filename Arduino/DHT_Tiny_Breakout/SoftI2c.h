@@ -0,0 +1,163 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef SOFT_I2C_H
+#define SOFT_I2C_H
+
+#include <Arduino.h>
+
+// ***
+// *** The USI of the ATtiny is taken by the slave, so a sensor
+// *** on I2C is read through a second, bit-banged master. The
+// *** lines are open drain: a line is pulled low by making the
+// *** pin an output and released by making it an input with the
+// *** pull-up on. Sensor modules have their own pull-ups; the
+// *** internal ones alone are only good for short wires.
+// ***
+// *** The bus runs at a few tens of kHz. A slave that holds
+// *** SCL low is waited for up to SOFT_I2C_STRETCH_LIMIT
+// *** microseconds.
+// ***
+#define SOFT_I2C_HALF_PERIOD    5
+#define SOFT_I2C_STRETCH_LIMIT  1000
+
+class SoftI2c
+{
+public:
+  SoftI2c(uint8_t sda, uint8_t scl) : _sda(sda), _scl(scl) {}
+
+  // ***
+  // *** Releases both lines.
+  // ***
+  void begin()
+  {
+    release(_sda);
+    release(_scl);
+  }
+
+  // ***
+  // *** Sends a start, or a repeated start, and the address.
+  // *** Returns true if the slave acknowledged it.
+  // ***
+  bool start(uint8_t address, bool read)
+  {
+    release(_sda);
+    releaseClock();
+    pull(_sda);
+    delayMicroseconds(SOFT_I2C_HALF_PERIOD);
+    pull(_scl);
+
+    return write((address << 1) | (read ? 1 : 0));
+  }
+
+  void stop()
+  {
+    pull(_sda);
+    delayMicroseconds(SOFT_I2C_HALF_PERIOD);
+    releaseClock();
+    release(_sda);
+    delayMicroseconds(SOFT_I2C_HALF_PERIOD);
+  }
+
+  // ***
+  // *** Sends a byte, most significant bit first, and returns
+  // *** true if the slave acknowledged it.
+  // ***
+  bool write(uint8_t value)
+  {
+    for (uint8_t i = 0; i < 8; i++)
+    {
+      writeBit(value & 0x80);
+      value <<= 1;
+    }
+
+    return !readBit();
+  }
+
+  // ***
+  // *** Reads a byte and acknowledges it when more are to
+  // *** follow.
+  // ***
+  uint8_t read(bool ack)
+  {
+    uint8_t returnValue = 0;
+
+    for (uint8_t i = 0; i < 8; i++)
+    {
+      returnValue = (returnValue << 1) | readBit();
+    }
+
+    writeBit(!ack);
+    return returnValue;
+  }
+
+private:
+  uint8_t _sda;
+  uint8_t _scl;
+
+  void pull(uint8_t pin)
+  {
+    digitalWrite(pin, LOW);
+    pinMode(pin, OUTPUT);
+  }
+
+  void release(uint8_t pin)
+  {
+    pinMode(pin, INPUT_PULLUP);
+  }
+
+  void releaseClock()
+  {
+    release(_scl);
+
+    for (uint16_t i = 0; i < SOFT_I2C_STRETCH_LIMIT && digitalRead(_scl) == LOW; i++)
+    {
+      delayMicroseconds(1);
+    }
+
+    delayMicroseconds(SOFT_I2C_HALF_PERIOD);
+  }
+
+  void writeBit(bool value)
+  {
+    if (value)
+    {
+      release(_sda);
+    }
+    else
+    {
+      pull(_sda);
+    }
+
+    delayMicroseconds(SOFT_I2C_HALF_PERIOD);
+    releaseClock();
+    pull(_scl);
+  }
+
+  uint8_t readBit()
+  {
+    release(_sda);
+    delayMicroseconds(SOFT_I2C_HALF_PERIOD);
+    releaseClock();
+    uint8_t returnValue = digitalRead(_sda) == HIGH ? 1 : 0;
+    pull(_scl);
+    return returnValue;
+  }
+};
+
+#endif
@@ -0,0 +1,611 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef SPILL_LOG_H
+#define SPILL_LOG_H
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <avr/eeprom.h>
+#include <util/atomic.h>
+#include "Registers.h"
+#include "Configuration.h"
+#include "Features.h"
+
+// ***
+// *** Define DHT_SPILL_LOG to keep readings the master did not
+// *** fetch in the EEPROM after the channel configurations, so a
+// *** master that was away can collect them later. A channel logs
+// *** every REGISTER_LOG_DECIMATION'th reading that was replaced
+// *** before it was read; 0, the default, logs nothing.
+// ***
+// *** The log is a ring of LOG_BLOCK_SIZE byte blocks. The first
+// *** byte of a block is its sequence number (LOG_END when the
+// *** block is erased) and the records follow it up to a LOG_END
+// *** byte. Times are whole seconds of uptime and values are in
+// *** tenths; numbers are zigzag encoded varints.
+// ***
+// *** 11cccccc time T H           key: channel c, absolute values
+// *** 10cccccc dt dT dH           delta from the last record of c
+// *** 0TTTHHHH                    dT and dH of 3 and 4 bits, same
+// ***                             channel and dt as the last record
+// ***
+// *** Each block starts a channel with a key record so it can be
+// *** decoded on its own. A record is written from its last byte
+// *** to its first after moving the LOG_END past it, and a block
+// *** gets its sequence number after its first LOG_END, so a reset
+// *** part way through a write never leaves a record half there.
+// ***
+// *** A read of REGISTER_LOG_DATA returns a header followed by the
+// *** records of the oldest block not read since the last ack:
+// ***
+// *** byte 0:   LOG_ENABLED | LOG_BLOCK_VALID | LOG_EARLIER_BOOT |
+// ***           LOG_BLOCK_PENDING
+// *** byte 1:   blocks left after this one
+// *** byte 2:   blocks dropped because the log was full
+// *** then the LOG_BLOCK_SIZE - 1 bytes after the sequence number
+// ***
+// *** The I2C handlers never touch the EEPROM, which could keep
+// *** the bus waiting for a write in progress. The loop copies
+// *** the block the next drain reads to RAM; until it has,
+// *** a drain returns LOG_BLOCK_PENDING and is read again.
+// ***
+// *** Reading the block being written closes it. Writing
+// *** LOG_COMMAND_ACK to REGISTER_LOG_CONTROL erases the blocks
+// *** read so far, LOG_COMMAND_REWIND reads them again and
+// *** LOG_COMMAND_CLEAR erases the log; a read returns the number
+// *** of blocks in the log. Erasing a block only writes its
+// *** sequence number and a short record is one byte, which
+// *** keeps the writes to each EEPROM cell to about two per trip
+// *** around the ring.
+// ***
+// #define DHT_SPILL_LOG
+
+#define LOG_RECORD_KEY            0xC0
+#define LOG_RECORD_DELTA          0x80
+#define LOG_RECORD_TYPE_MASK      0xC0
+#define LOG_RECORD_CHANNEL_MASK   0x3F
+#define LOG_SHORT_TEMPERATURE_SHIFT 4
+#define LOG_SHORT_HUMIDITY_MASK   0x0F
+#define LOG_END                   0xFF
+
+#define LOG_ENABLED               0x80
+#define LOG_BLOCK_VALID           0x40
+#define LOG_EARLIER_BOOT          0x20
+#define LOG_BLOCK_PENDING         0x10
+
+#define LOG_COMMAND_ACK           1
+#define LOG_COMMAND_REWIND        2
+#define LOG_COMMAND_CLEAR         3
+
+// ***
+// *** A drain fits in the 32 byte buffer of the Wire library,
+// *** or in one PEC read.
+// ***
+#define LOG_BLOCK_SIZE            29
+#define LOG_HEADER_SIZE           3
+#define LOG_DRAIN_SIZE            ((LOG_HEADER_SIZE) + (LOG_BLOCK_SIZE) - 1)
+
+// ***
+// *** The longest record is a key: the header, a 5 byte time
+// *** and two 3 byte values.
+// ***
+#define LOG_RECORD_SIZE           12
+
+#define LOG_START                 (DHT_CHANNEL_COUNT * CONFIGURATION_SIZE)
+#define LOG_BLOCK_COUNT           ((SERIAL_SIGNATURE - LOG_START) / LOG_BLOCK_SIZE)
+#define LOG_SEQUENCE_COUNT        255
+#define LOG_NO_INTERVAL           UINT32_MAX
+
+#if defined(DHT_SPILL_LOG)
+static_assert(LOG_BLOCK_COUNT >= 2, "The spill log needs at least two blocks");
+
+// ***
+// *** The ring: the oldest block, the number of blocks, the
+// *** sequence number of the newest block and where the next
+// *** record goes in it (0 when it is closed). Blocks from
+// *** before the last reset are counted in _logEarlier.
+// ***
+volatile uint8_t _logTail = 0;
+volatile uint8_t _logCount = 0;
+volatile uint8_t _logEarlier = 0;
+volatile uint8_t _logDropped = 0;
+uint8_t _logSequence = 0;
+uint8_t _logOffset = 0;
+
+// ***
+// *** The master side: the blocks read since the last ack, the
+// *** number of those an ack erases and the block being read.
+// *** _logHeadRead closes the newest block once it was read.
+// ***
+volatile uint8_t _logCursor = 0;
+volatile uint8_t _logAcked = 0;
+volatile uint8_t _logCommand = 0;
+volatile bool _logHeadRead = false;
+volatile bool _logDrainValid = false;
+volatile uint8_t _logDrainBlock = 0;
+volatile uint8_t _logDrainHeader = 0;
+volatile uint8_t _logDrainLeft = 0;
+volatile uint8_t _logDrainIndex = 0;
+
+// ***
+// *** The copy of the block at _logDrainCursor the drain is
+// *** served from. _logDrainReady is cleared before the block
+// *** changes.
+// ***
+uint8_t _logDrainBuffer[LOG_BLOCK_SIZE - 1];
+volatile uint8_t _logDrainCursor = 0;
+volatile bool _logDrainReady = false;
+
+// ***
+// *** The channel of the last record, the channels with a key
+// *** record in the newest block and the last record of each.
+// ***
+uint8_t _logChannel = 0;
+uint8_t _logKeyed = 0;
+uint32_t _logTime[DHT_CHANNEL_COUNT];
+uint32_t _logInterval[DHT_CHANNEL_COUNT];
+int16_t _logTemperature[DHT_CHANNEL_COUNT];
+int16_t _logHumidity[DHT_CHANNEL_COUNT];
+
+// ***
+// *** Readings the master has read and the readings skipped
+// *** by the decimation, per channel.
+// ***
+bool _readingFetched[DHT_CHANNEL_COUNT];
+uint8_t _logSkipped[DHT_CHANNEL_COUNT];
+
+inline uint16_t getLogBlockAddress(uint8_t block)
+{
+  return LOG_START + (uint16_t)block * LOG_BLOCK_SIZE;
+}
+
+inline uint8_t getLogBlock(uint8_t index)
+{
+  return (uint16_t)(_logTail + index) % LOG_BLOCK_COUNT;
+}
+
+inline uint8_t getNextLogSequence(uint8_t sequence)
+{
+  return sequence + 1 == LOG_SEQUENCE_COUNT ? 0 : sequence + 1;
+}
+
+bool isLogBlockValid(uint8_t block)
+{
+  // ***
+  // *** A block that does not start with a key record was not
+  // *** written by the log.
+  // ***
+  uint16_t address = getLogBlockAddress(block);
+  return EEPROM.read(address) < LOG_SEQUENCE_COUNT &&
+         (EEPROM.read(address + 1) & LOG_RECORD_TYPE_MASK) == LOG_RECORD_KEY &&
+         EEPROM.read(address + 1) != LOG_END;
+}
+
+void setupLog()
+{
+  // ***
+  // *** The log is the run of blocks with consecutive sequence
+  // *** numbers that starts after an erased block or a break in
+  // *** the sequence. Anything outside of it is erased.
+  // ***
+  for (uint8_t block = 0; block < LOG_BLOCK_COUNT; block++)
+  {
+    uint8_t previous = block == 0 ? LOG_BLOCK_COUNT - 1 : block - 1;
+
+    if (isLogBlockValid(block) &&
+        (!isLogBlockValid(previous) ||
+         EEPROM.read(getLogBlockAddress(block)) != getNextLogSequence(EEPROM.read(getLogBlockAddress(previous)))))
+    {
+      _logTail = block;
+      _logCount = 1;
+      _logSequence = EEPROM.read(getLogBlockAddress(block));
+
+      for (uint8_t next = getLogBlock(1); _logCount < LOG_BLOCK_COUNT && isLogBlockValid(next) &&
+           EEPROM.read(getLogBlockAddress(next)) == getNextLogSequence(_logSequence); next = getLogBlock(_logCount))
+      {
+        _logSequence = getNextLogSequence(_logSequence);
+        _logCount++;
+      }
+
+      break;
+    }
+  }
+
+  for (uint8_t i = _logCount; i < LOG_BLOCK_COUNT; i++)
+  {
+    EEPROM.update(getLogBlockAddress(getLogBlock(i)), LOG_END);
+  }
+
+  // ***
+  // *** Times restart with the uptime, so the blocks from before
+  // *** are marked for the master and are not added to.
+  // ***
+  _logEarlier = _logCount;
+  _logOffset = 0;
+}
+
+void openLogBlock()
+{
+  // ***
+  // *** A full log drops its oldest block, which is erased before
+  // *** it is used again.
+  // ***
+  if (_logCount == LOG_BLOCK_COUNT)
+  {
+    EEPROM.update(getLogBlockAddress(_logTail), LOG_END);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      _logTail = getLogBlock(1);
+      _logCount--;
+      if (_logCursor > 0) _logCursor--;
+      if (_logAcked > 0) _logAcked--;
+      if (_logEarlier > 0) _logEarlier--;
+      if (_logDropped < UINT8_MAX) _logDropped++;
+      _logDrainReady = false;
+    }
+  }
+
+  uint16_t address = getLogBlockAddress(getLogBlock(_logCount));
+  _logSequence = getNextLogSequence(_logSequence);
+  EEPROM.update(address + 1, LOG_END);
+  EEPROM.update(address, _logSequence);
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    _logCount++;
+    _logHeadRead = false;
+  }
+
+  _logOffset = 1;
+  _logKeyed = 0;
+}
+
+bool appendLogRecord(const uint8_t* record, uint8_t length)
+{
+  if (_logOffset == 0 || _logHeadRead || _logOffset + length > LOG_BLOCK_SIZE)
+  {
+    return false;
+  }
+
+  uint16_t address = getLogBlockAddress(getLogBlock(_logCount - 1)) + _logOffset;
+
+  if (_logOffset + length < LOG_BLOCK_SIZE)
+  {
+    EEPROM.update(address + length, LOG_END);
+  }
+
+  for (uint8_t i = length - 1; i > 0; i--)
+  {
+    EEPROM.update(address + i, record[i]);
+  }
+
+  // ***
+  // *** The first byte replaces the old LOG_END and makes the
+  // *** record part of the block, unless the master read the
+  // *** block in the meantime.
+  // ***
+  bool returnValue = false;
+  eeprom_busy_wait();
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    if (!_logHeadRead)
+    {
+      EEPROM.update(address, record[0]);
+      _logDrainReady = false;
+      returnValue = true;
+    }
+  }
+
+  if (returnValue)
+  {
+    _logOffset += length;
+  }
+
+  return returnValue;
+}
+
+uint8_t putLogVarint(uint8_t* buffer, uint32_t value)
+{
+  uint8_t length = 0;
+
+  while (value >= 0x80)
+  {
+    buffer[length++] = (uint8_t)value | 0x80;
+    value >>= 7;
+  }
+
+  buffer[length++] = (uint8_t)value;
+  return length;
+}
+
+inline uint16_t getZigzag(int16_t value)
+{
+  return ((uint16_t)value << 1) ^ (uint16_t)(value >> 15);
+}
+
+void spillReading(uint8_t channel, uint32_t time, int16_t temperature, int16_t humidity)
+{
+  uint8_t record[LOG_RECORD_SIZE];
+  uint8_t length = 0;
+  uint32_t interval = time - _logTime[channel];
+
+  if (bitRead(_logKeyed, channel) && !_logHeadRead)
+  {
+    int16_t temperatureChange = temperature - _logTemperature[channel];
+    int16_t humidityChange = humidity - _logHumidity[channel];
+
+    if (channel == _logChannel && interval == _logInterval[channel] &&
+        temperatureChange >= -4 && temperatureChange <= 3 && humidityChange >= -8 && humidityChange <= 7)
+    {
+      record[length++] = (getZigzag(temperatureChange) << LOG_SHORT_TEMPERATURE_SHIFT) | getZigzag(humidityChange);
+    }
+    else
+    {
+      record[length++] = LOG_RECORD_DELTA | channel;
+      length += putLogVarint(&record[length], interval);
+      length += putLogVarint(&record[length], getZigzag(temperatureChange));
+      length += putLogVarint(&record[length], getZigzag(humidityChange));
+    }
+  }
+
+  if (length > 0 && appendLogRecord(record, length))
+  {
+    _logInterval[channel] = interval;
+  }
+  else
+  {
+    // ***
+    // *** A key record starts the channel in this block or,
+    // *** when it does not fit, in a new one.
+    // ***
+    length = 0;
+    record[length++] = LOG_RECORD_KEY | channel;
+    length += putLogVarint(&record[length], time);
+    length += putLogVarint(&record[length], getZigzag(temperature));
+    length += putLogVarint(&record[length], getZigzag(humidity));
+
+    if (!appendLogRecord(record, length))
+    {
+      openLogBlock();
+      appendLogRecord(record, length);
+    }
+
+    bitSet(_logKeyed, channel);
+    _logInterval[channel] = LOG_NO_INTERVAL;
+  }
+
+  _logChannel = channel;
+  _logTime[channel] = time;
+  _logTemperature[channel] = temperature;
+  _logHumidity[channel] = humidity;
+}
+
+void checkLogCommand()
+{
+  uint8_t command;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    command = _logCommand;
+    _logCommand = 0;
+  }
+
+  if (command == LOG_COMMAND_ACK || command == LOG_COMMAND_CLEAR)
+  {
+    uint8_t count = command == LOG_COMMAND_ACK ? _logAcked : _logCount;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+      EEPROM.update(getLogBlockAddress(getLogBlock(i)), LOG_END);
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      _logTail = getLogBlock(count);
+      _logCount -= count;
+      _logCursor = count < _logCursor ? _logCursor - count : 0;
+      _logEarlier = count < _logEarlier ? _logEarlier - count : 0;
+      _logAcked = 0;
+      _logDropped = 0;
+      _logDrainReady = false;
+    }
+
+    if (_logCount == 0)
+    {
+      _logOffset = 0;
+    }
+  }
+}
+
+void prepareLogDrain()
+{
+  // ***
+  // *** Copies the block the next drain reads, unless a drain
+  // *** is in progress or the copy is current. The cursor may
+  // *** move while the block is read, in which case the copy
+  // *** is made again on the next pass.
+  // ***
+  uint8_t cursor;
+  bool current;
+
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    cursor = _logCursor;
+    current = _logDrainValid || (_logDrainReady && _logDrainCursor == cursor);
+  }
+
+  if (!current && cursor < _logCount)
+  {
+    uint16_t address = getLogBlockAddress(getLogBlock(cursor)) + 1;
+
+    for (uint8_t i = 0; i < LOG_BLOCK_SIZE - 1; i++)
+    {
+      _logDrainBuffer[i] = EEPROM.read(address + i);
+    }
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+      if (!_logDrainValid && _logCursor == cursor)
+      {
+        _logDrainCursor = cursor;
+        _logDrainReady = true;
+      }
+    }
+  }
+}
+
+void startLogDrain()
+{
+  // ***
+  // *** The next block the master has not read. Reading the
+  // *** newest block closes it so the block does not change
+  // *** after the master has seen it.
+  // ***
+  bool ready = _logDrainReady && _logDrainCursor == _logCursor;
+
+  _logDrainIndex = 0;
+  _logDrainValid = ready && _logCursor < _logCount;
+  _logDrainBlock = getLogBlock(_logCursor);
+  _logDrainHeader = (ready || _logCursor >= _logCount) ? LOG_ENABLED : LOG_ENABLED | LOG_BLOCK_PENDING;
+  _logDrainLeft = 0;
+
+  if (_logDrainValid)
+  {
+    _logDrainHeader |= LOG_BLOCK_VALID | (_logCursor < _logEarlier ? LOG_EARLIER_BOOT : 0);
+    _logDrainLeft = _logCount - _logCursor - 1;
+
+    if (_logDrainLeft == 0)
+    {
+      _logHeadRead = true;
+    }
+  }
+}
+
+uint8_t drainLogByte()
+{
+  uint8_t returnValue = LOG_END;
+  uint8_t index = _logDrainIndex++;
+
+  switch (index)
+  {
+    case 0:
+      returnValue = _logDrainHeader;
+      break;
+    case 1:
+      returnValue = _logDrainLeft;
+      break;
+    case 2:
+      returnValue = _logDropped;
+      break;
+    default:
+      if (_logDrainValid && index < LOG_DRAIN_SIZE)
+      {
+        returnValue = _logDrainBuffer[index - LOG_HEADER_SIZE];
+      }
+      break;
+  }
+
+  return returnValue;
+}
+
+void endLogDrain()
+{
+  // ***
+  // *** The block counts as read unless it was dropped while
+  // *** the master was reading it.
+  // ***
+  if (_logDrainValid && _logDrainBlock == getLogBlock(_logCursor))
+  {
+    _logCursor++;
+  }
+
+  _logDrainValid = false;
+}
+#endif
+
+bool handleLogWrite(uint8_t registerPosition, uint8_t value)
+{
+  bool returnValue = false;
+
+  if (registerPosition == REGISTER_LOG_CONTROL)
+  {
+#if defined(DHT_SPILL_LOG)
+    // ***
+    // *** An ack erases the blocks read before it; the loop
+    // *** does the writes.
+    // ***
+    if (value == LOG_COMMAND_REWIND)
+    {
+      _logCursor = 0;
+    }
+    else
+    {
+      if (value == LOG_COMMAND_ACK)
+      {
+        _logAcked = _logCursor;
+      }
+
+      _logCommand = value;
+    }
+#endif
+    returnValue = true;
+  }
+
+  return returnValue;
+}
+
+uint8_t getLogBlockCount()
+{
+#if defined(DHT_SPILL_LOG)
+  return _logCount;
+#else
+  return 0;
+#endif
+}
+
+void noteReadingFetched()
+{
+#if defined(DHT_SPILL_LOG)
+  _readingFetched[_channel] = true;
+#endif
+}
+
+void spillMissedReading()
+{
+#if defined(DHT_SPILL_LOG)
+  // ***
+  // *** Called before a new reading replaces the one in the
+  // *** registers.
+  // ***
+  uint8_t decimation = _registers[REGISTER_LOG_DECIMATION];
+
+  if (!_readingFetched[_channel] && decimation > 0 && readUint32(REGISTER_READING_ID) > 0 &&
+      ++_logSkipped[_channel] >= decimation)
+  {
+    _logSkipped[_channel] = 0;
+    spillReading(_channel, readUint32(REGISTER_READING_TIME) / 1000,
+                 round(readFloat(REGISTER_TEMPERATURE) * 10), round(readFloat(REGISTER_HUMIDITY) * 10));
+  }
+
+  _readingFetched[_channel] = false;
+#endif
+}
+#endif
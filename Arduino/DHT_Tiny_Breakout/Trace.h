@@ -0,0 +1,279 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+#include <util/atomic.h>
+#include "Registers.h"
+#include "Features.h"
+
+// ***
+// *** A trace build (DHT_TRACE defined) records an event ID and
+// *** a 16 bit time stamp at each trace point on the hot paths
+// *** into a small ring in RAM. The master drains the ring by
+// *** reading REGISTER_TRACE, which returns a header followed by
+// *** the oldest entries:
+// ***
+// *** byte 0:   TRACE_ENABLED | the number of entries that follow
+// *** byte 1:   events dropped because the ring was full
+// *** byte 2-3: the time stamp when the read started (uint16)
+// *** then 3 bytes per entry: the event ID and its time stamp
+// ***
+// *** Entries stay in the ring until the master writes
+// *** TRACE_COMMAND_ACK to REGISTER_TRACE, which removes the ones
+// *** the last drain sent. A drain the master did not receive is
+// *** read again and returns the same entries. Without DHT_TRACE
+// *** the trace points compile to nothing and the register reads
+// *** as 0.
+// ***
+// *** Nothing acks on the master's behalf. A master that gives
+// *** up on the breakout, for example after a transfer stretched
+// *** past its timeout while the clock came up (see Clock.h),
+// *** leaves the ring full: it stalls, and new events only add
+// *** to the dropped count until a master drains and acks again.
+// ***
+// *** The time stamp is micros() in TRACE_TICK_US ticks and
+// *** wraps about every second. The loop records a keepalive
+// *** at least every half wrap so consecutive entries are never
+// *** more than one wrap apart and the master can unwrap them
+// *** from the time stamp in the header.
+// ***
+#define TRACE_EVENT_LOOP          1
+#define TRACE_EVENT_READ_START    2
+#define TRACE_EVENT_READ_OK       3
+#define TRACE_EVENT_READ_ERROR    4
+#define TRACE_EVENT_RECEIVE       5
+#define TRACE_EVENT_REQUEST       6
+#define TRACE_EVENT_SAVE_START    7
+#define TRACE_EVENT_SAVE_END      8
+
+// ***
+// *** Sensor events carry the channel in the upper bits.
+// ***
+#define TRACE_EVENT_MASK          0x1F
+#define TRACE_CHANNEL_SHIFT       5
+
+#define TRACE_ENABLED             0x80
+#define TRACE_TICK_SHIFT          4
+#define TRACE_TICK_US             (1 << TRACE_TICK_SHIFT)
+#define TRACE_KEEPALIVE           0x8000
+
+#define TRACE_COMMAND_ACK         1
+
+// ***
+// *** A drain fits in the 32 byte buffer of the Wire library.
+// ***
+#define TRACE_HEADER_SIZE         4
+#define TRACE_ENTRY_SIZE          3
+#define TRACE_DRAIN_ENTRIES       8
+#define TRACE_DRAIN_SIZE          ((TRACE_HEADER_SIZE) + (TRACE_DRAIN_ENTRIES) * (TRACE_ENTRY_SIZE))
+
+#if defined(DHT_TRACE)
+
+#if defined( __AVR_ATtiny85__ )
+#define TRACE_SIZE                16
+#else
+#define TRACE_SIZE                64
+#endif
+
+static_assert((TRACE_SIZE & (TRACE_SIZE - 1)) == 0, "The trace ring size must be a power of two");
+
+#define TRACE(event)              trace(event)
+#define TRACE_CHANNEL(event)      trace((event) | (_channel << TRACE_CHANNEL_SHIFT))
+#define TRACE_LOOP()              traceLoop()
+#define TRACE_BUS(event, r)       do { if ((r) != REGISTER_TRACE) trace(event); } while (0)
+
+// ***
+// *** The ring. _traceHead is the oldest entry. Events are
+// *** recorded from the I2C handlers too, so the ring is only
+// *** changed with interrupts disabled.
+// ***
+uint8_t _traceEvent[TRACE_SIZE];
+uint16_t _traceTime[TRACE_SIZE];
+volatile uint8_t _traceHead = 0;
+volatile uint8_t _traceCount = 0;
+volatile uint8_t _traceDropped = 0;
+uint8_t _traceLastEvent = 0;
+uint16_t _traceLastTime = 0;
+
+// ***
+// *** The drain in progress: the entries and drops it reports,
+// *** its time stamp, the next byte to send and the number of
+// *** entries sent so far.
+// ***
+volatile uint8_t _traceDrainCount = 0;
+volatile uint8_t _traceDrainDropped = 0;
+volatile uint16_t _traceDrainTime = 0;
+volatile uint8_t _traceDrainIndex = 0;
+volatile uint8_t _traceDrainSent = 0;
+
+inline uint16_t getTraceTime()
+{
+  return (uint16_t)(micros() >> TRACE_TICK_SHIFT);
+}
+
+void trace(uint8_t event)
+{
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    uint16_t time = getTraceTime();
+
+    // ***
+    // *** A full ring keeps the oldest entries so the ones
+    // *** being drained do not move.
+    // ***
+    if (_traceCount < TRACE_SIZE)
+    {
+      uint8_t slot = (_traceHead + _traceCount) & (TRACE_SIZE - 1);
+      _traceEvent[slot] = event;
+      _traceTime[slot] = time;
+      _traceCount++;
+    }
+    else if (_traceDropped < UINT8_MAX)
+    {
+      _traceDropped++;
+    }
+
+    _traceLastEvent = event;
+    _traceLastTime = time;
+  }
+}
+
+void traceLoop()
+{
+  // ***
+  // *** Only the first pass of the loop after another event is
+  // *** recorded, and a keepalive when nothing else was.
+  // ***
+  if (_traceLastEvent != TRACE_EVENT_LOOP || (uint16_t)(getTraceTime() - _traceLastTime) >= TRACE_KEEPALIVE)
+  {
+    trace(TRACE_EVENT_LOOP);
+  }
+}
+
+void ackTraceDrain()
+{
+  // ***
+  // *** Remove the entries the last drain sent and the drops
+  // *** it reported.
+  // ***
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    _traceHead = (_traceHead + _traceDrainSent) & (TRACE_SIZE - 1);
+    _traceCount -= _traceDrainSent;
+    _traceDropped -= _traceDrainDropped;
+    _traceDrainCount = 0;
+    _traceDrainDropped = 0;
+    _traceDrainSent = 0;
+  }
+}
+
+void startTraceDrain()
+{
+  // ***
+  // *** Every drain starts at the oldest entry, so one that
+  // *** was not acked is sent again.
+  // ***
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+  {
+    _traceDrainCount = min(_traceCount, TRACE_DRAIN_ENTRIES);
+    _traceDrainDropped = 0;
+    _traceDrainTime = getTraceTime();
+    _traceDrainIndex = 0;
+    _traceDrainSent = 0;
+  }
+}
+
+uint8_t drainTraceByte()
+{
+  uint8_t returnValue = 0;
+  uint8_t index = _traceDrainIndex++;
+
+  if (index < TRACE_HEADER_SIZE)
+  {
+    switch (index)
+    {
+      case 0:
+        returnValue = TRACE_ENABLED | _traceDrainCount;
+        break;
+      case 1:
+        _traceDrainDropped = _traceDropped;
+        returnValue = _traceDrainDropped;
+        break;
+      case 2:
+        returnValue = (uint8_t)_traceDrainTime;
+        break;
+      case 3:
+        returnValue = (uint8_t)(_traceDrainTime >> 8);
+        break;
+    }
+  }
+  else
+  {
+    uint8_t entry = (index - TRACE_HEADER_SIZE) / TRACE_ENTRY_SIZE;
+    uint8_t offset = (index - TRACE_HEADER_SIZE) % TRACE_ENTRY_SIZE;
+
+    if (entry < _traceDrainCount)
+    {
+      uint8_t slot = (_traceHead + entry) & (TRACE_SIZE - 1);
+
+      switch (offset)
+      {
+        case 0:
+          returnValue = _traceEvent[slot];
+          break;
+        case 1:
+          returnValue = (uint8_t)_traceTime[slot];
+          break;
+        case 2:
+          returnValue = (uint8_t)(_traceTime[slot] >> 8);
+          _traceDrainSent = entry + 1;
+          break;
+      }
+    }
+  }
+
+  return returnValue;
+}
+#else
+#define TRACE(event)
+#define TRACE_CHANNEL(event)
+#define TRACE_LOOP()
+#define TRACE_BUS(event, r)
+#endif
+
+bool handleTraceWrite(uint8_t registerPosition, uint8_t value)
+{
+  bool returnValue = false;
+
+  if (registerPosition == REGISTER_TRACE)
+  {
+#if defined(DHT_TRACE)
+    if (value == TRACE_COMMAND_ACK)
+    {
+      ackTraceDrain();
+    }
+#endif
+    returnValue = true;
+  }
+
+  return returnValue;
+}
+#endif
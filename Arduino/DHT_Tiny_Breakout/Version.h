@@ -23,7 +23,7 @@
 // *** Version
 // ***
 #define VERSION_MAJOR   1
-#define VERSION_MINOR   1
-#define VERSION_BUILD   1
+#define VERSION_MINOR   2
+#define VERSION_BUILD   0
 
 #endif
@@ -55,8 +55,8 @@ int8_t dht::read11(uint8_t pin)
     bits[2] &= 0x7F;
 
     // CONVERT AND STORE
-    humidity    = bits[0];  // bits[1] == 0;
-    temperature = bits[2];  // bits[3] == 0;
+    humidity    = bits[0] * 10;  // bits[1] == 0;
+    temperature = bits[2] * 10;  // bits[3] == 0;
 
     // TEST CHECKSUM
     // bits[1] && bits[3] both 0
@@ -78,8 +78,8 @@ int8_t dht::read(uint8_t pin)
     bits[2] &= 0x83;
 
     // CONVERT AND STORE
-    humidity = (bits[0]*256 + bits[1]) * 0.1;
-    temperature = ((bits[2] & 0x7F)*256 + bits[3]) * 0.1;
+    humidity = bits[0]*256 + bits[1];
+    temperature = (bits[2] & 0x7F)*256 + bits[3];
     if (bits[2] & 0x80)  // negative temperature
     {
         temperature = -temperature;
@@ -102,16 +102,16 @@ int8_t dht::read(uint8_t pin)
 int8_t dht::_readSensor(uint8_t pin, uint8_t wakeupDelay, uint8_t leadingZeroBits)
 {
     // INIT BUFFERVAR TO RECEIVE DATA
-    uint8_t mask = 128;
-    uint8_t idx = 0;
+    DhtBits frame;
+    beginDhtBits(frame, leadingZeroBits, DHT_BITS_DIVISOR);
 
-    uint8_t data = 0;
-    uint8_t state = LOW;
-    uint8_t pstate = LOW;
-    uint16_t zeroLoop = DHTLIB_TIMEOUT;
-    uint16_t delta = 0;
+    uint16_t timeout = _timeout;
 
-    leadingZeroBits = 40 - leadingZeroBits; // reverse counting...
+    // CLEAR THE CAPTURE SO A FAILED READ DOES NOT SHOW STALE DATA
+    if (Features::capture && _capture != NULL)
+    {
+        memset(_capture, 0, DHTLIB_CAPTURE_SIZE);
+    }
 
     // replace digitalRead() with Direct Port Reads.
     // reduces footprint ~100 bytes => portability issue?
@@ -123,11 +123,11 @@ int8_t dht::_readSensor(uint8_t pin, uint8_t wakeupDelay, uint8_t leadingZeroBit
     // REQUEST SAMPLE
     pinMode(pin, OUTPUT);
     digitalWrite(pin, LOW); // T-be
-    delayMicroseconds(wakeupDelay * 1000UL);
+    delayMicroseconds((wakeupDelay * 1000UL) >> _clockShift);
     digitalWrite(pin, HIGH); // T-go
     pinMode(pin, INPUT);
 
-    uint16_t loopCount = DHTLIB_TIMEOUT * 2;  // 200uSec max
+    uint16_t loopCount = timeout * 2;  // 200uSec max
     // while(digitalRead(pin) == HIGH)
     while ((*PIR & bit) != LOW )
     {
@@ -135,60 +135,69 @@ int8_t dht::_readSensor(uint8_t pin, uint8_t wakeupDelay, uint8_t leadingZeroBit
     }
 
     // GET ACKNOWLEDGE or TIMEOUT
-    loopCount = DHTLIB_TIMEOUT;
+    loopCount = timeout;
     // while(digitalRead(pin) == LOW)
     while ((*PIR & bit) == LOW )  // T-rel
     {
         if (--loopCount == 0) return DHTLIB_ERROR_ACK_L;
     }
 
-    loopCount = DHTLIB_TIMEOUT;
+    loopCount = timeout;
     // while(digitalRead(pin) == HIGH)
     while ((*PIR & bit) != LOW )  // T-reh
     {
         if (--loopCount == 0) return DHTLIB_ERROR_ACK_H;
     }
 
-    loopCount = DHTLIB_TIMEOUT;
-
     // READ THE OUTPUT - 40 BITS => 5 BYTES
-    for (uint8_t i = 40; i != 0; )
+    // each bit is a low phase of fixed length followed by a high
+    // phase whose width in loops decides the bit (DhtBits.h).
+    uint8_t state = LOW;
+    uint8_t pstate = LOW;
+    uint16_t riseLoop = timeout;
+    loopCount = timeout;
+    for (uint8_t i = 0; i < DHT_BITS_COUNT; )
     {
-        // WAIT FOR FALLING EDGE
         state = (*PIR & bit);
-        if (state == LOW && pstate != LOW)
+        if (state != LOW && pstate == LOW)  // RISING EDGE
         {
-            if (i > leadingZeroBits) // DHT22 first 6 bits are all zero !!   DHT11 only 1
-            {
-                zeroLoop = min(zeroLoop, loopCount);
-                delta = (DHTLIB_TIMEOUT - zeroLoop)/4;
-            }
-            else if ( loopCount <= (zeroLoop - delta) ) // long -> one
-            {
-                data |= mask;
-            }
-            mask >>= 1;
-            if (mask == 0)   // next byte
+            riseLoop = loopCount;
+        }
+        else if (state == LOW && pstate != LOW)  // FALLING EDGE
+        {
+            uint16_t width = riseLoop - loopCount;
+            if (Features::capture && _capture != NULL)
             {
-                mask = 128;
-                bits[idx] = data;
-                idx++;
-                data = 0;
+                _capture[DHTLIB_CAPTURE_FRAME_SIZE + i] = width >> DHTLIB_CAPTURE_SHIFT;
             }
+            addDhtBit(frame, width);
+
             // next bit
-            --i;
+            ++i;
 
             // reset timeout flag
-            loopCount = DHTLIB_TIMEOUT;
+            loopCount = timeout;
         }
         pstate = state;
         // Check timeout
         if (--loopCount == 0)
         {
-            return DHTLIB_ERROR_TIMEOUT;
+            break;
         }
+    }
 
+    // KEEP WHAT WAS DECODED, ALSO ON A TIMEOUT
+    memcpy(bits, frame.frame, sizeof(bits));
+    if (Features::capture && _capture != NULL)
+    {
+        memcpy(_capture, bits, DHTLIB_CAPTURE_FRAME_SIZE);
     }
+
+    if (loopCount == 0)
+    {
+        return DHTLIB_ERROR_TIMEOUT;
+    }
+
     pinMode(pin, OUTPUT);
     digitalWrite(pin, HIGH);
 
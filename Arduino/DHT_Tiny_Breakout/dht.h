@@ -19,6 +19,9 @@
 #include <Arduino.h>
 #endif
 
+#include "Features.h"
+#include "DhtBits.h"
+
 #define DHT_LIB_VERSION "0.1.21"
 
 #define DHTLIB_OK                   0
@@ -45,10 +48,24 @@
 #define DHTLIB_TIMEOUT (F_CPU/40000)
 #endif
 
+// captured pulse widths are stored in one byte each,
+// shifted right so that DHTLIB_TIMEOUT still fits.
+#if DHTLIB_TIMEOUT > 510
+#define DHTLIB_CAPTURE_SHIFT 2
+#elif DHTLIB_TIMEOUT > 255
+#define DHTLIB_CAPTURE_SHIFT 1
+#else
+#define DHTLIB_CAPTURE_SHIFT 0
+#endif
+
+#define DHTLIB_CAPTURE_FRAME_SIZE   5
+#define DHTLIB_CAPTURE_PULSE_COUNT  40
+#define DHTLIB_CAPTURE_SIZE         (DHTLIB_CAPTURE_FRAME_SIZE + DHTLIB_CAPTURE_PULSE_COUNT)
+
 class dht
 {
 public:
-    dht() {};
+    dht() : _capture(NULL), _timeout(DHTLIB_TIMEOUT), _clockShift(0) {};
     // return values:
     // DHTLIB_OK
     // DHTLIB_ERROR_CHECKSUM
@@ -64,13 +81,68 @@ public:
     inline int8_t read33(uint8_t pin) { return read(pin); };
     inline int8_t read44(uint8_t pin) { return read(pin); };
 
-    double humidity;
-    double temperature;
+    // same as read11() and read() but the timing, masks and
+    // scaling come from a traits type known at compile time
+    // so a build for a single model folds them into constants.
+    template <class TTraits> int8_t readModel(uint8_t pin);
+
+    // when set, each read stores the raw 5 byte frame followed
+    // by the loop count of the high phase of every bit, the width
+    // the bit was decided on (DHTLIB_CAPTURE_SIZE bytes).
+    // pass NULL to stop capturing. a build without the capture
+    // feature (Features.h) never captures.
+    inline void setCapture(uint8_t* capture) { _capture = capture; };
+
+    // the CPU clock is F_CPU >> shift for the next read. the
+    // loop count timeout and the wakeup delay, which are in
+    // cycles, are scaled to match.
+    inline void setClockShift(uint8_t shift) { _clockShift = shift; _timeout = DHTLIB_TIMEOUT >> shift; };
+    inline uint16_t getTimeout() { return _timeout; };
+
+    // in tenths of a percent and tenths of a degree, read
+    // straight from the frame without going through a double.
+    int16_t humidity;
+    int16_t temperature;
 
 private:
     uint8_t bits[5];  // buffer to receive data
+    uint8_t* _capture; // optional raw frame and pulse capture
+    uint16_t _timeout; // DHTLIB_TIMEOUT at the active clock
+    uint8_t _clockShift;
     int8_t _readSensor(uint8_t pin, uint8_t wakeupDelay, uint8_t leadingZeroBits);
 };
+
+template <class TTraits> int8_t dht::readModel(uint8_t pin)
+{
+    // READ VALUES
+    int8_t result = _readSensor(pin, TTraits::wakeupDelay, TTraits::leadingZeroBits);
+
+    // these bits are always zero, masking them reduces errors.
+    bool valid = checkDhtFrame(bits, TTraits::humidityMask, TTraits::temperatureMask, TTraits::highResolution);
+
+    // CONVERT AND STORE
+    if (TTraits::highResolution)
+    {
+        humidity = bits[0]*256 + bits[1];
+        temperature = (bits[2] & 0x7F)*256 + bits[3];
+        if (bits[2] & 0x80)  // negative temperature
+        {
+            temperature = -temperature;
+        }
+    }
+    else
+    {
+        humidity    = bits[0] * 10;  // bits[1] == 0;
+        temperature = bits[2] * 10;  // bits[3] == 0;
+    }
+
+    // TEST CHECKSUM
+    if (!valid)
+    {
+        return DHTLIB_ERROR_CHECKSUM;
+    }
+    return result;
+}
 #endif
 //
 // END OF FILE
@@ -52,18 +52,88 @@ uint8_t _deviceAddress = 0;
 #define REGISTER_HUMIDITY           REGISTER_TEMPERATURE      + SIZE_FLOAT     // *** float
 #define REGISTER_STATUS             REGISTER_HUMIDITY         + SIZE_FLOAT     // *** uint8
 #define REGISTER_READING_ID         REGISTER_STATUS           + SIZE_UINT8     // *** uint32
-#define REGISTER_INTERVAL           REGISTER_READING_ID       + SIZE_UINT32    // *** uint32
+#define REGISTER_READING_TIME       REGISTER_READING_ID       + SIZE_UINT32    // *** uint32
+#define REGISTER_READING_AGE        REGISTER_READING_TIME     + SIZE_UINT32    // *** uint32
+#define REGISTER_INTERVAL           REGISTER_READING_AGE      + SIZE_UINT32    // *** uint32
 #define REGISTER_UPPER_THRESHOLD    REGISTER_INTERVAL         + SIZE_UINT32    // *** float
 #define REGISTER_LOWER_THRESHOLD    REGISTER_UPPER_THRESHOLD  + SIZE_FLOAT     // *** float
 #define REGISTER_START_DELAY        REGISTER_LOWER_THRESHOLD  + SIZE_FLOAT     // *** uint32
 #define REGISTER_CONFIG             REGISTER_START_DELAY      + SIZE_UINT32    // *** uint8
 #define REGISTER_DEVICE_ADDRESS     REGISTER_CONFIG           + SIZE_UINT8     // *** uint8
 #define REGISTER_DHT_MODEL          REGISTER_DEVICE_ADDRESS   + SIZE_UINT8     // *** uint8
+#define REGISTER_MIN_INTERVAL       REGISTER_DHT_MODEL        + SIZE_UINT8     // *** uint32
+#define REGISTER_SLOPE_THRESHOLD    REGISTER_MIN_INTERVAL     + SIZE_UINT32    // *** float
+#define REGISTER_CURRENT_INTERVAL   REGISTER_SLOPE_THRESHOLD  + SIZE_FLOAT     // *** uint32
+#define REGISTER_AGGREGATE_WINDOW   REGISTER_CURRENT_INTERVAL + SIZE_UINT32    // *** uint32
+#define REGISTER_AGGREGATE_COUNT    REGISTER_AGGREGATE_WINDOW + SIZE_UINT32    // *** uint16
+#define REGISTER_TEMPERATURE_MIN    REGISTER_AGGREGATE_COUNT  + SIZE_UINT16    // *** int16
+#define REGISTER_TEMPERATURE_MAX    REGISTER_TEMPERATURE_MIN  + SIZE_INT16     // *** int16
+#define REGISTER_TEMPERATURE_MEAN   REGISTER_TEMPERATURE_MAX  + SIZE_INT16     // *** int16
+#define REGISTER_HUMIDITY_MIN       REGISTER_TEMPERATURE_MEAN + SIZE_INT16     // *** int16
+#define REGISTER_HUMIDITY_MAX       REGISTER_HUMIDITY_MIN     + SIZE_INT16     // *** int16
+#define REGISTER_HUMIDITY_MEAN      REGISTER_HUMIDITY_MAX     + SIZE_INT16     // *** int16
+#define REGISTER_CAPTURE_RESULT     REGISTER_HUMIDITY_MEAN    + SIZE_INT16     // *** int8
+#define REGISTER_CAPTURE_TIMEOUT    REGISTER_CAPTURE_RESULT   + SIZE_INT8      // *** uint16
+#define REGISTER_CAPTURE_SHIFT      REGISTER_CAPTURE_TIMEOUT  + SIZE_UINT16    // *** uint8
+#define REGISTER_CAPTURE_FRAME      REGISTER_CAPTURE_SHIFT    + SIZE_UINT8     // *** uint8[5]
+#define REGISTER_CAPTURE_PULSES     REGISTER_CAPTURE_FRAME    + 5              // *** uint8[40]
+#define REGISTER_SERIAL             REGISTER_CAPTURE_PULSES   + 40             // *** uint32
+#define REGISTER_ENUM_CONTROL       REGISTER_SERIAL           + SIZE_UINT32    // *** uint8
+#define REGISTER_ENUM_SELECT        REGISTER_ENUM_CONTROL     + SIZE_UINT8     // *** uint8[5]
+#define REGISTER_ENUM_ASSIGN        REGISTER_ENUM_SELECT      + 5              // *** uint8
+#define REGISTER_FILTER_MODE        REGISTER_ENUM_ASSIGN      + SIZE_UINT8     // *** uint8
+#define REGISTER_TEMPERATURE_SLEW   REGISTER_FILTER_MODE      + SIZE_UINT8     // *** uint16
+#define REGISTER_HUMIDITY_SLEW      REGISTER_TEMPERATURE_SLEW + SIZE_UINT16    // *** uint16
+#define REGISTER_FILTER_REJECTS     REGISTER_HUMIDITY_SLEW    + SIZE_UINT16    // *** uint16
+#define REGISTER_TEMPERATURE_OFFSET REGISTER_FILTER_REJECTS   + SIZE_UINT16    // *** int16
+#define REGISTER_TEMPERATURE_GAIN   REGISTER_TEMPERATURE_OFFSET + SIZE_INT16   // *** uint16
+#define REGISTER_HUMIDITY_OFFSET    REGISTER_TEMPERATURE_GAIN + SIZE_UINT16    // *** int16
+#define REGISTER_HUMIDITY_GAIN      REGISTER_HUMIDITY_OFFSET  + SIZE_INT16     // *** uint16
+#define REGISTER_DEW_POINT          REGISTER_HUMIDITY_GAIN    + SIZE_UINT16    // *** int16
+#define REGISTER_ABSOLUTE_HUMIDITY  REGISTER_DEW_POINT        + SIZE_INT16     // *** uint16
+#define REGISTER_HEAT_INDEX         REGISTER_ABSOLUTE_HUMIDITY + SIZE_UINT16   // *** int16
+#define REGISTER_CHANNEL            REGISTER_HEAT_INDEX       + SIZE_INT16     // *** uint8
+#define REGISTER_CHANNEL_COUNT      REGISTER_CHANNEL          + SIZE_UINT8     // *** uint8
+#define REGISTER_TRACE              REGISTER_CHANNEL_COUNT    + SIZE_UINT8     // *** uint8
+#define REGISTER_CLOCK_IDLE_SHIFT   REGISTER_TRACE            + SIZE_UINT8     // *** uint8
+#define REGISTER_CLOCK_FULL_TIME    REGISTER_CLOCK_IDLE_SHIFT + SIZE_UINT8     // *** uint32
+#define REGISTER_CLOCK_IDLE_TIME    REGISTER_CLOCK_FULL_TIME  + SIZE_UINT32    // *** uint32
+#define REGISTER_LOG_DECIMATION     REGISTER_CLOCK_IDLE_TIME  + SIZE_UINT32    // *** uint8
+#define REGISTER_LOG_CONTROL        REGISTER_LOG_DECIMATION   + SIZE_UINT8     // *** uint8
+#define REGISTER_LOG_DATA           REGISTER_LOG_CONTROL      + SIZE_UINT8     // *** uint8
+#define REGISTER_AGGREGATE_CONTROL  REGISTER_LOG_DATA         + SIZE_UINT8     // *** uint8
 
 // ***
 // *** Total size of the registers in bytes.
 // ***
-#define REGISTER_TOTAL_SIZE         REGISTER_DHT_MODEL        + SIZE_UINT8
+#define REGISTER_TOTAL_SIZE         REGISTER_AGGREGATE_CONTROL + SIZE_UINT8
+
+// ***
+// *** The reading age until the breakout takes its first reading.
+// ***
+#define READING_AGE_NONE            0xFFFFFFFF
+
+// ***
+// *** Size of the aggregate block (count through humidity mean)
+// *** and the offset of a register within it.
+// ***
+#define AGGREGATE_OFFSET(r)         ((r) - (REGISTER_AGGREGATE_COUNT))
+#define AGGREGATE_BLOCK_SIZE        AGGREGATE_OFFSET(REGISTER_HUMIDITY_MEAN + SIZE_INT16)
+#define AGGREGATE_COMMAND_ACK       1
+
+// ***
+// *** Size of the derived block (dew point through heat index)
+// *** and the offset of a register within it.
+// ***
+#define DERIVED_OFFSET(r)           ((r) - (REGISTER_DEW_POINT))
+#define DERIVED_BLOCK_SIZE          DERIVED_OFFSET(REGISTER_HEAT_INDEX + SIZE_INT16)
+
+// ***
+// *** Size of the clock block (idle shift through idle time)
+// *** and the offset of a register within it.
+// ***
+#define CLOCK_OFFSET(r)             ((r) - (REGISTER_CLOCK_IDLE_SHIFT))
+#define CLOCK_BLOCK_SIZE            CLOCK_OFFSET(REGISTER_CLOCK_IDLE_TIME + SIZE_UINT32)
 
 // ***
 // *** Configuration bits.
@@ -71,9 +141,9 @@ uint8_t _deviceAddress = 0;
 #define CONFIG_BIT_SENSOR_ENABLED           0
 #define CONFIG_BIT_THRESHOLD_ENABLED        1
 #define CONFIG_BIT_TRIGGER_READING          2
-#define CONFIG_BIT_RESERVED_1               3
-#define CONFIG_BIT_RESERVED_2               4
-#define CONFIG_BIT_RESERVED_3               5
+#define CONFIG_BIT_ADAPTIVE_INTERVAL        3
+#define CONFIG_BIT_CAPTURE                  4
+#define CONFIG_BIT_PEC_ENABLED              5
 #define CONFIG_BIT_WRITE_CONFIG             6
 #define CONFIG_BIT_RESET_CONFIG             7
 
@@ -84,23 +154,134 @@ uint8_t _deviceAddress = 0;
 #define STATUS_UPPER_THRESHOLD_EXCEEDED     1
 #define STATUS_LOWER_THRESHOLD_EXCEEDED     2
 #define STATUS_DHT_READING_ERROR            3
-#define STATUS_RESERVED_2                   4
+#define STATUS_PEC_ERROR                    4
 #define STATUS_CONFIG_SAVED                 5
 #define STATUS_READ_ERROR                   6
 #define STATUS_WRITE_ERROR                  7
 
 // ***
-// *** The amount of delay to use after a write
-// *** operation to allow the device time to respond.
+// *** The first byte of a PEC read, which is followed by the
+// *** register and the byte count. No register has it.
+// ***
+#define PEC_READ_COMMAND                    0xFE
+
+// ***
+// *** Filter mode bits. Readings pass through the median of
+// *** the last three samples and/or a gate that rejects a change
+// *** faster than the slew limit (tenths per second) before they
+// *** are committed.
 // ***
-#define DEVICE_DELAY 50
+#define FILTER_BIT_MEDIAN                   0
+#define FILTER_BIT_SLEW                     1
+
+// ***
+// *** Calibration. A reading in tenths is corrected to
+// *** (value * gain / CALIBRATION_GAIN_ONE) + offset, so a gain
+// *** of CALIBRATION_GAIN_ONE and an offset of 0 leave it as is.
+// ***
+#define CALIBRATION_GAIN_ONE                4096
+#define CALIBRATION_GAIN_SHIFT              12
+
+// ***
+// *** Writes to the DHT Tiny are queued and run one at a
+// *** time from loop(). Instead of sleeping a fixed amount
+// *** of time after each write, the next transaction waits
+// *** until the device reports that it is ready for it.
+// ***
+#define QUEUE_SIZE                  16
+#define READY_POLL_INTERVAL         10
+#define READY_TIMEOUT             5000
+
+// ***
+// *** Transaction operations.
+// ***
+#define OPERATION_WRITE              0
+#define OPERATION_CALL               1
+#define OPERATION_RESET_PIN          2
+
+// ***
+// *** What the queue waits for after a transaction
+// *** has run and before the next one can start.
+// ***
+#define READY_NONE                   0   // *** Nothing, run the next transaction right away.
+#define READY_CONFIG                 1   // *** The device has acted on the configuration register.
+#define READY_BOOT                   2   // *** The device answers with its ID after a reset.
+#define READY_TIME                   3   // *** A fixed number of milliseconds have elapsed.
+
+// ***
+// *** The value of the ID register on a DHT Tiny.
+// ***
+#define DHT_TINY_ID               0x2d
 
 // ***
 // *** The amount of time, in milliseconds, to
-// *** delay after each loop iteration.
+// *** wait for the device after power up and
+// *** after pulsing the reset pin LOW.
+// ***
+#define DEVICE_START_TIMEOUT      2000
+#define RESET_PULSE_WIDTH          350
+
+// ***
+// *** A single queued transaction. Writes carry their
+// *** data; calls run a function in order with the
+// *** writes around them.
+// ***
+struct Transaction
+{
+  uint8_t operation;
+  uint8_t registerId;
+  uint8_t byteCount;
+  uint8_t data[SIZE_UINT32];
+  uint8_t ready;
+  uint16_t time;
+  void (*function)();
+};
+
+// ***
+// *** The transaction queue (a ring buffer) and
+// *** the readiness condition currently being waited on.
+// ***
+Transaction _queue[QUEUE_SIZE];
+uint8_t _queueHead = 0;
+uint8_t _queueCount = 0;
+uint8_t _waitReady = READY_NONE;
+uint16_t _waitTime = 0;
+uint32_t _waitStarted = 0;
+uint32_t _lastPoll = 0;
+
+// ***
+// *** Tracks the interrupt pin. When the pin supports an
+// *** external interrupt the ISR flags a change; otherwise
+// *** the pin is sampled on every pass through loop().
+// ***
+volatile bool _interruptPending = false;
+bool _interruptAttached = false;
+uint8_t _lastPinValue = HIGH;
+
+// ***
+// *** The amount of time, in milliseconds, between
+// *** each step of the test cycle.
 // ***
 uint32_t _myInterval = 2000;
 
+// ***
+// *** The time the last test step completed and
+// *** whether the test cycle has been paused
+// *** from the serial console.
+// ***
+uint32_t _lastStep = 0;
+bool _paused = false;
+
+// ***
+// *** SMBus packet error code (CRC-8, polynomial 0x07) computed
+// *** a nibble at a time. Every transfer carries one while the
+// *** device has CONFIG_BIT_PEC_ENABLED set.
+// ***
+const uint8_t _pecTable[16] PROGMEM = { 0x00, 0x07, 0x0E, 0x09, 0x1C, 0x1B, 0x12, 0x15,
+                                        0x38, 0x3F, 0x36, 0x31, 0x24, 0x23, 0x2A, 0x2D };
+bool _pecEnabled = false;
+uint32_t _pecErrors = 0;
+
 void setup()
 {
   // ***
@@ -118,6 +299,13 @@ void setup()
   // *** Initialize the interrupt pin.
   // ***
   pinMode(DHT_INTERRUPT_PIN, INPUT_PULLUP);
+  _lastPinValue = digitalRead(DHT_INTERRUPT_PIN);
+
+  if (digitalPinToInterrupt(DHT_INTERRUPT_PIN) != NOT_AN_INTERRUPT)
+  {
+    attachInterrupt(digitalPinToInterrupt(DHT_INTERRUPT_PIN), onInterruptPin, CHANGE);
+    _interruptAttached = true;
+  }
 
   // ***
   // *** Initialize the I2C.
@@ -126,18 +314,20 @@ void setup()
   Wire.setClock(400000);
 
   // ***
-  // *** Give the DHT Tiny a chance to get initialized.
-  // ***
-  Serial.println(F("Giving the DHT Tiny an opportunity to initialize...")); Serial.println();
-  delay(2000);
-
-  // ***
-  // *** Get the device address by searching for
-  // *** the device on the i2c bus.
+  // *** Get the device address by searching for the device
+  // *** on the i2c bus. Keep searching until it answers
+  // *** or it has had time to initialize.
   // ***
   Serial.println(F("Searching for DHT Tiny..."));
+  uint32_t searchStarted = millis();
   _deviceAddress = findFirstDhtTiny();
 
+  while (_deviceAddress == 0 && (millis() - searchStarted) < DEVICE_START_TIMEOUT)
+  {
+    delay(READY_POLL_INTERVAL);
+    _deviceAddress = findFirstDhtTiny();
+  }
+
   // ***
   // *** Check if we have a valid address.
   // ***
@@ -149,6 +339,11 @@ void setup()
     Serial.print(F("A DHT Tiny was found at address 0x")); Serial.println(_deviceAddress, HEX);
     Serial.println();
 
+    // ***
+    // *** Use PEC if the saved configuration enables it.
+    // ***
+    syncPec();
+
     // ***
     // *** Check the current DHT model and give the user
     // *** an opportunity to change it.
@@ -156,9 +351,16 @@ void setup()
     dhtModelCheck();
 
     // ***
-    // *** Display device data.
+    // *** Display device data once any model
+    // *** change has been written.
+    // ***
+    queueCall(displayDeviceData);
+    displayConsoleHelp();
+
+    // ***
+    // *** Run the first test step right away.
     // ***
-    displayDeviceData();
+    _lastStep = millis() - _myInterval;
   }
   else
   {
@@ -196,248 +398,286 @@ void loop()
 {
   if (_deviceAddress != 0)
   {
-    switch (_myCounter)
-    {
-      case STATE_INITIAL:
-        {
-          // ***
-          // *** Reset the saved configuration.
-          // ***
-          uint8_t configValue = requestUint8(REGISTER_CONFIG);
-          bitWrite(configValue, CONFIG_BIT_RESET_CONFIG, 1);
-          sendUint8(REGISTER_CONFIG, configValue);
-
-          // ***
-          // *** Reboot the device.
-          // ***
-          rebootDevice();
-
-          Serial.println(F("***************************************************************"));
-          Serial.println(F("Setting interval to 2 seconds, checking device every 2 seconds."));
-          Serial.println(F("***************************************************************"));
-          Serial.println(F(""));
-          sendUint32(REGISTER_INTERVAL, 2000);
-          _myInterval = 2000;
-          break;
-        }
-      case STATE_DISABLE_SENSOR:
-        {
-          // ***
-          // *** Set the enable bit in the configuration to 0.
-          // ***
-          Serial.println(F("***************************************************************"));
-          Serial.println(F("Disabling the sensor."));
-          Serial.println(F("***************************************************************"));
-          Serial.println(F(""));
-          uint8_t configValue = requestUint8(REGISTER_CONFIG);
-          bitWrite(configValue, CONFIG_BIT_SENSOR_ENABLED, 0);
-          sendUint8(REGISTER_CONFIG, configValue);
-          break;
-        }
-      case STATE_ENSABLE_SENSOR:
-        {
-          // ***
-          // *** Set the enable bit in the configuration to 1.
-          // ***
-          Serial.println(F("***************************************************************"));
-          Serial.println(F("Enabling the sensor."));
-          Serial.println(F("***************************************************************"));
-          Serial.println(F(""));
-          uint8_t configValue = requestUint8(REGISTER_CONFIG);
-          bitWrite(configValue, CONFIG_BIT_SENSOR_ENABLED, 1);
-          sendUint8(REGISTER_CONFIG, configValue);
-          break;
-        }
-      case STATE_ENABLE_THRESHOLDS:
-        {
-          // ***
-          // *** Turn the thresholds on.
-          // ***
-          Serial.println(F("***************************************************************"));
-          Serial.println(F("Enabling thresholds."));
-          Serial.println(F("***************************************************************"));
-          Serial.println(F(""));
-
-          // ***
-          // *** Set the thresholds
-          // ***
-          sendFloat(REGISTER_LOWER_THRESHOLD, 19.0);
-          sendFloat(REGISTER_UPPER_THRESHOLD, 21.0);
-
-          // ***
-          // *** Set the configuration bit to enable the thresholds.
-          // ***
-          uint8_t configValue = requestUint8(REGISTER_CONFIG);
-          bitWrite(configValue, CONFIG_BIT_THRESHOLD_ENABLED, 1);
-          sendUint8(REGISTER_CONFIG, configValue);
-          break;
-        }
-      case STATE_DISABLE_THRESHOLDS:
-        {
-          // ***
-          // *** Turn the thresholds off.
-          // ***
-          Serial.println(F("***************************************************************"));
-          Serial.println(F("Disabling thresholds."));
-          Serial.println(F("***************************************************************"));
-          Serial.println(F(""));
-
-          // ***
-          // *** Reset the thresholds
-          // ***
-          sendFloat(REGISTER_LOWER_THRESHOLD, 0.0);
-          sendFloat(REGISTER_UPPER_THRESHOLD, 0.0);
-
-          // ***
-          // *** Set the configuration bit to disable the thresholds.
-          // ***
-          uint8_t configValue = requestUint8(REGISTER_CONFIG);
-          bitWrite(configValue, CONFIG_BIT_THRESHOLD_ENABLED, 0);
-          sendUint8(REGISTER_CONFIG, configValue);
-          break;
-        }
-      case STATE_INTERVAL_1:
-        {
-          // ***
-          // *** Change the interval to 1 second.
-          // ***
-          Serial.println(F("***************************************************************"));
-          Serial.println(F("Setting interval to 1 second, checking device every 1 second."));
-          Serial.println(F("***************************************************************"));
-          Serial.println(F(""));
-          sendUint32(REGISTER_INTERVAL, 1000);
-          _myInterval = 1000;
-          break;
-        }
-      case STATE_INTERVAL_0:
-        {
-          // ***
-          // *** Change the interval to manual.
-          // ***
-          Serial.println(F("***************************************************************"));
-          Serial.println(F("Setting interval to 0, checking device every 2 seconds."));
-          Serial.println(F("***************************************************************"));
-          Serial.println(F(""));
-          sendUint32(REGISTER_INTERVAL, 0);
-          _myInterval = 2000;
-          break;
-        }
-      case STATE_INTERVAL_MANUAL:
-        {
-          // ***
-          // *** Trigger a reading manually.
-          // ***
-          Serial.println(F("***************************************************************"));
-          Serial.println(F("Triggering a reading manually."));
-          Serial.println(F("***************************************************************"));
-          Serial.println(F(""));
-          uint8_t configValue = requestUint8(REGISTER_CONFIG);
-          bitWrite(configValue, CONFIG_BIT_TRIGGER_READING, 1);
-          sendUint8(REGISTER_CONFIG, configValue);
-
-          // ***
-          // *** Give the sensor time to take a reading.
-          // ***
-          delay(350);
-          break;
-        }
-      case STATE_RESTORE_INTERVAL:
-        {
-          Serial.println(F("***************************************************************"));
-          Serial.println(F("Setting interval to 2 seconds, checking device every 2 seconds."));
-          Serial.println(F("***************************************************************"));
-          Serial.println(F(""));
-          sendUint32(REGISTER_INTERVAL, 2000);
-          _myInterval = 2000;
-          break;
-        }
-      case STATE_BAD_WRITE:
-        {
-          Serial.println(F("***************************************************************"));
-          Serial.println(F("Writing to wrong register position."));
-          Serial.println(F("***************************************************************"));
-          Serial.println(F(""));
-
-          // ***
-          // *** The device will reject this update.
-          // ***
-          sendUint32(REGISTER_INTERVAL + 1, 1000);
-
-          break;
-        }
-      case STATE_SAVE_CONFIG:
-        {
-          Serial.println(F("***************************************************************"));
-          Serial.println(F("Saving the configuration."));
-          Serial.println(F("***************************************************************"));
-          Serial.println();
-
-          // ***
-          // *** Set the configuration bits to enable
-          // *** the sensor and the thresholds.
-          // ***
-          uint8_t configValue = requestUint8(REGISTER_CONFIG);
-          bitWrite(configValue, CONFIG_BIT_SENSOR_ENABLED, 1);
-          bitWrite(configValue, CONFIG_BIT_THRESHOLD_ENABLED, 1);
-          sendUint8(REGISTER_CONFIG, configValue);
-
-          // ***
-          // *** Set the interval
-          // ***
-          sendUint32(REGISTER_INTERVAL, 1500);
-
-          // ***
-          // *** Set the thresholds
-          // ***
-          sendFloat(REGISTER_LOWER_THRESHOLD, 19.0);
-          sendFloat(REGISTER_UPPER_THRESHOLD, 21.0);
-          bitWrite(configValue, CONFIG_BIT_THRESHOLD_ENABLED, 0);
-
-          // ***
-          // *** Set the configuration bit to indicate we
-          // *** want the current configuration saved to EEPROM.
-          // ***
-          bitWrite(configValue, CONFIG_BIT_WRITE_CONFIG, 1);
-          sendUint8(REGISTER_CONFIG, configValue);
-          delay(1000);
-
-          // ***
-          // *** Display the current settings.
-          // ***
-          displayData();
-
-          // ***
-          // *** Reboot the device.
-          // ***
-          rebootDevice();
-          break;
-        }
-      case STATE_RESET:
-        {
-          _myCounter = 0;
-          break;
-        }
-    }
+    // ***
+    // *** Run the next queued transaction if the
+    // *** device is ready for it.
+    // ***
+    processQueue();
 
     // ***
-    // *** Display the sensor data.
+    // *** Report interrupt pin changes as they happen.
     // ***
-    displayData();
+    checkInterruptPin();
 
     // ***
-    // *** Wait
+    // *** Handle any command typed on the serial console.
     // ***
-    Serial.print(F("\tWaiting ")); Serial.print(_myInterval / 1000); Serial.println(F(" second(s) until next request."));
-    Serial.println();
-    delay(_myInterval);
+    checkConsole();
 
     // ***
-    // *** Increment the loop counter.
+    // *** Start the next test step once the previous
+    // *** one has drained from the queue and the
+    // *** interval has elapsed.
     // ***
-    _myCounter++;
+    if (!_paused && _queueCount == 0 && _waitReady == READY_NONE && (millis() - _lastStep) >= _myInterval)
+    {
+      runTestStep();
+    }
   }
 }
 
+// ***
+// *** Queues the transactions for the current step
+// *** of the test cycle.
+// ***
+void runTestStep()
+{
+  switch (_myCounter)
+  {
+    case STATE_INITIAL:
+      {
+        // ***
+        // *** Reset the saved configuration.
+        // ***
+        uint8_t configValue = requestUint8(REGISTER_CONFIG);
+        bitWrite(configValue, CONFIG_BIT_RESET_CONFIG, 1);
+        sendUint8(REGISTER_CONFIG, configValue);
+
+        // ***
+        // *** Reboot the device.
+        // ***
+        rebootDevice();
+
+        Serial.println(F("***************************************************************"));
+        Serial.println(F("Setting interval to 2 seconds, checking device every 2 seconds."));
+        Serial.println(F("***************************************************************"));
+        Serial.println(F(""));
+        sendUint32(REGISTER_INTERVAL, 2000);
+        _myInterval = 2000;
+        break;
+      }
+    case STATE_DISABLE_SENSOR:
+      {
+        // ***
+        // *** Set the enable bit in the configuration to 0.
+        // ***
+        Serial.println(F("***************************************************************"));
+        Serial.println(F("Disabling the sensor."));
+        Serial.println(F("***************************************************************"));
+        Serial.println(F(""));
+        uint8_t configValue = requestUint8(REGISTER_CONFIG);
+        bitWrite(configValue, CONFIG_BIT_SENSOR_ENABLED, 0);
+        sendUint8(REGISTER_CONFIG, configValue);
+        break;
+      }
+    case STATE_ENSABLE_SENSOR:
+      {
+        // ***
+        // *** Set the enable bit in the configuration to 1.
+        // ***
+        Serial.println(F("***************************************************************"));
+        Serial.println(F("Enabling the sensor."));
+        Serial.println(F("***************************************************************"));
+        Serial.println(F(""));
+        uint8_t configValue = requestUint8(REGISTER_CONFIG);
+        bitWrite(configValue, CONFIG_BIT_SENSOR_ENABLED, 1);
+        sendUint8(REGISTER_CONFIG, configValue);
+        break;
+      }
+    case STATE_ENABLE_THRESHOLDS:
+      {
+        // ***
+        // *** Turn the thresholds on.
+        // ***
+        Serial.println(F("***************************************************************"));
+        Serial.println(F("Enabling thresholds."));
+        Serial.println(F("***************************************************************"));
+        Serial.println(F(""));
+
+        // ***
+        // *** Set the thresholds
+        // ***
+        sendFloat(REGISTER_LOWER_THRESHOLD, 19.0);
+        sendFloat(REGISTER_UPPER_THRESHOLD, 21.0);
+
+        // ***
+        // *** Set the configuration bit to enable the thresholds.
+        // ***
+        uint8_t configValue = requestUint8(REGISTER_CONFIG);
+        bitWrite(configValue, CONFIG_BIT_THRESHOLD_ENABLED, 1);
+        sendUint8(REGISTER_CONFIG, configValue);
+        break;
+      }
+    case STATE_DISABLE_THRESHOLDS:
+      {
+        // ***
+        // *** Turn the thresholds off.
+        // ***
+        Serial.println(F("***************************************************************"));
+        Serial.println(F("Disabling thresholds."));
+        Serial.println(F("***************************************************************"));
+        Serial.println(F(""));
+
+        // ***
+        // *** Reset the thresholds
+        // ***
+        sendFloat(REGISTER_LOWER_THRESHOLD, 0.0);
+        sendFloat(REGISTER_UPPER_THRESHOLD, 0.0);
+
+        // ***
+        // *** Set the configuration bit to disable the thresholds.
+        // ***
+        uint8_t configValue = requestUint8(REGISTER_CONFIG);
+        bitWrite(configValue, CONFIG_BIT_THRESHOLD_ENABLED, 0);
+        sendUint8(REGISTER_CONFIG, configValue);
+        break;
+      }
+    case STATE_INTERVAL_1:
+      {
+        // ***
+        // *** Change the interval to 1 second.
+        // ***
+        Serial.println(F("***************************************************************"));
+        Serial.println(F("Setting interval to 1 second, checking device every 1 second."));
+        Serial.println(F("***************************************************************"));
+        Serial.println(F(""));
+        sendUint32(REGISTER_INTERVAL, 1000);
+        _myInterval = 1000;
+        break;
+      }
+    case STATE_INTERVAL_0:
+      {
+        // ***
+        // *** Change the interval to manual.
+        // ***
+        Serial.println(F("***************************************************************"));
+        Serial.println(F("Setting interval to 0, checking device every 2 seconds."));
+        Serial.println(F("***************************************************************"));
+        Serial.println(F(""));
+        sendUint32(REGISTER_INTERVAL, 0);
+        _myInterval = 2000;
+        break;
+      }
+    case STATE_INTERVAL_MANUAL:
+      {
+        // ***
+        // *** Trigger a reading manually.
+        // ***
+        Serial.println(F("***************************************************************"));
+        Serial.println(F("Triggering a reading manually."));
+        Serial.println(F("***************************************************************"));
+        Serial.println(F(""));
+        // ***
+        // *** The device clears the trigger bit once the reading
+        // *** has been taken, so the display that follows waits
+        // *** for the new reading.
+        // ***
+        uint8_t configValue = requestUint8(REGISTER_CONFIG);
+        bitWrite(configValue, CONFIG_BIT_TRIGGER_READING, 1);
+        sendUint8(REGISTER_CONFIG, configValue);
+        break;
+      }
+    case STATE_RESTORE_INTERVAL:
+      {
+        Serial.println(F("***************************************************************"));
+        Serial.println(F("Setting interval to 2 seconds, checking device every 2 seconds."));
+        Serial.println(F("***************************************************************"));
+        Serial.println(F(""));
+        sendUint32(REGISTER_INTERVAL, 2000);
+        _myInterval = 2000;
+        break;
+      }
+    case STATE_BAD_WRITE:
+      {
+        Serial.println(F("***************************************************************"));
+        Serial.println(F("Writing to wrong register position."));
+        Serial.println(F("***************************************************************"));
+        Serial.println(F(""));
+
+        // ***
+        // *** The device will reject this update.
+        // ***
+        sendUint32(REGISTER_INTERVAL + 1, 1000);
+
+        break;
+      }
+    case STATE_SAVE_CONFIG:
+      {
+        Serial.println(F("***************************************************************"));
+        Serial.println(F("Saving the configuration."));
+        Serial.println(F("***************************************************************"));
+        Serial.println();
+
+        // ***
+        // *** Set the configuration bits to enable
+        // *** the sensor and the thresholds.
+        // ***
+        uint8_t configValue = requestUint8(REGISTER_CONFIG);
+        bitWrite(configValue, CONFIG_BIT_SENSOR_ENABLED, 1);
+        bitWrite(configValue, CONFIG_BIT_THRESHOLD_ENABLED, 1);
+        sendUint8(REGISTER_CONFIG, configValue);
+
+        // ***
+        // *** Set the interval
+        // ***
+        sendUint32(REGISTER_INTERVAL, 1500);
+
+        // ***
+        // *** Set the thresholds
+        // ***
+        sendFloat(REGISTER_LOWER_THRESHOLD, 19.0);
+        sendFloat(REGISTER_UPPER_THRESHOLD, 21.0);
+        bitWrite(configValue, CONFIG_BIT_THRESHOLD_ENABLED, 0);
+
+        // ***
+        // *** Set the configuration bit to indicate we
+        // *** want the current configuration saved to EEPROM.
+        // *** The device clears the bit once it has been saved.
+        // ***
+        bitWrite(configValue, CONFIG_BIT_WRITE_CONFIG, 1);
+        sendUint8(REGISTER_CONFIG, configValue);
+
+        // ***
+        // *** Display the current settings.
+        // ***
+        queueCall(displayData);
+
+        // ***
+        // *** Reboot the device.
+        // ***
+        rebootDevice();
+        break;
+      }
+    case STATE_RESET:
+      {
+        _myCounter = 0;
+        break;
+      }
+  }
+
+  // ***
+  // *** Display the sensor data.
+  // ***
+  queueCall(displayData);
+  queueCall(finishTestStep);
+
+  // ***
+  // *** Increment the loop counter.
+  // ***
+  _myCounter++;
+}
+
+// ***
+// *** Runs after the last transaction of a test
+// *** step and starts the wait for the next one.
+// ***
+void finishTestStep()
+{
+  Serial.print(F("\tWaiting ")); Serial.print(_myInterval / 1000); Serial.println(F(" second(s) until next request."));
+  Serial.println();
+  _lastStep = millis();
+}
+
 // ***
 // *** Find the first DHT Tiny on the i2c bus and
 // *** returns it's address.
@@ -464,7 +704,7 @@ uint8_t findFirstDhtTiny()
       // ***
       // *** The ID value should be 0x2D for a DHT Tiny.
       // ***
-      if (id == 0x2d)
+      if (id == DHT_TINY_ID)
       {
         // ***
         // *** A DHT Tiny was found.
@@ -543,19 +783,28 @@ void dhtModelCheck()
 }
 
 // ***
-// *** Reboot the DHT Tiny
+// *** Reboot the DHT Tiny. The reset pin is held LOW for
+// *** RESET_PULSE_WIDTH and the queue then waits until the
+// *** device answers on the bus again.
 // ***
 void rebootDevice()
+{
+  queueCall(displayRebootBanner);
+  queueResetPin(LOW, READY_TIME, RESET_PULSE_WIDTH);
+  queueResetPin(HIGH, READY_BOOT, 0);
+}
+
+// ***
+// *** Displays the reboot banner when the
+// *** reboot reaches the front of the queue.
+// ***
+void displayRebootBanner()
 {
   Serial.println(F(""));
   Serial.println(F("************************************************************"));
   Serial.println(F("Rebooting device."));
   Serial.println(F("************************************************************"));
   Serial.println(F(""));
-  digitalWrite(DHT_RESET_PIN, LOW);
-  delay(350);
-  digitalWrite(DHT_RESET_PIN, HIGH);
-  delay(2000);
 }
 
 // ***
@@ -631,11 +880,23 @@ void displayData()
   // ***
   uint32_t startDelay = requestUint32(REGISTER_START_DELAY);
 
+  // ***
+  // *** Read the interval currently in effect.
+  // ***
+  uint32_t currentInterval = requestUint32(REGISTER_CURRENT_INTERVAL);
+
   // ***
   // *** Read the current reading ID.
   // ***
   uint32_t id = requestUint32(REGISTER_READING_ID);
 
+  // ***
+  // *** Read the time the reading was taken (device time)
+  // *** and how long ago that was.
+  // ***
+  uint32_t readingTime = requestUint32(REGISTER_READING_TIME);
+  uint32_t readingAge = requestUint32(REGISTER_READING_AGE);
+
   // ***
   // *** Read the upper temperature threshold.
   // ***
@@ -656,16 +917,92 @@ void displayData()
   // ***
   uint8_t statusValue = requestUint8(REGISTER_STATUS);
 
+  // ***
+  // *** Read the outlier filter mode and the number
+  // *** of readings it has rejected.
+  // ***
+  uint8_t filterMode = requestUint8(REGISTER_FILTER_MODE);
+  uint16_t filterRejects = requestUint16(REGISTER_FILTER_REJECTS);
+
+  // ***
+  // *** Read the calibration applied by the device.
+  // ***
+  int16_t temperatureOffset = (int16_t)requestUint16(REGISTER_TEMPERATURE_OFFSET);
+  uint16_t temperatureGain = requestUint16(REGISTER_TEMPERATURE_GAIN);
+  int16_t humidityOffset = (int16_t)requestUint16(REGISTER_HUMIDITY_OFFSET);
+  uint16_t humidityGain = requestUint16(REGISTER_HUMIDITY_GAIN);
+
+  // ***
+  // *** Read the derived block in one request.
+  // ***
+  byte derived[DERIVED_BLOCK_SIZE];
+  requestBytes(REGISTER_DEW_POINT, DERIVED_BLOCK_SIZE, derived);
+  int16_t dewPoint = ByteConverter::bytesToInt16(&derived[DERIVED_OFFSET(REGISTER_DEW_POINT)]);
+  uint16_t absoluteHumidity = ByteConverter::bytesToUint16(&derived[DERIVED_OFFSET(REGISTER_ABSOLUTE_HUMIDITY)]);
+  int16_t heatIndex = ByteConverter::bytesToInt16(&derived[DERIVED_OFFSET(REGISTER_HEAT_INDEX)]);
+
+  // ***
+  // *** Read the aggregate block in one request. Values
+  // *** are in tenths of a degree and tenths of a percent.
+  // ***
+  byte aggregate[AGGREGATE_BLOCK_SIZE];
+  requestBytes(REGISTER_AGGREGATE_COUNT, AGGREGATE_BLOCK_SIZE, aggregate);
+  uint16_t aggregateCount = ByteConverter::bytesToUint16(&aggregate[AGGREGATE_OFFSET(REGISTER_AGGREGATE_COUNT)]);
+  int16_t temperatureMin = ByteConverter::bytesToInt16(&aggregate[AGGREGATE_OFFSET(REGISTER_TEMPERATURE_MIN)]);
+  int16_t temperatureMax = ByteConverter::bytesToInt16(&aggregate[AGGREGATE_OFFSET(REGISTER_TEMPERATURE_MAX)]);
+  int16_t temperatureMean = ByteConverter::bytesToInt16(&aggregate[AGGREGATE_OFFSET(REGISTER_TEMPERATURE_MEAN)]);
+  int16_t humidityMean = ByteConverter::bytesToInt16(&aggregate[AGGREGATE_OFFSET(REGISTER_HUMIDITY_MEAN)]);
+
+  // ***
+  // *** Ack the aggregate block so the next read
+  // *** starts from new readings.
+  // ***
+  sendUint8(REGISTER_AGGREGATE_CONTROL, AGGREGATE_COMMAND_ACK);
+
+  // ***
+  // *** Read the selected channel and the number of channels.
+  // ***
+  uint8_t channel = requestUint8(REGISTER_CHANNEL);
+  uint8_t channelCount = requestUint8(REGISTER_CHANNEL_COUNT);
+
+  // ***
+  // *** Read the time spent at each clock rate.
+  // ***
+  byte clockBlock[CLOCK_BLOCK_SIZE];
+  requestBytes(REGISTER_CLOCK_IDLE_SHIFT, CLOCK_BLOCK_SIZE, clockBlock);
+  uint8_t clockIdleShift = clockBlock[CLOCK_OFFSET(REGISTER_CLOCK_IDLE_SHIFT)];
+  uint32_t clockFullTime = ByteConverter::bytesToUint32(&clockBlock[CLOCK_OFFSET(REGISTER_CLOCK_FULL_TIME)]);
+  uint32_t clockIdleTime = ByteConverter::bytesToUint32(&clockBlock[CLOCK_OFFSET(REGISTER_CLOCK_IDLE_TIME)]);
+
+  // ***
+  // *** Read the spill log decimation and the blocks waiting
+  // *** in the log.
+  // ***
+  uint8_t logDecimation = requestUint8(REGISTER_LOG_DECIMATION);
+  uint8_t logBlocks = requestUint8(REGISTER_LOG_CONTROL);
+
   // ***
   // *** Display the results.
   // ***
   Serial.print(F("Reading ID = ")); Serial.println(id);
+  Serial.print(F("\tChannel = ")); Serial.print(channel); Serial.print(F(" of ")); Serial.println(channelCount);
+  Serial.print(F("\tReading Time = ")); Serial.print(readingTime); Serial.println(F(" mS"));
+  Serial.print(F("\tReading Age = "));
+  if (readingAge == READING_AGE_NONE) Serial.println(F("none")); else { Serial.print(readingAge); Serial.println(F(" mS")); }
   Serial.print(F("\tInterval = ")); Serial.print(interval); Serial.println(F(" mS"));
+  Serial.print(F("\tCurrent Interval = ")); Serial.print(currentInterval); Serial.println(F(" mS"));
   Serial.print(F("\tStart Delay = ")); Serial.print(startDelay); Serial.println(F(" mS"));
   Serial.print(F("\tTemperature = ")); Serial.print(temperatureC); Serial.print(F("C, ")); Serial.print(temperatureF); Serial.println(F("F"));
   Serial.print(F("\tHumidity = ")); Serial.print(humidity); Serial.println(F("%"));
+  Serial.print(F("\tDew Point = ")); Serial.print(dewPoint / 10.0); Serial.println(F("C"));
+  Serial.print(F("\tAbsolute Humidity = ")); Serial.print(absoluteHumidity / 100.0); Serial.println(F(" g/m3"));
+  Serial.print(F("\tHeat Index = ")); Serial.print(heatIndex / 10.0); Serial.println(F("C"));
+  Serial.print(F("\tAggregate = ")); Serial.print(aggregateCount); Serial.print(F(" reading(s), ")); Serial.print(temperatureMin / 10.0); Serial.print(F("C min, ")); Serial.print(temperatureMax / 10.0); Serial.print(F("C max, ")); Serial.print(temperatureMean / 10.0); Serial.print(F("C mean, ")); Serial.print(humidityMean / 10.0); Serial.println(F("% mean"));
+  Serial.print(F("\tCalibration = ")); Serial.print(temperatureGain / (float)CALIBRATION_GAIN_ONE, 4); Serial.print(F(" x T + ")); Serial.print(temperatureOffset / 10.0); Serial.print(F("C, ")); Serial.print(humidityGain / (float)CALIBRATION_GAIN_ONE, 4); Serial.print(F(" x H + ")); Serial.print(humidityOffset / 10.0); Serial.println(F("%"));
   Serial.print(F("\tUpper Threshold = ")); Serial.print(upperThreshold); Serial.println(F("C"));
   Serial.print(F("\tLower Threshold = ")); Serial.print(lowerThreshold); Serial.println(F("C"));
+  Serial.print(F("\tClock = ")); Serial.print(clockFullTime); Serial.print(F(" mS full, ")); Serial.print(clockIdleTime); Serial.print(F(" mS at 1/")); Serial.println(1 << clockIdleShift);
+  Serial.print(F("\tSpill Log = ")); Serial.print(logBlocks); Serial.print(F(" block(s), 1 in ")); Serial.println(logDecimation);
 
   // ***
   // *** Display the configuration bits.
@@ -681,6 +1018,8 @@ void displayData()
   // *** Display specific bit values.
   // ***
   if (bitRead(configValue, CONFIG_BIT_THRESHOLD_ENABLED) == 1) Serial.println(F("\tThresholds are enabled.")); else Serial.println(F("\tThresholds are disabled."));
+  Serial.print(F("\tFilter: median ")); Serial.print(bitRead(filterMode, FILTER_BIT_MEDIAN) ? F("on") : F("off")); Serial.print(F(", slew ")); Serial.print(bitRead(filterMode, FILTER_BIT_SLEW) ? F("on") : F("off")); Serial.print(F(", ")); Serial.print(filterRejects); Serial.println(F(" rejected."));
+  if (_pecEnabled) { Serial.print(F("\tPEC is enabled, ")); Serial.print(_pecErrors); Serial.println(F(" error(s).")); } else Serial.println(F("\tPEC is disabled."));
   if (bitRead(statusValue, STATUS_UPPER_THRESHOLD_EXCEEDED) == 1) Serial.println(F("\tUpper threshold exceeded."));
   if (bitRead(statusValue, STATUS_LOWER_THRESHOLD_EXCEEDED) == 1) Serial.println(F("\tLower threshold exceeded."));
   if (bitRead(statusValue, STATUS_DHT_READING_ERROR) == 1) Serial.println(F("\tDHT Read Error = YES")); else Serial.println(F("\tDHT Read Error = NO"));
@@ -712,35 +1051,77 @@ void displayBits(uint8_t byteValue)
 
 // ***
 // *** Request one or more bytes from a given register
-// *** on the DHT Tiny.
+// *** on the DHT Tiny. Returns false if the device did
+// *** not acknowledge or returned fewer bytes.
+// ***
+bool requestBytes(uint8_t registerId, uint8_t byteCount, uint8_t* data)
+{
+  return readBytes(registerId, byteCount, data, _pecEnabled);
+}
+
 // ***
-void requestBytes(uint8_t registerId, uint8_t byteCount, uint8_t* data)
+// *** Read one or more bytes from a given register. A PEC
+// *** read sends PEC_READ_COMMAND, the register and the byte
+// *** count and gets the PEC after the data. A plain read is
+// *** always accepted.
+// ***
+bool readBytes(uint8_t registerId, uint8_t byteCount, uint8_t* data, bool pec)
 {
+  bool returnValue = false;
+
   // ***
   // *** Send the byte array to the i2c device.
   // ***
   Wire.beginTransmission(_deviceAddress);
+  if (pec) Wire.write(PEC_READ_COMMAND);
   Wire.write(registerId);
+  if (pec) Wire.write(byteCount);
   byte response = Wire.endTransmission(true);
 
   if (response == 0)
   {
-    Wire.requestFrom(_deviceAddress, byteCount);
+    uint8_t frameCount = pec ? byteCount + 1 : byteCount;
+    returnValue = (Wire.requestFrom(_deviceAddress, frameCount) == frameCount);
     for (int i = 0; i < byteCount; i++)
     {
       data[i] = Wire.read();
     }
+
+    if (pec)
+    {
+      // ***
+      // *** The PEC covers the address, the command, the
+      // *** register, the count, the address with the read
+      // *** bit and the data.
+      // ***
+      uint8_t crc = updatePec(0, _deviceAddress << 1);
+      crc = updatePec(crc, PEC_READ_COMMAND);
+      crc = updatePec(crc, registerId);
+      crc = updatePec(crc, byteCount);
+      crc = updatePec(crc, (_deviceAddress << 1) | 1);
+      for (int i = 0; i < byteCount; i++)
+      {
+        crc = updatePec(crc, data[i]);
+      }
+
+      if (crc != Wire.read())
+      {
+        _pecErrors++;
+        returnValue = false;
+      }
+    }
   }
+
+  return returnValue;
 }
 
 // ***
-// *** Send one or more bytes to a given register
-// *** on the DHT Tiny.
+// *** Write one or more bytes to a given register on the
+// *** DHT Tiny. This is called by the queue; use sendBytes()
+// *** everywhere else.
 // ***
-bool sendBytes(uint8_t registerId, uint8_t byteCount, uint8_t* data)
+bool writeBytes(uint8_t registerId, uint8_t byteCount, uint8_t* data)
 {
-  bool returnValue = false;
-
   // ***
   // *** Send the byte array to the i2c device.
   // ***
@@ -752,16 +1133,373 @@ bool sendBytes(uint8_t registerId, uint8_t byteCount, uint8_t* data)
     Wire.write(data[i]);
   }
 
-  returnValue = (Wire.endTransmission() == 0);
-
   // ***
-  // *** Give the device time to respond.
+  // *** The PEC covers the address, the register and the data.
   // ***
-  delay(DEVICE_DELAY);
+  if (_pecEnabled)
+  {
+    uint8_t crc = updatePec(0, _deviceAddress << 1);
+    crc = updatePec(crc, registerId);
+    for (int i = 0; i < byteCount; i++)
+    {
+      crc = updatePec(crc, data[i]);
+    }
+    Wire.write(crc);
+  }
+
+  return (Wire.endTransmission() == 0);
+}
+
+// ***
+// *** Adds a byte to a PEC.
+// ***
+uint8_t updatePec(uint8_t crc, uint8_t value)
+{
+  crc ^= value;
+  crc = (crc << 4) ^ pgm_read_byte(&_pecTable[crc >> 4]);
+  crc = (crc << 4) ^ pgm_read_byte(&_pecTable[crc >> 4]);
+
+  return crc;
+}
+
+// ***
+// *** Reads the configuration with a plain read and uses PEC
+// *** from now on if the device has it enabled. Called whenever
+// *** the configuration may have changed on the device.
+// ***
+void syncPec()
+{
+  uint8_t configValue = 0;
+
+  if (readBytes(REGISTER_CONFIG, 1, &configValue, false))
+  {
+    _pecEnabled = bitRead(configValue, CONFIG_BIT_PEC_ENABLED);
+  }
+}
+
+// ***
+// *** Flips the PEC enable bit on the device.
+// ***
+void togglePec()
+{
+  uint8_t configValue = requestUint8(REGISTER_CONFIG);
+  bitWrite(configValue, CONFIG_BIT_PEC_ENABLED, !_pecEnabled);
+  sendUint8(REGISTER_CONFIG, configValue);
+  if (_pecEnabled) Serial.println(F("Disabling PEC.")); else Serial.println(F("Enabling PEC."));
+}
+
+// ***
+// *** Turns the outlier filter (median and slew gate) on or off.
+// ***
+void toggleFilter()
+{
+  uint8_t filterMode = requestUint8(REGISTER_FILTER_MODE) ? 0 : (_BV(FILTER_BIT_MEDIAN) | _BV(FILTER_BIT_SLEW));
+  sendUint8(REGISTER_FILTER_MODE, filterMode);
+  if (filterMode) Serial.println(F("Enabling the filter.")); else Serial.println(F("Disabling the filter."));
+}
+
+// ***
+// *** Selects the next channel of a breakout with more than
+// *** one sensor. Everything read or written after this goes
+// *** to the bank of that channel.
+// ***
+void nextChannel()
+{
+  uint8_t channelCount = requestUint8(REGISTER_CHANNEL_COUNT);
+  uint8_t channel = channelCount > 1 ? (requestUint8(REGISTER_CHANNEL) + 1) % channelCount : 0;
+  sendUint8(REGISTER_CHANNEL, channel);
+  Serial.print(F("Selecting channel ")); Serial.print(channel); Serial.println(F("."));
+}
+
+// ***
+// *** Queue one or more bytes to be sent to a given register
+// *** on the DHT Tiny. The configuration register is acted on
+// *** by the device's loop() rather than its i2c handler, so
+// *** the transaction that follows a write to it waits until
+// *** the device has caught up.
+// ***
+bool sendBytes(uint8_t registerId, uint8_t byteCount, uint8_t* data)
+{
+  Transaction transaction;
+  transaction.operation = OPERATION_WRITE;
+  transaction.registerId = registerId;
+  transaction.byteCount = min(byteCount, SIZE_UINT32);
+  memcpy(transaction.data, data, transaction.byteCount);
+  transaction.ready = (registerId == REGISTER_CONFIG) ? READY_CONFIG : READY_NONE;
+  transaction.time = 0;
+  transaction.function = 0;
+
+  return queueTransaction(transaction);
+}
+
+// ***
+// *** Queue a function to run once every transaction
+// *** queued before it has completed.
+// ***
+bool queueCall(void (*function)())
+{
+  Transaction transaction;
+  transaction.operation = OPERATION_CALL;
+  transaction.byteCount = 0;
+  transaction.ready = READY_NONE;
+  transaction.time = 0;
+  transaction.function = function;
+
+  return queueTransaction(transaction);
+}
+
+// ***
+// *** Queue a change to the level of the reset pin.
+// ***
+bool queueResetPin(uint8_t value, uint8_t ready, uint16_t time)
+{
+  Transaction transaction;
+  transaction.operation = OPERATION_RESET_PIN;
+  transaction.byteCount = 1;
+  transaction.data[0] = value;
+  transaction.ready = ready;
+  transaction.time = time;
+  transaction.function = 0;
+
+  return queueTransaction(transaction);
+}
+
+// ***
+// *** Add a transaction to the end of the queue.
+// ***
+bool queueTransaction(const Transaction& transaction)
+{
+  bool returnValue = false;
+
+  if (_queueCount < QUEUE_SIZE)
+  {
+    _queue[(_queueHead + _queueCount) % QUEUE_SIZE] = transaction;
+    _queueCount++;
+    returnValue = true;
+  }
+  else
+  {
+    Serial.println(F("\tThe transaction queue is full."));
+  }
+
+  return returnValue;
+}
+
+// ***
+// *** Run the transaction at the front of the queue
+// *** once the device is ready for it.
+// ***
+void processQueue()
+{
+  if (_queueCount > 0 && isDeviceReady())
+  {
+    // ***
+    // *** Take the transaction off the queue before running
+    // *** it; a queued call may queue more transactions.
+    // ***
+    Transaction transaction = _queue[_queueHead];
+    _queueHead = (_queueHead + 1) % QUEUE_SIZE;
+    _queueCount--;
+
+    switch (transaction.operation)
+    {
+      case OPERATION_WRITE:
+        if (!writeBytes(transaction.registerId, transaction.byteCount, transaction.data))
+        {
+          Serial.print(F("\tWrite to register ")); Serial.print(transaction.registerId); Serial.println(F(" was not acknowledged."));
+        }
+        break;
+      case OPERATION_CALL:
+        transaction.function();
+        break;
+      case OPERATION_RESET_PIN:
+        digitalWrite(DHT_RESET_PIN, transaction.data[0]);
+        break;
+    }
+
+    // ***
+    // *** Start waiting for the device.
+    // ***
+    _waitReady = transaction.ready;
+    _waitTime = transaction.time;
+    _waitStarted = millis();
+    _lastPoll = _waitStarted;
+  }
+}
+
+// ***
+// *** Checks the condition the queue is waiting on. The
+// *** device is polled at most every READY_POLL_INTERVAL
+// *** milliseconds and the wait is abandoned after
+// *** READY_TIMEOUT milliseconds.
+// ***
+bool isDeviceReady()
+{
+  bool returnValue = true;
+
+  if (_waitReady != READY_NONE)
+  {
+    uint32_t now = millis();
+
+    if (_waitReady == READY_TIME)
+    {
+      returnValue = (now - _waitStarted) >= _waitTime;
+    }
+    else if ((now - _waitStarted) >= READY_TIMEOUT)
+    {
+      Serial.println(F("\tTimed out waiting for the DHT Tiny."));
+    }
+    else if ((now - _lastPoll) < READY_POLL_INTERVAL)
+    {
+      returnValue = false;
+    }
+    else
+    {
+      _lastPoll = now;
+      returnValue = pollDevice(_waitReady);
+    }
+
+    if (returnValue)
+    {
+      _waitReady = READY_NONE;
+    }
+  }
+
+  return returnValue;
+}
+
+// ***
+// *** Reads the registers that tell whether the device
+// *** has reached the given readiness condition.
+// ***
+bool pollDevice(uint8_t ready)
+{
+  bool returnValue = false;
+
+  if (ready == READY_CONFIG)
+  {
+    // ***
+    // *** The device clears the self-clearing bits once it
+    // *** has acted on them and reflects the enable bit in
+    // *** the status register once the sensor has started
+    // *** or stopped.
+    // ***
+    uint8_t configValue = 0;
+    uint8_t statusValue = 0;
+
+    if (readBytes(REGISTER_CONFIG, 1, &configValue, false) && readBytes(REGISTER_STATUS, 1, &statusValue, false))
+    {
+      _pecEnabled = bitRead(configValue, CONFIG_BIT_PEC_ENABLED);
+
+      returnValue = bitRead(configValue, CONFIG_BIT_TRIGGER_READING) == 0 &&
+                    bitRead(configValue, CONFIG_BIT_WRITE_CONFIG) == 0 &&
+                    bitRead(configValue, CONFIG_BIT_RESET_CONFIG) == 0 &&
+                    bitRead(configValue, CONFIG_BIT_SENSOR_ENABLED) == bitRead(statusValue, STATUS_SENSOR_IS_ENABLED);
+    }
+  }
+  else if (ready == READY_BOOT)
+  {
+    // ***
+    // *** The device does not acknowledge until it
+    // *** has started its i2c slave.
+    // ***
+    uint8_t id = 0;
+    returnValue = readBytes(REGISTER_ID, 1, &id, false) && id == DHT_TINY_ID;
+
+    // ***
+    // *** The saved configuration may have PEC enabled.
+    // ***
+    if (returnValue)
+    {
+      syncPec();
+    }
+  }
 
   return returnValue;
 }
 
+// ***
+// *** Called when the interrupt pin changes if the
+// *** pin supports an external interrupt.
+// ***
+void onInterruptPin()
+{
+  _interruptPending = true;
+}
+
+// ***
+// *** Displays a change on the interrupt pin as soon as it
+// *** is seen. DHT_INTERRUPT_PIN goes HIGH whenever a
+// *** temperature threshold is exceeded.
+// ***
+void checkInterruptPin()
+{
+  if (!_interruptAttached || _interruptPending)
+  {
+    _interruptPending = false;
+    uint8_t pinValue = digitalRead(DHT_INTERRUPT_PIN);
+
+    if (pinValue != _lastPinValue)
+    {
+      _lastPinValue = pinValue;
+      Serial.print(F("\tArduino Pin ")); Serial.print(DHT_INTERRUPT_PIN); Serial.print(F(" changed to "));
+      if (pinValue == LOW) Serial.println(F("LOW")); else Serial.println(F("HIGH"));
+    }
+  }
+}
+
+// ***
+// *** Handles single character commands from the
+// *** serial console without blocking.
+// ***
+void checkConsole()
+{
+  while (Serial.available() > 0)
+  {
+    char command = Serial.read();
+
+    switch (command)
+    {
+      case 'd':
+        queueCall(displayData);
+        break;
+      case 'n':
+        _lastStep = millis() - _myInterval;
+        break;
+      case 'p':
+        _paused = !_paused;
+        if (_paused) Serial.println(F("Test cycle paused.")); else Serial.println(F("Test cycle resumed."));
+        break;
+      case 'c':
+        queueCall(togglePec);
+        break;
+      case 'f':
+        queueCall(toggleFilter);
+        break;
+      case 's':
+        queueCall(nextChannel);
+        break;
+      case 'q':
+        Serial.print(F("Queue: ")); Serial.print(_queueCount); Serial.print(F(" transaction(s), waiting on "));
+        Serial.println(_waitReady);
+        break;
+      case 'h':
+      case '?':
+        displayConsoleHelp();
+        break;
+    }
+  }
+}
+
+// ***
+// *** Displays the serial console commands.
+// ***
+void displayConsoleHelp()
+{
+  Serial.println(F("Commands: [d] Display data [n] Next step now [p] Pause/resume [c] PEC on/off [f] Filter on/off [s] Next channel [q] Queue status [h] Help"));
+  Serial.println();
+}
+
 // ***
 // *** Request a uint8_t from a given register
 // *** on the DHT Tiny.
@@ -791,6 +1529,21 @@ bool sendUint8(uint8_t registerId, uint8_t value)
   return returnValue;
 }
 
+// ***
+// *** Request a uint16_t from a given register
+// *** on the DHT Tiny.
+// ***
+uint16_t requestUint16(uint8_t registerId)
+{
+  uint16_t returnValue = 0;
+
+  byte data[2];
+  requestBytes(registerId, 2, data);
+  returnValue = ByteConverter::bytesToUint16(data);
+
+  return returnValue;
+}
+
 // ***
 // *** Request a float from a given register
 // *** on the DHT Tiny.
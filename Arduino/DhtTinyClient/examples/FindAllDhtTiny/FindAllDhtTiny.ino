@@ -0,0 +1,89 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include <Wire.h>
+#include <DhtTinyClient.h>
+#include <DhtTinyDiscovery.h>
+#include <DhtTinyWireTransport.h>
+
+// ***
+// *** Finds every DHT Tiny Breakout on the bus, gives any that
+// *** share an address (such as new ones, which all start at
+// *** 0x26) an address of their own and then polls them all.
+// ***
+#define MAX_DEVICES 8
+
+DhtTinyWireTransport _transport(Wire);
+DhtTinyDiscovery _discovery(_transport);
+DhtTinyClient* _devices[MAX_DEVICES];
+uint8_t _deviceCount = 0;
+
+void setup()
+{
+  Serial.begin(115200);
+  Wire.begin();
+  Wire.setClock(400000);
+
+  // ***
+  // *** Give the DHT Tiny a chance to get initialized.
+  // ***
+  delay(2000);
+
+  uint8_t addresses[MAX_DEVICES];
+  uint32_t serials[MAX_DEVICES];
+  uint8_t found = _discovery.findAll(addresses, serials, MAX_DEVICES, true);
+
+  Serial.print(F("Found ")); Serial.print(found);
+  Serial.print(F(" in ")); Serial.print(_discovery.getTransactionCount()); Serial.println(F(" transactions"));
+
+  for (uint8_t i = 0; i < found; i++)
+  {
+    Serial.print(F("Serial ")); Serial.print(serials[i], HEX);
+
+    if (addresses[i] != 0)
+    {
+      Serial.print(F(" at 0x")); Serial.println(addresses[i], HEX);
+
+      DhtTinyClient* device = new DhtTinyClient(_transport, addresses[i]);
+      if (device->begin())
+      {
+        _devices[_deviceCount++] = device;
+      }
+    }
+    else
+    {
+      Serial.println(F(" could not be given an address"));
+    }
+  }
+}
+
+void loop()
+{
+  for (uint8_t i = 0; i < _deviceCount; i++)
+  {
+    if (_devices[i]->update() == DHTTINY_UPDATED)
+    {
+      Serial.print(F("0x")); Serial.print(_devices[i]->getAddress(), HEX);
+      Serial.print(F(" #")); Serial.print(_devices[i]->getReadingId());
+      Serial.print(F(" ")); Serial.print(_devices[i]->getTemperature()); Serial.print(F(" C "));
+      Serial.print(_devices[i]->getHumidity()); Serial.println(F(" %"));
+    }
+  }
+
+  delay(250);
+}
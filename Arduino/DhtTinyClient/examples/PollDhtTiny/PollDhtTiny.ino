@@ -0,0 +1,75 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include <Wire.h>
+#include <DhtTinyClient.h>
+#include <DhtTinyWireTransport.h>
+
+// ***
+// *** Polls two DHT Tiny Breakouts on the same bus. Each
+// *** poll is a single read of the reading id; the
+// *** measurement block is only read when it has changed.
+// ***
+DhtTinyWireTransport _transport(Wire);
+DhtTinyClient _devices[] = { DhtTinyClient(_transport, 0x26), DhtTinyClient(_transport, 0x27) };
+
+#define DEVICE_COUNT (sizeof(_devices) / sizeof(_devices[0]))
+
+void setup()
+{
+  Serial.begin(115200);
+  Wire.begin();
+  Wire.setClock(400000);
+
+  // ***
+  // *** Give the DHT Tiny a chance to get initialized.
+  // ***
+  delay(2000);
+
+  for (uint8_t i = 0; i < DEVICE_COUNT; i++)
+  {
+    Serial.print(F("0x")); Serial.print(_devices[i].getAddress(), HEX);
+    if (_devices[i].begin())
+    {
+      Serial.print(F(" DHT")); Serial.print(_devices[i].getDhtModel());
+      Serial.print(F(" version ")); Serial.print(_devices[i].getVersionMajor());
+      Serial.print(F(".")); Serial.print(_devices[i].getVersionMinor());
+      Serial.print(F(" interval ")); Serial.println(_devices[i].getInterval());
+    }
+    else
+    {
+      Serial.println(F(" not found"));
+    }
+  }
+}
+
+void loop()
+{
+  for (uint8_t i = 0; i < DEVICE_COUNT; i++)
+  {
+    if (_devices[i].update() == DHTTINY_UPDATED)
+    {
+      Serial.print(F("0x")); Serial.print(_devices[i].getAddress(), HEX);
+      Serial.print(F(" #")); Serial.print(_devices[i].getReadingId());
+      Serial.print(F(" ")); Serial.print(_devices[i].getTemperature()); Serial.print(F(" C "));
+      Serial.print(_devices[i].getHumidity()); Serial.println(F(" %"));
+    }
+  }
+
+  delay(250);
+}
@@ -0,0 +1,337 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include "DhtTinyClient.h"
+
+// ***
+// *** The registers loaded into the cache by refresh(). The
+// *** breakout returns one register per read outside of the
+// *** measurement and aggregate blocks, so each is one read.
+// ***
+static const uint8_t _cachedRegisters[][2] =
+{
+    { REGISTER_ID, SIZE_UINT8 },
+    { REGISTER_VER_MAJOR, SIZE_UINT8 },
+    { REGISTER_VER_MINOR, SIZE_UINT8 },
+    { REGISTER_VER_BUILD, SIZE_UINT8 },
+    { REGISTER_INTERVAL, SIZE_UINT32 },
+    { REGISTER_UPPER_THRESHOLD, SIZE_FLOAT },
+    { REGISTER_LOWER_THRESHOLD, SIZE_FLOAT },
+    { REGISTER_START_DELAY, SIZE_UINT32 },
+    { REGISTER_CONFIG, SIZE_UINT8 },
+    { REGISTER_DEVICE_ADDRESS, SIZE_UINT8 },
+    { REGISTER_DHT_MODEL, SIZE_UINT8 },
+    { REGISTER_MIN_INTERVAL, SIZE_UINT32 },
+    { REGISTER_SLOPE_THRESHOLD, SIZE_FLOAT },
+    { REGISTER_AGGREGATE_WINDOW, SIZE_UINT32 }
+};
+
+// ***
+// *** Configuration bits the breakout clears once it has
+// *** acted on them.
+// ***
+#define CONFIG_SELF_CLEARING_BITS   ((1 << CONFIG_BIT_TRIGGER_READING) | (1 << CONFIG_BIT_WRITE_CONFIG) | (1 << CONFIG_BIT_RESET_CONFIG))
+
+#define MEASUREMENT_BLOCK_SIZE      ((MEASUREMENT_BLOCK_END) - (MEASUREMENT_BLOCK_START))
+#define DERIVED_BLOCK_SIZE          ((DERIVED_BLOCK_END) - (DERIVED_BLOCK_START))
+#define DERIVED_OFFSET(r)           ((r) - (DERIVED_BLOCK_START))
+#define CLOCK_BLOCK_SIZE            ((CLOCK_BLOCK_END) - (CLOCK_BLOCK_START))
+#define CLOCK_OFFSET(r)             ((r) - (CLOCK_BLOCK_START))
+
+DhtTinyClient::DhtTinyClient(DhtTinyTransport& transport, uint8_t address)
+    : _transport(transport), _address(address), _hasReading(false), _stale(true), _pec(false), _transactions(0), _pecErrors(0)
+{
+    memset(_registers, 0, sizeof(_registers));
+}
+
+bool DhtTinyClient::begin()
+{
+    _hasReading = false;
+    return refresh() && _registers[REGISTER_ID] == DHTTINY_ID;
+}
+
+bool DhtTinyClient::refresh()
+{
+    for (uint8_t i = 0; i < sizeof(_cachedRegisters) / sizeof(_cachedRegisters[0]); i++)
+    {
+        uint8_t registerId = _cachedRegisters[i][0];
+        if (!readRegisters(registerId, &_registers[registerId], _cachedRegisters[i][1]))
+        {
+            return false;
+        }
+    }
+
+    _stale = false;
+    _pec = getConfigBit(CONFIG_BIT_PEC_ENABLED);
+    return true;
+}
+
+int8_t DhtTinyClient::update()
+{
+    // ***
+    // *** A reset of the configuration is applied by the
+    // *** breakout after the write, so the cache is reloaded
+    // *** on the next update.
+    // ***
+    if (_stale && !refresh())
+    {
+        return DHTTINY_ERROR;
+    }
+
+    uint8_t readingId[SIZE_UINT32];
+    if (!readRegisters(REGISTER_READING_ID, readingId, SIZE_UINT32))
+    {
+        return DHTTINY_ERROR;
+    }
+
+    if (_hasReading && memcmp(readingId, &_registers[REGISTER_READING_ID], SIZE_UINT32) == 0)
+    {
+        return DHTTINY_UNCHANGED;
+    }
+
+    // ***
+    // *** A read from the start of the measurement block returns
+    // *** the whole block in one transaction.
+    // ***
+    if (!readRegisters(MEASUREMENT_BLOCK_START, &_registers[MEASUREMENT_BLOCK_START], MEASUREMENT_BLOCK_SIZE))
+    {
+        return DHTTINY_ERROR;
+    }
+
+    _hasReading = true;
+    return DHTTINY_UPDATED;
+}
+
+bool DhtTinyClient::setConfig(uint8_t value)
+{
+    if (!writeRegisters(REGISTER_CONFIG, &value, SIZE_UINT8))
+    {
+        return false;
+    }
+
+    _registers[REGISTER_CONFIG] = value & ~CONFIG_SELF_CLEARING_BITS;
+    _pec = getConfigBit(CONFIG_BIT_PEC_ENABLED);
+    if (value & (1 << CONFIG_BIT_RESET_CONFIG))
+    {
+        // ***
+        // *** The default configuration has PEC disabled.
+        // ***
+        _stale = true;
+        _pec = false;
+    }
+
+    return true;
+}
+
+bool DhtTinyClient::setConfigBit(uint8_t bit, bool value)
+{
+    uint8_t config = _registers[REGISTER_CONFIG];
+    config = value ? config | (1 << bit) : config & ~(1 << bit);
+    return setConfig(config);
+}
+
+bool DhtTinyClient::selectChannel(uint8_t channel)
+{
+    if (!writeRegisters(REGISTER_CHANNEL, &channel, SIZE_UINT8))
+    {
+        return false;
+    }
+
+    // ***
+    // *** The cache and the last reading belong to the
+    // *** bank that was selected before.
+    // ***
+    _stale = true;
+    _hasReading = false;
+    return true;
+}
+
+bool DhtTinyClient::readCurrentInterval(uint32_t& value)
+{
+    uint8_t buffer[SIZE_UINT32];
+    if (!readRegisters(REGISTER_CURRENT_INTERVAL, buffer, SIZE_UINT32))
+    {
+        return false;
+    }
+
+    memcpy(&value, buffer, SIZE_UINT32);
+    return true;
+}
+
+bool DhtTinyClient::readChannel(uint8_t& value)
+{
+    return readRegisters(REGISTER_CHANNEL, &value, SIZE_UINT8);
+}
+
+bool DhtTinyClient::readChannelCount(uint8_t& value)
+{
+    return readRegisters(REGISTER_CHANNEL_COUNT, &value, SIZE_UINT8);
+}
+
+bool DhtTinyClient::readFilterRejects(uint16_t& value)
+{
+    uint8_t buffer[SIZE_UINT16];
+    if (!readRegisters(REGISTER_FILTER_REJECTS, buffer, SIZE_UINT16))
+    {
+        return false;
+    }
+
+    memcpy(&value, buffer, SIZE_UINT16);
+    return true;
+}
+
+bool DhtTinyClient::readDerived(int16_t& dewPoint, uint16_t& absoluteHumidity, int16_t& heatIndex)
+{
+    uint8_t buffer[DERIVED_BLOCK_SIZE];
+    if (!readRegisters(DERIVED_BLOCK_START, buffer, DERIVED_BLOCK_SIZE))
+    {
+        return false;
+    }
+
+    memcpy(&dewPoint, &buffer[DERIVED_OFFSET(REGISTER_DEW_POINT)], SIZE_INT16);
+    memcpy(&absoluteHumidity, &buffer[DERIVED_OFFSET(REGISTER_ABSOLUTE_HUMIDITY)], SIZE_UINT16);
+    memcpy(&heatIndex, &buffer[DERIVED_OFFSET(REGISTER_HEAT_INDEX)], SIZE_INT16);
+    return true;
+}
+
+bool DhtTinyClient::readClockTime(uint8_t& idleShift, uint32_t& fullTime, uint32_t& idleTime)
+{
+    uint8_t buffer[CLOCK_BLOCK_SIZE];
+    if (!readRegisters(CLOCK_BLOCK_START, buffer, CLOCK_BLOCK_SIZE))
+    {
+        return false;
+    }
+
+    idleShift = buffer[CLOCK_OFFSET(REGISTER_CLOCK_IDLE_SHIFT)];
+    memcpy(&fullTime, &buffer[CLOCK_OFFSET(REGISTER_CLOCK_FULL_TIME)], SIZE_UINT32);
+    memcpy(&idleTime, &buffer[CLOCK_OFFSET(REGISTER_CLOCK_IDLE_TIME)], SIZE_UINT32);
+    return true;
+}
+
+bool DhtTinyClient::drainTrace(uint8_t* buffer)
+{
+    // ***
+    // *** The drain is one read; a PEC read of it fits in a
+    // *** single piece.
+    // ***
+    return readRegisters(REGISTER_TRACE, buffer, TRACE_DRAIN_SIZE);
+}
+
+bool DhtTinyClient::readLogBlockCount(uint8_t& value)
+{
+    return readRegisters(REGISTER_LOG_CONTROL, &value, SIZE_UINT8);
+}
+
+bool DhtTinyClient::drainLog(uint8_t* buffer)
+{
+    // ***
+    // *** Like the trace, the drain fits in a single PEC read.
+    // ***
+    return readRegisters(REGISTER_LOG_DATA, buffer, LOG_DRAIN_SIZE);
+}
+
+bool DhtTinyClient::readRegisters(uint8_t registerId, uint8_t* buffer, uint8_t count)
+{
+    if (!_pec)
+    {
+        _transactions++;
+        return _transport.read(_address, registerId, buffer, count);
+    }
+
+    // ***
+    // *** Each piece starts where the last one stopped.
+    // ***
+    for (uint8_t offset = 0; offset < count; offset += DHTTINY_PEC_CHUNK)
+    {
+        uint8_t chunk = (count - offset < DHTTINY_PEC_CHUNK) ? count - offset : DHTTINY_PEC_CHUNK;
+        if (!readPecRegisters(registerId + offset, &buffer[offset], chunk))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool DhtTinyClient::readPecRegisters(uint8_t registerId, uint8_t* buffer, uint8_t count)
+{
+    uint8_t command[3] = { PEC_READ_COMMAND, registerId, count };
+    uint8_t frame[DHTTINY_PEC_CHUNK + 1];
+
+    _transactions++;
+    if (!_transport.transfer(_address, command, sizeof(command), frame, count + 1))
+    {
+        return false;
+    }
+
+    uint8_t pec = DhtTinyPec::update(DHTTINY_PEC_INITIAL, DhtTinyPec::writeAddress(_address));
+    pec = DhtTinyPec::update(pec, command, sizeof(command));
+    pec = DhtTinyPec::update(pec, DhtTinyPec::readAddress(_address));
+    pec = DhtTinyPec::update(pec, frame, count);
+
+    if (pec != frame[count])
+    {
+        _pecErrors++;
+        return false;
+    }
+
+    memcpy(buffer, frame, count);
+    return true;
+}
+
+bool DhtTinyClient::writeRegisters(uint8_t registerId, const uint8_t* buffer, uint8_t count)
+{
+    bool written = false;
+
+    _transactions++;
+    if (_pec)
+    {
+        if (count > DHTTINY_PEC_CHUNK)
+        {
+            return false;
+        }
+
+        uint8_t frame[DHTTINY_PEC_CHUNK + 1];
+        memcpy(frame, buffer, count);
+
+        uint8_t pec = DhtTinyPec::update(DHTTINY_PEC_INITIAL, DhtTinyPec::writeAddress(_address));
+        pec = DhtTinyPec::update(pec, registerId);
+        frame[count] = DhtTinyPec::update(pec, buffer, count);
+
+        written = _transport.write(_address, registerId, frame, count + 1);
+    }
+    else
+    {
+        written = _transport.write(_address, registerId, buffer, count);
+    }
+
+    if (!written)
+    {
+        return false;
+    }
+
+    // ***
+    // *** Write through to the cache.
+    // ***
+    if (registerId + count <= DHTTINY_CACHE_SIZE)
+    {
+        memcpy(&_registers[registerId], buffer, count);
+    }
+
+    return true;
+}
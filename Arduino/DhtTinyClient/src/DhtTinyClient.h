@@ -0,0 +1,239 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef DHT_TINY_CLIENT_H
+#define DHT_TINY_CLIENT_H
+
+#include <stdint.h>
+#include <string.h>
+#include "DhtTinyRegisters.h"
+#include "DhtTinyTransport.h"
+#include "DhtTinyPec.h"
+
+// ***
+// *** Results of DhtTinyClient::update().
+// ***
+#define DHTTINY_UPDATED             1
+#define DHTTINY_UNCHANGED           0
+#define DHTTINY_ERROR               -1
+
+// ***
+// *** The client mirrors the registers from the ID through the
+// *** aggregate window. Registers past it are read on demand.
+// ***
+#define DHTTINY_CACHE_SIZE          REGISTER_AGGREGATE_COUNT
+#define DHTTINY_ID                  0x2D
+
+// ***
+// *** PEC reads longer than this are made in pieces so each one,
+// *** with its PEC, fits the 32 byte buffer of the Wire library.
+// ***
+#define DHTTINY_PEC_CHUNK           31
+
+// ***
+// *** Master side client for one DHT Tiny Breakout. Any number of
+// *** clients can share a transport.
+// ***
+// *** The identity and configuration registers are read once by
+// *** begin() and kept in a cache; setters write through to the
+// *** device and the cache. update() reads the reading id and
+// *** only fetches the measurement block when it has advanced, so
+// *** polling a breakout with no new reading is a single 4 byte
+// *** read. Values are stored in the byte order of the breakout,
+// *** which is little endian like the hosts this builds for.
+// ***
+class DhtTinyClient
+{
+public:
+    DhtTinyClient(DhtTinyTransport& transport, uint8_t address);
+
+    uint8_t getAddress() const { return _address; };
+
+    // ***
+    // *** Checks the device id and loads the configuration cache.
+    // ***
+    bool begin();
+
+    // ***
+    // *** Reloads the configuration cache from the device.
+    // ***
+    bool refresh();
+
+    // ***
+    // *** Returns DHTTINY_UPDATED when a new reading was fetched,
+    // *** DHTTINY_UNCHANGED when the reading id has not moved
+    // *** and DHTTINY_ERROR when the device did not respond.
+    // ***
+    int8_t update();
+
+    // ***
+    // *** The last reading fetched by update().
+    // ***
+    bool hasReading() const { return _hasReading; };
+    float getTemperature() const { return getRegister<float>(REGISTER_TEMPERATURE); };
+    float getHumidity() const { return getRegister<float>(REGISTER_HUMIDITY); };
+    uint8_t getStatus() const { return _registers[REGISTER_STATUS]; };
+    bool getStatusBit(uint8_t bit) const { return (_registers[REGISTER_STATUS] >> bit) & 1; };
+    uint32_t getReadingId() const { return getRegister<uint32_t>(REGISTER_READING_ID); };
+    uint32_t getReadingTime() const { return getRegister<uint32_t>(REGISTER_READING_TIME); };
+    uint32_t getReadingAge() const { return getRegister<uint32_t>(REGISTER_READING_AGE); };
+
+    // ***
+    // *** Cached identity.
+    // ***
+    uint8_t getVersionMajor() const { return _registers[REGISTER_VER_MAJOR]; };
+    uint8_t getVersionMinor() const { return _registers[REGISTER_VER_MINOR]; };
+    uint8_t getVersionBuild() const { return _registers[REGISTER_VER_BUILD]; };
+
+    // ***
+    // *** Cached configuration.
+    // ***
+    uint32_t getInterval() const { return getRegister<uint32_t>(REGISTER_INTERVAL); };
+    bool setInterval(uint32_t value) { return setRegister(REGISTER_INTERVAL, value); };
+    float getUpperThreshold() const { return getRegister<float>(REGISTER_UPPER_THRESHOLD); };
+    bool setUpperThreshold(float value) { return setRegister(REGISTER_UPPER_THRESHOLD, value); };
+    float getLowerThreshold() const { return getRegister<float>(REGISTER_LOWER_THRESHOLD); };
+    bool setLowerThreshold(float value) { return setRegister(REGISTER_LOWER_THRESHOLD, value); };
+    uint32_t getStartDelay() const { return getRegister<uint32_t>(REGISTER_START_DELAY); };
+    bool setStartDelay(uint32_t value) { return setRegister(REGISTER_START_DELAY, value); };
+    uint8_t getConfig() const { return _registers[REGISTER_CONFIG]; };
+    bool setConfig(uint8_t value);
+    bool getConfigBit(uint8_t bit) const { return (_registers[REGISTER_CONFIG] >> bit) & 1; };
+    bool setConfigBit(uint8_t bit, bool value);
+    uint8_t getDeviceAddress() const { return _registers[REGISTER_DEVICE_ADDRESS]; };
+    bool setDeviceAddress(uint8_t value) { return setRegister(REGISTER_DEVICE_ADDRESS, value); };
+    uint8_t getDhtModel() const { return _registers[REGISTER_DHT_MODEL]; };
+    bool setDhtModel(uint8_t value) { return setRegister(REGISTER_DHT_MODEL, value); };
+    uint32_t getMinInterval() const { return getRegister<uint32_t>(REGISTER_MIN_INTERVAL); };
+    bool setMinInterval(uint32_t value) { return setRegister(REGISTER_MIN_INTERVAL, value); };
+    float getSlopeThreshold() const { return getRegister<float>(REGISTER_SLOPE_THRESHOLD); };
+    bool setSlopeThreshold(float value) { return setRegister(REGISTER_SLOPE_THRESHOLD, value); };
+    uint32_t getAggregateWindow() const { return getRegister<uint32_t>(REGISTER_AGGREGATE_WINDOW); };
+    bool setAggregateWindow(uint32_t value) { return setRegister(REGISTER_AGGREGATE_WINDOW, value); };
+    bool ackAggregate() { return setRegister(REGISTER_AGGREGATE_CONTROL, (uint8_t)AGGREGATE_COMMAND_ACK); };
+
+    // ***
+    // *** Outlier filter settings. These are past the end of the
+    // *** cache and are written straight to the device.
+    // ***
+    bool setFilterMode(uint8_t value) { return setRegister(REGISTER_FILTER_MODE, value); };
+    bool setTemperatureSlew(uint16_t value) { return setRegister(REGISTER_TEMPERATURE_SLEW, value); };
+    bool setHumiditySlew(uint16_t value) { return setRegister(REGISTER_HUMIDITY_SLEW, value); };
+
+    // ***
+    // *** Calibration applied by the device before a reading is
+    // *** committed: value * gain / CALIBRATION_GAIN_ONE + offset,
+    // *** with the offset in tenths. Also written straight through.
+    // ***
+    bool setTemperatureCalibration(int16_t offset, uint16_t gain) { return setRegister(REGISTER_TEMPERATURE_OFFSET, offset) && setRegister(REGISTER_TEMPERATURE_GAIN, gain); };
+    bool setHumidityCalibration(int16_t offset, uint16_t gain) { return setRegister(REGISTER_HUMIDITY_OFFSET, offset) && setRegister(REGISTER_HUMIDITY_GAIN, gain); };
+
+    // ***
+    // *** A breakout with more than one sensor keeps a bank of
+    // *** registers per channel. Reads and writes go to the bank
+    // *** of the selected channel; selecting another one reloads
+    // *** the cache from its bank on the next update().
+    // ***
+    bool selectChannel(uint8_t channel);
+
+    // ***
+    // *** Registers that change on the device are not cached.
+    // ***
+    bool readCurrentInterval(uint32_t& value);
+    bool readFilterRejects(uint16_t& value);
+    bool readChannel(uint8_t& value);
+    bool readChannelCount(uint8_t& value);
+
+    // ***
+    // *** The derived block in one read: dew point and heat index
+    // *** in tenths of a degree, absolute humidity in hundredths
+    // *** of a g/m^3.
+    // ***
+    bool readDerived(int16_t& dewPoint, uint16_t& absoluteHumidity, int16_t& heatIndex);
+
+    // ***
+    // *** Reads up to TRACE_DRAIN_ENTRIES entries from the trace
+    // *** ring of the device. buffer receives TRACE_DRAIN_SIZE bytes
+    // *** laid out as described in DhtTinyRegisters.h. ackTrace()
+    // *** removes them; until then each drain returns them again.
+    // ***
+    bool drainTrace(uint8_t* buffer);
+    bool ackTrace() { return setRegister(REGISTER_TRACE, (uint8_t)TRACE_COMMAND_ACK); };
+
+    // ***
+    // *** The clock block in one read: the idle clock is F_CPU >>
+    // *** idleShift (0 when the breakout does not scale its clock)
+    // *** and the times, in milliseconds, spent at each clock.
+    // ***
+    bool readClockTime(uint8_t& idleShift, uint32_t& fullTime, uint32_t& idleTime);
+
+    // ***
+    // *** The spill log. drainLog() reads the oldest block not read
+    // *** since the last ackLog() into buffer (LOG_DRAIN_SIZE bytes,
+    // *** see DhtTinyRegisters.h); ackLog() erases the blocks read,
+    // *** rewindLog() reads them again. The decimation belongs to
+    // *** the selected channel and 0 turns its log off.
+    // ***
+    bool setLogDecimation(uint8_t value) { return setRegister(REGISTER_LOG_DECIMATION, value); };
+    bool readLogBlockCount(uint8_t& value);
+    bool drainLog(uint8_t* buffer);
+    bool ackLog() { return setRegister(REGISTER_LOG_CONTROL, (uint8_t)LOG_COMMAND_ACK); };
+    bool rewindLog() { return setRegister(REGISTER_LOG_CONTROL, (uint8_t)LOG_COMMAND_REWIND); };
+    bool clearLog() { return setRegister(REGISTER_LOG_CONTROL, (uint8_t)LOG_COMMAND_CLEAR); };
+    bool readRegisters(uint8_t registerId, uint8_t* buffer, uint8_t count);
+
+    // ***
+    // *** Number of bus transactions made by this client.
+    // ***
+    uint32_t getTransactionCount() const { return _transactions; };
+
+    // ***
+    // *** Every transfer carries a PEC while the configuration last
+    // *** read from or written to the device has CONFIG_BIT_PEC_ENABLED
+    // *** set. A read whose PEC does not match fails and is counted.
+    // ***
+    bool isPecEnabled() const { return _pec; };
+    uint32_t getPecErrorCount() const { return _pecErrors; };
+
+private:
+    template <typename T> T getRegister(uint8_t registerId) const
+    {
+        T value;
+        memcpy(&value, &_registers[registerId], sizeof(T));
+        return value;
+    }
+
+    template <typename T> bool setRegister(uint8_t registerId, T value)
+    {
+        return writeRegisters(registerId, (const uint8_t*)&value, sizeof(T));
+    }
+
+    bool writeRegisters(uint8_t registerId, const uint8_t* buffer, uint8_t count);
+    bool readPecRegisters(uint8_t registerId, uint8_t* buffer, uint8_t count);
+
+    DhtTinyTransport& _transport;
+    uint8_t _address;
+    bool _hasReading;
+    bool _stale;
+    bool _pec;
+    uint32_t _transactions;
+    uint32_t _pecErrors;
+    uint8_t _registers[DHTTINY_CACHE_SIZE];
+};
+
+#endif
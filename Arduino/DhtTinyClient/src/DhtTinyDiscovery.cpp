@@ -0,0 +1,200 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include "DhtTinyDiscovery.h"
+
+#include <string.h>
+
+DhtTinyDiscovery::DhtTinyDiscovery(DhtTinyTransport& transport)
+    : _transport(transport), _addresses(0), _serials(0), _maxCount(0), _count(0), _transactions(0)
+{
+    memset(_select, 0, sizeof(_select));
+}
+
+uint8_t DhtTinyDiscovery::findAll(uint8_t* addresses, uint32_t* serials, uint8_t maxCount, bool configured)
+{
+    _addresses = addresses;
+    _serials = serials;
+    _maxCount = maxCount;
+    _count = 0;
+    _transactions = 0;
+
+    // ***
+    // *** The breakouts taking part move to the setup address.
+    // ***
+    uint8_t command = configured ? ENUM_START_ALL : ENUM_START;
+    write(DHTTINY_GENERAL_CALL, REGISTER_ENUM_CONTROL, &command, SIZE_UINT8);
+    _transport.wait(DHTTINY_SETTLE_TIME * DHTTINY_SETTLE_RETRIES);
+
+    search(0);
+
+    // ***
+    // *** The breakouts that could not keep their address are
+    // *** placed once the addresses kept are all known.
+    // ***
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if (_addresses[i] == 0)
+        {
+            uint8_t address = getFreeAddress();
+            memcpy(&_select[1], &_serials[i], SIZE_UINT32);
+
+            if (address != 0 && select(SIZE_UINT32))
+            {
+                assign(i, address);
+            }
+        }
+    }
+
+    // ***
+    // *** Any breakout still taking part, such as one past
+    // *** maxCount, goes back to its own address.
+    // ***
+    command = ENUM_END;
+    write(DHTTINY_GENERAL_CALL, REGISTER_ENUM_CONTROL, &command, SIZE_UINT8);
+    _transport.wait(DHTTINY_SETTLE_TIME * DHTTINY_SETTLE_RETRIES);
+
+    return _count;
+}
+
+void DhtTinyDiscovery::search(uint8_t depth)
+{
+    uint8_t bitmap[ENUM_BITMAP_SIZE];
+
+    if (!select(depth) || !read(DHTTINY_SETUP_ADDRESS, REGISTER_ENUM_CONTROL, bitmap, ENUM_BITMAP_SIZE))
+    {
+        return;
+    }
+
+    for (uint16_t value = 0; value < 256 && _count < _maxCount; value++)
+    {
+        // ***
+        // *** A cleared bit is the next byte of the serial
+        // *** number of at least one selected breakout.
+        // ***
+        if ((bitmap[value >> 3] & (1 << (value & 7))) == 0)
+        {
+            _select[1 + depth] = value;
+
+            if (depth + 1 < SIZE_UINT32)
+            {
+                search(depth + 1);
+            }
+            else if (select(SIZE_UINT32))
+            {
+                found();
+            }
+        }
+    }
+}
+
+void DhtTinyDiscovery::found()
+{
+    uint8_t index = _count++;
+    uint8_t address = 0;
+
+    memcpy(&_serials[index], &_select[1], SIZE_UINT32);
+    _addresses[index] = 0;
+
+    // ***
+    // *** Only the selected breakout answers, with the
+    // *** address it had before the enumeration.
+    // ***
+    if (read(DHTTINY_SETUP_ADDRESS, REGISTER_DEVICE_ADDRESS, &address, SIZE_UINT8) &&
+        address >= DHTTINY_FIRST_ADDRESS && address <= DHTTINY_LAST_ADDRESS &&
+        address != DHTTINY_SETUP_ADDRESS && !isUsed(address))
+    {
+        assign(index, address);
+    }
+}
+
+bool DhtTinyDiscovery::select(uint8_t depth)
+{
+    _select[0] = depth;
+    return write(DHTTINY_SETUP_ADDRESS, REGISTER_ENUM_SELECT, _select, ENUM_SELECT_SIZE);
+}
+
+bool DhtTinyDiscovery::assign(uint8_t index, uint8_t address)
+{
+    if (!write(DHTTINY_SETUP_ADDRESS, REGISTER_ENUM_ASSIGN, &address, SIZE_UINT8))
+    {
+        return false;
+    }
+
+    // ***
+    // *** The breakout has moved once its serial
+    // *** number can be read at the new address.
+    // ***
+    for (uint8_t i = 0; i < DHTTINY_SETTLE_RETRIES; i++)
+    {
+        uint32_t serial = 0;
+        _transport.wait(DHTTINY_SETTLE_TIME);
+
+        if (read(address, REGISTER_SERIAL, (uint8_t*)&serial, SIZE_UINT32) && serial == _serials[index])
+        {
+            _addresses[index] = address;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool DhtTinyDiscovery::isUsed(uint8_t address) const
+{
+    for (uint8_t i = 0; i < _count; i++)
+    {
+        if (_addresses[i] == address)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+uint8_t DhtTinyDiscovery::getFreeAddress()
+{
+    for (uint8_t address = DHTTINY_FIRST_ADDRESS; address <= DHTTINY_LAST_ADDRESS; address++)
+    {
+        uint8_t id;
+
+        // ***
+        // *** An address that something other than a
+        // *** breakout answers on is not free either.
+        // ***
+        if (address != DHTTINY_SETUP_ADDRESS && !isUsed(address) && !read(address, REGISTER_ID, &id, SIZE_UINT8))
+        {
+            return address;
+        }
+    }
+
+    return 0;
+}
+
+bool DhtTinyDiscovery::read(uint8_t address, uint8_t registerId, uint8_t* buffer, uint8_t count)
+{
+    _transactions++;
+    return _transport.read(address, registerId, buffer, count);
+}
+
+bool DhtTinyDiscovery::write(uint8_t address, uint8_t registerId, const uint8_t* buffer, uint8_t count)
+{
+    _transactions++;
+    return _transport.write(address, registerId, buffer, count);
+}
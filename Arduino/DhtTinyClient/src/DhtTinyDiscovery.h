@@ -0,0 +1,100 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef DHT_TINY_DISCOVERY_H
+#define DHT_TINY_DISCOVERY_H
+
+#include <stdint.h>
+#include "DhtTinyRegisters.h"
+#include "DhtTinyTransport.h"
+
+// ***
+// *** Every breakout moves to the setup address during an
+// *** enumeration. It is also the address a factory fresh
+// *** breakout starts at, so it is never assigned.
+// ***
+#define DHTTINY_SETUP_ADDRESS       0x26
+#define DHTTINY_GENERAL_CALL        0x00
+#define DHTTINY_FIRST_ADDRESS       0x08
+#define DHTTINY_LAST_ADDRESS        0x77
+
+// ***
+// *** Time given to the breakouts to move to a new address. A
+// *** breakout reading its sensor acts on the write when it is
+// *** done, so a move is checked a few times.
+// ***
+#define DHTTINY_SETTLE_TIME         10
+#define DHTTINY_SETTLE_RETRIES      10
+
+// ***
+// *** Finds the DHT Tiny Breakouts on a bus with the enumeration
+// *** protocol of the firmware (see Enumeration.h in the breakout
+// *** sketch) rather than a sweep of the address range.
+// ***
+// *** All of the breakouts move to the setup address and the
+// *** master walks their serial numbers a byte at a time; each
+// *** step is a write of the prefix and a 32 byte read of the
+// *** bit map of the next byte, so finding N breakouts takes
+// *** about 12 N transactions however the addresses are spread.
+// ***
+// *** Only breakouts still at the setup address take part unless
+// *** configured is given, in which case every breakout does. A
+// *** breakout keeps its own address unless another breakout
+// *** found has it or it is the setup address. Those breakouts
+// *** are given the lowest address nothing answers on once the
+// *** others are placed.
+// ***
+class DhtTinyDiscovery
+{
+public:
+    DhtTinyDiscovery(DhtTinyTransport& transport);
+
+    // ***
+    // *** Finds up to maxCount breakouts and returns the number
+    // *** found. The address and serial number of each are written
+    // *** to addresses and serials; an address of 0 means the
+    // *** breakout did not answer at the address it was given.
+    // ***
+    uint8_t findAll(uint8_t* addresses, uint32_t* serials, uint8_t maxCount, bool configured = false);
+
+    // ***
+    // *** Number of bus transactions made by the last findAll().
+    // ***
+    uint32_t getTransactionCount() const { return _transactions; };
+
+private:
+    void search(uint8_t depth);
+    void found();
+    bool select(uint8_t depth);
+    bool assign(uint8_t index, uint8_t address);
+    bool isUsed(uint8_t address) const;
+    uint8_t getFreeAddress();
+
+    bool read(uint8_t address, uint8_t registerId, uint8_t* buffer, uint8_t count);
+    bool write(uint8_t address, uint8_t registerId, const uint8_t* buffer, uint8_t count);
+
+    DhtTinyTransport& _transport;
+    uint8_t* _addresses;
+    uint32_t* _serials;
+    uint8_t _maxCount;
+    uint8_t _count;
+    uint8_t _select[ENUM_SELECT_SIZE];
+    uint32_t _transactions;
+};
+
+#endif
@@ -0,0 +1,116 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include "DhtTinyLog.h"
+
+int8_t DhtTinyLog::decode(const uint8_t* drain, DhtTinyLogRecord* records)
+{
+    if ((drain[0] & (LOG_ENABLED | LOG_BLOCK_VALID)) != (LOG_ENABLED | LOG_BLOCK_VALID))
+    {
+        return -1;
+    }
+
+    const uint8_t* data = &drain[LOG_HEADER_SIZE];
+    const uint8_t size = LOG_BLOCK_SIZE - 1;
+
+    // ***
+    // *** The last record of each channel, which a delta record
+    // *** continues from, and of the block, which a short record
+    // *** continues from with the same interval.
+    // ***
+    DhtTinyLogRecord last[DHTTINY_LOG_CHANNELS];
+    uint32_t interval[DHTTINY_LOG_CHANNELS];
+    uint64_t keyed = 0;
+    uint8_t channel = 0;
+    uint8_t count = 0;
+    uint8_t offset = 0;
+
+    while (offset < size && data[offset] != LOG_END)
+    {
+        uint8_t header = data[offset++];
+        uint32_t time = 0;
+        uint32_t temperature = 0;
+        uint32_t humidity = 0;
+
+        if (header < LOG_RECORD_DELTA)
+        {
+            if (count == 0)
+            {
+                return -1;
+            }
+
+            last[channel].time += interval[channel];
+            last[channel].temperature += getZigzag(header >> LOG_SHORT_TEMPERATURE_SHIFT);
+            last[channel].humidity += getZigzag(header & LOG_SHORT_HUMIDITY_MASK);
+        }
+        else
+        {
+            channel = header & LOG_RECORD_CHANNEL_MASK;
+
+            if (!getVarint(data, size, offset, time) ||
+                !getVarint(data, size, offset, temperature) ||
+                !getVarint(data, size, offset, humidity))
+            {
+                return -1;
+            }
+
+            if ((header & LOG_RECORD_TYPE_MASK) == LOG_RECORD_KEY)
+            {
+                keyed |= (uint64_t)1 << channel;
+                interval[channel] = 0;
+                last[channel].channel = channel;
+                last[channel].time = time;
+                last[channel].temperature = getZigzag(temperature);
+                last[channel].humidity = getZigzag(humidity);
+            }
+            else if (keyed & ((uint64_t)1 << channel))
+            {
+                interval[channel] = time;
+                last[channel].time += time;
+                last[channel].temperature += getZigzag(temperature);
+                last[channel].humidity += getZigzag(humidity);
+            }
+            else
+            {
+                return -1;
+            }
+        }
+
+        records[count++] = last[channel];
+    }
+
+    return count;
+}
+
+bool DhtTinyLog::getVarint(const uint8_t* data, uint8_t size, uint8_t& offset, uint32_t& value)
+{
+    value = 0;
+
+    for (uint8_t shift = 0; shift < 35 && offset < size; shift += 7)
+    {
+        uint8_t byte = data[offset++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
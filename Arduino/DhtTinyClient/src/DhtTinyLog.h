@@ -0,0 +1,67 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef DHT_TINY_LOG_H
+#define DHT_TINY_LOG_H
+
+#include <stdint.h>
+#include "DhtTinyRegisters.h"
+
+// ***
+// *** The records a block of the spill log can hold and the
+// *** channels a key record can name.
+// ***
+#define DHTTINY_LOG_RECORDS         ((LOG_BLOCK_SIZE) - 1)
+#define DHTTINY_LOG_CHANNELS        (LOG_RECORD_CHANNEL_MASK + 1)
+
+// ***
+// *** A reading from the spill log. The time is in whole seconds
+// *** of the uptime of the breakout when it was logged; values
+// *** are in tenths.
+// ***
+struct DhtTinyLogRecord
+{
+    uint8_t channel;
+    uint32_t time;
+    int16_t temperature;
+    int16_t humidity;
+};
+
+// ***
+// *** Decodes the records of one block of the spill log (see
+// *** SpillLog.h in the breakout sketch). Each block starts every
+// *** channel in it with a key record, so a block is decoded on
+// *** its own.
+// ***
+class DhtTinyLog
+{
+public:
+    // ***
+    // *** Decodes the records that follow the header of a drain
+    // *** into records, which has room for DHTTINY_LOG_RECORDS.
+    // *** Returns the number decoded or -1 when the block is not
+    // *** valid.
+    // ***
+    static int8_t decode(const uint8_t* drain, DhtTinyLogRecord* records);
+
+private:
+    static bool getVarint(const uint8_t* data, uint8_t size, uint8_t& offset, uint32_t& value);
+    static int16_t getZigzag(uint32_t value) { return (int16_t)((value >> 1) ^ (0 - (value & 1))); };
+};
+
+#endif
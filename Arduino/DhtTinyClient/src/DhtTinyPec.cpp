@@ -0,0 +1,41 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include "DhtTinyPec.h"
+
+uint8_t DhtTinyPec::update(uint8_t pec, uint8_t value)
+{
+    pec ^= value;
+
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        pec = (pec & 0x80) ? (pec << 1) ^ DHTTINY_PEC_POLYNOMIAL : pec << 1;
+    }
+
+    return pec;
+}
+
+uint8_t DhtTinyPec::update(uint8_t pec, const uint8_t* buffer, uint8_t count)
+{
+    for (uint8_t i = 0; i < count; i++)
+    {
+        pec = update(pec, buffer[i]);
+    }
+
+    return pec;
+}
@@ -0,0 +1,49 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef DHT_TINY_PEC_H
+#define DHT_TINY_PEC_H
+
+#include <stdint.h>
+
+// ***
+// *** The SMBus packet error code the breakout checks and sends
+// *** once CONFIG_BIT_PEC_ENABLED is set: a CRC-8 with the
+// *** polynomial x^8 + x^2 + x + 1 and an initial value of 0.
+// ***
+// *** A write is followed by the PEC of the address (with the
+// *** write bit), the register and the data. A PEC read sends
+// *** PEC_READ_COMMAND, the register and a byte count and gets
+// *** that many bytes back followed by the PEC of the address,
+// *** those three bytes, the address (with the read bit) and the
+// *** data.
+// ***
+#define DHTTINY_PEC_INITIAL         0x00
+#define DHTTINY_PEC_POLYNOMIAL      0x07
+
+class DhtTinyPec
+{
+public:
+    static uint8_t update(uint8_t pec, uint8_t value);
+    static uint8_t update(uint8_t pec, const uint8_t* buffer, uint8_t count);
+
+    static uint8_t writeAddress(uint8_t address) { return address << 1; };
+    static uint8_t readAddress(uint8_t address) { return (address << 1) | 1; };
+};
+
+#endif
@@ -0,0 +1,305 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef DHT_TINY_REGISTERS_H
+#define DHT_TINY_REGISTERS_H
+
+// ***
+// *** Register map of the DHT Tiny Breakout for masters. This
+// *** mirrors Arduino/DHT_Tiny_Breakout/Register_Defs.h and must be
+// *** kept in step with it.
+// ***
+#ifndef SIZE_FLOAT
+#define SIZE_FLOAT    4
+#define SIZE_INT8     1
+#define SIZE_UINT8    1
+#define SIZE_INT16    2
+#define SIZE_UINT16   2
+#define SIZE_INT32    4
+#define SIZE_UINT32   4
+#endif
+
+// ***
+// *** Size of the raw frame capture. A DHT frame is 40 bits
+// *** (5 bytes) and the width of the high phase of each bit,
+// *** which decides it, is kept as its pulse width.
+// ***
+#define CAPTURE_FRAME_SIZE          5
+#define CAPTURE_PULSE_COUNT         40
+
+// ***
+// *** Enumeration. The select register holds a depth followed by
+// *** a serial number prefix, and a read of the control register
+// *** returns a 256 bit map of the next serial byte of the selected
+// *** devices. See DhtTinyDiscovery.h.
+// ***
+#define ENUM_SELECT_SIZE            5
+#define ENUM_BITMAP_SIZE            32
+#define ENUM_START                  1
+#define ENUM_END                    2
+#define ENUM_START_ALL              3
+// ***
+// *** Address of each variable
+// *** within the registers.
+// ***
+#define REGISTER_ID                 0                                          // *** uint8
+#define REGISTER_VER_MAJOR          REGISTER_ID               + SIZE_UINT8     // *** uint8
+#define REGISTER_VER_MINOR          REGISTER_VER_MAJOR        + SIZE_UINT8     // *** uint8
+#define REGISTER_VER_BUILD          REGISTER_VER_MINOR        + SIZE_UINT8     // *** uint8
+#define REGISTER_TEMPERATURE        REGISTER_VER_BUILD        + SIZE_UINT8     // *** float
+#define REGISTER_HUMIDITY           REGISTER_TEMPERATURE      + SIZE_FLOAT     // *** float
+#define REGISTER_STATUS             REGISTER_HUMIDITY         + SIZE_FLOAT     // *** uint8
+#define REGISTER_READING_ID         REGISTER_STATUS           + SIZE_UINT8     // *** uint32
+#define REGISTER_READING_TIME       REGISTER_READING_ID       + SIZE_UINT32    // *** uint32
+#define REGISTER_READING_AGE        REGISTER_READING_TIME     + SIZE_UINT32    // *** uint32
+#define REGISTER_INTERVAL           REGISTER_READING_AGE      + SIZE_UINT32    // *** uint32
+#define REGISTER_UPPER_THRESHOLD    REGISTER_INTERVAL         + SIZE_UINT32    // *** float
+#define REGISTER_LOWER_THRESHOLD    REGISTER_UPPER_THRESHOLD  + SIZE_FLOAT     // *** float
+#define REGISTER_START_DELAY        REGISTER_LOWER_THRESHOLD  + SIZE_FLOAT     // *** uint32
+#define REGISTER_CONFIG             REGISTER_START_DELAY      + SIZE_UINT32    // *** uint8
+#define REGISTER_DEVICE_ADDRESS     REGISTER_CONFIG           + SIZE_UINT8     // *** uint8
+#define REGISTER_DHT_MODEL          REGISTER_DEVICE_ADDRESS   + SIZE_UINT8     // *** uint8
+#define REGISTER_MIN_INTERVAL       REGISTER_DHT_MODEL        + SIZE_UINT8     // *** uint32
+#define REGISTER_SLOPE_THRESHOLD    REGISTER_MIN_INTERVAL     + SIZE_UINT32    // *** float
+#define REGISTER_CURRENT_INTERVAL   REGISTER_SLOPE_THRESHOLD  + SIZE_FLOAT     // *** uint32
+#define REGISTER_AGGREGATE_WINDOW   REGISTER_CURRENT_INTERVAL + SIZE_UINT32    // *** uint32
+#define REGISTER_AGGREGATE_COUNT    REGISTER_AGGREGATE_WINDOW + SIZE_UINT32    // *** uint16
+#define REGISTER_TEMPERATURE_MIN    REGISTER_AGGREGATE_COUNT  + SIZE_UINT16    // *** int16
+#define REGISTER_TEMPERATURE_MAX    REGISTER_TEMPERATURE_MIN  + SIZE_INT16     // *** int16
+#define REGISTER_TEMPERATURE_MEAN   REGISTER_TEMPERATURE_MAX  + SIZE_INT16     // *** int16
+#define REGISTER_HUMIDITY_MIN       REGISTER_TEMPERATURE_MEAN + SIZE_INT16     // *** int16
+#define REGISTER_HUMIDITY_MAX       REGISTER_HUMIDITY_MIN     + SIZE_INT16     // *** int16
+#define REGISTER_HUMIDITY_MEAN      REGISTER_HUMIDITY_MAX     + SIZE_INT16     // *** int16
+#define REGISTER_CAPTURE_RESULT     REGISTER_HUMIDITY_MEAN    + SIZE_INT16     // *** int8
+#define REGISTER_CAPTURE_TIMEOUT    REGISTER_CAPTURE_RESULT   + SIZE_INT8      // *** uint16
+#define REGISTER_CAPTURE_SHIFT      REGISTER_CAPTURE_TIMEOUT  + SIZE_UINT16    // *** uint8
+#define REGISTER_CAPTURE_FRAME      REGISTER_CAPTURE_SHIFT    + SIZE_UINT8     // *** uint8[5]
+#define REGISTER_CAPTURE_PULSES     REGISTER_CAPTURE_FRAME    + CAPTURE_FRAME_SIZE  // *** uint8[40]
+#define REGISTER_SERIAL             REGISTER_CAPTURE_PULSES   + CAPTURE_PULSE_COUNT // *** uint32
+#define REGISTER_ENUM_CONTROL       REGISTER_SERIAL           + SIZE_UINT32    // *** uint8
+#define REGISTER_ENUM_SELECT        REGISTER_ENUM_CONTROL     + SIZE_UINT8     // *** uint8[5]
+#define REGISTER_ENUM_ASSIGN        REGISTER_ENUM_SELECT      + ENUM_SELECT_SIZE    // *** uint8
+#define REGISTER_FILTER_MODE        REGISTER_ENUM_ASSIGN      + SIZE_UINT8     // *** uint8
+#define REGISTER_TEMPERATURE_SLEW   REGISTER_FILTER_MODE      + SIZE_UINT8     // *** uint16
+#define REGISTER_HUMIDITY_SLEW      REGISTER_TEMPERATURE_SLEW + SIZE_UINT16    // *** uint16
+#define REGISTER_FILTER_REJECTS     REGISTER_HUMIDITY_SLEW    + SIZE_UINT16    // *** uint16
+#define REGISTER_TEMPERATURE_OFFSET REGISTER_FILTER_REJECTS   + SIZE_UINT16    // *** int16
+#define REGISTER_TEMPERATURE_GAIN   REGISTER_TEMPERATURE_OFFSET + SIZE_INT16   // *** uint16
+#define REGISTER_HUMIDITY_OFFSET    REGISTER_TEMPERATURE_GAIN + SIZE_UINT16    // *** int16
+#define REGISTER_HUMIDITY_GAIN      REGISTER_HUMIDITY_OFFSET  + SIZE_INT16     // *** uint16
+#define REGISTER_DEW_POINT          REGISTER_HUMIDITY_GAIN    + SIZE_UINT16    // *** int16
+#define REGISTER_ABSOLUTE_HUMIDITY  REGISTER_DEW_POINT        + SIZE_INT16     // *** uint16
+#define REGISTER_HEAT_INDEX         REGISTER_ABSOLUTE_HUMIDITY + SIZE_UINT16   // *** int16
+#define REGISTER_CHANNEL            REGISTER_HEAT_INDEX       + SIZE_INT16     // *** uint8
+#define REGISTER_CHANNEL_COUNT      REGISTER_CHANNEL          + SIZE_UINT8     // *** uint8
+#define REGISTER_TRACE              REGISTER_CHANNEL_COUNT    + SIZE_UINT8     // *** uint8
+#define REGISTER_CLOCK_IDLE_SHIFT   REGISTER_TRACE            + SIZE_UINT8     // *** uint8
+#define REGISTER_CLOCK_FULL_TIME    REGISTER_CLOCK_IDLE_SHIFT + SIZE_UINT8     // *** uint32
+#define REGISTER_CLOCK_IDLE_TIME    REGISTER_CLOCK_FULL_TIME  + SIZE_UINT32    // *** uint32
+#define REGISTER_LOG_DECIMATION     REGISTER_CLOCK_IDLE_TIME  + SIZE_UINT32    // *** uint8
+#define REGISTER_LOG_CONTROL        REGISTER_LOG_DECIMATION   + SIZE_UINT8     // *** uint8
+#define REGISTER_LOG_DATA           REGISTER_LOG_CONTROL      + SIZE_UINT8     // *** uint8
+#define REGISTER_AGGREGATE_CONTROL  REGISTER_LOG_DATA         + SIZE_UINT8     // *** uint8
+
+// ***
+// *** Total size of the registers in bytes.
+// ***
+#define REGISTER_TOTAL_SIZE         REGISTER_AGGREGATE_CONTROL + SIZE_UINT8
+
+// ***
+// *** The measurement block is the range of registers from the
+// *** temperature through the reading age. A read that starts
+// *** within this block continues through the end of it so a
+// *** master can get the values and their age in one burst.
+// ***
+#define MEASUREMENT_BLOCK_START     REGISTER_TEMPERATURE
+#define MEASUREMENT_BLOCK_END       REGISTER_READING_AGE      + SIZE_UINT32
+
+// ***
+// *** The reading age until the first reading is taken; there
+// *** is nothing to be that old.
+// ***
+#define READING_AGE_NONE            0xFFFFFFFF
+
+// ***
+// *** The aggregate block holds the count, minimum, maximum and
+// *** mean of the readings in the last aggregation window, in
+// *** tenths of a degree and tenths of a percent. Like the
+// *** measurement block, it is read in one burst. Writing
+// *** AGGREGATE_COMMAND_ACK to REGISTER_AGGREGATE_CONTROL acks the
+// *** block; until then a read without a window reports the
+// *** readings of the last read again along with the new ones.
+// ***
+#define AGGREGATE_BLOCK_START       REGISTER_AGGREGATE_COUNT
+#define AGGREGATE_BLOCK_END         REGISTER_HUMIDITY_MEAN    + SIZE_INT16
+#define AGGREGATE_COMMAND_ACK       1
+
+// ***
+// *** The capture block holds the result, timing constants, raw
+// *** frame and pulse widths of the last sensor read when capture
+// *** is enabled. Every byte is startable so a master with a small
+// *** buffer can read the block in pieces.
+// ***
+#define CAPTURE_BLOCK_START         REGISTER_CAPTURE_RESULT
+#define CAPTURE_BLOCK_END           REGISTER_CAPTURE_PULSES   + CAPTURE_PULSE_COUNT
+
+// ***
+// *** The derived block holds the dew point and heat index in
+// *** tenths of a degree and the absolute humidity in hundredths
+// *** of a g/m^3, computed by the breakout from each committed
+// *** reading. Like the measurement block, it is read in one burst.
+// ***
+#define DERIVED_BLOCK_START         REGISTER_DEW_POINT
+#define DERIVED_BLOCK_END           REGISTER_HEAT_INDEX       + SIZE_INT16
+
+// ***
+// *** The clock block holds the idle clock shift and the time,
+// *** in milliseconds, spent at the full and the idle clock.
+// *** The times are brought up to date when a read starts in
+// *** the block, which is read in one burst.
+// ***
+#define CLOCK_BLOCK_START           REGISTER_CLOCK_IDLE_SHIFT
+#define CLOCK_BLOCK_END             REGISTER_CLOCK_IDLE_TIME  + SIZE_UINT32
+
+// ***
+// *** Configuration bits.
+// ***
+#define CONFIG_BIT_SENSOR_ENABLED           0
+#define CONFIG_BIT_THRESHOLD_ENABLED        1
+#define CONFIG_BIT_TRIGGER_READING          2
+#define CONFIG_BIT_ADAPTIVE_INTERVAL        3
+#define CONFIG_BIT_CAPTURE                  4
+#define CONFIG_BIT_PEC_ENABLED              5
+#define CONFIG_BIT_WRITE_CONFIG             6
+#define CONFIG_BIT_RESET_CONFIG             7
+
+// ***
+// *** Status register bits.
+// ***
+#define STATUS_SENSOR_IS_ENABLED            0
+#define STATUS_UPPER_THRESHOLD_EXCEEDED     1
+#define STATUS_LOWER_THRESHOLD_EXCEEDED     2
+#define STATUS_DHT_READING_ERROR            3
+#define STATUS_PEC_ERROR                    4
+#define STATUS_CONFIG_SAVED                 5
+#define STATUS_READ_ERROR                   6
+#define STATUS_WRITE_ERROR                  7
+
+// ***
+// *** The first byte of a PEC read, which is followed by the
+// *** register and the byte count. No register has it.
+// ***
+#define PEC_READ_COMMAND                    0xFE
+
+// ***
+// *** Filter mode bits. Readings pass through the median of
+// *** the last three samples and/or a gate that rejects a change
+// *** faster than the slew limit (tenths per second) before they
+// *** are committed.
+// ***
+#define FILTER_BIT_MEDIAN                   0
+#define FILTER_BIT_SLEW                     1
+
+// ***
+// *** Calibration. A reading in tenths is corrected to
+// *** (value * gain / CALIBRATION_GAIN_ONE) + offset, so a gain
+// *** of CALIBRATION_GAIN_ONE and an offset of 0 leave it as is.
+// ***
+#define CALIBRATION_GAIN_ONE                4096
+#define CALIBRATION_GAIN_SHIFT              12
+
+// ***
+// *** Trace drain (firmware built with DHT_TRACE). A read of
+// *** REGISTER_TRACE returns a header followed by the oldest
+// *** entries: TRACE_ENABLED | the entry count, the events
+// *** dropped, the time stamp of the read (uint16), then the
+// *** event ID and time stamp of each entry. Time stamps are
+// *** in TRACE_TICK_US ticks. The entries are sent again until
+// *** TRACE_COMMAND_ACK is written to REGISTER_TRACE. A breakout
+// *** built without the trace returns 0 in the first byte.
+// ***
+#define TRACE_EVENT_LOOP                    1
+#define TRACE_EVENT_READ_START              2
+#define TRACE_EVENT_READ_OK                 3
+#define TRACE_EVENT_READ_ERROR              4
+#define TRACE_EVENT_RECEIVE                 5
+#define TRACE_EVENT_REQUEST                 6
+#define TRACE_EVENT_SAVE_START              7
+#define TRACE_EVENT_SAVE_END                8
+#define TRACE_EVENT_MASK                    0x1F
+#define TRACE_CHANNEL_SHIFT                 5
+#define TRACE_ENABLED                       0x80
+#define TRACE_TICK_US                       16
+#define TRACE_HEADER_SIZE                   4
+#define TRACE_ENTRY_SIZE                    3
+#define TRACE_DRAIN_ENTRIES                 8
+#define TRACE_DRAIN_SIZE                    ((TRACE_HEADER_SIZE) + (TRACE_DRAIN_ENTRIES) * (TRACE_ENTRY_SIZE))
+#define TRACE_COMMAND_ACK                   1
+
+// ***
+// *** Spill log (firmware built with DHT_SPILL_LOG). A read of
+// *** REGISTER_LOG_DATA returns LOG_ENABLED | LOG_BLOCK_VALID |
+// *** LOG_EARLIER_BOOT, the blocks left after this one and the
+// *** blocks dropped because the log was full, followed by the
+// *** records of the oldest block not read since the last
+// *** LOG_COMMAND_ACK. DhtTinyLog decodes the records. With
+// *** LOG_BLOCK_PENDING the breakout had not copied the block out
+// *** of its EEPROM yet; read it again. A read of
+// *** REGISTER_LOG_CONTROL returns the number of blocks in the log.
+// ***
+#define LOG_RECORD_KEY                      0xC0
+#define LOG_RECORD_DELTA                    0x80
+#define LOG_RECORD_TYPE_MASK                0xC0
+#define LOG_RECORD_CHANNEL_MASK             0x3F
+#define LOG_SHORT_TEMPERATURE_SHIFT         4
+#define LOG_SHORT_HUMIDITY_MASK             0x0F
+#define LOG_END                             0xFF
+#define LOG_ENABLED                         0x80
+#define LOG_BLOCK_VALID                     0x40
+#define LOG_EARLIER_BOOT                    0x20
+#define LOG_BLOCK_PENDING                   0x10
+#define LOG_COMMAND_ACK                     1
+#define LOG_COMMAND_REWIND                  2
+#define LOG_COMMAND_CLEAR                   3
+#define LOG_BLOCK_SIZE                      29
+#define LOG_HEADER_SIZE                     3
+#define LOG_DRAIN_SIZE                      ((LOG_HEADER_SIZE) + (LOG_BLOCK_SIZE) - 1)
+
+// ***
+// *** Values of REGISTER_DHT_MODEL (see Sensor.h). An SHT3x is
+// *** read through a bit-banged I2C master with SDA on the data
+// *** pin and SCL on the power pin of the channel.
+// ***
+#define DHT_MODEL_11                11
+#define DHT_MODEL_21                21
+#define DHT_MODEL_22                22
+#define DHT_MODEL_33                33
+#define DHT_MODEL_44                44
+#define SENSOR_MODEL_SHT3X          31
+
+// ***
+// *** Results of a sensor read (see dht.h).
+// ***
+#define DHTLIB_OK                   0
+#define DHTLIB_ERROR_CHECKSUM       -1
+#define DHTLIB_ERROR_TIMEOUT        -2
+#define DHTLIB_ERROR_CONNECT        -3
+#define DHTLIB_ERROR_ACK_L          -4
+#define DHTLIB_ERROR_ACK_H          -5
+
+#endif
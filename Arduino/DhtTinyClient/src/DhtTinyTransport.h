@@ -0,0 +1,44 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef DHT_TINY_TRANSPORT_H
+#define DHT_TINY_TRANSPORT_H
+
+#include <stdint.h>
+
+// ***
+// *** The bus a DhtTinyClient talks over. A read selects the
+// *** register and then reads count bytes starting at it; a
+// *** write sends the register followed by count bytes. Both
+// *** return false if the device did not respond. A write to
+// *** address 0 is a general call. wait() gives the devices
+// *** time to act on a write. transfer() writes any command
+// *** bytes and then reads count bytes in one transaction.
+// ***
+class DhtTinyTransport
+{
+public:
+    virtual ~DhtTinyTransport() {}
+
+    virtual bool read(uint8_t address, uint8_t registerId, uint8_t* buffer, uint8_t count) = 0;
+    virtual bool write(uint8_t address, uint8_t registerId, const uint8_t* buffer, uint8_t count) = 0;
+    virtual void wait(uint16_t milliseconds) = 0;
+    virtual bool transfer(uint8_t address, const uint8_t* command, uint8_t commandCount, uint8_t* buffer, uint8_t count) = 0;
+};
+
+#endif
@@ -0,0 +1,56 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include "DhtTinyWireTransport.h"
+
+#if defined(ARDUINO)
+bool DhtTinyWireTransport::read(uint8_t address, uint8_t registerId, uint8_t* buffer, uint8_t count)
+{
+    return transfer(address, &registerId, 1, buffer, count);
+}
+
+bool DhtTinyWireTransport::transfer(uint8_t address, const uint8_t* command, uint8_t commandCount, uint8_t* buffer, uint8_t count)
+{
+    _wire.beginTransmission(address);
+    _wire.write(command, commandCount);
+    if (_wire.endTransmission(true) != 0) return false;
+
+    if (_wire.requestFrom(address, count) != count) return false;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        buffer[i] = _wire.read();
+    }
+
+    return true;
+}
+
+bool DhtTinyWireTransport::write(uint8_t address, uint8_t registerId, const uint8_t* buffer, uint8_t count)
+{
+    _wire.beginTransmission(address);
+    _wire.write(registerId);
+    _wire.write(buffer, count);
+    bool returnValue = (_wire.endTransmission() == 0);
+
+    // ***
+    // *** Give the device time to respond.
+    // ***
+    delay(_writeDelay);
+
+    return returnValue;
+}
+#endif
@@ -0,0 +1,48 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef DHT_TINY_WIRE_TRANSPORT_H
+#define DHT_TINY_WIRE_TRANSPORT_H
+
+#if defined(ARDUINO)
+#include <Arduino.h>
+#include <Wire.h>
+#include "DhtTinyTransport.h"
+
+// ***
+// *** Transport over the Arduino Wire library. The breakout
+// *** needs a short time to act on a write before the next
+// *** transaction, the same delay the Uno master uses.
+// ***
+class DhtTinyWireTransport : public DhtTinyTransport
+{
+public:
+    DhtTinyWireTransport(TwoWire& wire = Wire, uint16_t writeDelay = 50) : _wire(wire), _writeDelay(writeDelay) {};
+
+    virtual bool read(uint8_t address, uint8_t registerId, uint8_t* buffer, uint8_t count);
+    virtual bool write(uint8_t address, uint8_t registerId, const uint8_t* buffer, uint8_t count);
+    virtual void wait(uint16_t milliseconds) { delay(milliseconds); };
+    virtual bool transfer(uint8_t address, const uint8_t* command, uint8_t commandCount, uint8_t* buffer, uint8_t count);
+
+private:
+    TwoWire& _wire;
+    uint16_t _writeDelay;
+};
+#endif
+
+#endif
@@ -0,0 +1,134 @@
+#!/bin/sh
+#
+# Copyright © 2016 Daniel Porrey. All Rights Reserved.
+#
+# This file is part of the DHT Tiny project.
+#
+# DHT Tiny is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# DHT Tiny is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with DHT Tiny. If not,
+# see http://www.gnu.org/licenses/.
+#
+
+# ***
+# *** Builds the DHT Tiny Breakout firmware once per build profile
+# *** and reports the flash and SRAM used by each one, then once
+# *** per feature with only that feature left out of the full
+# *** profile (Features.h) to show what each feature costs.
+# ***
+# *** Requires arduino-cli with the ATtiny core and avr-size on
+# *** the path. Override FQBN to report on a different board.
+# ***
+FQBN=${FQBN:-attiny:avr:ATtinyX5:cpu=attiny85,clock=internal8}
+SKETCH=$(cd "$(dirname "$0")/../DHT_Tiny_Breakout" && pwd)
+BUILD=${BUILD:-/tmp/dht_tiny_size}
+
+# ***
+# *** Each profile is a name and the compiler flags for it.
+# ***
+PROFILES="
+full|-DDHT_PROFILE_FULL
+minimal|-DDHT_PROFILE_MINIMAL
+logger|-DDHT_PROFILE_LOGGER
+dht11-only|-DDHT_PROFILE_FULL -DDHT_FIXED_MODEL=11
+dht22-only|-DDHT_PROFILE_FULL -DDHT_FIXED_MODEL=22
+sht3x-only|-DDHT_PROFILE_FULL -DDHT_FIXED_MODEL=31
+trace|-DDHT_PROFILE_FULL -DDHT_TRACE
+clock-scaling|-DDHT_PROFILE_FULL -DDHT_CLOCK_SCALING
+spill-log|-DDHT_PROFILE_FULL -DDHT_SPILL_LOG
+"
+
+# ***
+# *** Each feature is a name and its switch in Features.h.
+# ***
+FEATURES="
+thresholds|DHT_FEATURE_THRESHOLDS
+persistence|DHT_FEATURE_PERSISTENCE
+filter|DHT_FEATURE_FILTER
+calibration|DHT_FEATURE_CALIBRATION
+derived|DHT_FEATURE_DERIVED
+aggregate|DHT_FEATURE_AGGREGATE
+adaptive|DHT_FEATURE_ADAPTIVE
+capture|DHT_FEATURE_CAPTURE
+int64|DHT_FEATURE_INT64
+debug|DHT_FEATURE_DEBUG
+"
+
+# ***
+# *** Builds the sketch with the given flags and prints the
+# *** flash and SRAM it uses, or nothing if the build failed.
+# *** Flash is .text + .data, SRAM is .data + .bss.
+# ***
+measure()
+{
+  arduino-cli compile --fqbn "$FQBN" \
+    --build-property "compiler.cpp.extra_flags=$2" \
+    --build-path "$BUILD/$1" "$SKETCH" > "$BUILD-$1.log" 2>&1 || return
+
+  avr-size -A "$BUILD/$1/DHT_Tiny_Breakout.ino.elf" | awk '
+    $1 == ".text" { text = $2 }
+    $1 == ".data" { data = $2 }
+    $1 == ".bss"  { bss = $2 }
+    END { printf "%d %d\n", text + data, data + bss }'
+}
+
+printf "%-20s %8s %8s\n" "Profile" "Flash" "SRAM"
+
+echo "$PROFILES" | while IFS='|' read -r name flags
+do
+  [ -z "$name" ] && continue
+
+  size=$(measure "$name" "$flags")
+
+  if [ -z "$size" ]
+  then
+    printf "%-20s %8s %8s\n" "$name" "failed" "-"
+    continue
+  fi
+
+  set -- $size
+  printf "%-20s %8d %8d\n" "$name" "$1" "$2"
+done
+
+# ***
+# *** The cost of a feature is the full profile less the
+# *** build without it.
+# ***
+full=$(measure full "-DDHT_PROFILE_FULL")
+
+if [ -z "$full" ]
+then
+  echo "The full profile failed to build; no feature report."
+  exit 1
+fi
+
+set -- $full
+fullFlash=$1
+fullSram=$2
+
+printf "\n%-20s %8s %8s\n" "Feature" "Flash" "SRAM"
+
+echo "$FEATURES" | while IFS='|' read -r name macro
+do
+  [ -z "$name" ] && continue
+
+  size=$(measure "no-$name" "-DDHT_PROFILE_FULL -D$macro=0")
+
+  if [ -z "$size" ]
+  then
+    printf "%-20s %8s %8s\n" "$name" "failed" "-"
+    continue
+  fi
+
+  set -- $size
+  printf "%-20s %8d %8d\n" "$name" $((fullFlash - $1)) $((fullSram - $2))
+done
@@ -0,0 +1,490 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include "DhtBatchDecode.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAS_X86_SIMD 1
+#endif
+
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "The breakout's registers are little endian and are decoded in place"
+#endif
+
+#define OFFSET_TEMPERATURE      MEASUREMENT_OFFSET(REGISTER_TEMPERATURE)
+#define OFFSET_HUMIDITY         MEASUREMENT_OFFSET(REGISTER_HUMIDITY)
+#define OFFSET_STATUS           MEASUREMENT_OFFSET(REGISTER_STATUS)
+#define OFFSET_READING_ID       MEASUREMENT_OFFSET(REGISTER_READING_ID)
+#define OFFSET_READING_TIME     MEASUREMENT_OFFSET(REGISTER_READING_TIME)
+#define OFFSET_READING_AGE      MEASUREMENT_OFFSET(REGISTER_READING_AGE)
+
+// ***
+// *** The range of a DHT22. A value outside of it, or NaN, can
+// *** only come from a reading that went wrong.
+// ***
+#define TEMPERATURE_MIN         -40.0f
+#define TEMPERATURE_MAX         125.0f
+#define HUMIDITY_MIN            0.0f
+#define HUMIDITY_MAX            100.0f
+
+#define STATUS_ENABLED_BIT      (1 << STATUS_SENSOR_IS_ENABLED)
+#define STATUS_ERROR_BIT        (1 << STATUS_DHT_READING_ERROR)
+#define STATUS_UPPER_BIT        (1 << STATUS_UPPER_THRESHOLD_EXCEEDED)
+#define STATUS_LOWER_BIT        (1 << STATUS_LOWER_THRESHOLD_EXCEEDED)
+
+// ***
+// *** The mask bits of the chunk of up to 64 snapshots being
+// *** decoded, kept in registers and stored once per chunk.
+// ***
+struct ChunkMasks
+{
+    uint64_t valid;
+    uint64_t error;
+    uint64_t upper;
+    uint64_t lower;
+};
+
+typedef size_t (*ChunkDecoder)(const uint8_t* buffer, size_t start, size_t end, size_t stride,
+                               const DhtMeasurementColumns& columns, ChunkMasks& masks);
+
+// ***
+// *** Decodes a batch a chunk at a time, storing each chunk's
+// *** masks. It is inlined into the function of each path so the
+// *** loop is built for the same instruction set as the chunks;
+// *** moving between SSE and AVX code once per chunk costs more
+// *** than the decoding.
+// ***
+template <ChunkDecoder decodeChunk>
+static inline __attribute__((always_inline)) size_t decodeChunks(const uint8_t* buffer, size_t count, size_t stride,
+                                                                  const DhtMeasurementColumns& columns)
+{
+    size_t valid = 0;
+
+    for (size_t start = 0; start < count; start += 64)
+    {
+        size_t end = count - start < 64 ? count : start + 64;
+        ChunkMasks masks = { 0, 0, 0, 0 };
+
+        valid += decodeChunk(buffer, start, end, stride, columns, masks);
+
+        size_t word = start / 64;
+        if (columns.validMask) columns.validMask[word] = masks.valid;
+        if (columns.errorMask) columns.errorMask[word] = masks.error;
+        if (columns.upperMask) columns.upperMask[word] = masks.upper;
+        if (columns.lowerMask) columns.lowerMask[word] = masks.lower;
+    }
+
+    return valid;
+}
+
+// ***
+// *** Four lanes of the compiler's generic vectors. They need
+// *** no instruction set of their own; the compiler builds them
+// *** from whatever the target has (NEON on ARM, SSE2 here) or
+// *** from plain scalar code where there is nothing.
+// ***
+typedef float Floats4 __attribute__((vector_size(16)));
+typedef int32_t Words4 __attribute__((vector_size(16)));
+
+// ***
+// *** One field of two snapshots in a word, the first in the
+// *** low half, so both are stored to their column at once.
+// ***
+static inline uint64_t loadPair(const uint8_t* record, size_t stride, uint8_t offset)
+{
+    uint32_t first, second;
+    memcpy(&first, record + offset, SIZE_UINT32);
+    memcpy(&second, record + stride + offset, SIZE_UINT32);
+    return first | (uint64_t)second << 32;
+}
+
+// ***
+// *** Bit n of each of eight status bytes, the first byte's in
+// *** bit 0. The multiply moves the bit of byte i to bit 56 + i.
+// ***
+static inline uint64_t gatherStatusBits(uint64_t statuses, uint8_t n)
+{
+    return (((statuses >> n) & 0x0101010101010101ULL) * 0x0102040810204080ULL) >> 56;
+}
+
+// ***
+// *** Decodes snapshots two at a time. This is the scalar path
+// *** and the tail of the vector paths. Stores, not the checks,
+// *** are what a snapshot costs here: a column per field needs
+// *** a store per field per snapshot where a structure needs a
+// *** few, so each field of the two is stored as one word. The
+// *** values are then checked in the columns four at a time,
+// *** and the status bits are turned into masks eight at a
+// *** time, once per chunk.
+// ***
+static size_t decodeChunkScalar(const uint8_t* buffer, size_t start, size_t end, size_t stride,
+                                const DhtMeasurementColumns& columns, ChunkMasks& chunkMasks)
+{
+    // ***
+    // *** A column that is not wanted is written to scratch
+    // *** instead, so the stores do not branch. The values
+    // *** that are checked need scratch of their own.
+    // ***
+    float temperatureScratch[64], humidityScratch[64];
+    uint32_t readingIdScratch[64], scratch[64];
+    uint8_t statuses[64 + 8];
+
+    float* temperatures = columns.temperature ? columns.temperature + start : temperatureScratch;
+    float* humidities = columns.humidity ? columns.humidity + start : humidityScratch;
+    uint32_t* readingIds = columns.readingId ? columns.readingId + start : readingIdScratch;
+    uint32_t* readingTimes = columns.readingTime ? columns.readingTime + start : scratch;
+    uint32_t* readingAges = columns.readingAge ? columns.readingAge + start : scratch;
+
+    const uint8_t* record = buffer + start * stride;
+    size_t count = end - start;
+    size_t i = 0;
+
+    for (; i + 2 <= count; i += 2, record += 2 * stride)
+    {
+        uint64_t temperature = loadPair(record, stride, OFFSET_TEMPERATURE);
+        uint64_t humidity = loadPair(record, stride, OFFSET_HUMIDITY);
+        uint64_t readingId = loadPair(record, stride, OFFSET_READING_ID);
+        uint64_t readingTime = loadPair(record, stride, OFFSET_READING_TIME);
+        uint64_t readingAge = loadPair(record, stride, OFFSET_READING_AGE);
+        uint16_t status = record[OFFSET_STATUS] | record[stride + OFFSET_STATUS] << 8;
+
+        memcpy(temperatures + i, &temperature, sizeof(temperature));
+        memcpy(humidities + i, &humidity, sizeof(humidity));
+        memcpy(readingIds + i, &readingId, sizeof(readingId));
+        memcpy(readingTimes + i, &readingTime, sizeof(readingTime));
+        memcpy(readingAges + i, &readingAge, sizeof(readingAge));
+        memcpy(statuses + i, &status, sizeof(status));
+    }
+
+    if (i < count)
+    {
+        memcpy(temperatures + i, record + OFFSET_TEMPERATURE, SIZE_FLOAT);
+        memcpy(humidities + i, record + OFFSET_HUMIDITY, SIZE_FLOAT);
+        memcpy(readingIds + i, record + OFFSET_READING_ID, SIZE_UINT32);
+        memcpy(readingTimes + i, record + OFFSET_READING_TIME, SIZE_UINT32);
+        memcpy(readingAges + i, record + OFFSET_READING_AGE, SIZE_UINT32);
+        statuses[i] = record[OFFSET_STATUS];
+    }
+
+    // ***
+    // *** The values and the reading id. A lane that passes is
+    // *** all ones, so masking with its own bit and combining
+    // *** the lanes gives the bits of the four.
+    // ***
+    const Words4 laneBits = { 1, 2, 4, 8 };
+    uint64_t inRangeBits = 0;
+
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        Floats4 temperature, humidity;
+        Words4 readingId;
+        memcpy(&temperature, temperatures + i, sizeof(temperature));
+        memcpy(&humidity, humidities + i, sizeof(humidity));
+        memcpy(&readingId, readingIds + i, sizeof(readingId));
+
+        Words4 lanes = (temperature >= TEMPERATURE_MIN) & (temperature <= TEMPERATURE_MAX) &
+                       (humidity >= HUMIDITY_MIN) & (humidity <= HUMIDITY_MAX) & (readingId != 0) & laneBits;
+        inRangeBits |= (uint64_t)(lanes[0] | lanes[1] | lanes[2] | lanes[3]) << i;
+    }
+
+    for (; i < count; i++)
+    {
+        uint64_t inRange = (temperatures[i] >= TEMPERATURE_MIN) & (temperatures[i] <= TEMPERATURE_MAX) &
+                           (humidities[i] >= HUMIDITY_MIN) & (humidities[i] <= HUMIDITY_MAX) & (readingIds[i] != 0);
+        inRangeBits |= inRange << i;
+    }
+
+    // ***
+    // *** The status bits. The bytes past count are cleared so
+    // *** they add nothing to the masks.
+    // ***
+    memset(statuses + count, 0, 8);
+    uint64_t enabledBits = 0, errorBits = 0, upperBits = 0, lowerBits = 0;
+
+    for (i = 0; i < count; i += 8)
+    {
+        uint64_t eight;
+        memcpy(&eight, statuses + i, sizeof(eight));
+        enabledBits |= gatherStatusBits(eight, STATUS_SENSOR_IS_ENABLED) << i;
+        errorBits |= gatherStatusBits(eight, STATUS_DHT_READING_ERROR) << i;
+        upperBits |= gatherStatusBits(eight, STATUS_UPPER_THRESHOLD_EXCEEDED) << i;
+        lowerBits |= gatherStatusBits(eight, STATUS_LOWER_THRESHOLD_EXCEEDED) << i;
+    }
+
+    uint64_t validBits = inRangeBits & enabledBits & ~errorBits;
+
+    if (columns.status) memcpy(columns.status + start, statuses, count);
+    if (columns.valid)
+    {
+        for (i = 0; i < count; i++) columns.valid[start + i] = (validBits >> i) & 1;
+    }
+
+    uint8_t bit = start % 64;
+    chunkMasks.valid |= validBits << bit;
+    chunkMasks.error |= errorBits << bit;
+    chunkMasks.upper |= upperBits << bit;
+    chunkMasks.lower |= lowerBits << bit;
+
+    return __builtin_popcountll(validBits);
+}
+
+#ifdef HAS_X86_SIMD
+
+// ***
+// *** Four snapshots at a time. SSE has no gather, so each field
+// *** is put together from four scalar loads; the checks, the
+// *** masks and the stores are done four at a time.
+// ***
+__attribute__((target("sse4.1")))
+static inline __m128i loadWords(const uint8_t* record, size_t stride, uint8_t offset)
+{
+    uint32_t a, b, c, d;
+    memcpy(&a, record + offset, SIZE_UINT32);
+    memcpy(&b, record + stride + offset, SIZE_UINT32);
+    memcpy(&c, record + 2 * stride + offset, SIZE_UINT32);
+    memcpy(&d, record + 3 * stride + offset, SIZE_UINT32);
+    return _mm_setr_epi32(a, b, c, d);
+}
+
+__attribute__((target("sse4.1")))
+static size_t decodeChunkSse(const uint8_t* buffer, size_t start, size_t end, size_t stride,
+                             const DhtMeasurementColumns& output, ChunkMasks& chunkMasks)
+{
+    // ***
+    // *** The status and valid columns are written with byte
+    // *** stores, which may alias anything, so the column pointers
+    // *** and masks are copied to locals rather than read through
+    // *** the references every four snapshots.
+    // ***
+    const DhtMeasurementColumns columns = output;
+    ChunkMasks masks = chunkMasks;
+
+    const __m128i enabledOnly = _mm_set1_epi32(STATUS_ENABLED_BIT);
+    const __m128i enabledOrError = _mm_set1_epi32(STATUS_ENABLED_BIT | STATUS_ERROR_BIT);
+    const __m128i statusByte = _mm_set1_epi32(0xFF);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128 temperatureMin = _mm_set1_ps(TEMPERATURE_MIN), temperatureMax = _mm_set1_ps(TEMPERATURE_MAX);
+    const __m128 humidityMin = _mm_set1_ps(HUMIDITY_MIN), humidityMax = _mm_set1_ps(HUMIDITY_MAX);
+
+    size_t valid = 0;
+    size_t i = start;
+
+    for (; i + 4 <= end; i += 4)
+    {
+        const uint8_t* record = buffer + i * stride;
+
+        __m128 temperature = _mm_castsi128_ps(loadWords(record, stride, OFFSET_TEMPERATURE));
+        __m128 humidity = _mm_castsi128_ps(loadWords(record, stride, OFFSET_HUMIDITY));
+        __m128i readingId = loadWords(record, stride, OFFSET_READING_ID);
+        __m128i status = _mm_and_si128(loadWords(record, stride, OFFSET_STATUS), statusByte);
+
+        __m128 inRange = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(temperature, temperatureMin), _mm_cmple_ps(temperature, temperatureMax)),
+                                    _mm_and_ps(_mm_cmpge_ps(humidity, humidityMin), _mm_cmple_ps(humidity, humidityMax)));
+        __m128i enabled = _mm_cmpeq_epi32(_mm_and_si128(status, enabledOrError), enabledOnly);
+        __m128 isValid = _mm_andnot_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(readingId, zero)),
+                                       _mm_and_ps(inRange, _mm_castsi128_ps(enabled)));
+
+        uint32_t validBits = _mm_movemask_ps(isValid);
+        valid += __builtin_popcount(validBits);
+
+        if (columns.temperature) _mm_storeu_ps(columns.temperature + i, temperature);
+        if (columns.humidity) _mm_storeu_ps(columns.humidity + i, humidity);
+        if (columns.readingId) _mm_storeu_si128((__m128i*)(columns.readingId + i), readingId);
+        if (columns.readingTime) _mm_storeu_si128((__m128i*)(columns.readingTime + i), loadWords(record, stride, OFFSET_READING_TIME));
+        if (columns.readingAge) _mm_storeu_si128((__m128i*)(columns.readingAge + i), loadWords(record, stride, OFFSET_READING_AGE));
+
+        if (columns.status)
+        {
+            uint32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packus_epi32(status, zero), zero));
+            memcpy(columns.status + i, &packed, 4);
+        }
+
+        if (columns.valid)
+        {
+            __m128i flags = _mm_and_si128(_mm_castps_si128(isValid), _mm_set1_epi32(1));
+            uint32_t packed = _mm_cvtsi128_si32(_mm_packus_epi16(_mm_packus_epi32(flags, zero), zero));
+            memcpy(columns.valid + i, &packed, 4);
+        }
+
+        // ***
+        // *** Shifting each status bit to the sign bit lets
+        // *** movemask collect it.
+        // ***
+        uint8_t bit = i % 64;
+        masks.valid |= (uint64_t)validBits << bit;
+        masks.error |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_slli_epi32(status, 31 - STATUS_DHT_READING_ERROR))) << bit;
+        masks.upper |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_slli_epi32(status, 31 - STATUS_UPPER_THRESHOLD_EXCEEDED))) << bit;
+        masks.lower |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_slli_epi32(status, 31 - STATUS_LOWER_THRESHOLD_EXCEEDED))) << bit;
+    }
+
+    chunkMasks = masks;
+    return valid + decodeChunkScalar(buffer, i, end, stride, columns, chunkMasks);
+}
+
+__attribute__((target("avx2")))
+static inline __m256i loadWords8(const uint8_t* record, size_t stride, uint8_t offset)
+{
+    return _mm256_set_m128i(loadWords(record + 4 * stride, stride, offset), loadWords(record, stride, offset));
+}
+
+// ***
+// *** Eight snapshots at a time.
+// ***
+__attribute__((target("avx2")))
+static size_t decodeChunkAvx2(const uint8_t* buffer, size_t start, size_t end, size_t stride,
+                              const DhtMeasurementColumns& output, ChunkMasks& chunkMasks)
+{
+    // ***
+    // *** Copied for the same reason as in decodeChunkSse(); the
+    // *** masks go back to chunkMasks before the scalar tail.
+    // ***
+    const DhtMeasurementColumns columns = output;
+    ChunkMasks masks = chunkMasks;
+
+    const __m256i enabledOnly = _mm256_set1_epi32(STATUS_ENABLED_BIT);
+    const __m256i enabledOrError = _mm256_set1_epi32(STATUS_ENABLED_BIT | STATUS_ERROR_BIT);
+    const __m256i statusByte = _mm256_set1_epi32(0xFF);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256 temperatureMin = _mm256_set1_ps(TEMPERATURE_MIN), temperatureMax = _mm256_set1_ps(TEMPERATURE_MAX);
+    const __m256 humidityMin = _mm256_set1_ps(HUMIDITY_MIN), humidityMax = _mm256_set1_ps(HUMIDITY_MAX);
+
+    size_t valid = 0;
+    size_t i = start;
+
+    for (; i + 8 <= end; i += 8)
+    {
+        const uint8_t* base = buffer + i * stride;
+
+        __m256 temperature = _mm256_castsi256_ps(loadWords8(base, stride, OFFSET_TEMPERATURE));
+        __m256 humidity = _mm256_castsi256_ps(loadWords8(base, stride, OFFSET_HUMIDITY));
+        __m256i readingId = loadWords8(base, stride, OFFSET_READING_ID);
+        __m256i status = _mm256_and_si256(loadWords8(base, stride, OFFSET_STATUS), statusByte);
+
+        __m256 inRange = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(temperature, temperatureMin, _CMP_GE_OQ),
+                                                     _mm256_cmp_ps(temperature, temperatureMax, _CMP_LE_OQ)),
+                                       _mm256_and_ps(_mm256_cmp_ps(humidity, humidityMin, _CMP_GE_OQ),
+                                                     _mm256_cmp_ps(humidity, humidityMax, _CMP_LE_OQ)));
+        __m256i enabled = _mm256_cmpeq_epi32(_mm256_and_si256(status, enabledOrError), enabledOnly);
+        __m256 isValid = _mm256_andnot_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(readingId, zero)),
+                                          _mm256_and_ps(inRange, _mm256_castsi256_ps(enabled)));
+
+        uint32_t validBits = _mm256_movemask_ps(isValid);
+        valid += __builtin_popcount(validBits);
+
+        if (columns.temperature) _mm256_storeu_ps(columns.temperature + i, temperature);
+        if (columns.humidity) _mm256_storeu_ps(columns.humidity + i, humidity);
+        if (columns.readingId) _mm256_storeu_si256((__m256i*)(columns.readingId + i), readingId);
+        if (columns.readingTime)
+        {
+            _mm256_storeu_si256((__m256i*)(columns.readingTime + i),
+                                loadWords8(base, stride, OFFSET_READING_TIME));
+        }
+        if (columns.readingAge)
+        {
+            _mm256_storeu_si256((__m256i*)(columns.readingAge + i),
+                                loadWords8(base, stride, OFFSET_READING_AGE));
+        }
+
+        // ***
+        // *** The packs work within each 128 bit lane, so the two
+        // *** halves are packed together first.
+        // ***
+        if (columns.status)
+        {
+            __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(status), _mm256_extracti128_si256(status, 1));
+            _mm_storel_epi64((__m128i*)(columns.status + i), _mm_packus_epi16(words, words));
+        }
+
+        if (columns.valid)
+        {
+            __m256i flags = _mm256_and_si256(_mm256_castps_si256(isValid), _mm256_set1_epi32(1));
+            __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(flags), _mm256_extracti128_si256(flags, 1));
+            _mm_storel_epi64((__m128i*)(columns.valid + i), _mm_packus_epi16(words, words));
+        }
+
+        uint8_t bit = i % 64;
+        masks.valid |= (uint64_t)validBits << bit;
+        masks.error |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(status, 31 - STATUS_DHT_READING_ERROR))) << bit;
+        masks.upper |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(status, 31 - STATUS_UPPER_THRESHOLD_EXCEEDED))) << bit;
+        masks.lower |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(status, 31 - STATUS_LOWER_THRESHOLD_EXCEEDED))) << bit;
+    }
+
+    // ***
+    // *** The tail and the caller are not built for AVX, and SSE
+    // *** code run with the upper halves of the registers dirty
+    // *** is slowed down on every instruction.
+    // ***
+    _mm256_zeroupper();
+
+    chunkMasks = masks;
+    return valid + decodeChunkScalar(buffer, i, end, stride, columns, chunkMasks);
+}
+
+__attribute__((target("sse4.1")))
+static size_t decodeSse(const uint8_t* buffer, size_t count, size_t stride, const DhtMeasurementColumns& columns)
+{
+    return decodeChunks<decodeChunkSse>(buffer, count, stride, columns);
+}
+
+__attribute__((target("avx2")))
+static size_t decodeAvx2(const uint8_t* buffer, size_t count, size_t stride, const DhtMeasurementColumns& columns)
+{
+    size_t valid = decodeChunks<decodeChunkAvx2>(buffer, count, stride, columns);
+    _mm256_zeroupper();
+    return valid;
+}
+
+#endif
+
+uint8_t getBestDecodePath()
+{
+#ifdef HAS_X86_SIMD
+    if (__builtin_cpu_supports("avx2")) return DHT_DECODE_AVX2;
+    if (__builtin_cpu_supports("sse4.1")) return DHT_DECODE_SSE;
+#endif
+    return DHT_DECODE_SCALAR;
+}
+
+const char* getDecodePathName(uint8_t path)
+{
+    switch (path)
+    {
+    case DHT_DECODE_SCALAR: return "scalar";
+    case DHT_DECODE_SSE: return "sse4.1";
+    case DHT_DECODE_AVX2: return "avx2";
+    default: return "best";
+    }
+}
+
+size_t decodeMeasurements(const uint8_t* buffer, size_t count, size_t stride,
+                          const DhtMeasurementColumns& columns, uint8_t path)
+{
+    if (stride < MEASUREMENT_SIZE) return 0;
+
+    uint8_t best = getBestDecodePath();
+    if (path > best) path = best;
+
+#ifdef HAS_X86_SIMD
+    if (path == DHT_DECODE_AVX2) return decodeAvx2(buffer, count, stride, columns);
+    if (path == DHT_DECODE_SSE) return decodeSse(buffer, count, stride, columns);
+#endif
+    return decodeChunks<decodeChunkScalar>(buffer, count, stride, columns);
+}
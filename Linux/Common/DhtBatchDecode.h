@@ -0,0 +1,90 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef DHT_BATCH_DECODE_H
+#define DHT_BATCH_DECODE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "DhtTinyRegisters.h"
+
+// ***
+// *** Decodes many measurement blocks at once into one array per
+// *** field. The input is a buffer of snapshots, one per breakout
+// *** or per poll, each holding the measurement block (the burst
+// *** DhtTinyClient::update() reads) at the start of a record of
+// *** stride bytes. A stride of MEASUREMENT_SIZE packs them tightly;
+// *** a stride of REGISTER_TOTAL_SIZE with the buffer advanced to
+// *** MEASUREMENT_BLOCK_START decodes whole register dumps.
+// ***
+// *** Besides the values, each snapshot is checked: it is valid
+// *** when the sensor is enabled, the last read did not fail, it
+// *** has a reading and both values are in the range of a DHT22.
+// *** The validity and three status bits are also returned as bit
+// *** masks, 64 snapshots to a word, so a caller can skip to the
+// *** snapshots it wants with a count of trailing zeros.
+// ***
+// *** On x86 the AVX2 or SSE4.1 path is picked at run time; the
+// *** scalar path is used elsewhere and gives the same results.
+// ***
+#define MEASUREMENT_SIZE            ((MEASUREMENT_BLOCK_END) - (MEASUREMENT_BLOCK_START))
+#define MEASUREMENT_OFFSET(r)       ((r) - (MEASUREMENT_BLOCK_START))
+
+#define DHT_DECODE_SCALAR           0
+#define DHT_DECODE_SSE              1
+#define DHT_DECODE_AVX2             2
+#define DHT_DECODE_BEST             0xFF
+
+#define DHT_DECODE_MASK_WORDS(n)    (((n) + 63) / 64)
+
+// ***
+// *** The arrays a batch is decoded into. Each holds count values,
+// *** except the masks which hold DHT_DECODE_MASK_WORDS(count)
+// *** words. An array left NULL is not written.
+// ***
+struct DhtMeasurementColumns
+{
+    float* temperature;
+    float* humidity;
+    uint32_t* readingId;
+    uint32_t* readingTime;
+    uint32_t* readingAge;
+    uint8_t* status;
+    uint8_t* valid;
+
+    uint64_t* validMask;
+    uint64_t* errorMask;
+    uint64_t* upperMask;
+    uint64_t* lowerMask;
+};
+
+// ***
+// *** The path DHT_DECODE_BEST selects on this CPU.
+// ***
+uint8_t getBestDecodePath();
+const char* getDecodePathName(uint8_t path);
+
+// ***
+// *** Returns the number of valid snapshots. A path this CPU does
+// *** not support falls back to the best one it does.
+// ***
+size_t decodeMeasurements(const uint8_t* buffer, size_t count, size_t stride,
+                          const DhtMeasurementColumns& columns, uint8_t path = DHT_DECODE_BEST);
+
+#endif
@@ -0,0 +1,560 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include "DhtSeries.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <string.h>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// ***
+// *** The columns of one decoded block.
+// ***
+struct DecodedBlock
+{
+    uint32_t readingId[DHT_SERIES_BLOCK_ROWS];
+    uint64_t time[DHT_SERIES_BLOCK_ROWS];
+    int16_t temperature[DHT_SERIES_BLOCK_ROWS];
+    int16_t humidity[DHT_SERIES_BLOCK_ROWS];
+    uint8_t status[DHT_SERIES_BLOCK_ROWS];
+};
+
+#define COLUMN_BIT(c)   (1 << (c))
+#define ALL_COLUMNS     ((1 << DHT_SERIES_COLUMNS) - 1)
+
+static inline uint64_t zigzag(int64_t value)
+{
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t unzigzag(uint64_t value)
+{
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static inline void putVarint(std::vector<uint8_t>& buffer, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        buffer.push_back((uint8_t)value | 0x80);
+        value >>= 7;
+    }
+
+    buffer.push_back((uint8_t)value);
+}
+
+static inline uint64_t getVarint(const uint8_t*& position, const uint8_t* end)
+{
+    uint64_t value = 0;
+    for (uint8_t shift = 0; position < end && shift < 64; shift += 7)
+    {
+        uint8_t byte = *position++;
+        value |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) break;
+    }
+
+    return value;
+}
+
+static inline int16_t toTenths(float value)
+{
+    return (int16_t)lroundf(value * 10);
+}
+
+static bool writeAll(int fd, const void* buffer, size_t size)
+{
+    const uint8_t* position = (const uint8_t*)buffer;
+    while (size > 0)
+    {
+        ssize_t written = write(fd, position, size);
+        if (written <= 0) return false;
+        position += written;
+        size -= written;
+    }
+
+    return true;
+}
+
+static void decodeBlock(const DhtSeriesBlock* block, uint32_t columns, DecodedBlock& decoded)
+{
+    const uint8_t* base = (const uint8_t*)block;
+
+    for (uint8_t c = 0; c < DHT_SERIES_COLUMNS; c++)
+    {
+        if ((columns & COLUMN_BIT(c)) == 0) continue;
+
+        const uint8_t* position = base + block->columns[c];
+        const uint8_t* end = base + (c + 1 < DHT_SERIES_COLUMNS ? block->columns[c + 1] : block->size);
+
+        switch (c)
+        {
+        case DHT_SERIES_COLUMN_READING_ID:
+        {
+            uint32_t previous = block->firstReadingId;
+            for (uint16_t i = 0; i < block->count; i++)
+            {
+                previous += (uint32_t)unzigzag(getVarint(position, end));
+                decoded.readingId[i] = previous;
+            }
+            break;
+        }
+        case DHT_SERIES_COLUMN_TIME:
+        {
+            uint64_t previous = block->firstTime;
+            int64_t delta = 0;
+            for (uint16_t i = 0; i < block->count; i++)
+            {
+                delta += unzigzag(getVarint(position, end));
+                previous += delta;
+                decoded.time[i] = previous;
+            }
+            break;
+        }
+        case DHT_SERIES_COLUMN_TEMPERATURE:
+        case DHT_SERIES_COLUMN_HUMIDITY:
+        {
+            int16_t* values = c == DHT_SERIES_COLUMN_TEMPERATURE ? decoded.temperature : decoded.humidity;
+            int16_t previous = 0;
+            for (uint16_t i = 0; i < block->count; i++)
+            {
+                previous += (int16_t)unzigzag(getVarint(position, end));
+                values[i] = previous;
+            }
+            break;
+        }
+        case DHT_SERIES_COLUMN_STATUS:
+        {
+            uint16_t i = 0;
+            while (i < block->count && position < end)
+            {
+                uint8_t value = *position++;
+                uint64_t run = getVarint(position, end);
+                for (; run > 0 && i < block->count; run--)
+                {
+                    decoded.status[i++] = value;
+                }
+            }
+            break;
+        }
+        }
+    }
+}
+
+std::string getSeriesName(const char* bus, uint8_t address)
+{
+    // ***
+    // *** /dev/i2c-1 and 0x26 give i2c-1-0x26.
+    // ***
+    const char* slash = strrchr(bus, '/');
+    char suffix[8];
+    snprintf(suffix, sizeof(suffix), "-0x%02X", address);
+    return std::string(slash ? slash + 1 : bus) + suffix;
+}
+
+DhtSeriesWriter::DhtSeriesWriter() : _lastTime(0), _bytesWritten(0)
+{
+}
+
+DhtSeriesWriter::~DhtSeriesWriter()
+{
+    flush();
+}
+
+bool DhtSeriesWriter::open(const char* directory, const char* bus, uint8_t address)
+{
+    std::string path = std::string(directory) + "/" + getSeriesName(bus, address);
+    _dataPath = path + ".dts";
+    _indexPath = path + ".dti";
+    _pending.clear();
+    _pending.reserve(DHT_SERIES_BLOCK_ROWS);
+    _lastTime = 0;
+
+    int fd = ::open(_indexPath.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+
+    // ***
+    // *** A new index starts with its header. An existing one
+    // *** gives the time of the last reading, since readings are
+    // *** only ever appended in time order.
+    // ***
+    DhtSeriesIndexHeader header;
+    struct stat status;
+    bool valid = fstat(fd, &status) == 0;
+
+    if (valid && status.st_size == 0)
+    {
+        memset(&header, 0, sizeof(header));
+        header.magic = DHT_SERIES_INDEX_MAGIC;
+        header.version = DHT_SERIES_VERSION;
+        valid = writeAll(fd, &header, sizeof(header));
+    }
+    else if (valid)
+    {
+        valid = pread(fd, &header, sizeof(header), 0) == sizeof(header) &&
+                header.magic == DHT_SERIES_INDEX_MAGIC && header.version == DHT_SERIES_VERSION;
+
+        size_t entries = (status.st_size - sizeof(header)) / sizeof(DhtSeriesIndexEntry);
+        DhtSeriesIndexEntry entry;
+        if (valid && entries > 0 &&
+            pread(fd, &entry, sizeof(entry), sizeof(header) + (entries - 1) * sizeof(entry)) == sizeof(entry))
+        {
+            _lastTime = entry.lastTime;
+        }
+    }
+
+    ::close(fd);
+    return valid;
+}
+
+bool DhtSeriesWriter::append(const DhtSeriesRecord& record)
+{
+    if (record.time < _lastTime) return false;
+
+    _pending.push_back(record);
+    _lastTime = record.time;
+
+    return _pending.size() < DHT_SERIES_BLOCK_ROWS || flush();
+}
+
+bool DhtSeriesWriter::flush()
+{
+    if (_pending.empty()) return true;
+
+    DhtSeriesBlock block;
+    memset(&block, 0, sizeof(block));
+    block.magic = DHT_SERIES_BLOCK_MAGIC;
+    block.version = DHT_SERIES_VERSION;
+    block.count = _pending.size();
+    block.firstTime = _pending.front().time;
+    block.lastTime = _pending.back().time;
+    block.firstReadingId = _pending.front().readingId;
+    block.lastReadingId = _pending.back().readingId;
+    block.minTemperature = block.minHumidity = INT16_MAX;
+    block.maxTemperature = block.maxHumidity = INT16_MIN;
+
+    _buffer.assign(sizeof(block), 0);
+
+    // ***
+    // *** Reading ids.
+    // ***
+    block.columns[DHT_SERIES_COLUMN_READING_ID] = _buffer.size();
+    uint32_t previousId = block.firstReadingId;
+    for (size_t i = 0; i < _pending.size(); i++)
+    {
+        putVarint(_buffer, zigzag((int32_t)(_pending[i].readingId - previousId)));
+        previousId = _pending[i].readingId;
+    }
+
+    // ***
+    // *** Times.
+    // ***
+    block.columns[DHT_SERIES_COLUMN_TIME] = _buffer.size();
+    uint64_t previousTime = block.firstTime;
+    int64_t previousDelta = 0;
+    for (size_t i = 0; i < _pending.size(); i++)
+    {
+        int64_t delta = _pending[i].time - previousTime;
+        putVarint(_buffer, zigzag(delta - previousDelta));
+        previousTime = _pending[i].time;
+        previousDelta = delta;
+    }
+
+    // ***
+    // *** Measurements, also summarized in the header.
+    // ***
+    for (uint8_t c = DHT_SERIES_COLUMN_TEMPERATURE; c <= DHT_SERIES_COLUMN_HUMIDITY; c++)
+    {
+        bool temperature = c == DHT_SERIES_COLUMN_TEMPERATURE;
+        int16_t& minimum = temperature ? block.minTemperature : block.minHumidity;
+        int16_t& maximum = temperature ? block.maxTemperature : block.maxHumidity;
+        int64_t& sum = temperature ? block.temperatureSum : block.humiditySum;
+
+        block.columns[c] = _buffer.size();
+        int16_t previous = 0;
+        for (size_t i = 0; i < _pending.size(); i++)
+        {
+            int16_t value = toTenths(temperature ? _pending[i].temperature : _pending[i].humidity);
+            putVarint(_buffer, zigzag(value - previous));
+            previous = value;
+
+            if (value < minimum) minimum = value;
+            if (value > maximum) maximum = value;
+            sum += value;
+        }
+    }
+
+    // ***
+    // *** Status.
+    // ***
+    block.columns[DHT_SERIES_COLUMN_STATUS] = _buffer.size();
+    for (size_t i = 0; i < _pending.size();)
+    {
+        size_t run = 1;
+        while (i + run < _pending.size() && _pending[i + run].status == _pending[i].status) run++;
+
+        _buffer.push_back(_pending[i].status);
+        putVarint(_buffer, run);
+        i += run;
+    }
+
+    block.size = _buffer.size();
+    memcpy(_buffer.data(), &block, sizeof(block));
+
+    // ***
+    // *** The block is appended before its index entry, so a
+    // *** reader never finds an entry for a block that is not
+    // *** all there.
+    // ***
+    int data = ::open(_dataPath.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (data < 0) return false;
+
+    struct stat status;
+    bool written = fstat(data, &status) == 0 && writeAll(data, _buffer.data(), _buffer.size());
+    ::close(data);
+    if (!written) return false;
+
+    DhtSeriesIndexEntry entry;
+    entry.firstTime = block.firstTime;
+    entry.lastTime = block.lastTime;
+    entry.offset = status.st_size;
+
+    int index = ::open(_indexPath.c_str(), O_WRONLY | O_APPEND);
+    if (index < 0) return false;
+
+    written = writeAll(index, &entry, sizeof(entry));
+    ::close(index);
+    if (!written) return false;
+
+    _bytesWritten += _buffer.size() + sizeof(entry);
+    _pending.clear();
+    return true;
+}
+
+DhtSeriesReader::DhtSeriesReader() : _data(NULL), _dataSize(0), _index(NULL), _indexSize(0), _entries(NULL), _blockCount(0)
+{
+}
+
+DhtSeriesReader::~DhtSeriesReader()
+{
+    close();
+}
+
+static const uint8_t* mapFile(const std::string& path, size_t& size)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return NULL;
+
+    struct stat status;
+    void* memory = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && status.st_size > 0)
+    {
+        size = status.st_size;
+        memory = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+
+    ::close(fd);
+    return memory == MAP_FAILED ? NULL : (const uint8_t*)memory;
+}
+
+bool DhtSeriesReader::open(const char* directory, const char* bus, uint8_t address)
+{
+    close();
+
+    std::string path = std::string(directory) + "/" + getSeriesName(bus, address);
+    _index = mapFile(path + ".dti", _indexSize);
+    if (_index == NULL || _indexSize < sizeof(DhtSeriesIndexHeader))
+    {
+        close();
+        return false;
+    }
+
+    const DhtSeriesIndexHeader* header = (const DhtSeriesIndexHeader*)_index;
+    if (header->magic != DHT_SERIES_INDEX_MAGIC || header->version != DHT_SERIES_VERSION)
+    {
+        close();
+        return false;
+    }
+
+    _entries = (const DhtSeriesIndexEntry*)(_index + sizeof(DhtSeriesIndexHeader));
+    _blockCount = (_indexSize - sizeof(DhtSeriesIndexHeader)) / sizeof(DhtSeriesIndexEntry);
+
+    // ***
+    // *** A segment with an index but no blocks yet is empty.
+    // ***
+    _data = mapFile(path + ".dts", _dataSize);
+    if (_data == NULL) _blockCount = 0;
+
+    // ***
+    // *** Drop entries past the end of the data, which can only
+    // *** be left by a segment that was truncated.
+    // ***
+    while (_blockCount > 0 && _entries[_blockCount - 1].offset + sizeof(DhtSeriesBlock) > _dataSize)
+    {
+        _blockCount--;
+    }
+
+    return true;
+}
+
+void DhtSeriesReader::close()
+{
+    if (_data != NULL) munmap((void*)_data, _dataSize);
+    if (_index != NULL) munmap((void*)_index, _indexSize);
+
+    _data = NULL;
+    _index = NULL;
+    _entries = NULL;
+    _dataSize = 0;
+    _indexSize = 0;
+    _blockCount = 0;
+}
+
+uint64_t DhtSeriesReader::getFirstTime() const
+{
+    return _blockCount ? _entries[0].firstTime : 0;
+}
+
+uint64_t DhtSeriesReader::getLastTime() const
+{
+    return _blockCount ? _entries[_blockCount - 1].lastTime : 0;
+}
+
+size_t DhtSeriesReader::findFirstBlock(uint64_t from) const
+{
+    // ***
+    // *** The first block that ends at or after from.
+    // ***
+    const DhtSeriesIndexEntry* entry = std::lower_bound(_entries, _entries + _blockCount, from,
+        [](const DhtSeriesIndexEntry& e, uint64_t time) { return e.lastTime < time; });
+
+    return entry - _entries;
+}
+
+const DhtSeriesBlock* DhtSeriesReader::getBlock(size_t index) const
+{
+    const DhtSeriesBlock* block = (const DhtSeriesBlock*)(_data + _entries[index].offset);
+    if (block->magic != DHT_SERIES_BLOCK_MAGIC || block->version != DHT_SERIES_VERSION ||
+        block->count > DHT_SERIES_BLOCK_ROWS || _entries[index].offset + block->size > _dataSize)
+    {
+        return NULL;
+    }
+
+    return block;
+}
+
+size_t DhtSeriesReader::read(uint64_t from, uint64_t to, std::vector<DhtSeriesRecord>& records) const
+{
+    size_t added = 0;
+    DecodedBlock decoded;
+
+    for (size_t b = findFirstBlock(from); b < _blockCount && _entries[b].firstTime < to; b++)
+    {
+        const DhtSeriesBlock* block = getBlock(b);
+        if (block == NULL) continue;
+
+        decodeBlock(block, ALL_COLUMNS, decoded);
+        for (uint16_t i = 0; i < block->count; i++)
+        {
+            if (decoded.time[i] < from || decoded.time[i] >= to) continue;
+
+            DhtSeriesRecord record;
+            record.time = decoded.time[i];
+            record.readingId = decoded.readingId[i];
+            record.temperature = decoded.temperature[i] / 10.0f;
+            record.humidity = decoded.humidity[i] / 10.0f;
+            record.status = decoded.status[i];
+            records.push_back(record);
+            added++;
+        }
+    }
+
+    return added;
+}
+
+DhtSeriesAggregate DhtSeriesReader::aggregate(uint64_t from, uint64_t to) const
+{
+    DhtSeriesAggregate result;
+    memset(&result, 0, sizeof(result));
+
+    int16_t minTemperature = INT16_MAX, maxTemperature = INT16_MIN;
+    int16_t minHumidity = INT16_MAX, maxHumidity = INT16_MIN;
+    int64_t temperatureSum = 0, humiditySum = 0;
+    DecodedBlock decoded;
+
+    for (size_t b = findFirstBlock(from); b < _blockCount && _entries[b].firstTime < to; b++)
+    {
+        const DhtSeriesBlock* block = getBlock(b);
+        if (block == NULL) continue;
+
+        if (block->firstTime >= from && block->lastTime < to)
+        {
+            // ***
+            // *** The whole block is in the range.
+            // ***
+            result.count += block->count;
+            temperatureSum += block->temperatureSum;
+            humiditySum += block->humiditySum;
+            minTemperature = std::min(minTemperature, block->minTemperature);
+            maxTemperature = std::max(maxTemperature, block->maxTemperature);
+            minHumidity = std::min(minHumidity, block->minHumidity);
+            maxHumidity = std::max(maxHumidity, block->maxHumidity);
+            result.blocksSkipped++;
+            continue;
+        }
+
+        // ***
+        // *** Only the columns the aggregate needs are decoded.
+        // ***
+        decodeBlock(block, COLUMN_BIT(DHT_SERIES_COLUMN_TIME) | COLUMN_BIT(DHT_SERIES_COLUMN_TEMPERATURE) |
+                           COLUMN_BIT(DHT_SERIES_COLUMN_HUMIDITY), decoded);
+        result.blocksDecoded++;
+
+        for (uint16_t i = 0; i < block->count; i++)
+        {
+            if (decoded.time[i] < from || decoded.time[i] >= to) continue;
+
+            result.count++;
+            temperatureSum += decoded.temperature[i];
+            humiditySum += decoded.humidity[i];
+            minTemperature = std::min(minTemperature, decoded.temperature[i]);
+            maxTemperature = std::max(maxTemperature, decoded.temperature[i]);
+            minHumidity = std::min(minHumidity, decoded.humidity[i]);
+            maxHumidity = std::max(maxHumidity, decoded.humidity[i]);
+        }
+    }
+
+    if (result.count == 0)
+    {
+        result.minTemperature = result.maxTemperature = result.meanTemperature = NAN;
+        result.minHumidity = result.maxHumidity = result.meanHumidity = NAN;
+        return result;
+    }
+
+    result.minTemperature = minTemperature / 10.0f;
+    result.maxTemperature = maxTemperature / 10.0f;
+    result.meanTemperature = temperatureSum / 10.0 / result.count;
+    result.minHumidity = minHumidity / 10.0f;
+    result.maxHumidity = maxHumidity / 10.0f;
+    result.meanHumidity = humiditySum / 10.0 / result.count;
+    return result;
+}
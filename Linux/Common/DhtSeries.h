@@ -0,0 +1,197 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef DHT_SERIES_H
+#define DHT_SERIES_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+// ***
+// *** An archive of readings on disk. Each breakout has its own
+// *** append-only segment, named after its bus and address, made
+// *** of blocks of up to DHT_SERIES_BLOCK_ROWS readings. A block
+// *** stores each field in its own column:
+// ***
+// ***   reading id     delta from the previous reading
+// ***   time (ms)      delta of the delta, so a steady poll is 1 byte
+// ***   temperature    delta, in tenths of a degree
+// ***   humidity       delta, in tenths of a percent
+// ***   status         runs of the same value
+// ***
+// *** The deltas are zigzag encoded and written as varints. The
+// *** block header keeps the time range and the minimum, maximum
+// *** and sum of each measurement, so an aggregate over the blocks
+// *** a query covers completely is answered from the headers.
+// ***
+// *** Beside each segment is a sparse index with one entry per
+// *** block (its time range and offset). A reader maps both files
+// *** and finds the first block of a range by a binary search, so
+// *** only the blocks at the ends of a range are ever decoded.
+// ***
+#define DHT_SERIES_BLOCK_MAGIC  0x42535444      // *** "DTSB"
+#define DHT_SERIES_INDEX_MAGIC  0x49535444      // *** "DTSI"
+#define DHT_SERIES_VERSION      1
+#define DHT_SERIES_BLOCK_ROWS   1024
+#define DHT_SERIES_COLUMNS      5
+
+#define DHT_SERIES_COLUMN_READING_ID    0
+#define DHT_SERIES_COLUMN_TIME          1
+#define DHT_SERIES_COLUMN_TEMPERATURE   2
+#define DHT_SERIES_COLUMN_HUMIDITY      3
+#define DHT_SERIES_COLUMN_STATUS        4
+
+// ***
+// *** One reading. The measurements are kept to the tenth the
+// *** breakout reports.
+// ***
+struct DhtSeriesRecord
+{
+    uint64_t time;
+    uint32_t readingId;
+    float temperature;
+    float humidity;
+    uint8_t status;
+};
+
+struct DhtSeriesBlock
+{
+    uint64_t firstTime;
+    uint64_t lastTime;
+    int64_t temperatureSum;
+    int64_t humiditySum;
+    uint32_t magic;
+    uint32_t size;
+    uint32_t firstReadingId;
+    uint32_t lastReadingId;
+    uint32_t columns[DHT_SERIES_COLUMNS];
+    uint16_t count;
+    uint8_t version;
+    uint8_t reserved;
+    int16_t minTemperature;
+    int16_t maxTemperature;
+    int16_t minHumidity;
+    int16_t maxHumidity;
+};
+
+struct DhtSeriesIndexHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint8_t reserved[8];
+};
+
+struct DhtSeriesIndexEntry
+{
+    uint64_t firstTime;
+    uint64_t lastTime;
+    uint64_t offset;
+};
+
+static_assert(sizeof(DhtSeriesBlock) == 80, "The block header layout is fixed");
+static_assert(sizeof(DhtSeriesIndexHeader) == 16, "The index header layout is fixed");
+static_assert(sizeof(DhtSeriesIndexEntry) == 24, "The index entry layout is fixed");
+
+// ***
+// *** The result of an aggregate query. The blocks counts show
+// *** how much of the range was answered from block headers.
+// ***
+struct DhtSeriesAggregate
+{
+    uint64_t count;
+    float minTemperature;
+    float maxTemperature;
+    float meanTemperature;
+    float minHumidity;
+    float maxHumidity;
+    float meanHumidity;
+    uint32_t blocksSkipped;
+    uint32_t blocksDecoded;
+};
+
+// ***
+// *** The file name of a breakout's segment, without extension.
+// ***
+std::string getSeriesName(const char* bus, uint8_t address);
+
+// ***
+// *** Appends the readings of one breakout. Readings are kept in
+// *** memory until a block is full or flush() is called, and the
+// *** files are only open while a block is written, so a writer
+// *** can be kept for every breakout of a large fleet.
+// ***
+class DhtSeriesWriter
+{
+public:
+    DhtSeriesWriter();
+    ~DhtSeriesWriter();
+
+    bool open(const char* directory, const char* bus, uint8_t address);
+    bool append(const DhtSeriesRecord& record);
+    bool flush();
+
+    uint64_t getBytesWritten() const { return _bytesWritten; };
+
+private:
+    std::string _dataPath;
+    std::string _indexPath;
+    std::vector<DhtSeriesRecord> _pending;
+    std::vector<uint8_t> _buffer;
+    uint64_t _lastTime;
+    uint64_t _bytesWritten;
+};
+
+// ***
+// *** Answers queries over one breakout's segment. The files
+// *** are mapped read only; blocks appended after open() are not
+// *** seen until the segment is opened again.
+// ***
+class DhtSeriesReader
+{
+public:
+    DhtSeriesReader();
+    ~DhtSeriesReader();
+
+    bool open(const char* directory, const char* bus, uint8_t address);
+    void close();
+
+    size_t getBlockCount() const { return _blockCount; };
+    uint64_t getFirstTime() const;
+    uint64_t getLastTime() const;
+
+    // ***
+    // *** The readings with from <= time < to.
+    // ***
+    size_t read(uint64_t from, uint64_t to, std::vector<DhtSeriesRecord>& records) const;
+    DhtSeriesAggregate aggregate(uint64_t from, uint64_t to) const;
+
+private:
+    size_t findFirstBlock(uint64_t from) const;
+    const DhtSeriesBlock* getBlock(size_t index) const;
+
+    const uint8_t* _data;
+    size_t _dataSize;
+    const uint8_t* _index;
+    size_t _indexSize;
+    const DhtSeriesIndexEntry* _entries;
+    size_t _blockCount;
+};
+
+#endif
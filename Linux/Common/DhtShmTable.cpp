@@ -0,0 +1,242 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include "DhtShmTable.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+DhtShmTable::DhtShmTable() : _header(NULL), _slots(NULL), _size(0), _owner(false)
+{
+    _name[0] = 0;
+}
+
+DhtShmTable::~DhtShmTable()
+{
+    close();
+}
+
+bool DhtShmTable::create(const char* name, uint32_t slotCount)
+{
+    close();
+
+    // ***
+    // *** Start from an empty table; readers that still have an
+    // *** old one mapped keep it until they open the name again.
+    // ***
+    shm_unlink(name);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) return false;
+
+    size_t size = sizeof(DhtShmHeader) + (size_t)slotCount * sizeof(DhtShmSlot);
+    if (ftruncate(fd, size) < 0 || !map(fd, size, true))
+    {
+        ::close(fd);
+        shm_unlink(name);
+        return false;
+    }
+
+    ::close(fd);
+    _owner = true;
+    strncpy(_name, name, sizeof(_name) - 1);
+    _name[sizeof(_name) - 1] = 0;
+
+    // ***
+    // *** The mapping is zero filled, so every sequence starts
+    // *** even and no slot is in use. The magic is written last.
+    // ***
+    _header->version = DHT_SHM_VERSION;
+    _header->slotCount = slotCount;
+    _header->slotSize = sizeof(DhtShmSlot);
+    _header->slotsUsed.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _header->magic = DHT_SHM_MAGIC;
+    return true;
+}
+
+bool DhtShmTable::open(const char* name)
+{
+    close();
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    struct stat status;
+    bool valid = fstat(fd, &status) == 0 && (size_t)status.st_size >= sizeof(DhtShmHeader) &&
+                 map(fd, status.st_size, false);
+    ::close(fd);
+
+    if (valid)
+    {
+        // ***
+        // *** Refuse a table of another layout or one that
+        // *** is larger than the file.
+        // ***
+        valid = _header->magic == DHT_SHM_MAGIC && _header->version == DHT_SHM_VERSION &&
+                _header->slotSize == sizeof(DhtShmSlot) &&
+                sizeof(DhtShmHeader) + (size_t)_header->slotCount * sizeof(DhtShmSlot) <= _size;
+    }
+
+    if (!valid) close();
+    return valid;
+}
+
+bool DhtShmTable::map(int fd, size_t size, bool writable)
+{
+    void* memory = mmap(NULL, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) return false;
+
+    _header = (DhtShmHeader*)memory;
+    _slots = (DhtShmSlot*)(_header + 1);
+    _size = size;
+    return true;
+}
+
+void DhtShmTable::close()
+{
+    if (_header != NULL)
+    {
+        munmap(_header, _size);
+        _header = NULL;
+        _slots = NULL;
+        _size = 0;
+    }
+
+    if (_owner)
+    {
+        shm_unlink(_name);
+        _owner = false;
+    }
+}
+
+int32_t DhtShmTable::claimSlot(const char* bus, uint8_t address)
+{
+    if (_header == NULL || !_owner) return -1;
+
+    std::lock_guard<std::mutex> lock(_claimLock);
+
+    int32_t slot = find(bus, address);
+    if (slot >= 0) return slot;
+
+    uint32_t used = _header->slotsUsed.load(std::memory_order_relaxed);
+    if (used == _header->slotCount) return -1;
+
+    // ***
+    // *** The key is written before the slot is counted, so a
+    // *** reader that sees the count also sees the key.
+    // ***
+    DhtShmSlot& entry = _slots[used];
+    strncpy(entry.bus, bus, DHT_SHM_BUS_SIZE - 1);
+    entry.bus[DHT_SHM_BUS_SIZE - 1] = 0;
+    entry.address = address;
+    _header->slotsUsed.store(used + 1, std::memory_order_release);
+
+    return used;
+}
+
+void DhtShmTable::publish(int32_t slot, uint32_t readingId, float temperature, float humidity, uint32_t age, uint64_t time)
+{
+    if (slot < 0 || (uint32_t)slot >= _header->slotCount) return;
+
+    DhtShmSlot& entry = _slots[slot];
+    uint32_t temperatureBits, humidityBits;
+    memcpy(&temperatureBits, &temperature, sizeof(temperatureBits));
+    memcpy(&humidityBits, &humidity, sizeof(humidityBits));
+
+    // ***
+    // *** An odd sequence tells readers an update is under way.
+    // *** The fence keeps the stores below from moving above it.
+    // ***
+    uint32_t sequence = entry.sequence.load(std::memory_order_relaxed);
+    entry.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    entry.readingId.store(readingId, std::memory_order_relaxed);
+    entry.temperature.store(temperatureBits, std::memory_order_relaxed);
+    entry.humidity.store(humidityBits, std::memory_order_relaxed);
+    entry.age.store(age, std::memory_order_relaxed);
+    entry.timeLow.store((uint32_t)time, std::memory_order_relaxed);
+    entry.timeHigh.store((uint32_t)(time >> 32), std::memory_order_relaxed);
+
+    entry.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool DhtShmTable::read(uint32_t slot, DhtShmReading& reading, uint32_t* retries) const
+{
+    if (slot >= getSlotsUsed()) return false;
+
+    const DhtShmSlot& entry = _slots[slot];
+    memcpy(reading.bus, entry.bus, DHT_SHM_BUS_SIZE);
+    reading.bus[DHT_SHM_BUS_SIZE - 1] = 0;
+    reading.address = entry.address;
+
+    uint32_t temperatureBits, humidityBits, timeLow, timeHigh;
+    uint32_t before, after;
+    uint32_t torn = 0;
+
+    while (true)
+    {
+        before = entry.sequence.load(std::memory_order_acquire);
+
+        if ((before & 1) == 0)
+        {
+            reading.readingId = entry.readingId.load(std::memory_order_relaxed);
+            temperatureBits = entry.temperature.load(std::memory_order_relaxed);
+            humidityBits = entry.humidity.load(std::memory_order_relaxed);
+            reading.age = entry.age.load(std::memory_order_relaxed);
+            timeLow = entry.timeLow.load(std::memory_order_relaxed);
+            timeHigh = entry.timeHigh.load(std::memory_order_relaxed);
+
+            // ***
+            // *** The fence keeps the loads above from moving
+            // *** below the second load of the sequence.
+            // ***
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = entry.sequence.load(std::memory_order_relaxed);
+
+            if (before == after) break;
+        }
+
+        torn++;
+    }
+
+    memcpy(&reading.temperature, &temperatureBits, sizeof(reading.temperature));
+    memcpy(&reading.humidity, &humidityBits, sizeof(reading.humidity));
+    reading.time = (uint64_t)timeHigh << 32 | timeLow;
+
+    if (retries != NULL) *retries += torn;
+    return true;
+}
+
+int32_t DhtShmTable::find(const char* bus, uint8_t address) const
+{
+    uint32_t used = getSlotsUsed();
+
+    for (uint32_t i = 0; i < used; i++)
+    {
+        if (_slots[i].address == address && strncmp(_slots[i].bus, bus, DHT_SHM_BUS_SIZE - 1) == 0)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,146 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef DHT_SHM_TABLE_H
+#define DHT_SHM_TABLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include <mutex>
+
+// ***
+// *** The latest reading of every breakout a collector polls, kept
+// *** in POSIX shared memory (/dev/shm) so any number of local
+// *** processes can read it without opening the bus themselves.
+// ***
+// *** The table is a fixed layout: a 64 byte header followed by
+// *** slotCount slots of 64 bytes. A slot is claimed for a breakout,
+// *** keyed by its bus and address, the first time it has a
+// *** reading and keeps that breakout for the life of the table.
+// *** Readers only look at the first slotsUsed slots.
+// ***
+// *** Each slot is guarded by a sequence lock. The one thread that
+// *** polls the breakout makes the sequence odd, writes the reading
+// *** and makes it even again. A reader copies the reading between
+// *** two loads of the sequence and tries again if they differ or
+// *** are odd, so it never sees half of an update and never blocks
+// *** the writer. Reading takes no system call and no lock.
+// ***
+#define DHT_SHM_MAGIC           0x53544844      // *** "DHTS"
+#define DHT_SHM_VERSION         1
+#define DHT_SHM_DEFAULT_SLOTS   128
+#define DHT_SHM_BUS_SIZE        24
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2, "Shared memory needs lock free atomics");
+
+// ***
+// *** A consistent copy of one slot.
+// ***
+struct DhtShmReading
+{
+    char bus[DHT_SHM_BUS_SIZE];
+    uint8_t address;
+    uint32_t readingId;
+    float temperature;
+    float humidity;
+    uint32_t age;
+    uint64_t time;
+};
+
+struct DhtShmHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotSize;
+    std::atomic<uint32_t> slotsUsed;
+    uint8_t reserved[44];
+};
+
+struct DhtShmSlot
+{
+    std::atomic<uint32_t> sequence;
+
+    // ***
+    // *** Set once when the slot is claimed, before it is
+    // *** counted in slotsUsed.
+    // ***
+    char bus[DHT_SHM_BUS_SIZE];
+    uint8_t address;
+    uint8_t reserved[3];
+
+    // ***
+    // *** The reading, as words so each one is copied with a
+    // *** single relaxed atomic load or store.
+    // ***
+    std::atomic<uint32_t> readingId;
+    std::atomic<uint32_t> temperature;
+    std::atomic<uint32_t> humidity;
+    std::atomic<uint32_t> age;
+    std::atomic<uint32_t> timeLow;
+    std::atomic<uint32_t> timeHigh;
+    uint8_t padding[8];
+};
+
+static_assert(sizeof(DhtShmHeader) == 64, "The header is one cache line");
+static_assert(sizeof(DhtShmSlot) == 64, "A slot is one cache line");
+
+class DhtShmTable
+{
+public:
+    DhtShmTable();
+    ~DhtShmTable();
+
+    // ***
+    // *** The publisher creates the table, replacing any table left
+    // *** by an earlier run; readers map it read only.
+    // ***
+    bool create(const char* name, uint32_t slotCount = DHT_SHM_DEFAULT_SLOTS);
+    bool open(const char* name);
+    void close();
+
+    // ***
+    // *** Publisher. Slots are claimed under a lock, which is
+    // *** only taken the first time a breakout is published;
+    // *** after that the slot index is cached by the caller.
+    // ***
+    int32_t claimSlot(const char* bus, uint8_t address);
+    void publish(int32_t slot, uint32_t readingId, float temperature, float humidity, uint32_t age, uint64_t time);
+
+    // ***
+    // *** Reader. read() returns false for a slot that is not
+    // *** in use; retries counts the copies that were torn.
+    // ***
+    uint32_t getSlotCount() const { return _header ? _header->slotCount : 0; };
+    uint32_t getSlotsUsed() const { return _header ? _header->slotsUsed.load(std::memory_order_acquire) : 0; };
+    bool read(uint32_t slot, DhtShmReading& reading, uint32_t* retries = NULL) const;
+    int32_t find(const char* bus, uint8_t address) const;
+
+private:
+    bool map(int fd, size_t size, bool writable);
+
+    DhtShmHeader* _header;
+    DhtShmSlot* _slots;
+    size_t _size;
+    bool _owner;
+    std::mutex _claimLock;
+    char _name[64];
+};
+
+#endif
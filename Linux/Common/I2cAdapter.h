@@ -0,0 +1,67 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef I2C_ADAPTER_H
+#define I2C_ADAPTER_H
+
+#include <stdint.h>
+#include <unistd.h>
+
+// ***
+// *** An I2C adapter as seen by the host tools: either a real
+// *** i2c-dev bus (I2cBus) or a simulated one (MockI2cAdapter).
+// *** Each adapter counts the transfers it makes; for I2cBus that
+// *** is the number of ioctl system calls.
+// ***
+class I2cAdapter
+{
+public:
+    I2cAdapter() : _transfers(0) {};
+    virtual ~I2cAdapter() {}
+
+    // ***
+    // *** Select the register and read count bytes starting at it.
+    // ***
+    virtual bool readRegisters(uint8_t address, uint8_t registerId, uint8_t* buffer, uint16_t count) = 0;
+
+    // ***
+    // *** Write count bytes starting at the register.
+    // ***
+    virtual bool writeRegisters(uint8_t address, uint8_t registerId, const uint8_t* buffer, uint16_t count) = 0;
+
+    // ***
+    // *** Write the command bytes and read count bytes. An adapter
+    // *** that can only select a register takes a one byte command.
+    // ***
+    virtual bool readCommand(uint8_t address, const uint8_t* command, uint16_t commandCount, uint8_t* buffer, uint16_t count)
+    {
+        return commandCount == 1 && readRegisters(address, command[0], buffer, count);
+    };
+
+    // ***
+    // *** Leave the bus idle for a time.
+    // ***
+    virtual void wait(uint32_t milliseconds) { usleep(milliseconds * 1000); };
+
+    uint64_t getTransferCount() const { return _transfers; };
+
+protected:
+    uint64_t _transfers;
+};
+
+#endif
@@ -0,0 +1,108 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include "I2cBus.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+I2cBus::I2cBus(bool combined) : _fd(-1), _combined(combined)
+{
+}
+
+I2cBus::~I2cBus()
+{
+    close();
+}
+
+bool I2cBus::open(const char* device)
+{
+    close();
+    _fd = ::open(device, O_RDWR);
+    return _fd >= 0;
+}
+
+void I2cBus::close()
+{
+    if (_fd >= 0)
+    {
+        ::close(_fd);
+        _fd = -1;
+    }
+}
+
+bool I2cBus::readRegisters(uint8_t address, uint8_t registerId, uint8_t* buffer, uint16_t count)
+{
+    return readCommand(address, &registerId, 1, buffer, count);
+}
+
+bool I2cBus::readCommand(uint8_t address, const uint8_t* command, uint16_t commandCount, uint8_t* buffer, uint16_t count)
+{
+    struct i2c_msg messages[2];
+    messages[0].addr = address;
+    messages[0].flags = 0;
+    messages[0].len = commandCount;
+    messages[0].buf = (uint8_t*)command;
+    messages[1].addr = address;
+    messages[1].flags = I2C_M_RD;
+    messages[1].len = count;
+    messages[1].buf = buffer;
+
+    if (_combined)
+    {
+        return transfer(messages, 2);
+    }
+
+    return transfer(&messages[0], 1) && transfer(&messages[1], 1);
+}
+
+bool I2cBus::writeRegisters(uint8_t address, uint8_t registerId, const uint8_t* buffer, uint16_t count)
+{
+    // ***
+    // *** The register id leads the data in a single write.
+    // ***
+    uint8_t message[1 + 255];
+    if (count > sizeof(message) - 1) return false;
+
+    message[0] = registerId;
+    memcpy(&message[1], buffer, count);
+
+    struct i2c_msg messages[1];
+    messages[0].addr = address;
+    messages[0].flags = 0;
+    messages[0].len = count + 1;
+    messages[0].buf = message;
+
+    return transfer(messages, 1);
+}
+
+bool I2cBus::transfer(struct i2c_msg* messages, uint32_t count)
+{
+    if (_fd < 0) return false;
+
+    struct i2c_rdwr_ioctl_data data;
+    data.msgs = messages;
+    data.nmsgs = count;
+
+    _transfers++;
+    return ioctl(_fd, I2C_RDWR, &data) == (int)count;
+}
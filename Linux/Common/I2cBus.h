@@ -0,0 +1,54 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include "I2cAdapter.h"
+
+struct i2c_msg;
+
+// ***
+// *** A Linux i2c-dev adapter (for example /dev/i2c-1). A register
+// *** read is the register id write and the data read combined in
+// *** one I2C_RDWR call with a repeated start between them. Pass
+// *** combined = false to send them as separate transactions with
+// *** a stop between, the way the Arduino master does.
+// ***
+class I2cBus : public I2cAdapter
+{
+public:
+    I2cBus(bool combined = true);
+    ~I2cBus();
+
+    bool open(const char* device);
+    void close();
+    bool isOpen() const { return _fd >= 0; }
+
+    virtual bool readRegisters(uint8_t address, uint8_t registerId, uint8_t* buffer, uint16_t count);
+    virtual bool writeRegisters(uint8_t address, uint8_t registerId, const uint8_t* buffer, uint16_t count);
+    virtual bool readCommand(uint8_t address, const uint8_t* command, uint16_t commandCount, uint8_t* buffer, uint16_t count);
+
+private:
+    bool transfer(struct i2c_msg* messages, uint32_t count);
+
+    int _fd;
+    bool _combined;
+};
+
+#endif
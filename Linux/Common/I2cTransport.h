@@ -0,0 +1,57 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef I2C_TRANSPORT_H
+#define I2C_TRANSPORT_H
+
+#include "DhtTinyTransport.h"
+#include "I2cAdapter.h"
+
+// ***
+// *** DhtTinyClient transport over a host I2C adapter.
+// ***
+class I2cTransport : public DhtTinyTransport
+{
+public:
+    I2cTransport(I2cAdapter& adapter) : _adapter(adapter) {};
+
+    virtual bool read(uint8_t address, uint8_t registerId, uint8_t* buffer, uint8_t count)
+    {
+        return _adapter.readRegisters(address, registerId, buffer, count);
+    }
+
+    virtual bool write(uint8_t address, uint8_t registerId, const uint8_t* buffer, uint8_t count)
+    {
+        return _adapter.writeRegisters(address, registerId, buffer, count);
+    }
+
+    virtual void wait(uint16_t milliseconds)
+    {
+        _adapter.wait(milliseconds);
+    }
+
+    virtual bool transfer(uint8_t address, const uint8_t* command, uint8_t commandCount, uint8_t* buffer, uint8_t count)
+    {
+        return _adapter.readCommand(address, command, commandCount, buffer, count);
+    }
+
+private:
+    I2cAdapter& _adapter;
+};
+
+#endif
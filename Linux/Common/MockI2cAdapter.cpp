@@ -0,0 +1,124 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include "MockI2cAdapter.h"
+
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+static uint64_t monotonicNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+void MockI2cAdapter::addDevice(uint8_t address, uint32_t interval)
+{
+    Device device;
+    memset(&device, 0, sizeof(device));
+    device.address = address;
+    device.started = monotonicNs();
+
+    device.registers[REGISTER_ID] = 0x2D;
+    device.registers[REGISTER_VER_MAJOR] = 1;
+    device.registers[REGISTER_VER_MINOR] = 2;
+    device.registers[REGISTER_CONFIG] = 1 << CONFIG_BIT_SENSOR_ENABLED;
+    device.registers[REGISTER_DEVICE_ADDRESS] = address;
+    device.registers[REGISTER_DHT_MODEL] = 22;
+    memcpy(&device.registers[REGISTER_INTERVAL], &interval, SIZE_UINT32);
+    memcpy(&device.registers[REGISTER_CURRENT_INTERVAL], &interval, SIZE_UINT32);
+
+    _devices.push_back(device);
+}
+
+bool MockI2cAdapter::readRegisters(uint8_t address, uint8_t registerId, uint8_t* buffer, uint16_t count)
+{
+    _transfers++;
+    wait(count + 2);
+
+    Device* device = findDevice(address);
+    if (device == NULL || registerId + count > REGISTER_TOTAL_SIZE) return false;
+
+    updateDevice(*device);
+    memcpy(buffer, &device->registers[registerId], count);
+    return true;
+}
+
+bool MockI2cAdapter::writeRegisters(uint8_t address, uint8_t registerId, const uint8_t* buffer, uint16_t count)
+{
+    _transfers++;
+    wait(count + 2);
+
+    Device* device = findDevice(address);
+    if (device == NULL || registerId + count > REGISTER_TOTAL_SIZE) return false;
+
+    memcpy(&device->registers[registerId], buffer, count);
+    return true;
+}
+
+MockI2cAdapter::Device* MockI2cAdapter::findDevice(uint8_t address)
+{
+    for (size_t i = 0; i < _devices.size(); i++)
+    {
+        if (_devices[i].address == address) return &_devices[i];
+    }
+
+    return NULL;
+}
+
+void MockI2cAdapter::updateDevice(Device& device)
+{
+    // ***
+    // *** Take the readings that are due since the last access.
+    // ***
+    uint32_t interval;
+    memcpy(&interval, &device.registers[REGISTER_INTERVAL], SIZE_UINT32);
+    if (interval == 0) return;
+
+    uint64_t now = monotonicNs();
+    uint32_t readingId = (now - device.started) / (interval * 1000000ULL) + 1;
+    if (readingId == device.readingId) return;
+
+    device.readingId = readingId;
+    uint32_t readingTime = (now - device.started) / 1000000ULL;
+    float temperature = 21.0 + 2.0 * sin(readingId * 0.05 + device.address);
+    float humidity = 45.0 + 5.0 * cos(readingId * 0.03 + device.address);
+    uint32_t age = 0;
+
+    memcpy(&device.registers[REGISTER_TEMPERATURE], &temperature, SIZE_FLOAT);
+    memcpy(&device.registers[REGISTER_HUMIDITY], &humidity, SIZE_FLOAT);
+    memcpy(&device.registers[REGISTER_READING_ID], &readingId, SIZE_UINT32);
+    memcpy(&device.registers[REGISTER_READING_TIME], &readingTime, SIZE_UINT32);
+    memcpy(&device.registers[REGISTER_READING_AGE], &age, SIZE_UINT32);
+}
+
+void MockI2cAdapter::wait(uint16_t bytes)
+{
+    if (_byteTime == 0) return;
+
+    // ***
+    // *** Spin rather than sleep; the times are far below the
+    // *** resolution of a sleep.
+    // ***
+    uint64_t until = monotonicNs() + (uint64_t)_byteTime * bytes;
+    while (monotonicNs() < until)
+    {
+    }
+}
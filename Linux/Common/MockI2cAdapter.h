@@ -0,0 +1,61 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef MOCK_I2C_ADAPTER_H
+#define MOCK_I2C_ADAPTER_H
+
+#include <vector>
+#include "I2cAdapter.h"
+#include "DhtTinyRegisters.h"
+
+// ***
+// *** A simulated adapter with DHT Tiny Breakouts on it, for
+// *** running the host tools without I2C hardware. Each breakout
+// *** takes a new reading every interval milliseconds on the
+// *** monotonic clock. When byteTime is set, every transfer takes
+// *** that many nanoseconds per byte on the wire (about 22500 at
+// *** 400 kHz) so throughput is bounded like a real bus.
+// ***
+class MockI2cAdapter : public I2cAdapter
+{
+public:
+    MockI2cAdapter(uint32_t byteTime = 0) : _byteTime(byteTime) {};
+
+    void addDevice(uint8_t address, uint32_t interval);
+
+    virtual bool readRegisters(uint8_t address, uint8_t registerId, uint8_t* buffer, uint16_t count);
+    virtual bool writeRegisters(uint8_t address, uint8_t registerId, const uint8_t* buffer, uint16_t count);
+
+private:
+    struct Device
+    {
+        uint8_t address;
+        uint64_t started;
+        uint32_t readingId;
+        uint8_t registers[REGISTER_TOTAL_SIZE];
+    };
+
+    Device* findDevice(uint8_t address);
+    void updateDevice(Device& device);
+    void wait(uint16_t bytes);
+
+    uint32_t _byteTime;
+    std::vector<Device> _devices;
+};
+
+#endif
@@ -0,0 +1,33 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef ARDUINO_SHIM_H
+#define ARDUINO_SHIM_H
+
+// ***
+// *** Just enough of Arduino.h for host programs to include the
+// *** breakout's register definitions (Register_Defs.h) and use
+// *** the same size and protection tables as the firmware.
+// ***
+#include <stdint.h>
+#include <string.h>
+#include <avr/pgmspace.h>
+
+typedef uint8_t byte;
+
+#endif
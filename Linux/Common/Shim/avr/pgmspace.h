@@ -0,0 +1,32 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef PGMSPACE_SHIM_H
+#define PGMSPACE_SHIM_H
+
+#include <stdint.h>
+
+// ***
+// *** On the host, flash tables are ordinary constant data.
+// ***
+#define PROGMEM
+#define pgm_read_byte(address)  (*(const uint8_t*)(address))
+#define pgm_read_word(address)  (*(const uint16_t*)(address))
+#define pgm_read_ptr(address)   (*(void* const*)(address))
+
+#endif
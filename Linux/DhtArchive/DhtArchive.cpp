@@ -0,0 +1,394 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+
+// ***
+// *** Records readings in the columnar archive (Common/DhtSeries.h)
+// *** and queries it.
+// ***
+// ***   DhtCollector --bus /dev/i2c-1 | DhtArchive ingest archive
+// ***   DhtArchive query archive i2c-1 0x26 --from 1700000000000 --to 1700003600000
+// ***   DhtArchive aggregate archive i2c-1 0x26
+// ***
+// *** ingest reads the lines DhtCollector prints. bench fills a
+// *** directory with a synthetic fleet and times ingest and queries:
+// ***
+// ***   DhtArchive bench /tmp/archive --devices 500 --days 365 --interval 60
+// ***
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "DhtSeries.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: DhtArchive ingest <directory>\n"
+            "       DhtArchive query <directory> <bus> <address> [--from <ms>] [--to <ms>]\n"
+            "       DhtArchive aggregate <directory> <bus> <address> [--from <ms>] [--to <ms>]\n"
+            "       DhtArchive bench <directory> [--devices <n>] [--days <n>] [--interval <s>]\n");
+}
+
+static bool makeDirectory(const char* directory)
+{
+    if (mkdir(directory, 0755) == 0 || errno == EEXIST) return true;
+
+    perror(directory);
+    return false;
+}
+
+static double elapsedSince(Clock::time_point start)
+{
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+static int ingest(const char* directory)
+{
+    if (!makeDirectory(directory)) return 1;
+
+    std::map<std::string, DhtSeriesWriter*> writers;
+    uint64_t lines = 0, rejected = 0;
+    char line[256];
+
+    while (fgets(line, sizeof(line), stdin) != NULL)
+    {
+        // ***
+        // *** time bus address reading-id temperature humidity age [status]
+        // ***
+        unsigned long long time;
+        char bus[64];
+        unsigned int address, readingId, age, status = 0;
+        DhtSeriesRecord record;
+
+        int fields = sscanf(line, "%llu %63s %x %u %f %f %u %u", &time, bus, &address, &readingId,
+                            &record.temperature, &record.humidity, &age, &status);
+        if (fields < 7 || address > 0x7F)
+        {
+            rejected++;
+            continue;
+        }
+
+        record.time = time;
+        record.readingId = readingId;
+        record.status = status;
+
+        std::string key = getSeriesName(bus, address);
+        std::map<std::string, DhtSeriesWriter*>::iterator writer = writers.find(key);
+        if (writer == writers.end())
+        {
+            DhtSeriesWriter* created = new DhtSeriesWriter();
+            if (!created->open(directory, bus, address))
+            {
+                fprintf(stderr, "%s: could not open %s\n", directory, key.c_str());
+                delete created;
+                return 1;
+            }
+
+            writer = writers.insert(std::make_pair(key, created)).first;
+        }
+
+        if (writer->second->append(record)) lines++;
+        else rejected++;
+    }
+
+    for (std::map<std::string, DhtSeriesWriter*>::iterator i = writers.begin(); i != writers.end(); i++)
+    {
+        delete i->second;
+    }
+
+    fprintf(stderr, "readings   %llu\n", (unsigned long long)lines);
+    fprintf(stderr, "rejected   %llu\n", (unsigned long long)rejected);
+    return 0;
+}
+
+static int query(const char* directory, const char* bus, uint8_t address, uint64_t from, uint64_t to, bool summary)
+{
+    DhtSeriesReader reader;
+    if (!reader.open(directory, bus, address))
+    {
+        fprintf(stderr, "%s: no archive of %s\n", directory, getSeriesName(bus, address).c_str());
+        return 1;
+    }
+
+    if (summary)
+    {
+        DhtSeriesAggregate result = reader.aggregate(from, to);
+        printf("readings     %llu\n", (unsigned long long)result.count);
+        printf("temperature  %.1f / %.2f / %.1f\n", result.minTemperature, result.meanTemperature, result.maxTemperature);
+        printf("humidity     %.1f / %.2f / %.1f\n", result.minHumidity, result.meanHumidity, result.maxHumidity);
+        printf("blocks       %u from headers, %u decoded\n", result.blocksSkipped, result.blocksDecoded);
+        return 0;
+    }
+
+    std::vector<DhtSeriesRecord> records;
+    reader.read(from, to, records);
+
+    for (size_t i = 0; i < records.size(); i++)
+    {
+        printf("%llu %s 0x%02X %u %.1f %.1f %u\n", (unsigned long long)records[i].time, bus, address,
+               records[i].readingId, records[i].temperature, records[i].humidity, records[i].status);
+    }
+
+    return 0;
+}
+
+// ***
+// *** A breakout in a room: a daily cycle with a slow random
+// *** walk on top, polled with a little jitter, and now and
+// *** then a failed read.
+// ***
+struct SyntheticDevice
+{
+    uint32_t random;
+    uint32_t readingId;
+    float base;
+    float drift;
+};
+
+static inline uint32_t nextRandom(uint32_t& state)
+{
+    state = state * 1664525 + 1013904223;
+    return state >> 8;
+}
+
+static void makeRecord(SyntheticDevice& device, uint64_t time, DhtSeriesRecord& record)
+{
+    double day = fmod(time / 86400000.0, 1.0);
+    device.drift += ((int32_t)(nextRandom(device.random) % 21) - 10) / 100.0f;
+    device.drift *= 0.995f;
+
+    record.time = time + nextRandom(device.random) % 20;
+    record.readingId = ++device.readingId;
+    record.temperature = roundf((device.base + 3.0f * sin(day * 2 * M_PI) + device.drift) * 10) / 10;
+    record.humidity = roundf((45.0f - 8.0f * sin(day * 2 * M_PI) - device.drift) * 10) / 10;
+    record.status = nextRandom(device.random) % 1000 == 0 ? 1 : 0;
+}
+
+struct Latency
+{
+    const char* name;
+    std::vector<double> samples;
+};
+
+static void printLatency(Latency& latency)
+{
+    std::sort(latency.samples.begin(), latency.samples.end());
+    size_t n = latency.samples.size();
+    printf("%-22s p50 %9.1f us   p99 %9.1f us\n", latency.name, latency.samples[n / 2] * 1e6,
+           latency.samples[std::min(n - 1, n * 99 / 100)] * 1e6);
+}
+
+static int bench(const char* directory, uint32_t devices, uint32_t days, uint32_t interval)
+{
+    if (!makeDirectory(directory)) return 1;
+
+    const uint64_t start = 1700000000000ULL;
+    const uint64_t step = interval * 1000ULL;
+    const uint64_t span = days * 86400000ULL;
+
+    std::vector<SyntheticDevice> fleet(devices);
+    std::vector<DhtSeriesWriter> writers(devices);
+    char bus[16];
+
+    for (uint32_t d = 0; d < devices; d++)
+    {
+        snprintf(bus, sizeof(bus), "bench%u", d / 100);
+        if (!writers[d].open(directory, bus, 0x08 + d % 100))
+        {
+            fprintf(stderr, "%s: could not open a segment\n", directory);
+            return 1;
+        }
+
+        fleet[d].random = d * 7919 + 1;
+        fleet[d].readingId = 0;
+        fleet[d].base = 18.0f + d % 10;
+        fleet[d].drift = 0;
+    }
+
+    // ***
+    // *** Ingest in time order across the fleet, as a collector
+    // *** would. The size of the same readings as DhtCollector
+    // *** lines is estimated from one reading in every 1000.
+    // ***
+    uint64_t rows = 0, textBytes = 0, textRows = 0;
+    DhtSeriesRecord record;
+    char line[128];
+
+    Clock::time_point started = Clock::now();
+    for (uint64_t time = start; time < start + span; time += step)
+    {
+        for (uint32_t d = 0; d < devices; d++)
+        {
+            makeRecord(fleet[d], time, record);
+            writers[d].append(record);
+
+            if (rows++ % 1000 == 0)
+            {
+                textBytes += snprintf(line, sizeof(line), "%llu bench%u 0x%02X %u %.1f %.1f %u\n",
+                                      (unsigned long long)record.time, d / 100, 0x08 + d % 100,
+                                      record.readingId, record.temperature, record.humidity, 0);
+                textRows++;
+            }
+        }
+    }
+
+    uint64_t bytes = 0;
+    for (uint32_t d = 0; d < devices; d++)
+    {
+        writers[d].flush();
+        bytes += writers[d].getBytesWritten();
+    }
+
+    double ingestTime = elapsedSince(started);
+    printf("devices    %u\n", devices);
+    printf("readings   %llu (%u days every %u s)\n", (unsigned long long)rows, days, interval);
+    printf("ingest     %.1f s (%.2f M readings/s)\n", ingestTime, rows / ingestTime / 1e6);
+    printf("size       %.1f MB (%.2f bytes/reading, text %.1f bytes/reading)\n", bytes / 1e6,
+           (double)bytes / rows, textRows ? (double)textBytes / textRows : 0.0);
+
+    // ***
+    // *** Random queries against every device. The files are in
+    // *** the page cache after ingest, so these are warm times.
+    // ***
+    std::vector<DhtSeriesReader> readers(devices);
+    for (uint32_t d = 0; d < devices; d++)
+    {
+        snprintf(bus, sizeof(bus), "bench%u", d / 100);
+        readers[d].open(directory, bus, 0x08 + d % 100);
+    }
+
+    Latency latencies[] =
+    {
+        { "read 1 hour", {} },
+        { "read 1 day", {} },
+        { "aggregate 1 day", {} },
+        { "aggregate 30 days", {} },
+        { "aggregate all", {} }
+    };
+    const uint64_t lengths[] = { 3600000ULL, 86400000ULL, 86400000ULL, 30 * 86400000ULL, span };
+
+    uint32_t random = 12345;
+    uint64_t checksum = 0, decoded = 0, skipped = 0;
+    std::vector<DhtSeriesRecord> records;
+
+    for (uint32_t q = 0; q < 1000; q++)
+    {
+        for (uint32_t k = 0; k < 5; k++)
+        {
+            const DhtSeriesReader& reader = readers[nextRandom(random) % devices];
+            uint64_t length = std::min(lengths[k], span);
+            uint64_t from = start + (span > length ? nextRandom(random) % ((span - length) / 1000) * 1000 : 0);
+
+            Clock::time_point begin = Clock::now();
+            if (k < 2)
+            {
+                records.clear();
+                checksum += reader.read(from, from + length, records);
+            }
+            else
+            {
+                DhtSeriesAggregate result = reader.aggregate(from, from + length);
+                checksum += result.count;
+                decoded += result.blocksDecoded;
+                skipped += result.blocksSkipped;
+            }
+
+            latencies[k].samples.push_back(elapsedSince(begin));
+        }
+    }
+
+    for (uint32_t k = 0; k < 5; k++)
+    {
+        printLatency(latencies[k]);
+    }
+
+    printf("aggregates %llu blocks from headers, %llu decoded\n", (unsigned long long)skipped, (unsigned long long)decoded);
+    printf("checksum   %llu\n", (unsigned long long)checksum);
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        usage();
+        return 1;
+    }
+
+    const char* command = argv[1];
+    const char* directory = argv[2];
+
+    if (strcmp(command, "ingest") == 0 && argc == 3) return ingest(directory);
+
+    if ((strcmp(command, "query") == 0 || strcmp(command, "aggregate") == 0) && argc >= 5)
+    {
+        uint64_t from = 0, to = UINT64_MAX;
+        for (int i = 5; i < argc; i++)
+        {
+            bool hasValue = i + 1 < argc;
+            if (strcmp(argv[i], "--from") == 0 && hasValue) from = strtoull(argv[++i], NULL, 0);
+            else if (strcmp(argv[i], "--to") == 0 && hasValue) to = strtoull(argv[++i], NULL, 0);
+            else
+            {
+                usage();
+                return 1;
+            }
+        }
+
+        return query(directory, argv[3], strtoul(argv[4], NULL, 0), from, to, strcmp(command, "aggregate") == 0);
+    }
+
+    if (strcmp(command, "bench") == 0)
+    {
+        uint32_t devices = 500, days = 365, interval = 60;
+        for (int i = 3; i < argc; i++)
+        {
+            bool hasValue = i + 1 < argc;
+            if (strcmp(argv[i], "--devices") == 0 && hasValue) devices = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--days") == 0 && hasValue) days = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--interval") == 0 && hasValue) interval = atoi(argv[++i]);
+            else
+            {
+                usage();
+                return 1;
+            }
+        }
+
+        if (devices == 0 || days == 0 || interval == 0)
+        {
+            usage();
+            return 1;
+        }
+
+        return bench(directory, devices, days, interval);
+    }
+
+    usage();
+    return 1;
+}
@@ -0,0 +1,490 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+
+// ***
+// *** Pulls raw frame captures from DHT Tiny Breakouts and replays
+// *** them through the breakout's bit decoder offline.
+// ***
+// ***   DhtCapture pull --bus /dev/i2c-1 --address 0x40-0x47 --count 100 > field.cap
+// ***   DhtCapture replay --model 22 field.cap
+// ***   DhtCapture replay --model 22 --sweep field.cap
+// ***
+// *** Each capture is one line of text:
+// ***
+// ***   <address> <reading id> <result> <timeout> <shift> <frame hex> <40 pulse widths>
+// ***
+// *** The pulse widths are the loop counts of the high phase of
+// *** each bit (rising edge to falling edge) shifted right by
+// *** <shift>. Captures pulled from firmware that timed the whole
+// *** bit period do not replay correctly.
+// ***
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <vector>
+
+#include "DhtTinyRegisters.h"
+#include "DhtBits.h"
+#include "I2cBus.h"
+
+#define BREAKOUT_ID                 0x2D
+#define CAPTURE_BLOCK_SIZE          ((CAPTURE_BLOCK_END) - (CAPTURE_BLOCK_START))
+#define CAPTURE_OFFSET(r)           ((r) - (CAPTURE_BLOCK_START))
+
+struct Capture
+{
+    uint8_t address;
+    uint32_t readingId;
+    int8_t result;
+    uint16_t timeout;
+    uint8_t shift;
+    uint8_t frame[CAPTURE_FRAME_SIZE];
+    uint8_t pulses[CAPTURE_PULSE_COUNT];
+};
+
+struct DecoderSettings
+{
+    uint8_t leadingZeroBits;
+    uint8_t deltaDivisor;
+    uint8_t humidityMask;
+    uint8_t temperatureMask;
+    bool highResolution;
+};
+
+static volatile sig_atomic_t _stop = 0;
+
+static void onSignal(int)
+{
+    _stop = 1;
+}
+
+static uint32_t toUint32(const uint8_t* bytes)
+{
+    return (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+}
+
+// ***
+// *** Capture records.
+// ***
+static void writeCapture(FILE* file, const Capture& capture)
+{
+    fprintf(file, "0x%02X %u %d %u %u ", capture.address, capture.readingId, capture.result, capture.timeout, capture.shift);
+
+    for (int i = 0; i < CAPTURE_FRAME_SIZE; i++)
+    {
+        fprintf(file, "%02X", capture.frame[i]);
+    }
+
+    for (int i = 0; i < CAPTURE_PULSE_COUNT; i++)
+    {
+        fprintf(file, " %u", capture.pulses[i]);
+    }
+
+    fprintf(file, "\n");
+}
+
+static bool parseCapture(const char* line, Capture& capture)
+{
+    unsigned int address, readingId, timeout, shift;
+    int result, used;
+    char frame[2 * CAPTURE_FRAME_SIZE + 1];
+
+    if (sscanf(line, "%x %u %d %u %u %10s%n", &address, &readingId, &result, &timeout, &shift, frame, &used) != 6 ||
+        strlen(frame) != 2 * CAPTURE_FRAME_SIZE)
+    {
+        return false;
+    }
+
+    capture.address = address;
+    capture.readingId = readingId;
+    capture.result = result;
+    capture.timeout = timeout;
+    capture.shift = shift;
+
+    for (int i = 0; i < CAPTURE_FRAME_SIZE; i++)
+    {
+        unsigned int value;
+        if (sscanf(&frame[2 * i], "%2x", &value) != 1) return false;
+        capture.frame[i] = value;
+    }
+
+    const char* p = line + used;
+    for (int i = 0; i < CAPTURE_PULSE_COUNT; i++)
+    {
+        char* end;
+        unsigned long value = strtoul(p, &end, 10);
+        if (end == p || value > 255) return false;
+        capture.pulses[i] = value;
+        p = end;
+    }
+
+    return true;
+}
+
+static void readCaptures(FILE* file, std::vector<Capture>& captures)
+{
+    char line[512];
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        Capture capture;
+        if (line[0] != '#' && parseCapture(line, capture))
+        {
+            captures.push_back(capture);
+        }
+    }
+}
+
+// ***
+// *** A capture run through the breakout's own bit decision and
+// *** checksum test (DHT_Tiny_Breakout/DhtBits.h). The pulse
+// *** widths are turned back into the loop counts the decoder saw.
+// ***
+static int8_t replayCapture(const Capture& capture, const DecoderSettings& settings, uint8_t* bits)
+{
+    DhtBits frame;
+    beginDhtBits(frame, settings.leadingZeroBits, settings.deltaDivisor);
+
+    for (uint8_t i = 0; i < CAPTURE_PULSE_COUNT; i++)
+    {
+        uint16_t width = (uint16_t)capture.pulses[i] << capture.shift;
+
+        // ***
+        // *** A zero width is a bit the sensor never sent.
+        // ***
+        if (width == 0 || width >= capture.timeout) return DHTLIB_ERROR_TIMEOUT;
+
+        addDhtBit(frame, width);
+    }
+
+    memcpy(bits, frame.frame, CAPTURE_FRAME_SIZE);
+    return checkDhtFrame(bits, settings.humidityMask, settings.temperatureMask, settings.highResolution) ?
+           DHTLIB_OK : DHTLIB_ERROR_CHECKSUM;
+}
+
+struct ReplaySummary
+{
+    uint32_t frames;
+    uint32_t passed;
+    uint32_t recovered;
+    uint32_t lost;
+};
+
+static ReplaySummary replayAll(const std::vector<Capture>& captures, const DecoderSettings& settings)
+{
+    ReplaySummary summary = { 0, 0, 0, 0 };
+
+    for (size_t i = 0; i < captures.size(); i++)
+    {
+        const Capture& capture = captures[i];
+
+        // ***
+        // *** Only reads that got as far as the data bits have a frame.
+        // ***
+        if (capture.result != DHTLIB_OK && capture.result != DHTLIB_ERROR_CHECKSUM) continue;
+
+        uint8_t bits[CAPTURE_FRAME_SIZE];
+        bool passed = replayCapture(capture, settings, bits) == DHTLIB_OK;
+
+        summary.frames++;
+        if (passed) summary.passed++;
+        if (passed && capture.result != DHTLIB_OK) summary.recovered++;
+        if (!passed && capture.result == DHTLIB_OK) summary.lost++;
+    }
+
+    return summary;
+}
+
+static int replay(int argc, char** argv)
+{
+    DecoderSettings settings = { 6, DHT_BITS_DIVISOR, 0x03, 0x83, true };
+    bool sweep = false;
+    std::vector<Capture> captures;
+    bool haveFile = false;
+
+    for (int i = 0; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--model") == 0 && i + 1 < argc)
+        {
+            if (atoi(argv[++i]) == 11)
+            {
+                settings.leadingZeroBits = 1;
+                settings.humidityMask = 0x7F;
+                settings.temperatureMask = 0x7F;
+                settings.highResolution = false;
+            }
+        }
+        else if (strcmp(argv[i], "--leading") == 0 && i + 1 < argc)
+        {
+            settings.leadingZeroBits = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--divisor") == 0 && i + 1 < argc)
+        {
+            settings.deltaDivisor = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--sweep") == 0)
+        {
+            sweep = true;
+        }
+        else
+        {
+            FILE* file = strcmp(argv[i], "-") == 0 ? stdin : fopen(argv[i], "r");
+            if (file == NULL)
+            {
+                perror(argv[i]);
+                return 1;
+            }
+            readCaptures(file, captures);
+            if (file != stdin) fclose(file);
+            haveFile = true;
+        }
+    }
+
+    if (!haveFile) readCaptures(stdin, captures);
+
+    if (settings.leadingZeroBits < 1 || settings.leadingZeroBits >= CAPTURE_PULSE_COUNT || settings.deltaDivisor == 0)
+    {
+        fprintf(stderr, "invalid decoder settings\n");
+        return 1;
+    }
+
+    if (!sweep)
+    {
+        ReplaySummary summary = replayAll(captures, settings);
+        printf("captures   %zu\n", captures.size());
+        printf("frames     %u\n", summary.frames);
+        printf("passed     %u (%.2f%%)\n", summary.passed, summary.frames ? 100.0 * summary.passed / summary.frames : 0.0);
+        printf("recovered  %u\n", summary.recovered);
+        printf("lost       %u\n", summary.lost);
+        return 0;
+    }
+
+    // ***
+    // *** Pass rate for each leading zero count and delta divisor.
+    // ***
+    printf("leading divisor   passed  recovered  lost\n");
+    for (uint8_t leading = 1; leading <= 8; leading++)
+    {
+        for (uint8_t divisor = 2; divisor <= 8; divisor++)
+        {
+            settings.leadingZeroBits = leading;
+            settings.deltaDivisor = divisor;
+            ReplaySummary summary = replayAll(captures, settings);
+            printf("%7u %7u %7.2f%% %10u %5u\n", leading, divisor,
+                   summary.frames ? 100.0 * summary.passed / summary.frames : 0.0,
+                   summary.recovered, summary.lost);
+        }
+    }
+
+    return 0;
+}
+
+// ***
+// *** Pulling captures from the breakouts.
+// ***
+struct Device
+{
+    uint8_t address;
+    uint8_t config;
+    uint32_t lastReadingId;
+    uint32_t captures;
+};
+
+static bool readReadingId(I2cBus& bus, uint8_t address, uint32_t& readingId)
+{
+    uint8_t buffer[SIZE_UINT32];
+    if (!bus.readRegisters(address, REGISTER_READING_ID, buffer, sizeof(buffer))) return false;
+    readingId = toUint32(buffer);
+    return true;
+}
+
+static bool readCapture(I2cBus& bus, uint8_t address, uint8_t chunk, Capture& capture)
+{
+    // ***
+    // *** Every byte of the capture block is startable, so the
+    // *** block is read in pieces no larger than the breakout's
+    // *** transmit buffer.
+    // ***
+    uint8_t block[CAPTURE_BLOCK_SIZE];
+    for (uint8_t offset = 0; offset < CAPTURE_BLOCK_SIZE; offset += chunk)
+    {
+        uint8_t count = CAPTURE_BLOCK_SIZE - offset < chunk ? CAPTURE_BLOCK_SIZE - offset : chunk;
+        if (!bus.readRegisters(address, CAPTURE_BLOCK_START + offset, &block[offset], count)) return false;
+    }
+
+    capture.address = address;
+    capture.result = (int8_t)block[CAPTURE_OFFSET(REGISTER_CAPTURE_RESULT)];
+    capture.timeout = block[CAPTURE_OFFSET(REGISTER_CAPTURE_TIMEOUT)] | (block[CAPTURE_OFFSET(REGISTER_CAPTURE_TIMEOUT) + 1] << 8);
+    capture.shift = block[CAPTURE_OFFSET(REGISTER_CAPTURE_SHIFT)];
+    memcpy(capture.frame, &block[CAPTURE_OFFSET(REGISTER_CAPTURE_FRAME)], CAPTURE_FRAME_SIZE);
+    memcpy(capture.pulses, &block[CAPTURE_OFFSET(REGISTER_CAPTURE_PULSES)], CAPTURE_PULSE_COUNT);
+    return true;
+}
+
+static bool parseAddresses(const char* text, std::vector<Device>& devices)
+{
+    // ***
+    // *** A comma separated list of addresses and ranges,
+    // *** for example 0x40,0x42-0x47.
+    // ***
+    char* copy = strdup(text);
+    for (char* item = strtok(copy, ","); item != NULL; item = strtok(NULL, ","))
+    {
+        char* end;
+        unsigned long first = strtoul(item, &end, 0);
+        unsigned long last = *end == '-' ? strtoul(end + 1, &end, 0) : first;
+        if (*end != 0 || first < 0x08 || last > 0x77 || first > last)
+        {
+            free(copy);
+            return false;
+        }
+
+        for (unsigned long address = first; address <= last; address++)
+        {
+            Device device = { (uint8_t)address, 0, 0, 0 };
+            devices.push_back(device);
+        }
+    }
+    free(copy);
+    return true;
+}
+
+static int pull(int argc, char** argv)
+{
+    const char* busName = "/dev/i2c-1";
+    const char* addresses = NULL;
+    uint32_t count = 10;
+    uint32_t interval = 250;
+    uint8_t chunk = 16;
+    std::vector<Device> devices;
+
+    for (int i = 0; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--bus") == 0) busName = argv[i + 1];
+        else if (strcmp(argv[i], "--address") == 0) addresses = argv[i + 1];
+        else if (strcmp(argv[i], "--count") == 0) count = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--interval") == 0) interval = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--chunk") == 0) chunk = atoi(argv[i + 1]);
+    }
+
+    if (addresses == NULL || !parseAddresses(addresses, devices) || chunk == 0)
+    {
+        fprintf(stderr, "pull needs --address with valid addresses\n");
+        return 1;
+    }
+
+    I2cBus bus;
+    if (!bus.open(busName))
+    {
+        perror(busName);
+        return 1;
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    // ***
+    // *** Turn on capture for each breakout that answers, keeping
+    // *** its configuration so it can be put back afterwards.
+    // ***
+    std::vector<Device> active;
+    for (size_t i = 0; i < devices.size(); i++)
+    {
+        Device device = devices[i];
+        uint8_t id = 0;
+        if (!bus.readRegisters(device.address, REGISTER_ID, &id, 1) || id != BREAKOUT_ID ||
+            !bus.readRegisters(device.address, REGISTER_CONFIG, &device.config, 1) ||
+            !readReadingId(bus, device.address, device.lastReadingId))
+        {
+            fprintf(stderr, "0x%02X: no breakout\n", device.address);
+            continue;
+        }
+
+        device.config &= ~((1 << CONFIG_BIT_WRITE_CONFIG) | (1 << CONFIG_BIT_RESET_CONFIG));
+        uint8_t config = device.config | (1 << CONFIG_BIT_CAPTURE);
+        if (!bus.writeRegisters(device.address, REGISTER_CONFIG, &config, 1))
+        {
+            fprintf(stderr, "0x%02X: could not enable capture\n", device.address);
+            continue;
+        }
+
+        active.push_back(device);
+    }
+
+    printf("# address reading_id result timeout shift frame pulses[%d]\n", CAPTURE_PULSE_COUNT);
+
+    // ***
+    // *** Poll each breakout for a new reading and pull its
+    // *** capture. A capture is kept only if the reading id did
+    // *** not change while the block was being read.
+    // ***
+    size_t done = 0;
+    while (!_stop && done < active.size())
+    {
+        done = 0;
+        for (size_t i = 0; i < active.size(); i++)
+        {
+            Device& device = active[i];
+            if (device.captures >= count)
+            {
+                done++;
+                continue;
+            }
+
+            uint32_t readingId, afterId;
+            Capture capture;
+            if (readReadingId(bus, device.address, readingId) && readingId != device.lastReadingId &&
+                readCapture(bus, device.address, chunk, capture) &&
+                readReadingId(bus, device.address, afterId) && afterId == readingId)
+            {
+                capture.readingId = readingId;
+                writeCapture(stdout, capture);
+                fflush(stdout);
+                device.lastReadingId = readingId;
+                device.captures++;
+            }
+        }
+
+        if (done < active.size()) usleep(interval * 1000);
+    }
+
+    for (size_t i = 0; i < active.size(); i++)
+    {
+        bus.writeRegisters(active[i].address, REGISTER_CONFIG, &active[i].config, 1);
+    }
+
+    return 0;
+}
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: DhtCapture pull --address <list> [--bus <device>] [--count <n>] [--interval <ms>] [--chunk <bytes>]\n"
+            "       DhtCapture replay [--model 11|22] [--leading <bits>] [--divisor <n>] [--sweep] [file ...]\n");
+}
+
+int main(int argc, char** argv)
+{
+    if (argc >= 2 && strcmp(argv[1], "pull") == 0) return pull(argc - 2, argv + 2);
+    if (argc >= 2 && strcmp(argv[1], "replay") == 0) return replay(argc - 2, argv + 2);
+
+    usage();
+    return 1;
+}
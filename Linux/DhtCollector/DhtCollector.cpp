@@ -0,0 +1,378 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+
+// ***
+// *** Collects readings from DHT Tiny Breakouts on one or more
+// *** Linux I2C adapters, one worker thread per adapter.
+// ***
+// ***   DhtCollector --bus /dev/i2c-1=0x26,0x27 --bus /dev/i2c-3=0x26 --interval 1000
+// ***   DhtCollector --bus /dev/i2c-1 (scans 0x08-0x77)
+// ***
+// *** With --mock <buses>x<devices> the adapters are simulated so
+// *** the collector can be benchmarked without I2C hardware:
+// ***
+// ***   DhtCollector --mock 4x32 --interval 100 --duration 10 --quiet
+// ***
+// *** With --shm <name> the latest reading of every breakout is
+// *** also published to a shared memory table that local programs
+// *** read without touching the bus (see DhtShmRead):
+// ***
+// ***   DhtCollector --bus /dev/i2c-1 --shm /dhttiny --quiet
+// ***
+// *** With --metrics [<address>:]<port> the readings, counters and
+// *** poll latencies are served at /metrics for Prometheus. They
+// *** are rendered every 100 ms and scrapes are answered from the
+// *** last rendering, so scraping never adds bus traffic. The
+// *** address defaults to 127.0.0.1. Try it with the mock bus:
+// ***
+// ***   DhtCollector --mock 2x8 --quiet --metrics 9464
+// ***   curl http://127.0.0.1:9464/metrics
+// ***
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "DhtShmTable.h"
+#include "I2cBus.h"
+#include "Metrics.h"
+#include "MetricsServer.h"
+#include "MockI2cAdapter.h"
+#include "Worker.h"
+
+static volatile sig_atomic_t _stop = 0;
+static std::mutex _outputLock;
+static DhtShmTable _table;
+static bool _publish = false;
+static bool _print = true;
+
+static void onSignal(int)
+{
+    _stop = 1;
+}
+
+static void publishSample(const Sample& sample, uint64_t time)
+{
+    // ***
+    // *** Only the first sample of a breakout looks for its slot;
+    // *** each worker then writes its own slots without a lock.
+    // ***
+    if (*sample.handle < 0)
+    {
+        *sample.handle = _table.claimSlot(sample.bus, sample.address);
+        if (*sample.handle < 0)
+        {
+            fprintf(stderr, "%s: no free slot for 0x%02X\n", sample.bus, sample.address);
+            *sample.handle = INT32_MAX;
+        }
+    }
+
+    _table.publish(*sample.handle, sample.readingId, sample.temperature, sample.humidity, sample.age, time);
+}
+
+static void writeSample(const Sample& sample)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    uint64_t time = (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+
+    if (_publish) publishSample(sample, time);
+    if (!_print) return;
+
+    std::lock_guard<std::mutex> lock(_outputLock);
+    printf("%llu %s 0x%02X %u %.1f %.1f %u\n", (unsigned long long)time, sample.bus, sample.address,
+           sample.readingId, sample.temperature, sample.humidity, sample.age);
+    fflush(stdout);
+}
+
+static bool parseAddresses(const char* text, std::vector<uint8_t>& addresses)
+{
+    // ***
+    // *** A comma separated list of addresses and ranges,
+    // *** for example 0x26,0x30-0x37.
+    // ***
+    std::string list(text);
+    size_t position = 0;
+    while (position <= list.size())
+    {
+        size_t comma = list.find(',', position);
+        std::string item = list.substr(position, comma == std::string::npos ? std::string::npos : comma - position);
+
+        char* end;
+        unsigned long first = strtoul(item.c_str(), &end, 0);
+        unsigned long last = *end == '-' ? strtoul(end + 1, &end, 0) : first;
+        if (item.empty() || *end != 0 || first < 0x08 || last > 0x77 || first > last) return false;
+
+        for (unsigned long address = first; address <= last; address++)
+        {
+            addresses.push_back(address);
+        }
+
+        if (comma == std::string::npos) break;
+        position = comma + 1;
+    }
+
+    return true;
+}
+
+static bool parseListen(const char* text, std::string& address, uint16_t& port)
+{
+    // ***
+    // *** <port> or <address>:<port>.
+    // ***
+    std::string value(text);
+    size_t colon = value.rfind(':');
+    address = colon == std::string::npos ? "127.0.0.1" : value.substr(0, colon);
+
+    char* end;
+    unsigned long number = strtoul(value.c_str() + (colon == std::string::npos ? 0 : colon + 1), &end, 10);
+    if (*end != 0 || number == 0 || number > 65535) return false;
+
+    port = number;
+    return true;
+}
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: DhtCollector --bus <device>[=<addresses>] ... [options]\n"
+            "       DhtCollector --mock <buses>x<devices> [options]\n"
+            "options:\n"
+            "  --interval <ms>          poll each breakout this often (1000)\n"
+            "  --duration <s>           stop after this long\n"
+            "  --split                  stop between the register write and the read\n"
+            "  --quiet                  do not print samples\n"
+            "  --shm <name>             publish the latest readings to shared memory\n"
+            "  --shm-slots <count>      breakouts the shared memory table holds (128)\n"
+            "  --metrics <[addr:]port>  serve Prometheus metrics at /metrics (127.0.0.1)\n"
+            "  --mock-reading <ms>      reading interval of simulated breakouts (2000)\n"
+            "  --mock-byte-time <ns>    wire time per byte of simulated buses (0)\n");
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> buses;
+    uint32_t mockBuses = 0, mockDevices = 0;
+    uint32_t interval = 1000;
+    uint32_t duration = 0;
+    uint32_t mockReading = 2000;
+    uint32_t mockByteTime = 0;
+    bool combined = true;
+    bool quiet = false;
+    const char* shmName = NULL;
+    uint32_t shmSlots = DHT_SHM_DEFAULT_SLOTS;
+    const char* metricsListen = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--bus") == 0 && hasValue) buses.push_back(argv[++i]);
+        else if (strcmp(argv[i], "--mock") == 0 && hasValue)
+        {
+            if (sscanf(argv[++i], "%ux%u", &mockBuses, &mockDevices) != 2 || mockDevices > 0x70)
+            {
+                usage();
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--interval") == 0 && hasValue) interval = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--duration") == 0 && hasValue) duration = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--mock-reading") == 0 && hasValue) mockReading = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--mock-byte-time") == 0 && hasValue) mockByteTime = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--split") == 0) combined = false;
+        else if (strcmp(argv[i], "--quiet") == 0) quiet = true;
+        else if (strcmp(argv[i], "--shm") == 0 && hasValue) shmName = argv[++i];
+        else if (strcmp(argv[i], "--shm-slots") == 0 && hasValue) shmSlots = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--metrics") == 0 && hasValue) metricsListen = argv[++i];
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    if ((buses.empty() && mockBuses == 0) || interval == 0 || shmSlots == 0)
+    {
+        usage();
+        return 1;
+    }
+
+    if (shmName != NULL)
+    {
+        if (!_table.create(shmName, shmSlots))
+        {
+            perror(shmName);
+            return 1;
+        }
+
+        _publish = true;
+    }
+
+    MetricsServer metrics;
+    if (metricsListen != NULL)
+    {
+        std::string address;
+        uint16_t port = 0;
+        if (!parseListen(metricsListen, address, port))
+        {
+            usage();
+            return 1;
+        }
+
+        if (!metrics.open(address.c_str(), port))
+        {
+            perror(metricsListen);
+            return 1;
+        }
+    }
+
+    // ***
+    // *** One worker per adapter.
+    // ***
+    std::vector<Worker*> workers;
+    _print = !quiet;
+    SampleHandler handler = (quiet && !_publish) ? NULL : writeSample;
+
+    for (size_t i = 0; i < buses.size(); i++)
+    {
+        std::string device = buses[i];
+        std::vector<uint8_t> addresses;
+        size_t equals = device.find('=');
+        bool valid = equals == std::string::npos ? parseAddresses("0x08-0x77", addresses)
+                                                 : parseAddresses(device.c_str() + equals + 1, addresses);
+        device = device.substr(0, equals);
+
+        I2cBus* bus = new I2cBus(combined);
+        if (!valid || !bus->open(device.c_str()))
+        {
+            fprintf(stderr, "%s: could not open\n", device.c_str());
+            delete bus;
+            return 1;
+        }
+
+        workers.push_back(new Worker(device, bus, addresses, interval, handler));
+    }
+
+    for (uint32_t i = 0; i < mockBuses; i++)
+    {
+        MockI2cAdapter* adapter = new MockI2cAdapter(mockByteTime);
+        std::vector<uint8_t> addresses;
+        for (uint32_t j = 0; j < mockDevices; j++)
+        {
+            adapter->addDevice(0x08 + j, mockReading);
+            addresses.push_back(0x08 + j);
+        }
+
+        char name[16];
+        snprintf(name, sizeof(name), "mock%u", i);
+        workers.push_back(new Worker(name, adapter, addresses, interval, handler));
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    struct timespec started;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        if (!workers[i]->start())
+        {
+            perror(workers[i]->getName().c_str());
+            _stop = 1;
+        }
+    }
+
+    if (metricsListen != NULL)
+    {
+        renderMetrics(workers, 0, metrics.beginSnapshot());
+        metrics.publishSnapshot();
+
+        if (!metrics.start())
+        {
+            perror(metricsListen);
+            _stop = 1;
+        }
+    }
+
+    // ***
+    // *** The main thread waits for the end of the run and
+    // *** renders the metrics.
+    // ***
+    uint32_t elapsedMs = 0;
+    while (!_stop && (duration == 0 || elapsedMs < duration * 1000))
+    {
+        usleep(100000);
+
+        if (metricsListen != NULL)
+        {
+            renderMetrics(workers, metrics.getScrapeCount(), metrics.beginSnapshot());
+            metrics.publishSnapshot();
+        }
+
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        elapsedMs = (now.tv_sec - started.tv_sec) * 1000 + (now.tv_nsec - started.tv_nsec) / 1000000;
+    }
+
+    metrics.stop();
+    metrics.join();
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i]->stop();
+    }
+
+    // ***
+    // *** Report the totals across all workers.
+    // ***
+    WorkerStats total;
+    memset(&total, 0, sizeof(total));
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        workers[i]->join();
+        WorkerStats stats = workers[i]->getStats();
+        total.devices += stats.devices;
+        total.polls += stats.polls;
+        total.samples += stats.samples;
+        total.errors += stats.errors;
+        total.missed += stats.missed;
+        total.transfers += stats.transfers;
+        delete workers[i];
+    }
+
+    double seconds = elapsedMs / 1000.0;
+    fprintf(stderr, "workers    %zu\n", workers.size());
+    fprintf(stderr, "devices    %u\n", total.devices);
+    fprintf(stderr, "duration   %.1f s\n", seconds);
+    fprintf(stderr, "polls      %llu (%.1f/s)\n", (unsigned long long)total.polls, seconds > 0 ? total.polls / seconds : 0.0);
+    fprintf(stderr, "samples    %llu (%.1f/s)\n", (unsigned long long)total.samples, seconds > 0 ? total.samples / seconds : 0.0);
+    fprintf(stderr, "errors     %llu\n", (unsigned long long)total.errors);
+    fprintf(stderr, "missed     %llu\n", (unsigned long long)total.missed);
+    fprintf(stderr, "transfers  %llu (%.2f per poll, %.2f per sample)\n", (unsigned long long)total.transfers,
+            total.polls ? (double)total.transfers / total.polls : 0.0,
+            total.samples ? (double)total.transfers / total.samples : 0.0);
+
+    return 0;
+}
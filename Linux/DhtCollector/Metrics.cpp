@@ -0,0 +1,209 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include "Metrics.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+// ***
+// *** A metric kept for each breakout.
+// ***
+struct DeviceMetric
+{
+    const char* name;
+    const char* type;
+    const char* help;
+
+    // ***
+    // *** Only rendered once the breakout has a reading.
+    // ***
+    bool reading;
+    double (*value)(const DeviceMetrics& metrics);
+};
+
+static const DeviceMetric _deviceMetrics[] =
+{
+    { "dhttiny_up", "gauge", "Whether the last poll of the breakout succeeded.", false,
+      [](const DeviceMetrics& metrics) -> double { return metrics.up; } },
+    { "dhttiny_temperature_celsius", "gauge", "Latest temperature reading.", true,
+      [](const DeviceMetrics& metrics) -> double { return metrics.temperature; } },
+    { "dhttiny_humidity_percent", "gauge", "Latest relative humidity reading.", true,
+      [](const DeviceMetrics& metrics) -> double { return metrics.humidity; } },
+    { "dhttiny_reading_age_seconds", "gauge", "Time since the breakout took the latest reading.", true,
+      [](const DeviceMetrics& metrics) -> double { return metrics.age / 1000.0; } },
+    { "dhttiny_reading_id", "gauge", "Reading ID of the latest reading.", true,
+      [](const DeviceMetrics& metrics) -> double { return metrics.readingId; } },
+    { "dhttiny_upper_threshold_exceeded", "gauge", "Whether the latest reading is above the upper threshold.", true,
+      [](const DeviceMetrics& metrics) -> double { return (metrics.status >> STATUS_UPPER_THRESHOLD_EXCEEDED) & 1; } },
+    { "dhttiny_lower_threshold_exceeded", "gauge", "Whether the latest reading is below the lower threshold.", true,
+      [](const DeviceMetrics& metrics) -> double { return (metrics.status >> STATUS_LOWER_THRESHOLD_EXCEEDED) & 1; } },
+    { "dhttiny_sensor_error", "gauge", "Whether the breakout failed to read its sensor.", true,
+      [](const DeviceMetrics& metrics) -> double { return (metrics.status >> STATUS_DHT_READING_ERROR) & 1; } },
+    { "dhttiny_polls_total", "counter", "Polls of the breakout.", false,
+      [](const DeviceMetrics& metrics) -> double { return metrics.polls; } },
+    { "dhttiny_samples_total", "counter", "New readings collected from the breakout.", false,
+      [](const DeviceMetrics& metrics) -> double { return metrics.samples; } },
+    { "dhttiny_poll_errors_total", "counter", "Polls of the breakout that failed.", false,
+      [](const DeviceMetrics& metrics) -> double { return metrics.errors; } },
+    { "dhttiny_pec_errors_total", "counter", "Reads from the breakout with a PEC mismatch.", false,
+      [](const DeviceMetrics& metrics) -> double { return metrics.pecErrors; } }
+};
+
+struct DeviceEntry
+{
+    const Worker* worker;
+    DeviceMetrics metrics;
+};
+
+static void append(std::string& text, const char* format, ...)
+{
+    char line[256];
+    va_list arguments;
+    va_start(arguments, format);
+    int size = vsnprintf(line, sizeof(line), format, arguments);
+    va_end(arguments);
+
+    if (size > 0)
+    {
+        text.append(line, size < (int)sizeof(line) ? size : sizeof(line) - 1);
+    }
+}
+
+static void appendFamily(std::string& text, const char* name, const char* type, const char* help)
+{
+    append(text, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+static void appendBus(std::string& text, const Worker* worker)
+{
+    // ***
+    // *** Label values escape backslashes, quotes and new lines.
+    // ***
+    text += "bus=\"";
+    for (const char* value = worker->getName().c_str(); *value != 0; value++)
+    {
+        if (*value == '\n')
+        {
+            text += "\\n";
+            continue;
+        }
+
+        if (*value == '\\' || *value == '"') text += '\\';
+        text += *value;
+    }
+
+    text += '"';
+}
+
+void renderMetrics(const std::vector<Worker*>& workers, uint64_t scrapes, std::string& text)
+{
+    // ***
+    // *** Each breakout is read from its worker once. The sequence
+    // *** lock in getDeviceMetrics() makes all of its metrics come
+    // *** from the same poll. The list keeps its capacity between
+    // *** calls.
+    // ***
+    static std::vector<DeviceEntry> devices;
+    devices.clear();
+
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        uint32_t count = workers[i]->getDeviceCount();
+        for (uint32_t j = 0; j < count; j++)
+        {
+            DeviceEntry entry = { workers[i], workers[i]->getDeviceMetrics(j) };
+            devices.push_back(entry);
+        }
+    }
+
+    text.clear();
+
+    for (size_t i = 0; i < sizeof(_deviceMetrics) / sizeof(_deviceMetrics[0]); i++)
+    {
+        const DeviceMetric& metric = _deviceMetrics[i];
+        appendFamily(text, metric.name, metric.type, metric.help);
+
+        for (size_t j = 0; j < devices.size(); j++)
+        {
+            const DeviceMetrics& metrics = devices[j].metrics;
+            if (metric.reading && !metrics.hasReading) continue;
+
+            append(text, "%s{", metric.name);
+            appendBus(text, devices[j].worker);
+            append(text, ",address=\"0x%02X\"} %.15g\n", metrics.address, metric.value(metrics));
+        }
+    }
+
+    // ***
+    // *** The metrics of each bus.
+    // ***
+    appendFamily(text, "dhttiny_bus_devices", "gauge", "Breakouts on the bus that answered.");
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        text += "dhttiny_bus_devices{";
+        appendBus(text, workers[i]);
+        append(text, "} %u\n", workers[i]->getDeviceCount());
+    }
+
+    appendFamily(text, "dhttiny_bus_missed_polls_total", "counter", "Polls skipped because the worker fell behind.");
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        text += "dhttiny_bus_missed_polls_total{";
+        appendBus(text, workers[i]);
+        append(text, "} %llu\n", (unsigned long long)workers[i]->getStats().missed);
+    }
+
+    appendFamily(text, "dhttiny_bus_transfers_total", "counter", "Bus transactions made by polls.");
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        text += "dhttiny_bus_transfers_total{";
+        appendBus(text, workers[i]);
+        append(text, "} %llu\n", (unsigned long long)workers[i]->getStats().transfers);
+    }
+
+    appendFamily(text, "dhttiny_poll_duration_seconds", "histogram", "Time taken by one poll of a breakout.");
+    for (size_t i = 0; i < workers.size(); i++)
+    {
+        WorkerLatency latency = workers[i]->getLatency();
+        uint64_t cumulative = 0;
+
+        for (uint32_t j = 0; j < WORKER_LATENCY_BUCKETS; j++)
+        {
+            cumulative += latency.buckets[j];
+            text += "dhttiny_poll_duration_seconds_bucket{";
+            appendBus(text, workers[i]);
+            append(text, ",le=\"%g\"} %llu\n", WorkerLatencyBounds[j] / 1000000.0, (unsigned long long)cumulative);
+        }
+
+        text += "dhttiny_poll_duration_seconds_bucket{";
+        appendBus(text, workers[i]);
+        append(text, ",le=\"+Inf\"} %llu\n", (unsigned long long)latency.count);
+
+        text += "dhttiny_poll_duration_seconds_sum{";
+        appendBus(text, workers[i]);
+        append(text, "} %.9g\n", latency.sum / 1000000000.0);
+
+        text += "dhttiny_poll_duration_seconds_count{";
+        appendBus(text, workers[i]);
+        append(text, "} %llu\n", (unsigned long long)latency.count);
+    }
+
+    appendFamily(text, "dhttiny_scrapes_total", "counter", "Metrics scrapes answered.");
+    append(text, "dhttiny_scrapes_total %llu\n", (unsigned long long)scrapes);
+}
@@ -0,0 +1,57 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Worker.h"
+
+// ***
+// *** Renders the state of every worker and its breakouts as
+// *** Prometheus text into text, which is cleared first. Every
+// *** breakout is labelled with its bus and address:
+// ***
+// ***   dhttiny_up                          last poll succeeded (0/1)
+// ***   dhttiny_temperature_celsius         latest reading
+// ***   dhttiny_humidity_percent            latest reading
+// ***   dhttiny_reading_age_seconds         age of the latest reading
+// ***   dhttiny_reading_id                  reading ID of the latest reading
+// ***   dhttiny_upper_threshold_exceeded    alert state (0/1)
+// ***   dhttiny_lower_threshold_exceeded    alert state (0/1)
+// ***   dhttiny_sensor_error                the breakout could not read its sensor (0/1)
+// ***   dhttiny_polls_total                 polls
+// ***   dhttiny_samples_total               new readings
+// ***   dhttiny_poll_errors_total           polls that failed
+// ***   dhttiny_pec_errors_total            PEC mismatches
+// ***
+// *** and each bus with its name:
+// ***
+// ***   dhttiny_bus_devices                 breakouts that answered
+// ***   dhttiny_bus_missed_polls_total      polls skipped by a late worker
+// ***   dhttiny_bus_transfers_total         bus transactions
+// ***   dhttiny_poll_duration_seconds       histogram of poll latency
+// ***
+// *** The readings are only rendered once a breakout has one.
+// ***
+void renderMetrics(const std::vector<Worker*>& workers, uint64_t scrapes, std::string& text);
+
+#endif
@@ -0,0 +1,286 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include "MetricsServer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#define CONTENT_TYPE_METRICS    "text/plain; version=0.0.4; charset=utf-8"
+#define CONTENT_TYPE_TEXT       "text/plain; charset=utf-8"
+
+MetricsServer::MetricsServer()
+    : _next(&_buffers[0]), _current(NULL), _serving(NULL), _listen(-1), _epoll(-1), _stopEvent(-1), _scrapes(0)
+{
+}
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+    join();
+
+    if (_listen >= 0) close(_listen);
+    if (_epoll >= 0) close(_epoll);
+    if (_stopEvent >= 0) close(_stopEvent);
+}
+
+bool MetricsServer::open(const char* address, uint16_t port)
+{
+    struct sockaddr_in socketAddress;
+    memset(&socketAddress, 0, sizeof(socketAddress));
+    socketAddress.sin_family = AF_INET;
+    socketAddress.sin_port = htons(port);
+    if (inet_pton(AF_INET, address, &socketAddress.sin_addr) != 1)
+    {
+        errno = EINVAL;
+        return false;
+    }
+
+    _listen = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    if (_listen < 0) return false;
+
+    int reuse = 1;
+    setsockopt(_listen, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    return bind(_listen, (struct sockaddr*)&socketAddress, sizeof(socketAddress)) == 0 && listen(_listen, 16) == 0;
+}
+
+bool MetricsServer::start()
+{
+    _epoll = epoll_create1(EPOLL_CLOEXEC);
+    _stopEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (_listen < 0 || _epoll < 0 || _stopEvent < 0) return false;
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = _listen;
+    if (epoll_ctl(_epoll, EPOLL_CTL_ADD, _listen, &event) != 0) return false;
+    event.data.fd = _stopEvent;
+    if (epoll_ctl(_epoll, EPOLL_CTL_ADD, _stopEvent, &event) != 0) return false;
+
+    _thread = std::thread(&MetricsServer::run, this);
+    return true;
+}
+
+void MetricsServer::stop()
+{
+    if (_stopEvent >= 0)
+    {
+        uint64_t value = 1;
+        if (write(_stopEvent, &value, sizeof(value)) < 0)
+        {
+            perror("metrics");
+        }
+    }
+}
+
+void MetricsServer::join()
+{
+    if (_thread.joinable()) _thread.join();
+}
+
+std::string& MetricsServer::beginSnapshot()
+{
+    // ***
+    // *** With three buffers one is always neither current nor
+    // *** being served.
+    // ***
+    std::string* current = _current;
+    std::string* serving = _serving;
+
+    for (uint32_t i = 0; i < METRICS_BUFFERS; i++)
+    {
+        if (&_buffers[i] != current && &_buffers[i] != serving)
+        {
+            _next = &_buffers[i];
+            break;
+        }
+    }
+
+    _next->clear();
+    return *_next;
+}
+
+void MetricsServer::publishSnapshot()
+{
+    _current = _next;
+}
+
+void MetricsServer::run()
+{
+    while (true)
+    {
+        struct epoll_event events[2];
+        int count = epoll_wait(_epoll, events, 2, -1);
+        if (count < 0) continue;
+
+        for (int i = 0; i < count; i++)
+        {
+            if (events[i].data.fd == _stopEvent) return;
+        }
+
+        int client = accept4(_listen, NULL, NULL, SOCK_CLOEXEC);
+        if (client < 0) continue;
+
+        serve(client);
+        close(client);
+    }
+}
+
+void MetricsServer::serve(int client)
+{
+    struct timeval timeout;
+    timeout.tv_sec = METRICS_TIMEOUT_MS / 1000;
+    timeout.tv_usec = (METRICS_TIMEOUT_MS % 1000) * 1000;
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // ***
+    // *** Read up to the end of the request headers. Only the
+    // *** request line is used; a longer request is cut short.
+    // ***
+    char request[METRICS_REQUEST_SIZE];
+    size_t size = 0;
+    request[0] = 0;
+
+    while (size < sizeof(request) - 1 && strstr(request, "\r\n\r\n") == NULL && strstr(request, "\n\n") == NULL)
+    {
+        ssize_t count = recv(client, request + size, sizeof(request) - 1 - size, 0);
+        if (count <= 0) return;
+
+        size += count;
+        request[size] = 0;
+    }
+
+    bool head = strncmp(request, "HEAD ", 5) == 0;
+    const char* path = strncmp(request, "GET ", 4) == 0 ? request + 4 : head ? request + 5 : NULL;
+    bool metrics = path != NULL && strncmp(path, "/metrics", 8) == 0 && (path[8] == ' ' || path[8] == '?');
+
+    const char* status = "200 OK";
+    const char* type = CONTENT_TYPE_METRICS;
+    const char* body = NULL;
+    size_t bodySize = 0;
+    std::string* snapshot = NULL;
+
+    if (path == NULL)
+    {
+        status = "405 Method Not Allowed";
+        body = "Method not allowed\n";
+    }
+    else if (!metrics)
+    {
+        status = "404 Not Found";
+        body = "Metrics are served at /metrics\n";
+    }
+    else
+    {
+        // ***
+        // *** Mark the snapshot before using it and check that it
+        // *** was not replaced in between, so the renderer cannot
+        // *** pick it for the next snapshot while it is sent.
+        // ***
+        snapshot = _current;
+        while (true)
+        {
+            _serving = snapshot;
+            std::string* current = _current;
+            if (current == snapshot) break;
+            snapshot = current;
+        }
+
+        if (snapshot == NULL)
+        {
+            status = "503 Service Unavailable";
+            body = "No metrics yet\n";
+        }
+        else
+        {
+            body = snapshot->data();
+            bodySize = snapshot->size();
+        }
+    }
+
+    if (snapshot == NULL)
+    {
+        type = CONTENT_TYPE_TEXT;
+        bodySize = strlen(body);
+    }
+
+    char header[256];
+    int headerSize = snprintf(header, sizeof(header),
+                              "HTTP/1.1 %s\r\n"
+                              "Content-Type: %s\r\n"
+                              "Content-Length: %zu\r\n"
+                              "Connection: close\r\n"
+                              "\r\n", status, type, bodySize);
+
+    if (send(client, header, headerSize, body, head ? 0 : bodySize) && snapshot != NULL)
+    {
+        _scrapes++;
+    }
+
+    _serving = NULL;
+}
+
+bool MetricsServer::send(int client, const char* header, size_t headerSize, const char* body, size_t bodySize)
+{
+    struct iovec parts[2];
+    parts[0].iov_base = (void*)header;
+    parts[0].iov_len = headerSize;
+    parts[1].iov_base = (void*)body;
+    parts[1].iov_len = bodySize;
+
+    struct msghdr message;
+    memset(&message, 0, sizeof(message));
+    message.msg_iov = parts;
+    message.msg_iovlen = 2;
+
+    // ***
+    // *** Keep sending until both parts are out; a client that
+    // *** stops reading times out.
+    // ***
+    while (message.msg_iovlen > 0)
+    {
+        ssize_t count = sendmsg(client, &message, MSG_NOSIGNAL);
+        if (count <= 0) return false;
+
+        while (message.msg_iovlen > 0 && (size_t)count >= message.msg_iov->iov_len)
+        {
+            count -= message.msg_iov->iov_len;
+            message.msg_iov++;
+            message.msg_iovlen--;
+        }
+
+        if (message.msg_iovlen > 0)
+        {
+            message.msg_iov->iov_base = (char*)message.msg_iov->iov_base + count;
+            message.msg_iov->iov_len -= count;
+        }
+    }
+
+    return true;
+}
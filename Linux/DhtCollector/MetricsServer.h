@@ -0,0 +1,92 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <thread>
+
+// ***
+// *** Serves the collector's metrics over HTTP for Prometheus to
+// *** scrape. A scrape is only ever answered from the snapshot
+// *** the collector last rendered, so it never touches a bus, and
+// *** the request and response headers are built on the stack so
+// *** it allocates nothing.
+// ***
+// *** The collector renders into one of three buffers and swaps it
+// *** in with publishSnapshot(). The server marks the snapshot it
+// *** is sending, and the renderer never writes the snapshot being
+// *** served or the one that is current, so a new snapshot never
+// *** waits for a slow scrape and a scrape never sees half of one.
+// ***
+// *** Scrapes are answered one at a time from the server's thread
+// *** with a short timeout for clients that stall. Bind to
+// *** 127.0.0.1 (the default) unless the metrics should be
+// *** reachable from other hosts.
+// ***
+#define METRICS_BUFFERS         3
+#define METRICS_REQUEST_SIZE    1024
+#define METRICS_TIMEOUT_MS      1000
+
+class MetricsServer
+{
+public:
+    MetricsServer();
+    ~MetricsServer();
+
+    // ***
+    // *** Listens on address (IPv4, for example 127.0.0.1 or
+    // *** 0.0.0.0) and port.
+    // ***
+    bool open(const char* address, uint16_t port);
+    bool start();
+    void stop();
+    void join();
+
+    // ***
+    // *** Renderer. beginSnapshot() returns an empty buffer that
+    // *** no scrape is using; publishSnapshot() makes it the one
+    // *** that is served. The buffers keep their capacity, so after
+    // *** the first few snapshots rendering does not allocate either.
+    // ***
+    std::string& beginSnapshot();
+    void publishSnapshot();
+
+    uint64_t getScrapeCount() const { return _scrapes; };
+
+private:
+    void run();
+    void serve(int client);
+    bool send(int client, const char* header, size_t headerSize, const char* body, size_t bodySize);
+
+    std::string _buffers[METRICS_BUFFERS];
+    std::string* _next;
+    std::atomic<std::string*> _current;
+    std::atomic<std::string*> _serving;
+
+    int _listen;
+    int _epoll;
+    int _stopEvent;
+    std::thread _thread;
+    std::atomic<uint64_t> _scrapes;
+};
+
+#endif
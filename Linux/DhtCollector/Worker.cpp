@@ -0,0 +1,342 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include "Worker.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+const uint32_t WorkerLatencyBounds[WORKER_LATENCY_BUCKETS] =
+{
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000
+};
+
+static uint64_t monotonicNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+Worker::Worker(const std::string& name, I2cAdapter* adapter, const std::vector<uint8_t>& addresses,
+               uint32_t interval, SampleHandler handler)
+    : _name(name), _adapter(adapter), _transport(*adapter), _addresses(addresses), _state(addresses.size()),
+      _interval(interval * 1000000ULL), _handler(handler), _epoll(-1), _timer(-1), _stopEvent(-1),
+      _devices(0), _polls(0), _samples(0), _errors(0), _missed(0), _transfers(0), _baseTransfers(0),
+      _latencySum(0)
+{
+    for (uint32_t i = 0; i < WORKER_LATENCY_BUCKETS; i++)
+    {
+        _latencyBuckets[i] = 0;
+    }
+}
+
+Worker::~Worker()
+{
+    stop();
+    join();
+
+    if (_epoll >= 0) close(_epoll);
+    if (_timer >= 0) close(_timer);
+    if (_stopEvent >= 0) close(_stopEvent);
+    delete _adapter;
+}
+
+bool Worker::start()
+{
+    _epoll = epoll_create1(EPOLL_CLOEXEC);
+    _timer = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    _stopEvent = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (_epoll < 0 || _timer < 0 || _stopEvent < 0) return false;
+
+    struct epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = _timer;
+    if (epoll_ctl(_epoll, EPOLL_CTL_ADD, _timer, &event) != 0) return false;
+    event.data.fd = _stopEvent;
+    if (epoll_ctl(_epoll, EPOLL_CTL_ADD, _stopEvent, &event) != 0) return false;
+
+    _thread = std::thread(&Worker::run, this);
+    return true;
+}
+
+void Worker::stop()
+{
+    if (_stopEvent >= 0)
+    {
+        uint64_t value = 1;
+        if (write(_stopEvent, &value, sizeof(value)) < 0)
+        {
+            perror(_name.c_str());
+        }
+    }
+}
+
+void Worker::join()
+{
+    if (_thread.joinable()) _thread.join();
+}
+
+WorkerStats Worker::getStats() const
+{
+    WorkerStats stats;
+    stats.devices = _devices;
+    stats.polls = _polls;
+    stats.samples = _samples;
+    stats.errors = _errors;
+    stats.missed = _missed;
+    stats.transfers = _transfers;
+    return stats;
+}
+
+DeviceMetrics Worker::getDeviceMetrics(uint32_t index) const
+{
+    const DeviceState& state = _state[index];
+    DeviceMetrics metrics;
+    uint64_t sampled;
+    uint32_t before, after;
+
+    metrics.address = state.address;
+
+    // ***
+    // *** Retry until the sequence is even and has not moved, so
+    // *** every field comes from the same poll.
+    // ***
+    do
+    {
+        before = state.sequence.load(std::memory_order_acquire);
+
+        metrics.up = state.up.load(std::memory_order_relaxed);
+        metrics.status = state.status.load(std::memory_order_relaxed);
+        metrics.readingId = state.readingId.load(std::memory_order_relaxed);
+        metrics.temperature = state.temperature.load(std::memory_order_relaxed);
+        metrics.humidity = state.humidity.load(std::memory_order_relaxed);
+        metrics.age = state.age.load(std::memory_order_relaxed);
+        sampled = state.sampled.load(std::memory_order_relaxed);
+        metrics.polls = state.polls.load(std::memory_order_relaxed);
+        metrics.samples = state.samples.load(std::memory_order_relaxed);
+        metrics.errors = state.errors.load(std::memory_order_relaxed);
+        metrics.pecErrors = state.pecErrors.load(std::memory_order_relaxed);
+
+        // ***
+        // *** The fence keeps the loads above from moving
+        // *** below the second load of the sequence.
+        // ***
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = state.sequence.load(std::memory_order_relaxed);
+    }
+    while ((before & 1) != 0 || before != after);
+
+    // ***
+    // *** A breakout that has not taken a reading yet reports
+    // *** READING_AGE_NONE, which is not an age to add to.
+    // ***
+    metrics.hasReading = sampled != 0 && metrics.readingId != 0;
+    if (metrics.hasReading) metrics.age += (monotonicNs() - sampled) / 1000000ULL;
+    return metrics;
+}
+
+WorkerLatency Worker::getLatency() const
+{
+    WorkerLatency latency;
+    for (uint32_t i = 0; i < WORKER_LATENCY_BUCKETS; i++)
+    {
+        latency.buckets[i] = _latencyBuckets[i];
+    }
+
+    latency.count = _polls;
+    latency.sum = _latencySum;
+    return latency;
+}
+
+bool Worker::discover()
+{
+    // ***
+    // *** Keep the breakouts that answer. Loading their
+    // *** configuration is not counted as polling traffic.
+    // ***
+    for (size_t i = 0; i < _addresses.size(); i++)
+    {
+        Slot slot = { DhtTinyClient(_transport, _addresses[i]), 0, -1, (uint32_t)_slots.size() };
+        if (slot.client.begin())
+        {
+            _state[slot.state].address = _addresses[i];
+            _state[slot.state].up = true;
+            _slots.push_back(slot);
+        }
+        else
+        {
+            fprintf(stderr, "%s: no breakout at 0x%02X\n", _name.c_str(), _addresses[i]);
+        }
+    }
+
+    // ***
+    // *** Publishing the count makes the states above visible
+    // *** to getDeviceMetrics().
+    // ***
+    _devices = _slots.size();
+    _baseTransfers = _adapter->getTransferCount();
+    return !_slots.empty();
+}
+
+void Worker::run()
+{
+    if (!discover()) return;
+
+    // ***
+    // *** Give each breakout its own phase within the interval.
+    // ***
+    uint64_t start = monotonicNs();
+    for (size_t i = 0; i < _slots.size(); i++)
+    {
+        _slots[i].due = start + _interval * i / _slots.size();
+    }
+
+    armTimer();
+
+    while (true)
+    {
+        struct epoll_event events[2];
+        int count = epoll_wait(_epoll, events, 2, -1);
+        if (count < 0) continue;
+
+        for (int i = 0; i < count; i++)
+        {
+            if (events[i].data.fd == _stopEvent) return;
+        }
+
+        uint64_t expirations;
+        if (read(_timer, &expirations, sizeof(expirations)) < 0)
+        {
+            // ***
+            // *** Nothing to read; the timer was re-armed.
+            // ***
+        }
+
+        uint64_t now = monotonicNs();
+        for (size_t i = 0; i < _slots.size(); i++)
+        {
+            Slot& slot = _slots[i];
+            if (slot.due > now) continue;
+
+            poll(slot);
+            slot.due += _interval;
+
+            // ***
+            // *** A worker that falls a whole interval behind skips
+            // *** the polls it missed rather than bursting them.
+            // ***
+            if (slot.due <= now)
+            {
+                uint64_t behind = (now - slot.due) / _interval + 1;
+                _missed += behind;
+                slot.due += behind * _interval;
+            }
+        }
+
+        _transfers = _adapter->getTransferCount() - _baseTransfers;
+        armTimer();
+    }
+}
+
+void Worker::poll(Slot& slot)
+{
+    DeviceState& state = _state[slot.state];
+
+    uint64_t started = monotonicNs();
+    int8_t result = slot.client.update();
+    uint64_t latency = monotonicNs() - started;
+
+    // ***
+    // *** The buckets are counted without the ones below them;
+    // *** the reader adds them up. The poll is counted first and
+    // *** read last so the count is never below the buckets.
+    // ***
+    _polls++;
+    uint32_t bucket = 0;
+    while (bucket < WORKER_LATENCY_BUCKETS && latency > WorkerLatencyBounds[bucket] * 1000ULL) bucket++;
+    if (bucket < WORKER_LATENCY_BUCKETS) _latencyBuckets[bucket]++;
+    _latencySum += latency;
+
+    // ***
+    // *** An odd sequence tells getDeviceMetrics() an update is
+    // *** under way. The fence keeps the stores below from moving
+    // *** above it. Only this thread writes the state, so the
+    // *** counters need no read-modify-write.
+    // ***
+    uint32_t sequence = state.sequence.load(std::memory_order_relaxed);
+    state.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    state.polls.store(state.polls.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    state.up.store(result != DHTTINY_ERROR, std::memory_order_relaxed);
+    state.pecErrors.store(slot.client.getPecErrorCount(), std::memory_order_relaxed);
+
+    if (result == DHTTINY_ERROR)
+    {
+        _errors++;
+        state.errors.store(state.errors.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+    else if (result == DHTTINY_UPDATED)
+    {
+        _samples++;
+        state.samples.store(state.samples.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        state.status.store(slot.client.getStatus(), std::memory_order_relaxed);
+        state.readingId.store(slot.client.getReadingId(), std::memory_order_relaxed);
+        state.temperature.store(slot.client.getTemperature(), std::memory_order_relaxed);
+        state.humidity.store(slot.client.getHumidity(), std::memory_order_relaxed);
+        state.age.store(slot.client.getReadingAge(), std::memory_order_relaxed);
+        state.sampled.store(started, std::memory_order_relaxed);
+    }
+
+    state.sequence.store(sequence + 2, std::memory_order_release);
+
+    if (result == DHTTINY_UPDATED && _handler != NULL)
+    {
+        Sample sample;
+        sample.bus = _name.c_str();
+        sample.address = slot.client.getAddress();
+        sample.readingId = slot.client.getReadingId();
+        sample.temperature = slot.client.getTemperature();
+        sample.humidity = slot.client.getHumidity();
+        sample.age = slot.client.getReadingAge();
+        sample.handle = &slot.handle;
+        _handler(sample);
+    }
+}
+
+void Worker::armTimer()
+{
+    uint64_t next = _slots[0].due;
+    for (size_t i = 1; i < _slots.size(); i++)
+    {
+        if (_slots[i].due < next) next = _slots[i].due;
+    }
+
+    struct itimerspec timer;
+    memset(&timer, 0, sizeof(timer));
+    timer.it_value.tv_sec = next / 1000000000ULL;
+    timer.it_value.tv_nsec = next % 1000000000ULL;
+    timerfd_settime(_timer, TFD_TIMER_ABSTIME, &timer, NULL);
+}
@@ -0,0 +1,196 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef WORKER_H
+#define WORKER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "DhtTinyClient.h"
+#include "I2cAdapter.h"
+#include "I2cTransport.h"
+
+// ***
+// *** A new reading from one breakout.
+// ***
+struct Sample
+{
+    const char* bus;
+    uint8_t address;
+    uint32_t readingId;
+    float temperature;
+    float humidity;
+    uint32_t age;
+
+    // ***
+    // *** Kept by the worker for each breakout on behalf of the
+    // *** handler, so it can remember where a breakout's samples
+    // *** go without a lookup. It is -1 until the handler sets it.
+    // ***
+    int32_t* handle;
+};
+
+typedef void (*SampleHandler)(const Sample& sample);
+
+// ***
+// *** Counters kept by a worker while it runs.
+// ***
+struct WorkerStats
+{
+    uint32_t devices;
+    uint64_t polls;
+    uint64_t samples;
+    uint64_t errors;
+    uint64_t missed;
+    uint64_t transfers;
+};
+
+// ***
+// *** The state of one breakout as the worker last saw it. The
+// *** reading fields are only valid once hasReading is set; the
+// *** age includes the time since the sample was taken.
+// ***
+struct DeviceMetrics
+{
+    uint8_t address;
+    bool up;
+    bool hasReading;
+    uint8_t status;
+    uint32_t readingId;
+    float temperature;
+    float humidity;
+    uint32_t age;
+    uint64_t polls;
+    uint64_t samples;
+    uint64_t errors;
+    uint32_t pecErrors;
+};
+
+// ***
+// *** Upper bounds, in microseconds, of the poll latency buckets.
+// *** Polls slower than the last bound are only in the count.
+// ***
+#define WORKER_LATENCY_BUCKETS 11
+
+extern const uint32_t WorkerLatencyBounds[WORKER_LATENCY_BUCKETS];
+
+struct WorkerLatency
+{
+    uint64_t buckets[WORKER_LATENCY_BUCKETS];
+    uint64_t count;
+    uint64_t sum;
+};
+
+// ***
+// *** Polls the breakouts on one adapter from its own thread.
+// *** Each breakout is polled once per interval, with the polls
+// *** spread evenly across the interval so the bus is never asked
+// *** for every device at once. A timerfd armed for the next poll
+// *** and an eventfd used to stop the worker are waited on with
+// *** epoll, so an idle worker uses no CPU.
+// ***
+// *** The counters, the latest state of each breakout and the
+// *** latency of each poll are kept in atomics, so another thread
+// *** can read them while the worker runs without stopping it.
+// *** The state of a breakout is guarded by a sequence lock, as
+// *** the slots of DhtShmTable are, so it is read whole.
+// ***
+class Worker
+{
+public:
+    Worker(const std::string& name, I2cAdapter* adapter, const std::vector<uint8_t>& addresses,
+           uint32_t interval, SampleHandler handler);
+    ~Worker();
+
+    bool start();
+    void stop();
+    void join();
+
+    const std::string& getName() const { return _name; };
+    WorkerStats getStats() const;
+
+    uint32_t getDeviceCount() const { return _devices; };
+    DeviceMetrics getDeviceMetrics(uint32_t index) const;
+    WorkerLatency getLatency() const;
+
+private:
+    struct Slot
+    {
+        DhtTinyClient client;
+        uint64_t due;
+        int32_t handle;
+        uint32_t state;
+    };
+
+    // ***
+    // *** Written by the worker, read by getDeviceMetrics(). The
+    // *** first _devices entries are in use. The sequence is odd
+    // *** while poll() is updating the fields after it.
+    // ***
+    struct DeviceState
+    {
+        std::atomic<uint32_t> sequence;
+        uint8_t address;
+        std::atomic<bool> up;
+        std::atomic<uint8_t> status;
+        std::atomic<uint32_t> readingId;
+        std::atomic<float> temperature;
+        std::atomic<float> humidity;
+        std::atomic<uint32_t> age;
+        std::atomic<uint64_t> sampled;
+        std::atomic<uint64_t> polls;
+        std::atomic<uint64_t> samples;
+        std::atomic<uint64_t> errors;
+        std::atomic<uint32_t> pecErrors;
+    };
+
+    void run();
+    bool discover();
+    void poll(Slot& slot);
+    void armTimer();
+
+    std::string _name;
+    I2cAdapter* _adapter;
+    I2cTransport _transport;
+    std::vector<uint8_t> _addresses;
+    std::vector<Slot> _slots;
+    std::vector<DeviceState> _state;
+    uint64_t _interval;
+    SampleHandler _handler;
+
+    int _epoll;
+    int _timer;
+    int _stopEvent;
+    std::thread _thread;
+
+    std::atomic<uint32_t> _devices;
+    std::atomic<uint64_t> _polls;
+    std::atomic<uint64_t> _samples;
+    std::atomic<uint64_t> _errors;
+    std::atomic<uint64_t> _missed;
+    std::atomic<uint64_t> _transfers;
+    uint64_t _baseTransfers;
+    std::atomic<uint64_t> _latencyBuckets[WORKER_LATENCY_BUCKETS];
+    std::atomic<uint64_t> _latencySum;
+};
+
+#endif
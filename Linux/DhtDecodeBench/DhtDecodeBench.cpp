@@ -0,0 +1,317 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+
+// ***
+// *** Times the batch decoder (Common/DhtBatchDecode.h) against
+// *** the per-value decoding a collector does today: a union copy
+// *** of each field (as ByteConverter does) and a branch for each
+// *** status bit, into one structure per snapshot. Every path is
+// *** first checked against the scalar one.
+// ***
+// ***   DhtDecodeBench
+// ***   DhtDecodeBench --count 100000 --repeat 2000 --stride 157
+// ***
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+
+#include "DhtBatchDecode.h"
+
+typedef std::chrono::steady_clock Clock;
+
+// ***
+// *** The per-value decoding being replaced.
+// ***
+union u_float
+{
+    uint8_t bytes[SIZE_FLOAT];
+    float value;
+};
+
+union u_uint32
+{
+    uint8_t bytes[SIZE_UINT32];
+    uint32_t value;
+};
+
+struct Reading
+{
+    float temperature;
+    float humidity;
+    uint32_t readingId;
+    uint32_t readingTime;
+    uint32_t readingAge;
+    uint8_t status;
+    bool valid;
+    bool error;
+    bool upper;
+    bool lower;
+};
+
+static float bytesToFloat(const uint8_t* buffer)
+{
+    u_float converter;
+    for (uint8_t i = 0; i < SIZE_FLOAT; i++) converter.bytes[i] = buffer[i];
+    return converter.value;
+}
+
+static uint32_t bytesToUint32(const uint8_t* buffer)
+{
+    u_uint32 converter;
+    for (uint8_t i = 0; i < SIZE_UINT32; i++) converter.bytes[i] = buffer[i];
+    return converter.value;
+}
+
+static bool getStatusBit(uint8_t status, uint8_t bit)
+{
+    return (status >> bit) & 1;
+}
+
+static size_t decodeReadings(const uint8_t* buffer, size_t count, size_t stride, Reading* readings)
+{
+    size_t valid = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint8_t* record = buffer + i * stride;
+        Reading& reading = readings[i];
+
+        reading.temperature = bytesToFloat(record + MEASUREMENT_OFFSET(REGISTER_TEMPERATURE));
+        reading.humidity = bytesToFloat(record + MEASUREMENT_OFFSET(REGISTER_HUMIDITY));
+        reading.status = record[MEASUREMENT_OFFSET(REGISTER_STATUS)];
+        reading.readingId = bytesToUint32(record + MEASUREMENT_OFFSET(REGISTER_READING_ID));
+        reading.readingTime = bytesToUint32(record + MEASUREMENT_OFFSET(REGISTER_READING_TIME));
+        reading.readingAge = bytesToUint32(record + MEASUREMENT_OFFSET(REGISTER_READING_AGE));
+
+        reading.error = getStatusBit(reading.status, STATUS_DHT_READING_ERROR);
+        reading.upper = getStatusBit(reading.status, STATUS_UPPER_THRESHOLD_EXCEEDED);
+        reading.lower = getStatusBit(reading.status, STATUS_LOWER_THRESHOLD_EXCEEDED);
+        reading.valid = false;
+
+        if (getStatusBit(reading.status, STATUS_SENSOR_IS_ENABLED) && !reading.error && reading.readingId != 0)
+        {
+            if (reading.temperature >= -40.0f && reading.temperature <= 125.0f)
+            {
+                if (reading.humidity >= 0.0f && reading.humidity <= 100.0f)
+                {
+                    reading.valid = true;
+                    valid++;
+                }
+            }
+        }
+    }
+
+    return valid;
+}
+
+// ***
+// *** Snapshots of a fleet: most are good, some have a failed
+// *** read, a disabled sensor, no reading yet or a value that
+// *** is out of range, in no particular order.
+// ***
+static void makeSnapshots(std::vector<uint8_t>& buffer, size_t count, size_t stride)
+{
+    buffer.assign(count * stride, 0);
+    uint32_t random = 1;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint8_t* record = &buffer[i * stride];
+        random = random * 1664525 + 1013904223;
+        uint32_t roll = random >> 24;
+
+        float temperature = 15.0f + (random >> 8) % 200 / 10.0f;
+        float humidity = 30.0f + (random >> 12) % 400 / 10.0f;
+        uint32_t readingId = roll < 5 ? 0 : (uint32_t)i * 7 + 1;
+        uint32_t readingTime = (uint32_t)i * 1000;
+        uint32_t readingAge = (random >> 4) % 2000;
+        uint8_t status = 1 << STATUS_SENSOR_IS_ENABLED;
+
+        if (roll >= 5 && roll < 15) status |= 1 << STATUS_DHT_READING_ERROR;
+        if (roll >= 15 && roll < 20) status = 0;
+        if (roll >= 20 && roll < 23) temperature = NAN;
+        if (roll >= 23 && roll < 26) humidity = 120.0f;
+        if ((random >> 3) % 11 == 0) status |= 1 << STATUS_UPPER_THRESHOLD_EXCEEDED;
+        if ((random >> 5) % 13 == 0) status |= 1 << STATUS_LOWER_THRESHOLD_EXCEEDED;
+
+        memcpy(record + MEASUREMENT_OFFSET(REGISTER_TEMPERATURE), &temperature, SIZE_FLOAT);
+        memcpy(record + MEASUREMENT_OFFSET(REGISTER_HUMIDITY), &humidity, SIZE_FLOAT);
+        record[MEASUREMENT_OFFSET(REGISTER_STATUS)] = status;
+        memcpy(record + MEASUREMENT_OFFSET(REGISTER_READING_ID), &readingId, SIZE_UINT32);
+        memcpy(record + MEASUREMENT_OFFSET(REGISTER_READING_TIME), &readingTime, SIZE_UINT32);
+        memcpy(record + MEASUREMENT_OFFSET(REGISTER_READING_AGE), &readingAge, SIZE_UINT32);
+    }
+}
+
+struct Columns
+{
+    std::vector<float> temperature, humidity;
+    std::vector<uint32_t> readingId, readingTime, readingAge;
+    std::vector<uint8_t> status, valid;
+    std::vector<uint64_t> validMask, errorMask, upperMask, lowerMask;
+    DhtMeasurementColumns view;
+
+    explicit Columns(size_t count)
+        : temperature(count), humidity(count), readingId(count), readingTime(count), readingAge(count),
+          status(count), valid(count), validMask(DHT_DECODE_MASK_WORDS(count)), errorMask(DHT_DECODE_MASK_WORDS(count)),
+          upperMask(DHT_DECODE_MASK_WORDS(count)), lowerMask(DHT_DECODE_MASK_WORDS(count))
+    {
+        view.temperature = temperature.data();
+        view.humidity = humidity.data();
+        view.readingId = readingId.data();
+        view.readingTime = readingTime.data();
+        view.readingAge = readingAge.data();
+        view.status = status.data();
+        view.valid = valid.data();
+        view.validMask = validMask.data();
+        view.errorMask = errorMask.data();
+        view.upperMask = upperMask.data();
+        view.lowerMask = lowerMask.data();
+    }
+
+    bool operator==(const Columns& other) const
+    {
+        // ***
+        // *** Compared as bytes so NaNs match.
+        // ***
+        size_t count = temperature.size();
+        return memcmp(temperature.data(), other.temperature.data(), count * sizeof(float)) == 0 &&
+               memcmp(humidity.data(), other.humidity.data(), count * sizeof(float)) == 0 &&
+               readingId == other.readingId && readingTime == other.readingTime && readingAge == other.readingAge &&
+               status == other.status && valid == other.valid && validMask == other.validMask &&
+               errorMask == other.errorMask && upperMask == other.upperMask && lowerMask == other.lowerMask;
+    }
+};
+
+static double report(const char* name, double seconds, size_t snapshots, double baseline)
+{
+    double ns = seconds * 1e9 / snapshots;
+    printf("%-12s %7.2f ns/snapshot  %8.1f M/s", name, ns, snapshots / seconds / 1e6);
+    if (baseline > 0) printf("  %5.2fx", baseline / ns);
+    printf("\n");
+    return ns;
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = 4096;
+    size_t repeat = 0;
+    size_t stride = MEASUREMENT_SIZE;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--count") == 0 && hasValue) count = strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--repeat") == 0 && hasValue) repeat = strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--stride") == 0 && hasValue) stride = strtoul(argv[++i], NULL, 0);
+        else
+        {
+            fprintf(stderr, "usage: DhtDecodeBench [--count <snapshots>] [--repeat <n>] [--stride <bytes>]\n");
+            return 1;
+        }
+    }
+
+    if (count == 0 || stride < MEASUREMENT_SIZE)
+    {
+        fprintf(stderr, "the stride must be at least %d bytes\n", (int)MEASUREMENT_SIZE);
+        return 1;
+    }
+
+    // ***
+    // *** About 200M snapshots in all unless told otherwise.
+    // ***
+    if (repeat == 0) repeat = 200000000 / count + 1;
+
+    std::vector<uint8_t> buffer;
+    makeSnapshots(buffer, count, stride);
+
+    // ***
+    // *** Every path must give what the scalar path gives, and
+    // *** the scalar path what the per-value decoding gives.
+    // ***
+    std::vector<Reading> readings(count);
+    size_t expected = decodeReadings(buffer.data(), count, stride, readings.data());
+
+    Columns reference(count);
+    size_t valid = decodeMeasurements(buffer.data(), count, stride, reference.view, DHT_DECODE_SCALAR);
+    bool matches = valid == expected;
+    for (size_t i = 0; i < count && matches; i++)
+    {
+        matches = readings[i].valid == (reference.valid[i] != 0) && readings[i].status == reference.status[i] &&
+                  readings[i].readingId == reference.readingId[i] &&
+                  readings[i].error == (((reference.errorMask[i / 64] >> (i % 64)) & 1) != 0);
+    }
+
+    if (!matches)
+    {
+        fprintf(stderr, "scalar: does not match the per-value decoding\n");
+        return 1;
+    }
+
+    uint8_t best = getBestDecodePath();
+    for (uint8_t path = DHT_DECODE_SSE; path <= best; path++)
+    {
+        Columns columns(count);
+        if (decodeMeasurements(buffer.data(), count, stride, columns.view, path) != valid || !(columns == reference))
+        {
+            fprintf(stderr, "%s: does not match the scalar path\n", getDecodePathName(path));
+            return 1;
+        }
+    }
+
+    
+    // ***
+    // *** The paths take turns in short rounds and the fastest
+    // *** round of each is kept, so other work on the host does
+    // *** not skew the ratios.
+    // ***
+    const size_t rounds = 50;
+    size_t perRound = repeat / rounds + 1;
+    size_t checksum = 0;
+    Columns columns(count);
+    double fastest[DHT_DECODE_AVX2 + 2] = { 0 };
+
+    for (size_t round = 0; round < rounds; round++)
+    {
+        for (int path = -1; path <= best; path++)
+        {
+            Clock::time_point start = Clock::now();
+            for (size_t r = 0; r < perRound; r++)
+            {
+                checksum += path < 0 ? decodeReadings(buffer.data(), count, stride, readings.data())
+                                     : decodeMeasurements(buffer.data(), count, stride, columns.view, path);
+            }
+
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            if (round == 0 || seconds < fastest[path + 1]) fastest[path + 1] = seconds;
+        }
+    }
+
+    printf("snapshots  %zu x %zu x %zu rounds, stride %zu, %zu valid\n", count, perRound, rounds, stride, valid);
+    double baseline = report("per-value", fastest[0], count * perRound, 0);
+    for (uint8_t path = DHT_DECODE_SCALAR; path <= best; path++)
+    {
+        report(getDecodePathName(path), fastest[path + 1], count * perRound, baseline);
+    }
+
+    printf("checksum   %zu\n", checksum);
+    return 0;
+}
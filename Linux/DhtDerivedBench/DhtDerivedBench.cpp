@@ -0,0 +1,253 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+// ***
+// *** Checks the breakout's integer dew point, absolute humidity
+// *** and heat index (DHT_Tiny_Breakout/Derived.h) against the
+// *** floating point formulas they replace, over the range of the
+// *** DHT22, and times both.
+// ***
+// ***   DhtDerivedBench
+// ***   DhtDerivedBench --step 5 --repeat 20
+// ***
+// *** The times are for this host; they show the relative cost
+// *** only. On the ATtiny the reference formulas would also link
+// *** the soft-float log() and exp().
+// ***
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAS_TSC 1
+#endif
+
+#include "Derived.h"
+
+struct Point
+{
+    int16_t temperature;
+    int16_t humidity;
+};
+
+struct Error
+{
+    double maximum;
+    double sum;
+    int16_t temperature;
+    int16_t humidity;
+    uint32_t count;
+};
+
+// ***
+// *** The reference formulas, with the same Magnus constants.
+// ***
+static double referenceDewPoint(double temperature, double humidity)
+{
+    double gamma = log(humidity / 100) + MAGNUS_B * temperature / (MAGNUS_C + temperature);
+    return MAGNUS_C * gamma / (MAGNUS_B - gamma);
+}
+
+static double referenceAbsoluteHumidity(double temperature, double humidity)
+{
+    double pressure = MAGNUS_PRESSURE * exp(MAGNUS_B * temperature / (MAGNUS_C + temperature)) * humidity / 100;
+    return 216.74 * pressure / (temperature + 273.15);
+}
+
+static double referenceHeatIndex(double temperature, double humidity)
+{
+    double t = temperature * 9 / 5 + 32;
+    double r = humidity;
+    double index = 0.5 * (t + 61 + (t - 68) * 1.2 + r * 0.094);
+
+    if ((index + t) / 2 >= 80)
+    {
+        index = -42.379 + 2.04901523 * t + 10.14333127 * r - 0.22475541 * t * r - 6.83783e-3 * t * t -
+                5.481717e-2 * r * r + 1.22874e-3 * t * t * r + 8.5282e-4 * t * r * r - 1.99e-6 * t * t * r * r;
+
+        if (r < 13 && t > 80 && t < 112)
+        {
+            index -= ((13 - r) / 4) * sqrt((17 - fabs(t - 95)) / 17);
+        }
+        else if (r > 85 && t > 80 && t < 87)
+        {
+            index += ((r - 85) / 10) * ((87 - t) / 5);
+        }
+    }
+
+    return (index - 32) * 5 / 9;
+}
+
+static void addError(Error& error, double value, double reference, const Point& point)
+{
+    double difference = fabs(value - reference);
+    if (difference > error.maximum)
+    {
+        error.maximum = difference;
+        error.temperature = point.temperature;
+        error.humidity = point.humidity;
+    }
+    error.sum += difference;
+    error.count++;
+}
+
+static void printError(const char* name, const Error& error, const char* unit)
+{
+    printf("%-18s max %6.3f %-5s mean %6.3f  (worst at %.1fC %.1f%%)\n", name, error.maximum, unit,
+           error.count ? error.sum / error.count : 0.0, error.temperature / 10.0, error.humidity / 10.0);
+}
+
+static uint64_t readTimer()
+{
+#ifdef HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+template <typename Function> static void timeCall(const char* name, const std::vector<Point>& points, uint32_t repeat, Function function)
+{
+    volatile double sink = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    uint64_t cycles = readTimer();
+
+    for (uint32_t i = 0; i < repeat; i++)
+    {
+        for (size_t j = 0; j < points.size(); j++)
+        {
+            sink = sink + function(points[j]);
+        }
+    }
+
+    cycles = readTimer() - cycles;
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double calls = (double)points.size() * repeat;
+
+#ifdef HAS_TSC
+    printf("%-30s %8.1f ns %8.1f cycles per call\n", name, seconds * 1e9 / calls, cycles / calls);
+#else
+    printf("%-30s %8.1f ns per call\n", name, seconds * 1e9 / calls);
+#endif
+}
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: DhtDerivedBench [options]\n"
+            "  --step <n>      grid step in tenths of a degree and percent (1)\n"
+            "  --repeat <n>    passes over the grid for the timings (10)\n");
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t step = 1;
+    uint32_t repeat = 10;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        const char* value = hasValue ? argv[i + 1] : "";
+
+        if (strcmp(argv[i], "--step") == 0 && hasValue) step = atoi(value), i++;
+        else if (strcmp(argv[i], "--repeat") == 0 && hasValue) repeat = atoi(value), i++;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    if (step == 0)
+    {
+        usage();
+        return 1;
+    }
+
+    // ***
+    // *** The DHT22 range: -40 to 80C, 0 to 100%. Relative
+    // *** humidity starts at 1% since the dew point of dry
+    // *** air is not defined.
+    // ***
+    std::vector<Point> points;
+    for (int32_t temperature = DERIVED_MINIMUM * 10; temperature <= DERIVED_MAXIMUM * 10; temperature += step)
+    {
+        for (int32_t humidity = 10; humidity <= 1000; humidity += step)
+        {
+            Point point = { (int16_t)temperature, (int16_t)humidity };
+            points.push_back(point);
+        }
+    }
+
+    Error dewPoint = { 0, 0, 0, 0, 0 };
+    Error absoluteHumidity = { 0, 0, 0, 0, 0 };
+    Error heatIndex = { 0, 0, 0, 0, 0 };
+    Error heatIndexTable = { 0, 0, 0, 0, 0 };
+
+    for (size_t i = 0; i < points.size(); i++)
+    {
+        const Point& point = points[i];
+        double temperature = point.temperature / 10.0;
+        double humidity = point.humidity / 10.0;
+
+        // ***
+        // *** Below the bottom of the table the dew point is
+        // *** reported as the bottom of the table.
+        // ***
+        double reference = referenceDewPoint(temperature, humidity);
+        if (reference >= DERIVED_MINIMUM)
+        {
+            addError(dewPoint, getDewPoint(point.temperature, point.humidity) / 10.0, reference, point);
+        }
+
+        addError(absoluteHumidity, getAbsoluteHumidity(point.temperature, point.humidity) / 100.0,
+                 referenceAbsoluteHumidity(temperature, humidity), point);
+
+        double index = getHeatIndex(point.temperature, point.humidity) / 10.0;
+        reference = referenceHeatIndex(temperature, humidity);
+        addError(heatIndex, index, reference, point);
+
+        // ***
+        // *** The range the NWS publishes the heat index for.
+        // ***
+        if (temperature >= 26.7 && temperature <= 43.3 && humidity >= 40)
+        {
+            addError(heatIndexTable, index, reference, point);
+        }
+    }
+
+    printf("points             %zu (step %.1f)\n\n", points.size(), step / 10.0);
+    printError("dew point", dewPoint, "C");
+    printError("absolute humidity", absoluteHumidity, "g/m3");
+    printError("heat index", heatIndex, "C");
+    printError("heat index (NWS)", heatIndexTable, "C");
+    printf("\n");
+
+    timeCall("dew point (integer)", points, repeat, [](const Point& p) { return (double)getDewPoint(p.temperature, p.humidity); });
+    timeCall("dew point (reference)", points, repeat, [](const Point& p) { return referenceDewPoint(p.temperature / 10.0, p.humidity / 10.0); });
+    timeCall("absolute humidity (integer)", points, repeat, [](const Point& p) { return (double)getAbsoluteHumidity(p.temperature, p.humidity); });
+    timeCall("absolute humidity (reference)", points, repeat, [](const Point& p) { return referenceAbsoluteHumidity(p.temperature / 10.0, p.humidity / 10.0); });
+    timeCall("heat index (integer)", points, repeat, [](const Point& p) { return (double)getHeatIndex(p.temperature, p.humidity); });
+    timeCall("heat index (reference)", points, repeat, [](const Point& p) { return referenceHeatIndex(p.temperature / 10.0, p.humidity / 10.0); });
+
+    return 0;
+}
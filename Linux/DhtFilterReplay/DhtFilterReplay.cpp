@@ -0,0 +1,287 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+// ***
+// *** Replays readings recorded by DhtCollector through the
+// *** breakout's outlier filter (DHT_Tiny_Breakout/Filter.h) in
+// *** each of its modes, and reports what a master would have
+// *** seen: the readings committed, the threshold interrupts
+// *** raised and the reads they cause.
+// ***
+// ***   DhtCollector --bus /dev/i2c-1 > trace.txt
+// ***   DhtFilterReplay --upper 26 --lower 21 < trace.txt
+// ***   DhtFilterReplay --spikes 0.01 --spike 20 < trace.txt
+// ***
+// *** A trace line is "<time> <bus> <address> <reading id>
+// *** <temperature> <humidity> <age>". Each new reading id of a
+// *** breakout is one sample, taken at time - age. With --spikes
+// *** a spike is added to that fraction of the samples so a clean
+// *** trace can show the effect of the filter; the reading it
+// *** replaced is used to measure the error of each mode.
+// ***
+// *** With --check it fails unless median+slew raises fewer
+// *** interrupts and causes fewer reads than off; make check runs
+// *** it on the trace in trace.txt.
+// ***
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Filter.h"
+
+struct Sample
+{
+    uint32_t time;
+    int16_t temperature;
+    int16_t humidity;
+    int16_t cleanTemperature;
+    int16_t cleanHumidity;
+};
+
+struct Options
+{
+    double upper;
+    double lower;
+    uint16_t temperatureSlew;
+    uint16_t humiditySlew;
+    double spikes;
+    double spike;
+    uint32_t seed;
+    bool check;
+};
+
+struct Results
+{
+    uint32_t commits;
+    uint32_t rejects;
+    uint32_t interrupts;
+    int32_t maxError;
+};
+
+static const struct
+{
+    const char* name;
+    uint8_t mode;
+} _modes[] =
+{
+    { "off", 0 },
+    { "median", 1 << FILTER_BIT_MEDIAN },
+    { "slew", 1 << FILTER_BIT_SLEW },
+    { "median+slew", (1 << FILTER_BIT_MEDIAN) | (1 << FILTER_BIT_SLEW) },
+};
+
+static int16_t toTenths(double value)
+{
+    return (int16_t)(value < 0 ? value * 10 - 0.5 : value * 10 + 0.5);
+}
+
+static bool readTrace(FILE* input, std::map<std::string, std::vector<Sample>>& devices)
+{
+    std::map<std::string, uint32_t> lastId;
+    char line[256];
+
+    while (fgets(line, sizeof(line), input))
+    {
+        unsigned long long time;
+        char bus[64];
+        unsigned address, id, age;
+        double temperature, humidity;
+
+        if (sscanf(line, "%llu %63s %x %u %lf %lf %u", &time, bus, &address, &id, &temperature, &humidity, &age) != 7)
+        {
+            fprintf(stderr, "skipping: %s", line);
+            continue;
+        }
+
+        // ***
+        // *** The collector prints a reading each time it is
+        // *** polled; only a new reading id is a new sample.
+        // ***
+        std::string key = std::string(bus) + " " + std::to_string(address);
+        std::map<std::string, uint32_t>::iterator last = lastId.find(key);
+        if (last != lastId.end() && last->second == id) continue;
+        lastId[key] = id;
+
+        Sample sample;
+        sample.time = (uint32_t)(time - age);
+        sample.temperature = sample.cleanTemperature = toTenths(temperature);
+        sample.humidity = sample.cleanHumidity = toTenths(humidity);
+        devices[key].push_back(sample);
+    }
+
+    return !devices.empty();
+}
+
+static uint32_t addSpikes(std::map<std::string, std::vector<Sample>>& devices, const Options& options)
+{
+    uint32_t count = 0;
+    srand(options.seed);
+
+    for (std::map<std::string, std::vector<Sample>>::iterator device = devices.begin(); device != devices.end(); device++)
+    {
+        for (size_t i = 0; i < device->second.size(); i++)
+        {
+            if (rand() < options.spikes * RAND_MAX)
+            {
+                int16_t spike = toTenths(rand() % 2 ? options.spike : -options.spike);
+                device->second[i].temperature += spike;
+                device->second[i].humidity += spike;
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+static void replay(const std::vector<Sample>& samples, uint8_t mode, const Options& options, Results& results)
+{
+    Filter filter;
+    resetFilter(filter);
+
+    int16_t upper = toTenths(options.upper);
+    int16_t lower = toTenths(options.lower);
+    bool exceeded = false;
+
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        int16_t temperature = samples[i].temperature;
+        int16_t humidity = samples[i].humidity;
+
+        if (!filterReading(filter, mode, options.temperatureSlew, options.humiditySlew, temperature, humidity, samples[i].time))
+        {
+            results.rejects++;
+            continue;
+        }
+
+        results.commits++;
+
+        // ***
+        // *** The breakout raises its interrupt line while the
+        // *** temperature is outside the thresholds; a master
+        // *** is woken each time it goes up.
+        // ***
+        bool outside = temperature <= lower || temperature >= upper;
+        if (outside && !exceeded) results.interrupts++;
+        exceeded = outside;
+
+        int32_t error = abs(temperature - samples[i].cleanTemperature);
+        if (error > results.maxError) results.maxError = error;
+    }
+}
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: DhtFilterReplay [options] < trace\n"
+            "  --upper <C>              upper threshold (26)\n"
+            "  --lower <C>              lower threshold (21)\n"
+            "  --temperature-slew <n>   slew limit, tenths of a degree per second (5)\n"
+            "  --humidity-slew <n>      slew limit, tenths of a percent per second (20)\n"
+            "  --spikes <p>             add a spike to this fraction of the readings (0)\n"
+            "  --spike <n>              size of an added spike, degrees and percent (20)\n"
+            "  --seed <n>               random seed (1)\n"
+            "  --check                  fail unless median+slew beats off\n");
+}
+
+int main(int argc, char** argv)
+{
+    Options options = { 26.0, 21.0, 5, 20, 0.0, 20.0, 1, false };
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        const char* value = hasValue ? argv[i + 1] : "";
+
+        if (strcmp(argv[i], "--upper") == 0 && hasValue) options.upper = atof(value), i++;
+        else if (strcmp(argv[i], "--lower") == 0 && hasValue) options.lower = atof(value), i++;
+        else if (strcmp(argv[i], "--temperature-slew") == 0 && hasValue) options.temperatureSlew = atoi(value), i++;
+        else if (strcmp(argv[i], "--humidity-slew") == 0 && hasValue) options.humiditySlew = atoi(value), i++;
+        else if (strcmp(argv[i], "--spikes") == 0 && hasValue) options.spikes = atof(value), i++;
+        else if (strcmp(argv[i], "--spike") == 0 && hasValue) options.spike = atof(value), i++;
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) options.seed = atoi(value), i++;
+        else if (strcmp(argv[i], "--check") == 0) options.check = true;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    std::map<std::string, std::vector<Sample>> devices;
+    if (!readTrace(stdin, devices))
+    {
+        fprintf(stderr, "no readings\n");
+        return 1;
+    }
+
+    uint32_t spikes = options.spikes > 0 ? addSpikes(devices, options) : 0;
+
+    size_t readings = 0;
+    for (std::map<std::string, std::vector<Sample>>::iterator device = devices.begin(); device != devices.end(); device++)
+    {
+        readings += device->second.size();
+    }
+
+    printf("readings   %zu from %zu breakout(s), %u spike(s) added\n\n", readings, devices.size(), spikes);
+    printf("%-12s %8s %8s %10s %8s %9s\n", "mode", "commits", "rejected", "interrupts", "reads", "max error");
+
+    const size_t modeCount = sizeof(_modes) / sizeof(_modes[0]);
+    Results all[modeCount];
+
+    for (size_t m = 0; m < modeCount; m++)
+    {
+        Results& results = all[m];
+        results = { 0, 0, 0, 0 };
+
+        for (std::map<std::string, std::vector<Sample>>::iterator device = devices.begin(); device != devices.end(); device++)
+        {
+            replay(device->second, _modes[m].mode, options, results);
+        }
+
+        // ***
+        // *** A polling master reads the measurement block once
+        // *** for each new reading id and once more for each
+        // *** interrupt it is woken by.
+        // ***
+        printf("%-12s %8u %8u %10u %8u %8.1fC\n", _modes[m].name, results.commits, results.rejects,
+               results.interrupts, results.commits + results.interrupts, results.maxError / 10.0);
+    }
+
+    // ***
+    // *** The first mode is off and the last is median+slew.
+    // ***
+    if (options.check)
+    {
+        const Results& off = all[0];
+        const Results& both = all[modeCount - 1];
+
+        if (both.interrupts >= off.interrupts || both.commits + both.interrupts >= off.commits + off.interrupts)
+        {
+            fprintf(stderr, "check failed: median+slew does not reduce interrupts and reads\n");
+            return 1;
+        }
+
+        printf("\ncheck passed\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,715 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+// ***
+// *** Runs the breakout firmware on the host HAL (Hal.cpp)
+// *** through scripted scenarios and writes what it measured as
+// *** JSON. Given the report of an earlier build, it compares the
+// *** two and fails if this build is slower or writes more.
+// ***
+// ***   DhtFirmwareBench --output report.json
+// ***   DhtFirmwareBench --output report.json --baseline baseline.json --tolerance 25
+// ***   DhtFirmwareBench --elf DHT_Tiny_Breakout.ino.elf --ram 512
+// ***   DhtFirmwareBench --check
+// ***
+// *** The protocol checks run first and --check runs only them.
+// ***
+// *** Scenarios, each on a fresh breakout with erased EEPROM:
+// ***
+// ***   idle      the breakout reads its sensors; no master
+// ***   polling   the master reads the measurement block every
+// ***             100 ms
+// ***   config    the master changes a threshold and saves the
+// ***             configuration every second
+// ***   failures  polling while the sensor stops answering and
+// ***             sends bad checksums, 10 s of each in turn
+// ***
+// *** Metrics of each scenario:
+// ***
+// ***   loop      the cost of each loop() pass
+// ***   decode    the cost of the passes that read a sensor; the
+// ***             frame itself is virtual time
+// ***   latency   the cost of the handlers for each master
+// ***             transaction, which the slave stretches the bus
+// ***             clock for
+// ***   blocked   the most virtual time one pass took, which is
+// ***             how long the bus went unanswered
+// ***   counts    sensor reads, committed readings, transactions
+// ***             and EEPROM bytes written
+// ***
+// *** Costs are counted in instructions retired on the host when
+// *** the kernel allows it (perf_event_paranoid <= 2 and a PMU),
+// *** which barely moves between runs, and in nanoseconds
+// *** otherwise. Either depends on the host and the compiler;
+// *** compare reports made on the same machine. Flash and SRAM come from avr-size when the
+// *** ELF of an AVR build is given, and the stack headroom is the
+// *** SRAM left over by the static data.
+// ***
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <linux/perf_event.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "DhtTinyPec.h"
+#include "DhtTinyRegisters.h"
+#include "HalControl.h"
+
+#ifndef BENCH_FIRMWARE_FLAGS
+#define BENCH_FIRMWARE_FLAGS ""
+#endif
+
+#define LOOP_STEP_US        500
+#define FAULT_PERIOD_MS     10000
+
+typedef std::chrono::steady_clock Clock;
+
+// ***
+// *** Counts what a piece of the firmware costs: instructions
+// *** retired in user space if there is a counter for them and
+// *** nanoseconds if not.
+// ***
+class Meter
+{
+public:
+    Meter() : _fd(-1) {}
+    ~Meter() { if (_fd >= 0) close(_fd); }
+
+    void open(bool clockOnly)
+    {
+        if (clockOnly) return;
+
+        struct perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.size = sizeof(attributes);
+        attributes.config = PERF_COUNT_HW_INSTRUCTIONS;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        _fd = syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+    }
+
+    // ***
+    // *** A child inherits the counter of its parent, which only
+    // *** counts the parent, so it opens one of its own.
+    // ***
+    void reopen()
+    {
+        if (_fd >= 0)
+        {
+            close(_fd);
+            _fd = -1;
+            open(false);
+        }
+    }
+
+    bool countsInstructions() const { return _fd >= 0; }
+    const char* getUnit() const { return _fd >= 0 ? "instructions" : "ns"; }
+
+    double now() const
+    {
+        uint64_t count = 0;
+        if (_fd >= 0 && read(_fd, &count, sizeof(count)) == (ssize_t)sizeof(count))
+        {
+            return (double)count;
+        }
+
+        return std::chrono::duration<double, std::nano>(Clock::now().time_since_epoch()).count();
+    }
+
+private:
+    int _fd;
+};
+
+static Meter _meter;
+
+struct Scenario
+{
+    const char* name;
+    uint32_t pollPeriod;
+    uint32_t configPeriod;
+    bool faults;
+};
+
+static const Scenario _scenarios[] =
+{
+    { "idle", 0, 0, false },
+    { "polling", 100, 0, false },
+    { "config", 0, 1000, false },
+    { "failures", 100, 0, true }
+};
+
+#define SCENARIO_COUNT (sizeof(_scenarios) / sizeof(Scenario))
+
+struct Distribution
+{
+    uint64_t count;
+    double p50;
+    double p90;
+    double p99;
+    double max;
+};
+
+// ***
+// *** What a scenario run sends back to the parent. It is plain
+// *** data so it can go through a pipe.
+// ***
+struct Result
+{
+    Distribution loop;
+    Distribution decode;
+    Distribution latency;
+    uint32_t maxBlockedUs;
+    uint32_t sensorReads;
+    uint32_t readings;
+    uint32_t transactions;
+    uint32_t eepromWrites;
+};
+
+static Distribution summarize(std::vector<double>& samples)
+{
+    Distribution distribution = { samples.size(), 0, 0, 0, 0 };
+
+    if (!samples.empty())
+    {
+        std::sort(samples.begin(), samples.end());
+        distribution.p50 = samples[samples.size() * 50 / 100];
+        distribution.p90 = samples[samples.size() * 90 / 100];
+        distribution.p99 = samples[samples.size() * 99 / 100];
+        distribution.max = samples.back();
+    }
+
+    return distribution;
+}
+
+static void keepFastest(Distribution& best, const Distribution& distribution)
+{
+    best.p50 = std::min(best.p50, distribution.p50);
+    best.p90 = std::min(best.p90, distribution.p90);
+    best.p99 = std::min(best.p99, distribution.p99);
+    best.max = std::min(best.max, distribution.max);
+}
+
+static double elapsed(double start)
+{
+    return _meter.now() - start;
+}
+
+// ***
+// *** Master transactions, timed.
+// ***
+static void readRegisters(uint8_t registerId, uint8_t* buffer, uint8_t count, std::vector<double>& latency)
+{
+    double start = _meter.now();
+    halMasterWrite(&registerId, 1);
+    halMasterRead(buffer, count);
+    latency.push_back(elapsed(start));
+}
+
+static void writeRegisters(uint8_t registerId, const void* data, uint8_t count, std::vector<double>& latency)
+{
+    uint8_t frame[1 + SIZE_UINT32];
+    frame[0] = registerId;
+    memcpy(&frame[1], data, count);
+
+    double start = _meter.now();
+    halMasterWrite(frame, count + 1);
+    latency.push_back(elapsed(start));
+}
+
+static Result runScenario(const Scenario& scenario, uint32_t duration)
+{
+    Result result;
+    std::vector<double> loopCosts, decodeCosts, latency;
+    uint32_t nextPoll = 0, nextConfig = 0, maxBlocked = 0;
+    uint8_t block[MEASUREMENT_BLOCK_END - MEASUREMENT_BLOCK_START];
+    bool toggle = false;
+
+    halReset();
+    setup();
+
+    while (halGetTime() / 1000 < duration)
+    {
+        uint32_t now = halGetTime() / 1000;
+
+        if (scenario.faults)
+        {
+            static const uint8_t faults[] = { HAL_SENSOR_OK, HAL_SENSOR_MISSING, HAL_SENSOR_CHECKSUM };
+            halSetSensorFault(faults[(now / FAULT_PERIOD_MS) % sizeof(faults)]);
+        }
+
+        if (scenario.pollPeriod > 0 && now >= nextPoll)
+        {
+            readRegisters(MEASUREMENT_BLOCK_START, block, sizeof(block), latency);
+            nextPoll = now + scenario.pollPeriod;
+        }
+
+        if (scenario.configPeriod > 0 && now >= nextConfig)
+        {
+            float threshold = toggle ? 27.0f : 26.0f;
+            uint8_t config = 0;
+            toggle = !toggle;
+
+            writeRegisters(REGISTER_UPPER_THRESHOLD, &threshold, SIZE_FLOAT, latency);
+            readRegisters(REGISTER_CONFIG, &config, SIZE_UINT8, latency);
+            config |= 1 << CONFIG_BIT_WRITE_CONFIG;
+            writeRegisters(REGISTER_CONFIG, &config, SIZE_UINT8, latency);
+            nextConfig = now + scenario.configPeriod;
+        }
+
+        uint32_t reads = halGetSensorReads();
+        uint32_t before = halGetTime();
+        double start = _meter.now();
+        loop();
+        double cost = elapsed(start);
+
+        loopCosts.push_back(cost);
+        if (halGetSensorReads() != reads) decodeCosts.push_back(cost);
+        maxBlocked = std::max(maxBlocked, halGetTime() - before);
+
+        halAdvance(LOOP_STEP_US);
+    }
+
+    uint32_t readingId = 0;
+    std::vector<double> unused;
+    readRegisters(REGISTER_READING_ID, (uint8_t*)&readingId, SIZE_UINT32, unused);
+
+    result.loop = summarize(loopCosts);
+    result.decode = summarize(decodeCosts);
+    result.transactions = latency.size();
+    result.latency = summarize(latency);
+    result.maxBlockedUs = maxBlocked;
+    result.sensorReads = halGetSensorReads();
+    result.readings = readingId;
+    result.eepromWrites = halGetEepromWrites();
+    return result;
+}
+
+// ***
+// *** The firmware keeps its state in globals, so each run is
+// *** made in a child that has never run it.
+// ***
+static bool runIsolated(const Scenario& scenario, uint32_t duration, Result& result)
+{
+    int pipeFds[2];
+    if (pipe(pipeFds) != 0)
+    {
+        perror("pipe");
+        return false;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        close(pipeFds[0]);
+        _meter.reopen();
+        Result childResult = runScenario(scenario, duration);
+        bool written = write(pipeFds[1], &childResult, sizeof(childResult)) == (ssize_t)sizeof(childResult);
+        _exit(written ? 0 : 1);
+    }
+
+    close(pipeFds[1]);
+    bool received = read(pipeFds[0], &result, sizeof(result)) == (ssize_t)sizeof(result);
+    close(pipeFds[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return received && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// ***
+// *** Checks of the bus protocol, each on a fresh breakout. A
+// *** failed check is reported and exits the child with 1.
+// ***
+static bool expect(bool condition, const char* check, const char* what)
+{
+    if (!condition) fprintf(stderr, "%s: %s\n", check, what);
+    return condition;
+}
+
+static uint8_t readByte(uint8_t registerId)
+{
+    uint8_t value = 0xFF;
+    halMasterWrite(&registerId, 1);
+    halMasterRead(&value, 1);
+    return value;
+}
+
+// ***
+// *** With PEC enabled a two byte write has no PEC and must not
+// *** be taken for a read, except for the plain write that only
+// *** turns PEC off. A PEC read gets the data and a valid PEC.
+// ***
+static bool checkPecFraming()
+{
+    const char* check = "pec";
+
+    halReset();
+    setup();
+
+    uint8_t address = readByte(REGISTER_DEVICE_ADDRESS);
+    uint8_t config = readByte(REGISTER_CONFIG) | (1 << CONFIG_BIT_PEC_ENABLED);
+    uint8_t enable[] = { REGISTER_CONFIG, config };
+    halMasterWrite(enable, sizeof(enable));
+    if (!expect(readByte(REGISTER_CONFIG) == config, check, "a plain write did not enable PEC")) return false;
+
+    uint8_t rejected[] = { REGISTER_CONFIG, (uint8_t)(config | (1 << CONFIG_BIT_THRESHOLD_ENABLED)) };
+    halMasterWrite(rejected, sizeof(rejected));
+    if (!expect(readByte(REGISTER_CONFIG) == config, check, "a write without a PEC was accepted")) return false;
+    if (!expect(readByte(REGISTER_STATUS) & (1 << STATUS_PEC_ERROR), check, "a write without a PEC did not set STATUS_PEC_ERROR")) return false;
+
+    uint8_t command[] = { PEC_READ_COMMAND, REGISTER_CONFIG, SIZE_UINT8 };
+    uint8_t frame[SIZE_UINT8 + 1];
+    halMasterWrite(command, sizeof(command));
+    halMasterRead(frame, sizeof(frame));
+
+    uint8_t pec = DhtTinyPec::update(DHTTINY_PEC_INITIAL, DhtTinyPec::writeAddress(address));
+    pec = DhtTinyPec::update(pec, command, sizeof(command));
+    pec = DhtTinyPec::update(pec, DhtTinyPec::readAddress(address));
+    pec = DhtTinyPec::update(pec, frame, SIZE_UINT8);
+    if (!expect(frame[0] == config && frame[1] == pec, check, "a PEC read did not return the configuration and its PEC")) return false;
+
+    uint8_t disable[] = { REGISTER_CONFIG, (uint8_t)(config & ~(1 << CONFIG_BIT_PEC_ENABLED)) };
+    halMasterWrite(disable, sizeof(disable));
+    return expect(readByte(REGISTER_CONFIG) == disable[1], check, "a plain write did not disable PEC");
+}
+
+static bool runCheck(bool (*check)())
+{
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        _exit(check() ? 0 : 1);
+    }
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// ***
+// *** The report is a flat map of metric names to numbers so
+// *** that two reports can be compared line by line.
+// ***
+typedef std::vector<std::pair<std::string, double> > Metrics;
+
+static void addDistribution(Metrics& metrics, const std::string& prefix, const Distribution& distribution)
+{
+    metrics.push_back(std::make_pair(prefix + ".count", (double)distribution.count));
+    metrics.push_back(std::make_pair(prefix + ".p50", distribution.p50));
+    metrics.push_back(std::make_pair(prefix + ".p90", distribution.p90));
+    metrics.push_back(std::make_pair(prefix + ".p99", distribution.p99));
+    metrics.push_back(std::make_pair(prefix + ".max", distribution.max));
+}
+
+static void addResult(Metrics& metrics, const std::string& name, const Result& result)
+{
+    addDistribution(metrics, name + ".loop", result.loop);
+    addDistribution(metrics, name + ".decode", result.decode);
+    addDistribution(metrics, name + ".latency", result.latency);
+    metrics.push_back(std::make_pair(name + ".blocked.max_us", (double)result.maxBlockedUs));
+    metrics.push_back(std::make_pair(name + ".sensor_reads", (double)result.sensorReads));
+    metrics.push_back(std::make_pair(name + ".readings", (double)result.readings));
+    metrics.push_back(std::make_pair(name + ".transactions", (double)result.transactions));
+    metrics.push_back(std::make_pair(name + ".eeprom_writes", (double)result.eepromWrites));
+}
+
+static bool addMemory(Metrics& metrics, const char* elf, uint32_t ram)
+{
+    std::string command = std::string("avr-size -A '") + elf + "'";
+    FILE* pipe = popen(command.c_str(), "r");
+    if (pipe == NULL)
+    {
+        return false;
+    }
+
+    char line[256], section[64];
+    unsigned long size = 0, text = 0, data = 0, bss = 0;
+    bool found = false;
+
+    while (fgets(line, sizeof(line), pipe) != NULL)
+    {
+        if (sscanf(line, "%63s %lu", section, &size) != 2) continue;
+        if (strcmp(section, ".text") == 0) { text = size; found = true; }
+        else if (strcmp(section, ".data") == 0) data = size;
+        else if (strcmp(section, ".bss") == 0) bss = size;
+    }
+
+    if (pclose(pipe) != 0 || !found)
+    {
+        return false;
+    }
+
+    // ***
+    // *** Flash is .text + .data, SRAM is .data + .bss, as in
+    // *** Arduino/Tools/size_report.sh.
+    // ***
+    metrics.push_back(std::make_pair("memory.flash_bytes", (double)(text + data)));
+    metrics.push_back(std::make_pair("memory.sram_bytes", (double)(data + bss)));
+    if (ram > 0)
+    {
+        metrics.push_back(std::make_pair("memory.stack_headroom_bytes", (double)ram - (double)(data + bss)));
+    }
+
+    return true;
+}
+
+static void writeReport(FILE* file, const Metrics& metrics, uint32_t duration)
+{
+    fprintf(file, "{\n");
+    fprintf(file, "  \"bench\": \"DhtFirmwareBench\",\n");
+    fprintf(file, "  \"format\": 1,\n");
+    fprintf(file, "  \"firmware_flags\": \"%s\",\n", BENCH_FIRMWARE_FLAGS);
+    fprintf(file, "  \"unit\": \"%s\",\n", _meter.getUnit());
+    fprintf(file, "  \"duration_ms\": %u,\n", duration);
+    fprintf(file, "  \"metrics\": {\n");
+    for (size_t i = 0; i < metrics.size(); i++)
+    {
+        fprintf(file, "    \"%s\": %.1f%s\n", metrics[i].first.c_str(), metrics[i].second, i + 1 < metrics.size() ? "," : "");
+    }
+    fprintf(file, "  }\n");
+    fprintf(file, "}\n");
+}
+
+// ***
+// *** Reads the unit and the metrics back from a report. Each
+// *** one is on a line of its own.
+// ***
+static bool readReport(const char* path, std::string& unit, std::map<std::string, double>& metrics)
+{
+    FILE* file = fopen(path, "r");
+    if (file == NULL)
+    {
+        perror(path);
+        return false;
+    }
+
+    char line[256], name[128];
+    double value = 0;
+    bool inMetrics = false;
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        if (sscanf(line, " \"unit\": \"%127[^\"]\"", name) == 1) unit = name;
+        else if (strstr(line, "\"metrics\"") != NULL) inMetrics = true;
+        else if (inMetrics && sscanf(line, " \"%127[^\"]\": %lf", name, &value) == 2) metrics[name] = value;
+    }
+
+    fclose(file);
+    return !metrics.empty();
+}
+
+static bool endsWith(const std::string& text, const char* suffix)
+{
+    size_t length = strlen(suffix);
+    return text.size() >= length && text.compare(text.size() - length, length, suffix) == 0;
+}
+
+// ***
+// *** The medians and 90th percentiles of the costs may grow by
+// *** the tolerance
+// *** before they count as a regression; the tails are too noisy
+// *** to judge on. Bytes written, flash, SRAM and the time the
+// *** bus goes unanswered do not depend on the host and may not
+// *** grow at all.
+// ***
+static uint32_t compareReports(const Metrics& metrics, const std::map<std::string, double>& baseline, double tolerance)
+{
+    uint32_t regressions = 0;
+
+    printf("%-36s %14s %14s %8s\n", "Metric", "Baseline", "Current", "Change");
+    for (size_t i = 0; i < metrics.size(); i++)
+    {
+        const std::string& name = metrics[i].first;
+        double current = metrics[i].second;
+        std::map<std::string, double>::const_iterator found = baseline.find(name);
+        if (found == baseline.end()) continue;
+
+        double previous = found->second;
+        double change = previous != 0 ? (current - previous) * 100.0 / previous : 0;
+        bool regression = false;
+
+        if (endsWith(name, ".p50") || endsWith(name, ".p90"))
+        {
+            regression = current > previous * (1.0 + tolerance / 100.0);
+        }
+        else if (endsWith(name, ".eeprom_writes") || endsWith(name, ".max_us") ||
+                 endsWith(name, "flash_bytes") || endsWith(name, "sram_bytes"))
+        {
+            regression = current > previous;
+        }
+        else if (endsWith(name, "headroom_bytes"))
+        {
+            regression = current < previous;
+        }
+
+        printf("%-36s %14.1f %14.1f %7.1f%%%s\n", name.c_str(), previous, current, change, regression ? "  REGRESSION" : "");
+        if (regression) regressions++;
+    }
+
+    return regressions;
+}
+
+int main(int argc, char** argv)
+{
+    const char* output = NULL;
+    const char* baselinePath = NULL;
+    const char* elf = NULL;
+    double tolerance = -1;
+    bool clockOnly = false;
+    bool checkOnly = false;
+    uint32_t duration = 120000;
+    uint32_t repeat = 5;
+    uint32_t ram = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--output") == 0 && hasValue) output = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && hasValue) baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--tolerance") == 0 && hasValue) tolerance = atof(argv[++i]);
+        else if (strcmp(argv[i], "--duration") == 0 && hasValue) duration = strtoul(argv[++i], NULL, 0) * 1000;
+        else if (strcmp(argv[i], "--repeat") == 0 && hasValue) repeat = strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--elf") == 0 && hasValue) elf = argv[++i];
+        else if (strcmp(argv[i], "--ram") == 0 && hasValue) ram = strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--clock") == 0) clockOnly = true;
+        else if (strcmp(argv[i], "--check") == 0) checkOnly = true;
+        else
+        {
+            fprintf(stderr, "usage: DhtFirmwareBench [--output <file>] [--baseline <file>] [--tolerance <percent>]\n"
+                            "                        [--duration <seconds>] [--repeat <n>] [--clock] [--check] [--elf <file> [--ram <bytes>]]\n");
+            return 1;
+        }
+    }
+
+    if (duration == 0 || repeat == 0)
+    {
+        fprintf(stderr, "the duration and repeat must be at least 1\n");
+        return 1;
+    }
+
+    // ***
+    // *** A build that gets the protocol wrong is not measured.
+    // ***
+    if (!runCheck(checkPecFraming)) return 1;
+    if (checkOnly) return 0;
+
+    _meter.open(clockOnly);
+    bool countsInstructions = _meter.countsInstructions();
+
+    // ***
+    // *** Each scenario is run several times and the fastest value
+    // *** of each statistic is kept, so other work on the host
+    // *** does not skew it. The counts are the same in every run.
+    // ***
+    Metrics metrics;
+    for (size_t i = 0; i < SCENARIO_COUNT; i++)
+    {
+        Result best;
+        for (uint32_t run = 0; run < repeat; run++)
+        {
+            Result result;
+            if (!runIsolated(_scenarios[i], duration, result))
+            {
+                fprintf(stderr, "%s: the run failed\n", _scenarios[i].name);
+                return 1;
+            }
+
+            if (run == 0)
+            {
+                best = result;
+            }
+            else
+            {
+                keepFastest(best.loop, result.loop);
+                keepFastest(best.decode, result.decode);
+                keepFastest(best.latency, result.latency);
+            }
+        }
+
+        addResult(metrics, _scenarios[i].name, best);
+        fprintf(stderr, "%-10s loop %6.0f  decode %6.0f  latency %6.0f %s (p50)  blocked %5u us  %u readings  %u EEPROM writes\n",
+                _scenarios[i].name, best.loop.p50, best.decode.p50, best.latency.p50, _meter.getUnit(), best.maxBlockedUs,
+                best.readings, best.eepromWrites);
+    }
+
+    if (elf != NULL && !addMemory(metrics, elf, ram))
+    {
+        fprintf(stderr, "%s: avr-size could not read it\n", elf);
+        return 1;
+    }
+
+    FILE* file = output != NULL ? fopen(output, "w") : stdout;
+    if (file == NULL)
+    {
+        perror(output);
+        return 1;
+    }
+
+    writeReport(file, metrics, duration);
+    if (file != stdout) fclose(file);
+
+    if (baselinePath != NULL)
+    {
+        std::string unit;
+        std::map<std::string, double> baseline;
+        if (!readReport(baselinePath, unit, baseline))
+        {
+            fprintf(stderr, "%s: no metrics\n", baselinePath);
+            return 1;
+        }
+
+        if (unit != _meter.getUnit())
+        {
+            fprintf(stderr, "%s: the costs are in %s, not %s\n", baselinePath, unit.c_str(), _meter.getUnit());
+            return 1;
+        }
+
+        // ***
+        // *** Instruction counts move by a fraction of a percent,
+        // *** times by tens of percent.
+        // ***
+        if (tolerance < 0) tolerance = countsInstructions ? 2 : 25;
+
+        uint32_t regressions = compareReports(metrics, baseline, tolerance);
+        printf("%u regression%s\n", regressions, regressions == 1 ? "" : "s");
+        return regressions > 0 ? 2 : 0;
+    }
+
+    return 0;
+}
@@ -0,0 +1,298 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include <Arduino.h>
+#include <Wire.h>
+#include <EEPROM.h>
+#include <avr/eeprom.h>
+#include "dht.h"
+#include "HalControl.h"
+
+#define HAL_PIN_COUNT   20
+
+HalSerial Serial;
+TwoWire Wire;
+HalEeprom EEPROM;
+
+volatile uint8_t _halPortInput = 0;
+volatile uint8_t TWAR = 0;
+volatile uint16_t EEAR = 0;
+volatile uint8_t EEDR = 0;
+
+static uint32_t _time = 0;
+static uint32_t _noise = 1;
+static uint8_t _sensorFault = HAL_SENSOR_OK;
+static uint32_t _eepromWrites = 0;
+static uint32_t _sensorReads = 0;
+static uint8_t _eeprom[HAL_EEPROM_SIZE];
+static uint8_t _pinModes[HAL_PIN_COUNT];
+static uint8_t _pinValues[HAL_PIN_COUNT];
+
+static void (*_receiveHandler)(uint8_t) = NULL;
+static void (*_requestHandler)() = NULL;
+static uint8_t _rxBuffer[BUFFER_LENGTH];
+static uint8_t _rxLength = 0;
+static uint8_t _rxPosition = 0;
+static uint8_t _txBuffer[BUFFER_LENGTH];
+static uint8_t _txLength = 0;
+
+void halReset()
+{
+    _time = 0;
+    _noise = 1;
+    _sensorFault = HAL_SENSOR_OK;
+    _eepromWrites = 0;
+    _sensorReads = 0;
+    memset(_eeprom, 0xFF, sizeof(_eeprom));
+    memset(_pinModes, INPUT, sizeof(_pinModes));
+    memset(_pinValues, LOW, sizeof(_pinValues));
+}
+
+void halAdvance(uint32_t us)
+{
+    _time += us;
+}
+
+uint32_t halGetTime()
+{
+    return _time;
+}
+
+void halSetSensorFault(uint8_t fault)
+{
+    _sensorFault = fault;
+}
+
+uint32_t halGetEepromWrites()
+{
+    return _eepromWrites;
+}
+
+uint32_t halGetSensorReads()
+{
+    return _sensorReads;
+}
+
+// ***
+// *** Time.
+// ***
+unsigned long millis()
+{
+    return _time / 1000;
+}
+
+unsigned long micros()
+{
+    return _time;
+}
+
+void delay(unsigned long ms)
+{
+    _time += ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    _time += us;
+}
+
+// ***
+// *** Pins. Nothing drives an input, so it reads its pull-up.
+// ***
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin < HAL_PIN_COUNT)
+    {
+        _pinModes[pin] = mode;
+        if (mode == INPUT_PULLUP) _pinValues[pin] = HIGH;
+    }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value)
+{
+    if (pin < HAL_PIN_COUNT) _pinValues[pin] = value;
+}
+
+int digitalRead(uint8_t pin)
+{
+    if (pin >= HAL_PIN_COUNT) return LOW;
+    return _pinModes[pin] == OUTPUT ? _pinValues[pin] : _pinModes[pin] == INPUT_PULLUP ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+    _noise = _noise * 1664525 + 1013904223;
+    return _noise >> 22;
+}
+
+void noInterrupts() {}
+void interrupts() {}
+
+// ***
+// *** EEPROM.
+// ***
+uint8_t HalEeprom::read(int address)
+{
+    return _eeprom[address % HAL_EEPROM_SIZE];
+}
+
+void HalEeprom::write(int address, uint8_t value)
+{
+    _eeprom[address % HAL_EEPROM_SIZE] = value;
+    _eepromWrites++;
+}
+
+void HalEeprom::update(int address, uint8_t value)
+{
+    if (read(address) != value) write(address, value);
+}
+
+uint8_t eeprom_read_byte(const uint8_t* address)
+{
+    EEAR = (uint16_t)(uintptr_t)address;
+    EEDR = EEPROM.read(EEAR);
+    return EEDR;
+}
+
+// ***
+// *** Wire.
+// ***
+void TwoWire::begin(uint8_t address) {}
+
+void TwoWire::onReceive(void (*handler)(uint8_t))
+{
+    _receiveHandler = handler;
+}
+
+void TwoWire::onRequest(void (*handler)())
+{
+    _requestHandler = handler;
+}
+
+int TwoWire::available()
+{
+    return _rxLength - _rxPosition;
+}
+
+int TwoWire::read()
+{
+    return _rxPosition < _rxLength ? _rxBuffer[_rxPosition++] : -1;
+}
+
+size_t TwoWire::write(uint8_t value)
+{
+    if (_txLength >= BUFFER_LENGTH) return 0;
+    _txBuffer[_txLength++] = value;
+    return 1;
+}
+
+void halMasterWrite(const uint8_t* data, uint8_t count)
+{
+    _rxLength = min(count, (uint8_t)BUFFER_LENGTH);
+    _rxPosition = 0;
+    memcpy(_rxBuffer, data, _rxLength);
+
+    if (_receiveHandler != NULL) _receiveHandler(_rxLength);
+}
+
+uint8_t halMasterRead(uint8_t* data, uint8_t count)
+{
+    _txLength = 0;
+    if (_requestHandler != NULL) _requestHandler();
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        data[i] = i < _txLength ? _txBuffer[i] : 0xFF;
+    }
+
+    return min(count, _txLength);
+}
+
+// ***
+// *** The DHT. The host cannot time the bits by counting loops,
+// *** so the frame is made here from the time and the pin, and
+// *** the time it takes on the wire is added to the clock. The
+// *** conversion and checksum test of dht::readModel() are the
+// *** firmware's own.
+// ***
+#define HAL_DHT_ACK_US      160
+#define HAL_DHT_ZERO_US     76
+#define HAL_DHT_ONE_US      120
+
+int8_t dht::_readSensor(uint8_t pin, uint8_t wakeupDelay, uint8_t leadingZeroBits)
+{
+    _sensorReads++;
+
+    if (_capture != NULL)
+    {
+        memset(_capture, 0, DHTLIB_CAPTURE_SIZE);
+    }
+
+    memset(bits, 0, sizeof(bits));
+    delayMicroseconds((wakeupDelay * 1000UL) >> _clockShift);
+
+    if (_sensorFault == HAL_SENSOR_MISSING)
+    {
+        delayMicroseconds(200);
+        return DHTLIB_ERROR_CONNECT;
+    }
+
+    // ***
+    // *** Each pin follows its own slow triangle, one step every
+    // *** few seconds.
+    // ***
+    uint32_t step = _time / 4000000 + pin * 7;
+    int16_t temperature = 200 + (int16_t)((step % 40 < 20) ? step % 40 : 40 - step % 40);
+    uint16_t humidity = 450 + (uint16_t)((step % 60 < 30) ? step % 60 : 60 - step % 60);
+
+    if (wakeupDelay == DHTLIB_DHT11_WAKEUP)
+    {
+        bits[0] = humidity / 10;
+        bits[2] = temperature / 10;
+    }
+    else
+    {
+        bits[0] = humidity >> 8;
+        bits[1] = humidity & 0xFF;
+        bits[2] = temperature >> 8;
+        bits[3] = temperature & 0xFF;
+    }
+
+    bits[4] = bits[0] + bits[1] + bits[2] + bits[3];
+    if (_sensorFault == HAL_SENSOR_CHECKSUM) bits[4] ^= 0x01;
+
+    uint32_t frameTime = HAL_DHT_ACK_US;
+    for (uint8_t i = 0; i < 40; i++)
+    {
+        bool one = (bits[i / 8] >> (7 - i % 8)) & 1;
+        frameTime += one ? HAL_DHT_ONE_US : HAL_DHT_ZERO_US;
+
+        if (_capture != NULL)
+        {
+            _capture[DHTLIB_CAPTURE_FRAME_SIZE + i] = (one ? _timeout * 7 / 10 : _timeout / 4) >> DHTLIB_CAPTURE_SHIFT;
+        }
+    }
+
+    if (_capture != NULL)
+    {
+        memcpy(_capture, bits, DHTLIB_CAPTURE_FRAME_SIZE);
+    }
+
+    delayMicroseconds(frameTime);
+    return DHTLIB_OK;
+}
@@ -0,0 +1,109 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef ARDUINO_HAL_H
+#define ARDUINO_HAL_H
+
+// ***
+// *** The part of the Arduino core the breakout firmware uses,
+// *** implemented on the host by Hal.cpp. Time is virtual: it
+// *** only moves when the bench or a delay moves it, so a run
+// *** is the same every time.
+// ***
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <avr/pgmspace.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH            1
+#define LOW             0
+#define INPUT           0
+#define OUTPUT          1
+#define INPUT_PULLUP    2
+
+#define HEX             16
+#define A0              14
+#define E2END           511
+
+// ***
+// *** The constants of binary.h the firmware uses.
+// ***
+#define B00001011       0x0B
+#define B10101010       0xAA
+#define bitRead(value, bit)             (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit)              ((value) |= (1UL << (bit)))
+#define bitClear(value, bit)            ((value) &= ~(1UL << (bit)))
+#define bitWrite(value, bit, bitvalue)  ((bitvalue) ? bitSet(value, bit) : bitClear(value, bit))
+#define _BV(bit)                        (1 << (bit))
+
+#define min(a, b)                       ((a) < (b) ? (a) : (b))
+#define max(a, b)                       ((a) > (b) ? (a) : (b))
+#define constrain(amt, low, high)       ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// ***
+// *** The DHT decoder reads its pin through the port registers.
+// *** The host decoder in Hal.cpp does not, so one port will do.
+// ***
+#define digitalPinToBitMask(pin)        (1 << ((pin) & 0x07))
+#define digitalPinToPort(pin)           0
+#define portInputRegister(port)         (&_halPortInput)
+extern volatile uint8_t _halPortInput;
+
+#define F(text)                         (text)
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+
+void noInterrupts();
+void interrupts();
+
+// ***
+// *** The TWI address register. The firmware sets the general
+// *** call bit in it.
+// ***
+#define TWGCE           0
+extern volatile uint8_t TWAR;
+
+// ***
+// *** Debug output goes nowhere.
+// ***
+class HalSerial
+{
+public:
+    void begin(unsigned long) {}
+    template <class T> void print(T) {}
+    template <class T> void print(T, int) {}
+    template <class T> void println(T) {}
+    template <class T> void println(T, int) {}
+    void println() {}
+};
+
+extern HalSerial Serial;
+
+#endif
@@ -0,0 +1,41 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef EEPROM_HAL_H
+#define EEPROM_HAL_H
+
+#include <stdint.h>
+
+// ***
+// *** The EEPROM starts erased. Every byte that is written, or
+// *** updated to a new value, is counted.
+// ***
+#define HAL_EEPROM_SIZE 512
+
+class HalEeprom
+{
+public:
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    void update(int address, uint8_t value);
+    uint16_t length() { return HAL_EEPROM_SIZE; }
+};
+
+extern HalEeprom EEPROM;
+
+#endif
@@ -0,0 +1,46 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef WIRE_HAL_H
+#define WIRE_HAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define BUFFER_LENGTH   32
+
+// ***
+// *** The slave side of the Wire library. The bench plays the
+// *** master through halMasterWrite() and halMasterRead(), which
+// *** call the handlers the way the TWI interrupt does.
+// ***
+class TwoWire
+{
+public:
+    void begin(uint8_t address);
+    void onReceive(void (*handler)(uint8_t));
+    void onRequest(void (*handler)());
+
+    int available();
+    int read();
+    size_t write(uint8_t value);
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,37 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef AVR_EEPROM_HAL_H
+#define AVR_EEPROM_HAL_H
+
+#include <stdint.h>
+#include <EEPROM.h>
+
+// ***
+// *** The address and data registers are plain variables that
+// *** eeprom_read_byte() leaves the last access in, as it does on
+// *** the AVR.
+// ***
+extern volatile uint16_t EEAR;
+extern volatile uint8_t EEDR;
+
+uint8_t eeprom_read_byte(const uint8_t* address);
+
+#define eeprom_busy_wait() do {} while (0)
+
+#endif
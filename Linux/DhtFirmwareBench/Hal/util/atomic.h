@@ -0,0 +1,30 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef ATOMIC_HAL_H
+#define ATOMIC_HAL_H
+
+// ***
+// *** The bench calls the handlers between loop passes, never
+// *** during one, so a block is atomic as it is.
+// ***
+#define ATOMIC_RESTORESTATE     0
+#define ATOMIC_FORCEON          1
+#define ATOMIC_BLOCK(type)      for (uint8_t _atomicOnce = 1; _atomicOnce; _atomicOnce = 0)
+
+#endif
@@ -0,0 +1,71 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef HAL_CONTROL_H
+#define HAL_CONTROL_H
+
+#include <stdint.h>
+
+// ***
+// *** What the bench sees of the host HAL. It does not include
+// *** Arduino.h, so the bench can use the standard library.
+// ***
+
+// ***
+// *** How the simulated DHT answers the next reads.
+// ***
+#define HAL_SENSOR_OK           0
+#define HAL_SENSOR_MISSING      1
+#define HAL_SENSOR_CHECKSUM     2
+
+// ***
+// *** Erases the EEPROM, sets the time to 0 and clears the
+// *** counters. Call it before setup().
+// ***
+void halReset();
+
+// ***
+// *** Moves the virtual time on.
+// ***
+void halAdvance(uint32_t us);
+uint32_t halGetTime();
+
+void halSetSensorFault(uint8_t fault);
+
+// ***
+// *** Counters since halReset().
+// ***
+uint32_t halGetEepromWrites();
+uint32_t halGetSensorReads();
+
+// ***
+// *** A master write of a register number and its data, and a
+// *** master read of the bytes after it. They call the handlers
+// *** the firmware registered with Wire. A read returns 0xFF
+// *** for each byte the firmware did not supply.
+// ***
+void halMasterWrite(const uint8_t* data, uint8_t count);
+uint8_t halMasterRead(uint8_t* data, uint8_t count);
+
+// ***
+// *** The sketch.
+// ***
+void setup();
+void loop();
+
+#endif
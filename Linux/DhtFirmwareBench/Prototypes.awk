@@ -0,0 +1,53 @@
+# Copyright © 2016 Daniel Porrey. All Rights Reserved.
+#
+# This file is part of the DHT Tiny project.
+# 
+# DHT Tiny is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+# 
+# DHT Tiny is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+# 
+# You should have received a copy of the GNU General Public License
+# along with DHT Tiny. If not, 
+# see http://www.gnu.org/licenses/.
+#
+
+# ***
+# *** Turns the sketch into C++ the way the Arduino builder does:
+# *** a prototype of every function is put in front of the first
+# *** one so they can be called before they are defined. Run it
+# *** with the sketch named twice; the first pass finds the
+# *** functions and the second prints the sketch.
+# ***
+# ***   awk -f Prototypes.awk Sketch.ino Sketch.ino > Sketch.cpp
+# ***
+
+FNR == NR {
+    if ($0 == "{" && previous ~ /^[A-Za-z_][A-Za-z0-9_ *&]*[ *&][A-Za-z_][A-Za-z0-9_]*\(.*\)$/ &&
+        previous !~ /^(if|for|while|switch|else|return)[ (]/)
+    {
+        prototypes[++count] = previous ";"
+        if (first == 0) first = FNR - 1
+    }
+
+    previous = $0
+    next
+}
+
+FNR == 1 {
+    printf "#line 1 \"%s\"\n", FILENAME
+}
+
+FNR == first {
+    for (i = 1; i <= count; i++) print prototypes[i]
+    printf "#line %d \"%s\"\n", FNR, FILENAME
+}
+
+{
+    print
+}
@@ -0,0 +1,517 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+
+// ***
+// *** Simulates a fleet of DHT Tiny Breakouts on one or more I2C
+// *** buses and a master polling them, and reports how the bus
+// *** and the readings hold up.
+// ***
+// ***   DhtFleetSim --devices 224 --buses 2 --speed 100 --strategy naive --poll 1000
+// ***   DhtFleetSim --devices 112 --strategy cached --schedule spread --alert-rate 0.01 --alert-line
+// ***   DhtFleetSim --devices 64 --discovery enumerate
+// ***
+// *** Strategies:
+// ***
+// ***   naive    the register by register reads of DHT_Uno_Master
+// ***   block    one read of the measurement block per poll
+// ***   cached   DhtTinyClient: the reading id, and the block only
+// ***            when the id has moved
+// ***
+// *** Discovery:
+// ***
+// ***   sweep      configured breakouts; the id of every address
+// ***              is read
+// ***   enumerate  factory fresh breakouts, all at the setup
+// ***              address, found and given addresses by
+// ***              DhtTinyDiscovery
+// ***
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "DhtTinyClient.h"
+#include "DhtTinyDiscovery.h"
+#include "I2cTransport.h"
+#include "SimBus.h"
+
+#define MS              1000000LL
+#define FIRST_ADDRESS   0x08
+#define LAST_ADDRESS    0x77
+#define BLOCK_OFFSET(r) ((r) - (MEASUREMENT_BLOCK_START))
+
+enum Strategy { STRATEGY_NAIVE, STRATEGY_BLOCK, STRATEGY_CACHED };
+
+struct Options
+{
+    uint32_t devices;
+    uint32_t buses;
+    uint32_t speed;
+    Strategy strategy;
+    bool enumerate;
+    bool spread;
+    uint32_t poll;
+    uint32_t reading;
+    double drift;
+    uint32_t duration;
+    double alertRate;
+    bool alertLine;
+    bool combined;
+    bool pec;
+    uint32_t overhead;
+    uint32_t seed;
+};
+
+// ***
+// *** The master's view of one breakout.
+// ***
+struct Node
+{
+    SimBreakout* device;
+    DhtTinyClient client;
+    int64_t due;
+    uint32_t firstReadingId;
+    uint32_t lastReadingId;
+    int64_t seenAlert;
+    uint64_t missed;
+    std::vector<int64_t> latencies;
+};
+
+struct Results
+{
+    int64_t discovery;
+    uint64_t discoveryTransfers;
+    uint64_t found;
+    int64_t setup;
+    int64_t busy;
+    int64_t elapsed;
+    uint64_t transfers;
+    uint64_t polls;
+    uint64_t overruns;
+    uint64_t readings;
+    uint64_t samples;
+    uint64_t missed;
+    uint64_t alertsByLine;
+    uint64_t alertsByPoll;
+    std::vector<int64_t> latencies;
+    std::vector<int64_t> deviceP99;
+    std::vector<int64_t> alertLatencies;
+};
+
+static uint32_t _random;
+
+static double randomUnit()
+{
+    _random = _random * 1664525u + 1013904223u;
+    return (_random >> 8) / 16777216.0;
+}
+
+// ***
+// *** A serial number for each breakout that depends only on
+// *** the seed, so it does not change the other random values.
+// ***
+static uint32_t serialFor(uint32_t seed, uint32_t busIndex, uint32_t index)
+{
+    uint32_t x = seed * 0x9E3779B9u ^ busIndex * 0x85EBCA6Bu ^ (index + 1) * 0xC2B2AE35u;
+    x ^= x >> 16;
+    x *= 0x7FEB352Du;
+    x ^= x >> 15;
+    x *= 0x846CA68Bu;
+    x ^= x >> 16;
+    return x;
+}
+
+static int64_t percentile(std::vector<int64_t>& values, double fraction)
+{
+    if (values.empty()) return 0;
+    std::sort(values.begin(), values.end());
+    size_t index = (size_t)(fraction * (values.size() - 1) + 0.5);
+    return values[index];
+}
+
+static bool readBytes(Node& node, uint8_t registerId, uint8_t* buffer, uint8_t count)
+{
+    return node.client.readRegisters(registerId, buffer, count);
+}
+
+// ***
+// *** Records a new reading seen by the master.
+// ***
+static void recordSample(Node& node, uint32_t readingId, uint8_t status, int64_t now, Results& results)
+{
+    if (readingId == node.lastReadingId || readingId == 0) return;
+
+    // ***
+    // *** The first reading seen is where counting starts.
+    // ***
+    if (node.lastReadingId == 0)
+    {
+        node.firstReadingId = node.lastReadingId = readingId;
+        return;
+    }
+
+    if (readingId > node.lastReadingId + 1)
+    {
+        node.missed += readingId - node.lastReadingId - 1;
+    }
+
+    node.lastReadingId = readingId;
+    node.latencies.push_back(now - node.device->getCommitTime());
+    results.samples++;
+
+    if ((status & (1 << STATUS_UPPER_THRESHOLD_EXCEEDED)) && node.device->isAlerting() &&
+        node.seenAlert != node.device->getAlertTime())
+    {
+        node.seenAlert = node.device->getAlertTime();
+        results.alertLatencies.push_back(now - node.seenAlert);
+        results.alertsByPoll++;
+    }
+}
+
+static void pollNode(SimBus& bus, Node& node, Strategy strategy, Results& results)
+{
+    uint8_t buffer[32];
+
+    results.polls++;
+
+    if (strategy == STRATEGY_NAIVE)
+    {
+        // ***
+        // *** The reads displayData() in DHT_Uno_Master makes,
+        // *** one register at a time.
+        // ***
+        uint32_t readingId;
+        uint8_t status;
+        if (!readBytes(node, REGISTER_ID, buffer, SIZE_UINT8)) return;
+        if (!readBytes(node, REGISTER_TEMPERATURE, buffer, SIZE_FLOAT)) return;
+        if (!readBytes(node, REGISTER_HUMIDITY, buffer, SIZE_FLOAT)) return;
+        if (!readBytes(node, REGISTER_STATUS, &status, SIZE_UINT8)) return;
+        if (!readBytes(node, REGISTER_READING_ID, buffer, SIZE_UINT32)) return;
+        memcpy(&readingId, buffer, SIZE_UINT32);
+        if (!readBytes(node, REGISTER_INTERVAL, buffer, SIZE_UINT32)) return;
+        if (!readBytes(node, REGISTER_CONFIG, buffer, SIZE_UINT8)) return;
+        if (!readBytes(node, REGISTER_DHT_MODEL, buffer, SIZE_UINT8)) return;
+        recordSample(node, readingId, status, bus.getNow(), results);
+    }
+    else if (strategy == STRATEGY_BLOCK)
+    {
+        uint32_t readingId;
+        if (!readBytes(node, MEASUREMENT_BLOCK_START, buffer, BLOCK_OFFSET(MEASUREMENT_BLOCK_END))) return;
+        memcpy(&readingId, &buffer[BLOCK_OFFSET(REGISTER_READING_ID)], SIZE_UINT32);
+        recordSample(node, readingId, buffer[BLOCK_OFFSET(REGISTER_STATUS)], bus.getNow(), results);
+    }
+    else if (node.client.update() == DHTTINY_UPDATED)
+    {
+        recordSample(node, node.client.getReadingId(), node.client.getStatus(), bus.getNow(), results);
+    }
+}
+
+// ***
+// *** On a rising edge of the shared alert line the master reads
+// *** the status of every breakout to find the one alerting. A
+// *** breakout that starts alerting while the line is already
+// *** high causes no edge and is only found by polling.
+// ***
+static void scanAlerts(SimBus& bus, std::vector<Node>& nodes, Results& results)
+{
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        Node& node = nodes[i];
+        uint8_t status;
+        if (bus.readRegisters(node.device->getAddress(), REGISTER_STATUS, &status, SIZE_UINT8) &&
+            (status & (1 << STATUS_UPPER_THRESHOLD_EXCEEDED)) && node.seenAlert != node.device->getAlertTime())
+        {
+            node.seenAlert = node.device->getAlertTime();
+            results.alertLatencies.push_back(bus.getNow() - node.seenAlert);
+            results.alertsByLine++;
+        }
+    }
+}
+
+static void simulateBus(const Options& options, uint32_t busIndex, uint32_t deviceCount, Results& results)
+{
+    SimBus bus(options.speed * 1000, options.combined, options.alertRate, options.overhead * 1000LL);
+    I2cTransport transport(bus);
+
+    // ***
+    // *** The breakouts power up at random times before the
+    // *** master starts, each with its own clock error.
+    // ***
+    for (uint32_t i = 0; i < deviceCount; i++)
+    {
+        int64_t boot = -(int64_t)(randomUnit() * options.reading * MS);
+        double drift = 1.0 + (randomUnit() * 2.0 - 1.0) * options.drift / 100.0;
+        uint8_t address = options.enumerate ? DHTTINY_SETUP_ADDRESS : FIRST_ADDRESS + i;
+        bus.addDevice(new SimBreakout(address, serialFor(options.seed, busIndex, i), boot, options.reading, drift));
+    }
+
+    if (options.enumerate)
+    {
+        // ***
+        // *** Discovery: every breakout starts at the setup
+        // *** address and is given one of its own.
+        // ***
+        std::vector<uint8_t> addresses(deviceCount);
+        std::vector<uint32_t> serials(deviceCount);
+        DhtTinyDiscovery discovery(transport);
+        uint8_t found = discovery.findAll(&addresses[0], &serials[0], deviceCount);
+
+        for (uint8_t i = 0; i < found; i++)
+        {
+            if (addresses[i] != 0) results.found++;
+        }
+    }
+    else
+    {
+        // ***
+        // *** Discovery: read the id of every address, the way
+        // *** findFirstDhtTiny() and FindAllDhtTinyAsync() do.
+        // ***
+        for (uint8_t address = FIRST_ADDRESS; address <= LAST_ADDRESS; address++)
+        {
+            uint8_t id;
+            if (bus.readRegisters(address, REGISTER_ID, &id, SIZE_UINT8) && id == DHTTINY_ID) results.found++;
+        }
+    }
+    int64_t discovered = bus.getNow();
+    results.discovery += discovered;
+    results.discoveryTransfers += bus.getTransferCount();
+
+    std::vector<Node> nodes;
+    for (size_t i = 0; i < bus.getDevices().size(); i++)
+    {
+        SimBreakout* device = bus.getDevices()[i];
+        Node node = { device, DhtTinyClient(transport, device->getAddress()), 0, 0, 0, -1, 0, std::vector<int64_t>() };
+        if (options.strategy == STRATEGY_CACHED || options.pec) node.client.begin();
+        if (options.pec) node.client.setConfigBit(CONFIG_BIT_PEC_ENABLED, true);
+        nodes.push_back(node);
+    }
+
+    int64_t start = bus.getNow();
+    results.setup += start - discovered;
+
+    // ***
+    // *** Each breakout is polled once per poll interval, either
+    // *** all at once or spread evenly across the interval.
+    // ***
+    int64_t poll = options.poll * MS;
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        nodes[i].due = start + (options.spread ? poll * (int64_t)i / (int64_t)nodes.size() : 0);
+    }
+
+    int64_t end = start + options.duration * 1000LL * MS;
+    int64_t busyAtStart = bus.getBusyTime();
+    uint64_t transfersAtStart = bus.getTransferCount();
+    bool line = bus.isAlertAsserted();
+
+    while (true)
+    {
+        size_t next = 0;
+        for (size_t i = 1; i < nodes.size(); i++)
+        {
+            if (nodes[i].due < nodes[next].due) next = i;
+        }
+
+        int64_t due = std::max(nodes[next].due, bus.getNow());
+        if (due >= end) break;
+
+        // ***
+        // *** With the alert line wired, the master reacts to
+        // *** readings as they are taken; otherwise it only
+        // *** wakes to poll.
+        // ***
+        if (options.alertLine && bus.getNextReading() < due)
+        {
+            bus.idleUntil(bus.getNextReading());
+            bool asserted = bus.isAlertAsserted();
+            if (asserted && !line) scanAlerts(bus, nodes, results);
+            line = asserted;
+            continue;
+        }
+
+        bus.idleUntil(due);
+        pollNode(bus, nodes[next], options.strategy, results);
+
+        // ***
+        // *** A poll that could not keep up skips its missed
+        // *** turns rather than bursting them.
+        // ***
+        nodes[next].due += poll;
+        if (nodes[next].due <= bus.getNow())
+        {
+            int64_t behind = (bus.getNow() - nodes[next].due) / poll + 1;
+            results.overruns += behind;
+            nodes[next].due += behind * poll;
+        }
+    }
+
+    bus.idleUntil(end);
+    results.busy += bus.getBusyTime() - busyAtStart;
+    results.elapsed += end - start;
+    results.transfers += bus.getTransferCount() - transfersAtStart;
+
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        if (nodes[i].firstReadingId != 0)
+        {
+            results.readings += nodes[i].device->getReadingId() - nodes[i].firstReadingId;
+        }
+        results.missed += nodes[i].missed;
+        results.latencies.insert(results.latencies.end(), nodes[i].latencies.begin(), nodes[i].latencies.end());
+        results.deviceP99.push_back(percentile(nodes[i].latencies, 0.99));
+    }
+
+    printf("bus %-3u devices %-4u utilization %5.1f%%\n", busIndex, deviceCount,
+           100.0 * (bus.getBusyTime() - busyAtStart) / (end - start));
+}
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: DhtFleetSim [options]\n"
+            "  --devices <n>          breakouts in the fleet (112)\n"
+            "  --buses <n>            buses they are spread over (1)\n"
+            "  --speed <kHz>          bus speed, 100 or 400 (400)\n"
+            "  --strategy <name>      naive, block or cached (cached)\n"
+            "  --discovery <name>     sweep or enumerate (sweep)\n"
+            "  --schedule <name>      burst or spread (spread)\n"
+            "  --poll <ms>            poll interval (1000)\n"
+            "  --reading <ms>         breakout reading interval (2000)\n"
+            "  --drift <percent>      breakout clock error (1)\n"
+            "  --duration <s>         simulated time (600)\n"
+            "  --alert-rate <p>       chance a reading is over threshold (0)\n"
+            "  --alert-line           the master watches the shared interrupt line\n"
+            "  --split                stop between register write and read\n"
+            "  --pec                  enable PEC on every breakout and use it\n"
+            "  --overhead <us>        master time per transaction (0)\n"
+            "  --seed <n>             random seed (1)\n");
+}
+
+int main(int argc, char** argv)
+{
+    Options options = { 112, 1, 400, STRATEGY_CACHED, false, true, 1000, 2000, 1.0, 600, 0.0, false, true, false, 0, 1 };
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        const char* value = hasValue ? argv[i + 1] : "";
+
+        if (strcmp(argv[i], "--devices") == 0 && hasValue) options.devices = atoi(value), i++;
+        else if (strcmp(argv[i], "--buses") == 0 && hasValue) options.buses = atoi(value), i++;
+        else if (strcmp(argv[i], "--speed") == 0 && hasValue) options.speed = atoi(value), i++;
+        else if (strcmp(argv[i], "--poll") == 0 && hasValue) options.poll = atoi(value), i++;
+        else if (strcmp(argv[i], "--reading") == 0 && hasValue) options.reading = atoi(value), i++;
+        else if (strcmp(argv[i], "--drift") == 0 && hasValue) options.drift = atof(value), i++;
+        else if (strcmp(argv[i], "--duration") == 0 && hasValue) options.duration = atoi(value), i++;
+        else if (strcmp(argv[i], "--alert-rate") == 0 && hasValue) options.alertRate = atof(value), i++;
+        else if (strcmp(argv[i], "--overhead") == 0 && hasValue) options.overhead = atoi(value), i++;
+        else if (strcmp(argv[i], "--seed") == 0 && hasValue) options.seed = atoi(value), i++;
+        else if (strcmp(argv[i], "--alert-line") == 0) options.alertLine = true;
+        else if (strcmp(argv[i], "--split") == 0) options.combined = false;
+        else if (strcmp(argv[i], "--pec") == 0) options.pec = true;
+        else if (strcmp(argv[i], "--strategy") == 0 && hasValue)
+        {
+            if (strcmp(value, "naive") == 0) options.strategy = STRATEGY_NAIVE;
+            else if (strcmp(value, "block") == 0) options.strategy = STRATEGY_BLOCK;
+            else if (strcmp(value, "cached") == 0) options.strategy = STRATEGY_CACHED;
+            else { usage(); return 1; }
+            i++;
+        }
+        else if (strcmp(argv[i], "--discovery") == 0 && hasValue)
+        {
+            if (strcmp(value, "sweep") == 0) options.enumerate = false;
+            else if (strcmp(value, "enumerate") == 0) options.enumerate = true;
+            else { usage(); return 1; }
+            i++;
+        }
+        else if (strcmp(argv[i], "--schedule") == 0 && hasValue)
+        {
+            if (strcmp(value, "burst") == 0) options.spread = false;
+            else if (strcmp(value, "spread") == 0) options.spread = true;
+            else { usage(); return 1; }
+            i++;
+        }
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    // ***
+    // *** Enumeration never assigns the setup address.
+    // ***
+    uint32_t perBus = options.buses ? (options.devices + options.buses - 1) / options.buses : 0;
+    uint32_t capacity = LAST_ADDRESS - FIRST_ADDRESS + (options.enumerate ? 0 : 1);
+    if (options.buses == 0 || options.devices == 0 || perBus > capacity ||
+        options.speed == 0 || options.poll == 0 || options.reading == 0)
+    {
+        fprintf(stderr, "a bus holds at most %u breakouts\n", capacity);
+        usage();
+        return 1;
+    }
+
+    _random = options.seed;
+
+    Results results;
+    results.discovery = results.setup = results.busy = results.elapsed = 0;
+    results.discoveryTransfers = results.found = 0;
+    results.transfers = results.polls = results.overruns = results.readings = results.samples = results.missed = 0;
+    results.alertsByLine = results.alertsByPoll = 0;
+
+    uint32_t remaining = options.devices;
+    for (uint32_t i = 0; i < options.buses; i++)
+    {
+        uint32_t count = std::min(perBus, remaining);
+        simulateBus(options, i, count, results);
+        remaining -= count;
+    }
+
+    double ms = 1.0 / MS;
+    printf("\n");
+    printf("discovery      %.1f ms per bus, %llu transactions, %llu of %u breakouts found\n",
+           results.discovery * ms / options.buses, (unsigned long long)results.discoveryTransfers,
+           (unsigned long long)results.found, options.devices);
+    printf("setup          %.1f ms per bus\n", results.setup * ms / options.buses);
+    printf("utilization    %.1f%% (mean of buses)\n", 100.0 * results.busy / results.elapsed);
+    printf("transactions   %llu (%.2f per poll)\n", (unsigned long long)results.transfers,
+           results.polls ? (double)results.transfers / results.polls : 0.0);
+    printf("polls          %llu (%llu skipped)\n", (unsigned long long)results.polls, (unsigned long long)results.overruns);
+    printf("readings       %llu taken, %llu seen, %llu missed (%.2f%%)\n", (unsigned long long)results.readings,
+           (unsigned long long)results.samples, (unsigned long long)results.missed,
+           results.readings ? 100.0 * results.missed / results.readings : 0.0);
+    printf("latency        p50 %.1f  p90 %.1f  p99 %.1f  max %.1f ms\n",
+           percentile(results.latencies, 0.50) * ms, percentile(results.latencies, 0.90) * ms,
+           percentile(results.latencies, 0.99) * ms, percentile(results.latencies, 1.0) * ms);
+    printf("device p99     median %.1f  worst %.1f ms\n",
+           percentile(results.deviceP99, 0.50) * ms, percentile(results.deviceP99, 1.0) * ms);
+
+    if (options.alertRate > 0)
+    {
+        printf("alerts         %llu by line, %llu by poll, latency p50 %.1f  p99 %.1f  max %.1f ms\n",
+               (unsigned long long)results.alertsByLine, (unsigned long long)results.alertsByPoll,
+               percentile(results.alertLatencies, 0.50) * ms, percentile(results.alertLatencies, 0.99) * ms,
+               percentile(results.alertLatencies, 1.0) * ms);
+    }
+
+    return 0;
+}
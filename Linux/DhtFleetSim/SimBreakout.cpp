@@ -0,0 +1,329 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include "SimBreakout.h"
+
+#include <string.h>
+
+// ***
+// *** The firmware's register tables. Register_Defs.h defines the
+// *** same register macros as DhtTinyRegisters.h; if the two ever
+// *** drift apart the compiler reports the redefinition.
+// ***
+#include "Register_Defs.h"
+#include "DhtTinyDiscovery.h"
+#include "DhtTinyPec.h"
+
+// ***
+// *** The states of Enumeration.h.
+// ***
+#define ENUM_STATE_IDLE       0
+#define ENUM_STATE_ACTIVE     1
+#define ENUM_STATE_ASSIGNED   2
+
+SimBreakout::SimBreakout(uint8_t address, uint32_t serial, int64_t boot, uint32_t interval, double drift)
+    : _address(address), _serial(serial), _enumerationState(ENUM_STATE_IDLE), _enumerationAddress(0), _boot(boot), _drift(drift), _readingId(0), _commitTime(0), _alertTime(0),
+      _alerting(false), _random(address * 2654435761u), _position(0), _requestCount(0),
+      _requestHasPec(false), _requestPec(0)
+{
+    memset(_registers, 0, sizeof(_registers));
+
+    // ***
+    // *** The defaults written by setup().
+    // ***
+    float upper = 26.0, lower = 21.0;
+    uint32_t startDelay = 1000;
+    _registers[REGISTER_ID] = 0x2D;
+    _registers[REGISTER_VER_MAJOR] = 1;
+    _registers[REGISTER_VER_MINOR] = 2;
+    _registers[REGISTER_CONFIG] = (1 << CONFIG_BIT_SENSOR_ENABLED) | (1 << CONFIG_BIT_THRESHOLD_ENABLED);
+    _registers[REGISTER_DEVICE_ADDRESS] = address;
+    _registers[REGISTER_DHT_MODEL] = 22;
+    memcpy(&_registers[REGISTER_SERIAL], &serial, SIZE_UINT32);
+    memcpy(&_registers[REGISTER_INTERVAL], &interval, SIZE_UINT32);
+    memcpy(&_registers[REGISTER_CURRENT_INTERVAL], &interval, SIZE_UINT32);
+    memcpy(&_registers[REGISTER_UPPER_THRESHOLD], &upper, SIZE_FLOAT);
+    memcpy(&_registers[REGISTER_LOWER_THRESHOLD], &lower, SIZE_FLOAT);
+    memcpy(&_registers[REGISTER_START_DELAY], &startDelay, SIZE_UINT32);
+    setStatusBit(STATUS_SENSOR_IS_ENABLED, true);
+
+    // ***
+    // *** The first reading follows the start delay on the
+    // *** breakout's own clock.
+    // ***
+    _nextReading = _boot + (int64_t)(startDelay * 1000000.0 / _drift);
+}
+
+void SimBreakout::receive(const uint8_t* buffer, uint8_t count, int64_t now)
+{
+    if (count == 0)
+    {
+        setStatusBit(STATUS_READ_ERROR, true);
+        setStatusBit(STATUS_WRITE_ERROR, false);
+        return;
+    }
+
+    // ***
+    // *** A PEC read is [PEC_READ_COMMAND, register, count].
+    // ***
+    bool pecEnabled = _registers[REGISTER_CONFIG] & (1 << CONFIG_BIT_PEC_ENABLED);
+    bool pecRead = pecEnabled && count == 3 && buffer[0] == PEC_READ_COMMAND;
+
+    uint8_t position = pecRead ? buffer[1] : buffer[0];
+    if (!isStartable(position))
+    {
+        setStatusBit(STATUS_READ_ERROR, count == 1 || pecRead);
+        setStatusBit(STATUS_WRITE_ERROR, count > 1 && !pecRead);
+        return;
+    }
+
+    _position = position;
+
+    // ***
+    // *** isPecRequired() and isPecDisableWrite() in Pec.h.
+    // ***
+    bool pecRequired = pecEnabled && (_position < REGISTER_ENUM_CONTROL || _position > REGISTER_ENUM_ASSIGN);
+    bool pecDisable = count == 2 && _position == REGISTER_CONFIG &&
+                      buffer[1] == (uint8_t)(_registers[REGISTER_CONFIG] & ~(1 << CONFIG_BIT_PEC_ENABLED));
+
+    if (!pecRead && count > 1)
+    {
+        uint8_t writeCount = count - 1;
+        bool pecValid = true;
+
+        if (pecRequired && !pecDisable)
+        {
+            writeCount--;
+            uint8_t pec = DhtTinyPec::update(DHTTINY_PEC_INITIAL, DhtTinyPec::writeAddress(_address));
+            pecValid = count > 2 && DhtTinyPec::update(pec, buffer, count - 1) == buffer[count - 1];
+            setStatusBit(STATUS_PEC_ERROR, !pecValid);
+        }
+
+        if (pecValid && writeCount == pgm_read_byte(&_registerSize[_position]) && isWriteable(_position))
+        {
+            if (!handleEnumerationWrite(_position, buffer[1]))
+            {
+                for (uint8_t i = 1; i <= writeCount; i++)
+                {
+                    _registers[_position] = buffer[i];
+                    _position = (_position + 1) % (REGISTER_TOTAL_SIZE);
+                }
+            }
+            setStatusBit(STATUS_WRITE_ERROR, false);
+        }
+        else
+        {
+            setStatusBit(STATUS_WRITE_ERROR, true);
+        }
+
+        _requestCount = 0;
+        setStatusBit(STATUS_READ_ERROR, false);
+        return;
+    }
+
+    // ***
+    // *** Reads within a block stream to the end of the block.
+    // ***
+    if (_position >= MEASUREMENT_BLOCK_START && _position < MEASUREMENT_BLOCK_END)
+    {
+        uint32_t readingTime, age;
+        memcpy(&readingTime, &_registers[REGISTER_READING_TIME], SIZE_UINT32);
+        age = _readingId == 0 ? READING_AGE_NONE : millis(now) - readingTime;
+        memcpy(&_registers[REGISTER_READING_AGE], &age, SIZE_UINT32);
+        _requestCount = MEASUREMENT_BLOCK_END - _position;
+    }
+    else if (_position >= AGGREGATE_BLOCK_START && _position < AGGREGATE_BLOCK_END)
+    {
+        _requestCount = AGGREGATE_BLOCK_END - _position;
+    }
+    else if (_position >= CAPTURE_BLOCK_START && _position < CAPTURE_BLOCK_END)
+    {
+        _requestCount = CAPTURE_BLOCK_END - _position;
+    }
+    else if (_position == REGISTER_ENUM_CONTROL)
+    {
+        _requestCount = ENUM_BITMAP_SIZE;
+    }
+    else
+    {
+        _requestCount = pgm_read_byte(&_registerSize[_position]);
+    }
+
+    _requestHasPec = pecRead;
+    if (_requestHasPec)
+    {
+        if (buffer[2] < _requestCount) _requestCount = buffer[2];
+        _requestPec = DhtTinyPec::update(DHTTINY_PEC_INITIAL, DhtTinyPec::writeAddress(_address));
+        _requestPec = DhtTinyPec::update(_requestPec, buffer, 3);
+        _requestPec = DhtTinyPec::update(_requestPec, DhtTinyPec::readAddress(_address));
+        _requestCount++;
+    }
+
+    setStatusBit(STATUS_READ_ERROR, false);
+    setStatusBit(STATUS_WRITE_ERROR, false);
+}
+
+uint8_t SimBreakout::request()
+{
+    if (_requestCount == 0) return 0xFF;
+
+    // ***
+    // *** A breakout that is not selected during an enumeration
+    // *** sends 0xFF, which leaves SDA to the selected ones.
+    // ***
+    bool selected = isEnumerationSelected();
+    if ((_enumerationState == ENUM_STATE_ACTIVE && !selected) || _enumerationState == ENUM_STATE_ASSIGNED)
+    {
+        _requestCount--;
+        return 0xFF;
+    }
+
+    if (_position == REGISTER_ENUM_CONTROL)
+    {
+        uint8_t index = ENUM_BITMAP_SIZE - _requestCount--;
+        uint8_t depth = _registers[REGISTER_ENUM_SELECT];
+        uint8_t next = depth < SIZE_UINT32 ? _registers[REGISTER_SERIAL + depth] : 0;
+        return (depth < SIZE_UINT32 && selected && (next >> 3) == index) ? (uint8_t)~(1 << (next & 7)) : 0xFF;
+    }
+
+    if (_requestHasPec && _requestCount == 1)
+    {
+        _requestCount--;
+        return _requestPec;
+    }
+
+    uint8_t value = _registers[_position];
+    _position = (_position + 1) % (REGISTER_TOTAL_SIZE);
+    _requestCount--;
+    _requestPec = DhtTinyPec::update(_requestPec, value);
+    return value;
+}
+
+void SimBreakout::applyAddress()
+{
+    if (_enumerationAddress == 0) return;
+
+    _address = _enumerationAddress;
+    _enumerationAddress = 0;
+    if (_enumerationState == ENUM_STATE_ASSIGNED) _enumerationState = ENUM_STATE_IDLE;
+}
+
+uint32_t SimBreakout::advance(int64_t now, double alertRate)
+{
+    uint32_t taken = 0;
+
+    while (_nextReading <= now)
+    {
+        // ***
+        // *** A small linear congruential generator keeps each
+        // *** breakout's readings repeatable for a given seed.
+        // ***
+        _random = _random * 1664525u + 1013904223u;
+        bool alert = (_random >> 8) / 16777216.0 < alertRate;
+
+        _random = _random * 1664525u + 1013904223u;
+        float temperature = alert ? 27.0 : 22.0 + (_random >> 8) / 16777216.0 * 3.0;
+        float humidity = 40.0 + (_random & 0xFF) / 25.6;
+
+        _readingId++;
+        uint32_t readingTime = millis(_nextReading);
+        uint32_t age = 0;
+        memcpy(&_registers[REGISTER_TEMPERATURE], &temperature, SIZE_FLOAT);
+        memcpy(&_registers[REGISTER_HUMIDITY], &humidity, SIZE_FLOAT);
+        memcpy(&_registers[REGISTER_READING_ID], &_readingId, SIZE_UINT32);
+        memcpy(&_registers[REGISTER_READING_TIME], &readingTime, SIZE_UINT32);
+        memcpy(&_registers[REGISTER_READING_AGE], &age, SIZE_UINT32);
+
+        // ***
+        // *** checkThresholds() raises the interrupt pin while the
+        // *** temperature is outside the thresholds.
+        // ***
+        setStatusBit(STATUS_UPPER_THRESHOLD_EXCEEDED, alert);
+        if (alert && !_alerting) _alertTime = _nextReading;
+        _alerting = alert;
+        _commitTime = _nextReading;
+
+        uint32_t interval;
+        memcpy(&interval, &_registers[REGISTER_INTERVAL], SIZE_UINT32);
+        _nextReading += (int64_t)(interval * 1000000.0 / _drift);
+        taken++;
+    }
+
+    return taken;
+}
+
+uint32_t SimBreakout::millis(int64_t now) const
+{
+    return (uint32_t)((now - _boot) * _drift / 1000000.0);
+}
+
+bool SimBreakout::isStartable(uint8_t position) const
+{
+    if (position >= REGISTER_TOTAL_SIZE) return false;
+    uint8_t protection = pgm_read_byte(&_registerProtection[position]);
+    return protection == 0 || protection == 2;
+}
+
+bool SimBreakout::isWriteable(uint8_t position) const
+{
+    return position < REGISTER_TOTAL_SIZE && pgm_read_byte(&_registerProtection[position]) == 0;
+}
+
+bool SimBreakout::handleEnumerationWrite(uint8_t position, uint8_t value)
+{
+    if (position == REGISTER_ENUM_CONTROL)
+    {
+        if (value == ENUM_START_ALL || (value == ENUM_START && _registers[REGISTER_DEVICE_ADDRESS] == DHTTINY_SETUP_ADDRESS))
+        {
+            _registers[REGISTER_ENUM_SELECT] = 0;
+            _enumerationState = ENUM_STATE_ACTIVE;
+            _enumerationAddress = DHTTINY_SETUP_ADDRESS;
+        }
+        else if (value == ENUM_END && _enumerationState == ENUM_STATE_ACTIVE)
+        {
+            _enumerationState = ENUM_STATE_IDLE;
+            _enumerationAddress = _registers[REGISTER_DEVICE_ADDRESS];
+        }
+        return true;
+    }
+
+    if (position == REGISTER_ENUM_ASSIGN)
+    {
+        if (_registers[REGISTER_ENUM_SELECT] == SIZE_UINT32 && isEnumerationSelected())
+        {
+            _registers[REGISTER_DEVICE_ADDRESS] = value;
+            _enumerationState = ENUM_STATE_ASSIGNED;
+            _enumerationAddress = value;
+        }
+        return true;
+    }
+
+    return false;
+}
+
+bool SimBreakout::isEnumerationSelected() const
+{
+    uint8_t depth = _registers[REGISTER_ENUM_SELECT];
+    if (_enumerationState != ENUM_STATE_ACTIVE || depth > SIZE_UINT32) return false;
+    return memcmp(&_registers[REGISTER_SERIAL], &_registers[REGISTER_ENUM_SELECT + 1], depth) == 0;
+}
+
+void SimBreakout::setStatusBit(uint8_t bit, bool value)
+{
+    _registers[REGISTER_STATUS] = value ? _registers[REGISTER_STATUS] | (1 << bit) : _registers[REGISTER_STATUS] & ~(1 << bit);
+}
@@ -0,0 +1,99 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef SIM_BREAKOUT_H
+#define SIM_BREAKOUT_H
+
+#include <stdint.h>
+#include "DhtTinyRegisters.h"
+
+// ***
+// *** One simulated DHT Tiny Breakout. The register handling
+// *** follows receiveEvent() and requestEvent() in the firmware
+// *** and uses the firmware's own size and protection tables.
+// *** Time is simulated time in nanoseconds.
+// ***
+class SimBreakout
+{
+public:
+    SimBreakout(uint8_t address, uint32_t serial, int64_t boot, uint32_t interval, double drift);
+
+    uint8_t getAddress() const { return _address; };
+    uint32_t getSerial() const { return _serial; };
+
+    // ***
+    // *** A write transaction from the master (the register id
+    // *** followed by any data), as seen by receiveEvent(). With
+    // *** PEC enabled it is framed as described in DhtTinyPec.h.
+    // ***
+    void receive(const uint8_t* buffer, uint8_t count, int64_t now);
+
+    // ***
+    // *** The next byte of a read transaction, as sent by
+    // *** requestEvent(). A master that reads past the prepared
+    // *** bytes gets 0xFF, an idle bus.
+    // ***
+    uint8_t request();
+
+    // ***
+    // *** The address change made by loop() after an
+    // *** enumeration command.
+    // ***
+    void applyAddress();
+
+    // ***
+    // *** Takes the readings due at or before now. Returns the
+    // *** number of readings taken.
+    // ***
+    uint32_t advance(int64_t now, double alertRate);
+    int64_t getNextReading() const { return _nextReading; };
+
+    uint32_t getReadingId() const { return _readingId; };
+    int64_t getCommitTime() const { return _commitTime; };
+    int64_t getAlertTime() const { return _alertTime; };
+    bool isAlerting() const { return _alerting; };
+
+private:
+    uint32_t millis(int64_t now) const;
+    bool isStartable(uint8_t position) const;
+    bool isWriteable(uint8_t position) const;
+    bool handleEnumerationWrite(uint8_t position, uint8_t value);
+    bool isEnumerationSelected() const;
+    void setStatusBit(uint8_t bit, bool value);
+
+    uint8_t _address;
+    uint32_t _serial;
+    uint8_t _enumerationState;
+    uint8_t _enumerationAddress;
+    int64_t _boot;
+    double _drift;
+    int64_t _nextReading;
+    uint32_t _readingId;
+    int64_t _commitTime;
+    int64_t _alertTime;
+    bool _alerting;
+    uint32_t _random;
+
+    uint8_t _registers[REGISTER_TOTAL_SIZE];
+    uint8_t _position;
+    uint8_t _requestCount;
+    bool _requestHasPec;
+    uint8_t _requestPec;
+};
+
+#endif
@@ -0,0 +1,164 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#include "SimBus.h"
+
+#include <stddef.h>
+
+#define BYTE_BITS   9
+
+SimBus::SimBus(uint32_t speed, bool combined, double alertRate, int64_t masterOverhead)
+    : _bitTime(1000000000LL / speed), _combined(combined), _alertRate(alertRate),
+      _masterOverhead(masterOverhead), _now(0), _busy(0)
+{
+}
+
+SimBus::~SimBus()
+{
+    for (size_t i = 0; i < _devices.size(); i++)
+    {
+        delete _devices[i];
+    }
+}
+
+bool SimBus::readRegisters(uint8_t address, uint8_t registerId, uint8_t* buffer, uint16_t count)
+{
+    return readCommand(address, &registerId, 1, buffer, count);
+}
+
+bool SimBus::readCommand(uint8_t address, const uint8_t* command, uint16_t commandCount, uint8_t* buffer, uint16_t count)
+{
+    _transfers++;
+    _now += _masterOverhead;
+    advanceDevices();
+
+    // ***
+    // *** Start and address. A missing device does not
+    // *** acknowledge and the master stops.
+    // ***
+    std::vector<SimBreakout*> devices;
+    findDevices(address, devices);
+    occupy(1 + BYTE_BITS);
+    if (devices.empty())
+    {
+        occupy(1);
+        return false;
+    }
+
+    // ***
+    // *** The command, then a repeated start or a stop and
+    // *** a new start, the address and the data.
+    // ***
+    occupy(commandCount * BYTE_BITS + (_combined ? 1 : 2) + BYTE_BITS + count * BYTE_BITS + 1);
+    for (size_t j = 0; j < devices.size(); j++)
+    {
+        devices[j]->receive(command, commandCount, _now);
+    }
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        buffer[i] = 0xFF;
+        for (size_t j = 0; j < devices.size(); j++)
+        {
+            buffer[i] &= devices[j]->request();
+        }
+    }
+
+    return true;
+}
+
+bool SimBus::writeRegisters(uint8_t address, uint8_t registerId, const uint8_t* buffer, uint16_t count)
+{
+    _transfers++;
+    _now += _masterOverhead;
+    advanceDevices();
+
+    std::vector<SimBreakout*> devices;
+    findDevices(address, devices);
+    occupy(1 + BYTE_BITS);
+    if (devices.empty())
+    {
+        occupy(1);
+        return false;
+    }
+
+    occupy((1 + count) * BYTE_BITS + 1);
+
+    uint8_t message[1 + 255];
+    message[0] = registerId;
+    for (uint16_t i = 0; i < count && i < 255; i++)
+    {
+        message[1 + i] = buffer[i];
+    }
+    for (size_t j = 0; j < devices.size(); j++)
+    {
+        devices[j]->receive(message, count + 1, _now);
+    }
+
+    return true;
+}
+
+void SimBus::idleUntil(int64_t time)
+{
+    if (time > _now) _now = time;
+    advanceDevices();
+}
+
+int64_t SimBus::getNextReading() const
+{
+    int64_t next = INT64_MAX;
+    for (size_t i = 0; i < _devices.size(); i++)
+    {
+        if (_devices[i]->getNextReading() < next) next = _devices[i]->getNextReading();
+    }
+
+    return next;
+}
+
+bool SimBus::isAlertAsserted() const
+{
+    for (size_t i = 0; i < _devices.size(); i++)
+    {
+        if (_devices[i]->isAlerting()) return true;
+    }
+
+    return false;
+}
+
+void SimBus::findDevices(uint8_t address, std::vector<SimBreakout*>& devices) const
+{
+    for (size_t i = 0; i < _devices.size(); i++)
+    {
+        if (address == 0 || _devices[i]->getAddress() == address) devices.push_back(_devices[i]);
+    }
+}
+
+void SimBus::occupy(uint32_t bits)
+{
+    _now += bits * _bitTime;
+    _busy += bits * _bitTime;
+}
+
+void SimBus::advanceDevices()
+{
+    for (size_t i = 0; i < _devices.size(); i++)
+    {
+        _devices[i]->applyAddress();
+        _devices[i]->advance(_now, _alertRate);
+    }
+}
@@ -0,0 +1,86 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+#ifndef SIM_BUS_H
+#define SIM_BUS_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "I2cAdapter.h"
+#include "SimBreakout.h"
+
+// ***
+// *** A simulated I2C bus with breakouts on it. Transactions take
+// *** the time of their bits at the bus speed: a start, nine bits
+// *** for each byte (eight plus the acknowledge) and a stop. A
+// *** register read either uses a repeated start or, split, a stop
+// *** and a new start. Simulated time only moves when the master
+// *** uses the bus or waits.
+// ***
+// *** Breakouts sharing an address all take part in a transaction;
+// *** SDA is a wired AND so the master reads the AND of the bytes
+// *** they send. A write to address 0 is a general call.
+// ***
+class SimBus : public I2cAdapter
+{
+public:
+    SimBus(uint32_t speed, bool combined, double alertRate, int64_t masterOverhead);
+    ~SimBus();
+
+    void addDevice(SimBreakout* device) { _devices.push_back(device); };
+    const std::vector<SimBreakout*>& getDevices() const { return _devices; };
+
+    virtual bool readRegisters(uint8_t address, uint8_t registerId, uint8_t* buffer, uint16_t count);
+    virtual bool writeRegisters(uint8_t address, uint8_t registerId, const uint8_t* buffer, uint16_t count);
+    virtual bool readCommand(uint8_t address, const uint8_t* command, uint16_t commandCount, uint8_t* buffer, uint16_t count);
+    virtual void wait(uint32_t milliseconds) { idleUntil(_now + milliseconds * 1000000LL); };
+
+    // ***
+    // *** The master waits until the given time.
+    // ***
+    void idleUntil(int64_t time);
+
+    // ***
+    // *** The time the next breakout takes a reading.
+    // ***
+    int64_t getNextReading() const;
+
+    // ***
+    // *** The interrupt pins of the breakouts wired together.
+    // ***
+    bool isAlertAsserted() const;
+
+    int64_t getNow() const { return _now; };
+    int64_t getBusyTime() const { return _busy; };
+
+private:
+    void findDevices(uint8_t address, std::vector<SimBreakout*>& devices) const;
+    void occupy(uint32_t bits);
+    void advanceDevices();
+
+    int64_t _bitTime;
+    bool _combined;
+    double _alertRate;
+    int64_t _masterOverhead;
+    int64_t _now;
+    int64_t _busy;
+    std::vector<SimBreakout*> _devices;
+};
+
+#endif
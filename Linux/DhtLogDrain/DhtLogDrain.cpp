@@ -0,0 +1,234 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+// ***
+// *** Collects the readings a DHT Tiny Breakout built with
+// *** DHT_SPILL_LOG kept while nothing was reading it, and prints
+// *** them as CSV: the time, the uptime of the breakout, the
+// *** channel, the temperature and the humidity.
+// ***
+// ***   DhtLogDrain --bus /dev/i2c-1 --address 0x26 [--keep]
+// ***   DhtLogDrain --bus /dev/i2c-1 --address 0x26 --decimation <n> [--channel <c>]
+// ***   DhtLogDrain --bus /dev/i2c-1 --address 0x26 --clear
+// ***
+// *** The log keeps the uptime in seconds. Readings from since the
+// *** breakout last started are placed on the host clock from its
+// *** uptime now; the others are printed without a time. The
+// *** blocks are erased once they were all read unless --keep is
+// *** given. --decimation logs every n'th missed reading of the
+// *** channel (0 turns the log off) and saves the configuration.
+// ***
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "DhtTinyClient.h"
+#include "DhtTinyLog.h"
+#include "I2cBus.h"
+#include "I2cTransport.h"
+
+#define DRAIN_PENDING_RETRIES   50
+#define DRAIN_PENDING_WAIT_NS   10000000
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: DhtLogDrain --bus <device> --address <address> [options]\n"
+            "options:\n"
+            "  --keep                   do not erase the blocks that were read\n"
+            "  --clear                  erase the log without reading it\n"
+            "  --decimation <n>         log every n'th missed reading (0 = off)\n"
+            "  --channel <c>            channel the decimation is for (0)\n");
+}
+
+static void print(const DhtTinyLogRecord& record, bool earlier, time_t now, uint32_t uptime)
+{
+    if (earlier || record.time > uptime)
+    {
+        printf("-,");
+    }
+    else
+    {
+        char text[32];
+        time_t when = now - (uptime - record.time);
+        strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", localtime(&when));
+        printf("%s,", text);
+    }
+
+    printf("%u,%u,%.1f,%.1f\n", record.time, record.channel, record.temperature / 10.0, record.humidity / 10.0);
+}
+
+int main(int argc, char** argv)
+{
+    const char* busName = NULL;
+    int address = 0;
+    int decimation = -1;
+    int channel = 0;
+    bool keep = false;
+    bool clear = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--bus") == 0 && hasValue) busName = argv[++i];
+        else if (strcmp(argv[i], "--address") == 0 && hasValue) address = strtol(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--decimation") == 0 && hasValue) decimation = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--channel") == 0 && hasValue) channel = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--keep") == 0) keep = true;
+        else if (strcmp(argv[i], "--clear") == 0) clear = true;
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    if (busName == NULL || address < 0x08 || address > 0x77 || decimation > UINT8_MAX)
+    {
+        usage();
+        return 1;
+    }
+
+    I2cBus bus;
+    if (!bus.open(busName))
+    {
+        perror(busName);
+        return 1;
+    }
+
+    I2cTransport transport(bus);
+    DhtTinyClient client(transport, address);
+    if (!client.begin())
+    {
+        fprintf(stderr, "%s:0x%02X: no breakout\n", busName, address);
+        return 1;
+    }
+
+    if (decimation >= 0)
+    {
+        if (!client.selectChannel(channel) || !client.refresh() || !client.setLogDecimation(decimation) ||
+            !client.setConfigBit(CONFIG_BIT_WRITE_CONFIG, true))
+        {
+            fprintf(stderr, "failed to set the decimation\n");
+            return 1;
+        }
+
+        return 0;
+    }
+
+    if (clear)
+    {
+        return client.clearLog() ? 0 : 1;
+    }
+
+    // ***
+    // *** The uptime of the breakout is the time of its last
+    // *** reading plus the age of it. Without a reading there
+    // *** is no age, and nothing in the log is from this boot.
+    // ***
+    if (client.update() == DHTTINY_ERROR)
+    {
+        fprintf(stderr, "failed to read the breakout\n");
+        return 1;
+    }
+
+    time_t now = time(NULL);
+    uint32_t uptime = 0;
+    if (client.getReadingAge() != READING_AGE_NONE)
+    {
+        uptime = (client.getReadingTime() + client.getReadingAge()) / 1000;
+    }
+
+    // ***
+    // *** Start from the oldest block in case an earlier run
+    // *** stopped part way through.
+    // ***
+    if (!client.rewindLog())
+    {
+        fprintf(stderr, "failed to rewind the log\n");
+        return 1;
+    }
+
+    printf("time,uptime,channel,temperature,humidity\n");
+
+    uint8_t left = 1;
+    uint8_t pending = 0;
+    uint32_t dropped = 0;
+    while (left > 0)
+    {
+        uint8_t buffer[LOG_DRAIN_SIZE];
+        if (!client.drainLog(buffer))
+        {
+            fprintf(stderr, "drain failed\n");
+            return 1;
+        }
+
+        if (!(buffer[0] & LOG_ENABLED))
+        {
+            fprintf(stderr, "spill log not enabled\n");
+            return 1;
+        }
+
+        // ***
+        // *** The breakout copies each block out of its EEPROM
+        // *** in its loop; give it a moment and read again.
+        // ***
+        if (buffer[0] & LOG_BLOCK_PENDING)
+        {
+            if (++pending > DRAIN_PENDING_RETRIES)
+            {
+                fprintf(stderr, "the breakout did not get the next block ready\n");
+                return 1;
+            }
+
+            struct timespec wait = { 0, DRAIN_PENDING_WAIT_NS };
+            nanosleep(&wait, NULL);
+            continue;
+        }
+
+        pending = 0;
+        if (!(buffer[0] & LOG_BLOCK_VALID))
+        {
+            break;
+        }
+
+        left = buffer[1];
+        dropped = buffer[2];
+
+        DhtTinyLogRecord records[DHTTINY_LOG_RECORDS];
+        int8_t count = DhtTinyLog::decode(buffer, records);
+        if (count < 0)
+        {
+            fprintf(stderr, "skipped a block that could not be decoded\n");
+        }
+
+        for (int8_t i = 0; i < count; i++)
+        {
+            print(records[i], buffer[0] & LOG_EARLIER_BOOT, now, uptime);
+        }
+    }
+
+    if (dropped > 0)
+    {
+        fprintf(stderr, "%u block(s) dropped because the log was full\n", dropped);
+    }
+
+    fflush(stdout);
+    return keep || client.ackLog() ? 0 : 1;
+}
@@ -0,0 +1,155 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+
+// ***
+// *** Reads the shared memory table published by DhtCollector
+// *** --shm. Nothing here opens the bus or takes a lock; each
+// *** reading is copied straight out of the mapped table.
+// ***
+// ***   DhtShmRead /dhttiny
+// ***   DhtShmRead /dhttiny --watch 1000
+// ***   DhtShmRead /dhttiny --bench 5
+// ***
+// *** --bench reads every slot in a loop for the given number of
+// *** seconds and reports the cost of one read and how often a
+// *** copy overlapped an update and had to be taken again.
+// ***
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <chrono>
+
+#include "DhtShmTable.h"
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: DhtShmRead <name> [options]\n"
+            "options:\n"
+            "  --watch <ms>     print the table again this often\n"
+            "  --bench <s>      time reads for this long\n");
+}
+
+static void printTable(const DhtShmTable& table)
+{
+    DhtShmReading reading;
+    uint32_t used = table.getSlotsUsed();
+
+    for (uint32_t i = 0; i < used; i++)
+    {
+        if (table.read(i, reading))
+        {
+            printf("%llu %s 0x%02X %u %.1f %.1f %u\n", (unsigned long long)reading.time, reading.bus, reading.address,
+                   reading.readingId, reading.temperature, reading.humidity, reading.age);
+        }
+    }
+
+    fflush(stdout);
+}
+
+static void benchmark(const DhtShmTable& table, uint32_t seconds)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    DhtShmReading reading;
+    uint64_t reads = 0;
+    uint32_t retries = 0;
+    uint32_t checksum = 0;
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point end = start + std::chrono::seconds(seconds);
+    Clock::time_point now = start;
+
+    // ***
+    // *** The clock is only checked once per pass over the table
+    // *** so it adds little to the time of a read.
+    // ***
+    while (now < end)
+    {
+        for (uint32_t pass = 0; pass < 1000; pass++)
+        {
+            uint32_t used = table.getSlotsUsed();
+            for (uint32_t i = 0; i < used; i++)
+            {
+                table.read(i, reading, &retries);
+                checksum += reading.readingId;
+                reads++;
+            }
+        }
+
+        now = Clock::now();
+    }
+
+    double elapsed = std::chrono::duration<double>(now - start).count();
+    printf("slots      %u of %u\n", table.getSlotsUsed(), table.getSlotCount());
+    printf("reads      %llu (%.1f M/s)\n", (unsigned long long)reads, reads / elapsed / 1e6);
+    printf("per read   %.1f ns\n", reads ? elapsed * 1e9 / reads : 0.0);
+    printf("retries    %u (%.4f%%)\n", retries, reads ? 100.0 * retries / reads : 0.0);
+    printf("checksum   %u\n", checksum);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argv[1][0] == '-')
+    {
+        usage();
+        return 1;
+    }
+
+    const char* name = argv[1];
+    uint32_t watch = 0;
+    uint32_t bench = 0;
+
+    for (int i = 2; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--watch") == 0 && hasValue) watch = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--bench") == 0 && hasValue) bench = atoi(argv[++i]);
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    DhtShmTable table;
+    if (!table.open(name))
+    {
+        fprintf(stderr, "%s: not a DHT Tiny table\n", name);
+        return 1;
+    }
+
+    if (bench > 0)
+    {
+        benchmark(table, bench);
+        return 0;
+    }
+
+    printTable(table);
+
+    while (watch > 0)
+    {
+        usleep(watch * 1000);
+        printf("\n");
+        printTable(table);
+    }
+
+    return 0;
+}
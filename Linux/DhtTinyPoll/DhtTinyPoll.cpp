@@ -0,0 +1,108 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+
+// ***
+// *** Polls one or more DHT Tiny Breakouts with DhtTinyClient and
+// *** prints each new reading.
+// ***
+// ***   DhtTinyPoll [--bus /dev/i2c-1] [--interval <ms>] <address> ...
+// ***
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <vector>
+
+#include "DhtTinyClient.h"
+#include "I2cBus.h"
+#include "I2cTransport.h"
+
+static volatile sig_atomic_t _stop = 0;
+
+static void onSignal(int)
+{
+    _stop = 1;
+}
+
+int main(int argc, char** argv)
+{
+    const char* busName = "/dev/i2c-1";
+    uint32_t interval = 250;
+    std::vector<uint8_t> addresses;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--bus") == 0 && i + 1 < argc) busName = argv[++i];
+        else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) interval = atoi(argv[++i]);
+        else addresses.push_back(strtoul(argv[i], NULL, 0));
+    }
+
+    if (addresses.empty())
+    {
+        fprintf(stderr, "usage: DhtTinyPoll [--bus <device>] [--interval <ms>] <address> ...\n");
+        return 1;
+    }
+
+    I2cBus bus;
+    if (!bus.open(busName))
+    {
+        perror(busName);
+        return 1;
+    }
+
+    I2cTransport transport(bus);
+    std::vector<DhtTinyClient> clients;
+    for (size_t i = 0; i < addresses.size(); i++)
+    {
+        DhtTinyClient client(transport, addresses[i]);
+        if (client.begin())
+        {
+            printf("0x%02X %s%u version %u.%u.%u interval %u ms\n", client.getAddress(),
+                   client.getDhtModel() == SENSOR_MODEL_SHT3X ? "SHT" : "DHT", client.getDhtModel(),
+                   client.getVersionMajor(), client.getVersionMinor(), client.getVersionBuild(), client.getInterval());
+            clients.push_back(client);
+        }
+        else
+        {
+            fprintf(stderr, "0x%02X: no breakout\n", addresses[i]);
+        }
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    while (!_stop && !clients.empty())
+    {
+        for (size_t i = 0; i < clients.size(); i++)
+        {
+            DhtTinyClient& client = clients[i];
+            if (client.update() == DHTTINY_UPDATED)
+            {
+                printf("0x%02X #%u %.1f C %.1f %% age %u ms\n", client.getAddress(), client.getReadingId(),
+                       client.getTemperature(), client.getHumidity(), client.getReadingAge());
+                fflush(stdout);
+            }
+        }
+
+        usleep(interval * 1000);
+    }
+
+    return 0;
+}
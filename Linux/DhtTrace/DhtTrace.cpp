@@ -0,0 +1,363 @@
+// Copyright © 2016 Daniel Porrey. All Rights Reserved.
+//
+// This file is part of the DHT Tiny project.
+// 
+// DHT Tiny is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+// 
+// DHT Tiny is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+// GNU General Public License for more details.
+// 
+// You should have received a copy of the GNU General Public License
+// along with DHT Tiny. If not, 
+// see http://www.gnu.org/licenses/.
+//
+
+// ***
+// *** Drains the trace ring of DHT Tiny Breakouts built with
+// *** DHT_TRACE and prints the events of all of them as one
+// *** timeline.
+// ***
+// ***   DhtTrace --bus /dev/i2c-1=0x26,0x27 --bus /dev/i2c-3=0x26 [--interval <ms>] [--duration <s>]
+// ***
+// *** Each entry carries a 16 bit time stamp from the clock of
+// *** its breakout. A drain is placed on the host clock at the
+// *** middle of the transfer, which is when the breakout stamped
+// *** the header, and the entries are placed backwards from it
+// *** one time stamp difference at a time. The error is the
+// *** time of one transfer. Events are printed once no breakout
+// *** can still return an older one.
+// ***
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "DhtTinyClient.h"
+#include "I2cBus.h"
+#include "I2cTransport.h"
+
+struct Device
+{
+    std::string name;
+    DhtTinyClient* client;
+
+    // ***
+    // *** Host time of the last drain and of the newest entry,
+    // *** and the events dropped by the breakout.
+    // ***
+    uint64_t anchor;
+    uint64_t newest;
+    uint32_t dropped;
+};
+
+struct Event
+{
+    uint64_t time;
+    uint32_t device;
+    uint8_t event;
+};
+
+static volatile sig_atomic_t _stop = 0;
+
+static const char* _eventNames[] =
+{
+    "?", "loop", "read start", "read ok", "read error", "receive", "request", "save start", "save end"
+};
+
+static void onSignal(int)
+{
+    _stop = 1;
+}
+
+static uint64_t monotonicNs()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ull + now.tv_nsec;
+}
+
+static bool parseAddresses(const char* text, std::vector<uint8_t>& addresses)
+{
+    // ***
+    // *** A comma separated list of addresses and ranges,
+    // *** for example 0x26,0x30-0x37.
+    // ***
+    std::string list(text);
+    size_t position = 0;
+    while (position <= list.size())
+    {
+        size_t comma = list.find(',', position);
+        std::string item = list.substr(position, comma == std::string::npos ? std::string::npos : comma - position);
+
+        char* end;
+        unsigned long first = strtoul(item.c_str(), &end, 0);
+        unsigned long last = *end == '-' ? strtoul(end + 1, &end, 0) : first;
+        if (item.empty() || *end != 0 || first < 0x08 || last > 0x77 || first > last) return false;
+
+        for (unsigned long address = first; address <= last; address++)
+        {
+            addresses.push_back(address);
+        }
+
+        if (comma == std::string::npos) break;
+        position = comma + 1;
+    }
+
+    return true;
+}
+
+static void usage()
+{
+    fprintf(stderr,
+            "usage: DhtTrace --bus <device>=<addresses> ... [options]\n"
+            "options:\n"
+            "  --interval <ms>          drain each breakout this often (100)\n"
+            "  --duration <s>           stop after this long\n");
+}
+
+static bool drain(Device& device, uint32_t index, std::vector<Event>& events)
+{
+    // ***
+    // *** A drain returns at most TRACE_DRAIN_ENTRIES entries,
+    // *** so keep going until the ring is empty.
+    // ***
+    uint8_t count = TRACE_DRAIN_ENTRIES;
+    while (count == TRACE_DRAIN_ENTRIES)
+    {
+        uint8_t buffer[TRACE_DRAIN_SIZE];
+        uint64_t started = monotonicNs();
+        if (!device.client->drainTrace(buffer))
+        {
+            return false;
+        }
+
+        uint64_t anchor = started + (monotonicNs() - started) / 2;
+        if (!(buffer[0] & TRACE_ENABLED))
+        {
+            fprintf(stderr, "%s: trace not enabled\n", device.name.c_str());
+            return false;
+        }
+
+        count = buffer[0] & ~TRACE_ENABLED;
+        if (count > TRACE_DRAIN_ENTRIES)
+        {
+            return false;
+        }
+
+        // ***
+        // *** The entries stay on the breakout until they are
+        // *** acked, so a drain that was not received is read
+        // *** again.
+        // ***
+        if ((count > 0 || buffer[1] != 0) && !device.client->ackTrace())
+        {
+            return false;
+        }
+
+        if (buffer[1] != 0)
+        {
+            device.dropped += buffer[1];
+            fprintf(stderr, "%s: %u events dropped\n", device.name.c_str(), buffer[1]);
+        }
+
+        // ***
+        // *** Walk from the newest entry back. Consecutive entries
+        // *** are less than a wrap apart since the breakout records
+        // *** a keepalive every half wrap.
+        // ***
+        uint16_t later = buffer[2] | (buffer[3] << 8);
+        uint64_t time = anchor;
+        size_t first = events.size();
+        events.resize(first + count);
+
+        for (int i = count - 1; i >= 0; i--)
+        {
+            const uint8_t* entry = &buffer[TRACE_HEADER_SIZE + i * TRACE_ENTRY_SIZE];
+            uint16_t stamp = entry[1] | (entry[2] << 8);
+            uint64_t elapsed = (uint64_t)(uint16_t)(later - stamp) * TRACE_TICK_US * 1000;
+
+            time = elapsed < time ? time - elapsed : 0;
+            later = stamp;
+
+            // ***
+            // *** The error of the anchor must not put an entry
+            // *** before one from the previous drain.
+            // ***
+            events[first + i].time = std::max(time, device.newest);
+            events[first + i].device = index;
+            events[first + i].event = entry[0];
+        }
+
+        if (count > 0)
+        {
+            device.newest = events.back().time;
+        }
+
+        device.anchor = anchor;
+    }
+
+    return true;
+}
+
+static void print(const std::vector<Device>& devices, const Event& event, uint64_t started)
+{
+    uint8_t id = event.event & TRACE_EVENT_MASK;
+    const char* name = id < sizeof(_eventNames) / sizeof(_eventNames[0]) ? _eventNames[id] : _eventNames[0];
+    int64_t time = (int64_t)(event.time - started);
+
+    printf("%10.6f  %-20s %s", time / 1e9, devices[event.device].name.c_str(), name);
+    if (id == TRACE_EVENT_READ_START || id == TRACE_EVENT_READ_OK || id == TRACE_EVENT_READ_ERROR ||
+        id == TRACE_EVENT_SAVE_START || id == TRACE_EVENT_SAVE_END)
+    {
+        printf(" ch%u", event.event >> TRACE_CHANNEL_SHIFT);
+    }
+
+    printf("\n");
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> buses;
+    uint32_t interval = 100;
+    uint32_t duration = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (strcmp(argv[i], "--bus") == 0 && hasValue) buses.push_back(argv[++i]);
+        else if (strcmp(argv[i], "--interval") == 0 && hasValue) interval = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--duration") == 0 && hasValue) duration = atoi(argv[++i]);
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    if (buses.empty() || interval == 0)
+    {
+        usage();
+        return 1;
+    }
+
+    // ***
+    // *** The adapters, transports and clients live until exit.
+    // ***
+    std::vector<Device> devices;
+    for (size_t i = 0; i < buses.size(); i++)
+    {
+        size_t equals = buses[i].find('=');
+        std::vector<uint8_t> addresses;
+        if (equals == std::string::npos || !parseAddresses(buses[i].c_str() + equals + 1, addresses))
+        {
+            usage();
+            return 1;
+        }
+
+        std::string busName = buses[i].substr(0, equals);
+        I2cBus* bus = new I2cBus();
+        if (!bus->open(busName.c_str()))
+        {
+            perror(busName.c_str());
+            return 1;
+        }
+
+        I2cTransport* transport = new I2cTransport(*bus);
+        for (size_t j = 0; j < addresses.size(); j++)
+        {
+            char name[64];
+            snprintf(name, sizeof(name), "%s:0x%02X", busName.c_str(), addresses[j]);
+
+            DhtTinyClient* client = new DhtTinyClient(*transport, addresses[j]);
+            if (!client->begin())
+            {
+                fprintf(stderr, "%s: no breakout\n", name);
+                delete client;
+                continue;
+            }
+
+            Device device = { name, client, 0, 0, 0 };
+            devices.push_back(device);
+        }
+    }
+
+    if (devices.empty())
+    {
+        return 1;
+    }
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    uint64_t started = monotonicNs();
+    uint64_t until = started + (uint64_t)duration * 1000000000ull;
+    std::vector<Event> pending;
+
+    while (!_stop && (duration == 0 || monotonicNs() < until))
+    {
+        // ***
+        // *** A breakout whose drain failed is drained again on
+        // *** the next pass rather than dropped, since its ring
+        // *** stalls until a drain is acked.
+        // ***
+        for (uint32_t i = 0; i < devices.size(); i++)
+        {
+            if (!drain(devices[i], i, pending))
+            {
+                fprintf(stderr, "%s: drain failed\n", devices[i].name.c_str());
+            }
+        }
+
+        // ***
+        // *** An event not drained yet was recorded after the last
+        // *** drain of its breakout, so everything before the
+        // *** oldest of those is final.
+        // ***
+        uint64_t horizon = devices[0].anchor;
+        for (size_t i = 1; i < devices.size(); i++)
+        {
+            horizon = std::min(horizon, devices[i].anchor);
+        }
+
+        std::stable_sort(pending.begin(), pending.end(), [](const Event& a, const Event& b) { return a.time < b.time; });
+
+        size_t ready = 0;
+        while (ready < pending.size() && pending[ready].time <= horizon)
+        {
+            print(devices, pending[ready], started);
+            ready++;
+        }
+
+        pending.erase(pending.begin(), pending.begin() + ready);
+        fflush(stdout);
+        usleep(interval * 1000);
+    }
+
+    // ***
+    // *** Nothing more will be drained.
+    // ***
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        print(devices, pending[i], started);
+    }
+
+    for (size_t i = 0; i < devices.size(); i++)
+    {
+        if (devices[i].dropped > 0)
+        {
+            fprintf(stderr, "%s: %u events dropped in total\n", devices[i].name.c_str(), devices[i].dropped);
+        }
+    }
+
+    return 0;
+}
@@ -135,7 +135,7 @@ namespace Porrey.Tiny.Dht.Views
                 this.StatusUpperThresholdExceeded = _dhtTiny.GetStatusBit(statusBits, DhtTiny.StatusBit.UpperThresholdExceeded) ? "1" : "0";
                 this.StatusLowerThresholdExceeded = _dhtTiny.GetStatusBit(statusBits, DhtTiny.StatusBit.LowerThresholdExceeded) ? "1" : "0";
                 this.StatusDhtReadError = _dhtTiny.GetStatusBit(statusBits, DhtTiny.StatusBit.DhtReadError) ? "1" : "0";
-                this.StatusReserved2 = _dhtTiny.GetStatusBit(statusBits, DhtTiny.StatusBit.Reserved2) ? "1" : "0";
+                this.StatusReserved2 = _dhtTiny.GetStatusBit(statusBits, DhtTiny.StatusBit.PecError) ? "1" : "0";
                 this.StatusConfigurationSaved = _dhtTiny.GetStatusBit(statusBits, DhtTiny.StatusBit.ConfigSaved) ? "1" : "0";
                 this.StatusReadError = _dhtTiny.GetStatusBit(statusBits, DhtTiny.StatusBit.ReadError) ? "1" : "0";
                 this.StatusWriteError = _dhtTiny.GetStatusBit(statusBits, DhtTiny.StatusBit.WriteError) ? "1" : "0";
@@ -143,9 +143,9 @@ namespace Porrey.Tiny.Dht.Views
                 this.configEnabled.IsChecked = _dhtTiny.GetConfigurationBit(configurationBits, DhtTiny.ConfigBit.SensorEnabled) ? true : false;
                 this.configThresholdEnabled.IsChecked = _dhtTiny.GetConfigurationBit(configurationBits, DhtTiny.ConfigBit.ThresholdEnabled) ? true : false;
                 this.configTriggerReading.IsChecked = _dhtTiny.GetConfigurationBit(configurationBits, DhtTiny.ConfigBit.TriggerReading) ? true : false;
-                this.reserved1.IsChecked = _dhtTiny.GetConfigurationBit(configurationBits, DhtTiny.ConfigBit.Reserved1) ? true : false;
-                this.reserved2.IsChecked = _dhtTiny.GetConfigurationBit(configurationBits, DhtTiny.ConfigBit.Reserved2) ? true : false;
-                this.reserved3.IsChecked = _dhtTiny.GetConfigurationBit(configurationBits, DhtTiny.ConfigBit.Reserved3) ? true : false;
+                this.reserved1.IsChecked = _dhtTiny.GetConfigurationBit(configurationBits, DhtTiny.ConfigBit.AdaptiveInterval) ? true : false;
+                this.reserved2.IsChecked = _dhtTiny.GetConfigurationBit(configurationBits, DhtTiny.ConfigBit.Capture) ? true : false;
+                this.reserved3.IsChecked = _dhtTiny.GetConfigurationBit(configurationBits, DhtTiny.ConfigBit.Pec) ? true : false;
                 this.writeConfiguration.IsChecked = _dhtTiny.GetConfigurationBit(configurationBits, DhtTiny.ConfigBit.WriteConfig) ? true : false;
                 this.resetConfiguration.IsChecked = _dhtTiny.GetConfigurationBit(configurationBits, DhtTiny.ConfigBit.ResetConfig) ? true : false;
 
@@ -628,7 +628,7 @@ namespace Porrey.Tiny.Dht.Views
 
         private async void OnReserved1Command()
         {
-            await FlipConfigurationBit(DhtTiny.ConfigBit.Reserved1);
+            await FlipConfigurationBit(DhtTiny.ConfigBit.AdaptiveInterval);
         }
 
         private bool OnCanReserved2Command()
@@ -638,7 +638,7 @@ namespace Porrey.Tiny.Dht.Views
 
         private async void OnReserved2Command()
         {
-            await FlipConfigurationBit(DhtTiny.ConfigBit.Reserved2);
+            await FlipConfigurationBit(DhtTiny.ConfigBit.Capture);
         }
 
         private bool OnCanReserved3Command()
@@ -648,7 +648,7 @@ namespace Porrey.Tiny.Dht.Views
 
         private async void OnReserved3Command()
         {
-            await FlipConfigurationBit(DhtTiny.ConfigBit.Reserved3);
+            await FlipConfigurationBit(DhtTiny.ConfigBit.Pec);
         }
 
         private bool OnCanWriteConfigurationCommand()
@@ -36,15 +36,63 @@ namespace Porrey.Uwp.IoT.Sensors.Tiny
         private const byte REGISTER_HUMIDITY = 8;
         private const byte REGISTER_STATUS = 12;
         private const byte REGISTER_READING_ID = 13;
-        private const byte REGISTER_INTERVAL = 17;
-        private const byte REGISTER_UPPER_THRESHOLD = 21;
-        private const byte REGISTER_LOWER_THRESHOLD = 25;
-        private const byte REGISTER_START_DELAY = 29;
-        private const byte REGISTER_CONFIG = 33;
-        private const byte REGISTER_DEVICE_ADDRESS = 34;
-        private const byte REGISTER_DHT_MODEL = 35;
+        private const byte REGISTER_READING_TIME = 17;
+        private const byte REGISTER_READING_AGE = 21;
+        private const byte REGISTER_INTERVAL = 25;
+        private const byte REGISTER_UPPER_THRESHOLD = 29;
+        private const byte REGISTER_LOWER_THRESHOLD = 33;
+        private const byte REGISTER_START_DELAY = 37;
+        private const byte REGISTER_CONFIG = 41;
+        private const byte REGISTER_DEVICE_ADDRESS = 42;
+        private const byte REGISTER_DHT_MODEL = 43;
+        private const byte REGISTER_MIN_INTERVAL = 44;
+        private const byte REGISTER_SLOPE_THRESHOLD = 48;
+        private const byte REGISTER_CURRENT_INTERVAL = 52;
+        private const byte REGISTER_AGGREGATE_WINDOW = 56;
+        private const byte REGISTER_AGGREGATE_COUNT = 60;
+        private const byte REGISTER_TEMPERATURE_MIN = 62;
+        private const byte REGISTER_TEMPERATURE_MAX = 64;
+        private const byte REGISTER_TEMPERATURE_MEAN = 66;
+        private const byte REGISTER_HUMIDITY_MIN = 68;
+        private const byte REGISTER_HUMIDITY_MAX = 70;
+        private const byte REGISTER_HUMIDITY_MEAN = 72;
+        private const byte REGISTER_CAPTURE_RESULT = 74;
+        private const byte REGISTER_CAPTURE_TIMEOUT = 75;
+        private const byte REGISTER_CAPTURE_SHIFT = 77;
+        private const byte REGISTER_CAPTURE_FRAME = 78;
+        private const byte REGISTER_CAPTURE_PULSES = 83;
+        private const byte REGISTER_SERIAL = 123;
+        private const byte REGISTER_ENUM_CONTROL = 127;
+        private const byte REGISTER_ENUM_SELECT = 128;
+        private const byte REGISTER_ENUM_ASSIGN = 133;
+        private const byte REGISTER_FILTER_MODE = 134;
+        private const byte REGISTER_TEMPERATURE_SLEW = 135;
+        private const byte REGISTER_HUMIDITY_SLEW = 137;
+        private const byte REGISTER_FILTER_REJECTS = 139;
+        private const byte REGISTER_TEMPERATURE_OFFSET = 141;
+        private const byte REGISTER_TEMPERATURE_GAIN = 143;
+        private const byte REGISTER_HUMIDITY_OFFSET = 145;
+        private const byte REGISTER_HUMIDITY_GAIN = 147;
+        private const byte REGISTER_DEW_POINT = 149;
+        private const byte REGISTER_ABSOLUTE_HUMIDITY = 151;
+        private const byte REGISTER_HEAT_INDEX = 153;
+        private const byte REGISTER_CHANNEL = 155;
+        private const byte REGISTER_CHANNEL_COUNT = 156;
+        private const byte REGISTER_TRACE = 157;
+        private const byte REGISTER_CLOCK_IDLE_SHIFT = 158;
+        private const byte REGISTER_CLOCK_FULL_TIME = 159;
+        private const byte REGISTER_CLOCK_IDLE_TIME = 163;
+        private const byte REGISTER_LOG_DECIMATION = 167;
+        private const byte REGISTER_LOG_CONTROL = 168;
+        private const byte REGISTER_LOG_DATA = 169;
+        private const byte REGISTER_AGGREGATE_CONTROL = 170;
+
+        private const byte REGISTER_TOTAL_SIZE = 171;
 
-        private const byte REGISTER_TOTAL_SIZE = 36;
+        // ***
+        // *** A calibration gain of 1.0.
+        // ***
+        public const ushort CalibrationGainOne = 4096;
 
 
         // ***
@@ -55,9 +103,9 @@ namespace Porrey.Uwp.IoT.Sensors.Tiny
 			SensorEnabled = 0,
 			ThresholdEnabled = 1,
 			TriggerReading = 2,
-			Reserved1 = 3,
-			Reserved2 = 4,
-			Reserved3 = 5,
+			AdaptiveInterval = 3,
+			Capture = 4,
+			Pec = 5,
 			WriteConfig = 6,
 			ResetConfig = 7
 		}
@@ -71,15 +119,75 @@ namespace Porrey.Uwp.IoT.Sensors.Tiny
 			UpperThresholdExceeded = 1,
 			LowerThresholdExceeded = 2,
 			DhtReadError = 3,
-			Reserved2 = 4,
+			PecError = 4,
 			ConfigSaved = 5,
 			ReadError = 6,
 			WriteError = 7,
 		}
 
+		// ***
+		// *** Outlier filter mode bits.
+		// ***
+		public enum FilterBit
+		{
+			Median = 0,
+			Slew = 1
+		}
+
+		// ***
+		// *** SMBus packet error code (CRC-8, polynomial 0x07).
+		// ***
+		private const byte PEC_POLYNOMIAL = 0x07;
+
+		private readonly byte _deviceAddress = 0;
+
 		public DhtTiny(byte deviceAddress)
 				: base(deviceAddress, I2cBusSpeed.FastMode)
 		{
+			_deviceAddress = deviceAddress;
+		}
+
+		// ***
+		// *** True when the device has PEC enabled; register writes
+		// *** then carry a PEC byte. Tracked from the configuration
+		// *** register each time it is read or written.
+		// ***
+		public bool PecEnabled { get; private set; }
+
+		private static byte UpdatePec(byte pec, byte value)
+		{
+			pec ^= value;
+
+			for (int i = 0; i < 8; i++)
+			{
+				pec = (byte)((pec & 0x80) != 0 ? (pec << 1) ^ PEC_POLYNOMIAL : pec << 1);
+			}
+
+			return pec;
+		}
+
+		// ***
+		// *** Writes a register value, appending the PEC over the
+		// *** address, the register and the data when PEC is enabled.
+		// ***
+		private async Task<bool> WriteRegisterAsync(byte[] writeBuffer)
+		{
+			if (this.PecEnabled)
+			{
+				byte[] pecBuffer = new byte[writeBuffer.Length + 1];
+				byte pec = UpdatePec(0, (byte)(_deviceAddress << 1));
+
+				for (int i = 0; i < writeBuffer.Length; i++)
+				{
+					pecBuffer[i] = writeBuffer[i];
+					pec = UpdatePec(pec, writeBuffer[i]);
+				}
+
+				pecBuffer[writeBuffer.Length] = pec;
+				writeBuffer = pecBuffer;
+			}
+
+			return await this.WriteAsync(writeBuffer);
 		}
 
 		public static async Task<IEnumerable<byte>> FindAllDhtTinyAsync(FindAllDhtTinyCallbackDelegate callback = null)
@@ -276,7 +384,7 @@ namespace Porrey.Uwp.IoT.Sensors.Tiny
 				// ***
 				// *** Write the register value and the value.
 				// ***
-				returnValue = await this.WriteAsync(writeBuffer);
+				returnValue = await this.WriteRegisterAsync(writeBuffer);
 			}
 			else
 			{
@@ -328,7 +436,7 @@ namespace Porrey.Uwp.IoT.Sensors.Tiny
 				// ***
 				// *** Write the register value and the value.
 				// ***
-				returnValue = await this.WriteAsync(writeBuffer);
+				returnValue = await this.WriteRegisterAsync(writeBuffer);
 			}
 			else
 			{
@@ -365,6 +473,60 @@ namespace Porrey.Uwp.IoT.Sensors.Tiny
 			return returnValue;
 		}
 
+		public async Task<uint> GetReadingTimeAsync()
+		{
+			uint returnValue = 0;
+
+			if (this.IsInitialized)
+			{
+				// ***
+				// *** The register ID
+				// ***
+				byte[] writeBuffer = new byte[1] { REGISTER_READING_TIME };
+				await this.WriteAsync(writeBuffer);
+
+				// ***
+				// *** Read from the device.
+				// ***
+				byte[] readBuffer = new byte[4] { 0, 0, 0, 0 };
+				await this.ReadAsync(readBuffer);
+				returnValue = BitConverter.ToUInt32(readBuffer, 0);
+			}
+			else
+			{
+				throw new DeviceNotInitializedException();
+			}
+
+			return returnValue;
+		}
+
+		public async Task<uint> GetReadingAgeAsync()
+		{
+			uint returnValue = 0;
+
+			if (this.IsInitialized)
+			{
+				// ***
+				// *** The register ID
+				// ***
+				byte[] writeBuffer = new byte[1] { REGISTER_READING_AGE };
+				await this.WriteAsync(writeBuffer);
+
+				// ***
+				// *** Read from the device.
+				// ***
+				byte[] readBuffer = new byte[4] { 0, 0, 0, 0 };
+				await this.ReadAsync(readBuffer);
+				returnValue = BitConverter.ToUInt32(readBuffer, 0);
+			}
+			else
+			{
+				throw new DeviceNotInitializedException();
+			}
+
+			return returnValue;
+		}
+
 		public async Task<float> GetUpperThresholdAsync()
 		{
 			float returnValue = 0;
@@ -460,7 +622,7 @@ namespace Porrey.Uwp.IoT.Sensors.Tiny
 				// ***
 				// *** Read from the device.
 				// ***
-				returnValue = await this.WriteAsync(writeBuffer);
+				returnValue = await this.WriteRegisterAsync(writeBuffer);
 			}
 			else
 			{
@@ -515,6 +677,7 @@ namespace Porrey.Uwp.IoT.Sensors.Tiny
 				byte[] readBuffer = new byte[1] { 0 };
 				await this.ReadAsync(readBuffer);
 				returnValue = readBuffer[0];
+				this.PecEnabled = Bit.Get(returnValue, (byte)ConfigBit.Pec);
 			}
 			else
 			{
@@ -543,7 +706,15 @@ namespace Porrey.Uwp.IoT.Sensors.Tiny
 				// ***
 				// *** Write the register value and the value.
 				// ***
-				returnValue = await this.WriteAsync(writeBuffer);
+				returnValue = await this.WriteRegisterAsync(writeBuffer);
+
+				// ***
+				// *** The reset bit restores the defaults, which have PEC disabled.
+				// ***
+				if (returnValue)
+				{
+					this.PecEnabled = Bit.Get(value, (byte)ConfigBit.ResetConfig) ? false : Bit.Get(value, (byte)ConfigBit.Pec);
+				}
 			}
 			else
 			{
@@ -650,7 +821,7 @@ namespace Porrey.Uwp.IoT.Sensors.Tiny
 				// ***
 				// *** Write the register value and the value.
 				// ***
-				returnValue = await this.WriteAsync(writeBuffer);
+				returnValue = await this.WriteRegisterAsync(writeBuffer);
 			}
 			else
 			{
@@ -790,7 +961,599 @@ namespace Porrey.Uwp.IoT.Sensors.Tiny
                 // ***
                 // *** Write the register value and the value.
                 // ***
-                returnValue = await this.WriteAsync(writeBuffer);
+                returnValue = await this.WriteRegisterAsync(writeBuffer);
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<uint> GetMinIntervalAsync()
+        {
+            uint returnValue = 0;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[1] { REGISTER_MIN_INTERVAL };
+                await this.WriteAsync(writeBuffer);
+
+                // ***
+                // *** Read from the device.
+                // ***
+                byte[] readBuffer = new byte[4] { 0, 0, 0, 0 };
+                await this.ReadAsync(readBuffer);
+                returnValue = BitConverter.ToUInt32(readBuffer, 0);
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<bool> SetMinIntervalAsync(uint value)
+        {
+            bool returnValue = false;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] data = BitConverter.GetBytes(value);
+                byte[] writeBuffer = new byte[5] { REGISTER_MIN_INTERVAL, data[0], data[1], data[2], data[3] };
+
+                // ***
+                // *** Write the register value and the value.
+                // ***
+                returnValue = await this.WriteRegisterAsync(writeBuffer);
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<float> GetSlopeThresholdAsync()
+        {
+            float returnValue = 0;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[1] { REGISTER_SLOPE_THRESHOLD };
+                await this.WriteAsync(writeBuffer);
+
+                // ***
+                // *** Read from the device.
+                // ***
+                byte[] readBuffer = new byte[4] { 0, 0, 0, 0 };
+                await this.ReadAsync(readBuffer);
+                returnValue = BitConverter.ToSingle(readBuffer, 0);
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<bool> SetSlopeThresholdAsync(float value)
+        {
+            bool returnValue = false;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] data = BitConverter.GetBytes(value);
+                byte[] writeBuffer = new byte[5] { REGISTER_SLOPE_THRESHOLD, data[0], data[1], data[2], data[3] };
+
+                // ***
+                // *** Write the register value and the value.
+                // ***
+                returnValue = await this.WriteRegisterAsync(writeBuffer);
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<uint> GetCurrentIntervalAsync()
+        {
+            uint returnValue = 0;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[1] { REGISTER_CURRENT_INTERVAL };
+                await this.WriteAsync(writeBuffer);
+
+                // ***
+                // *** Read from the device.
+                // ***
+                byte[] readBuffer = new byte[4] { 0, 0, 0, 0 };
+                await this.ReadAsync(readBuffer);
+                returnValue = BitConverter.ToUInt32(readBuffer, 0);
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<uint> GetAggregateWindowAsync()
+        {
+            uint returnValue = 0;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[1] { REGISTER_AGGREGATE_WINDOW };
+                await this.WriteAsync(writeBuffer);
+
+                // ***
+                // *** Read from the device.
+                // ***
+                byte[] readBuffer = new byte[4] { 0, 0, 0, 0 };
+                await this.ReadAsync(readBuffer);
+                returnValue = BitConverter.ToUInt32(readBuffer, 0);
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<bool> SetAggregateWindowAsync(uint value)
+        {
+            bool returnValue = false;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] data = BitConverter.GetBytes(value);
+                byte[] writeBuffer = new byte[5] { REGISTER_AGGREGATE_WINDOW, data[0], data[1], data[2], data[3] };
+
+                // ***
+                // *** Write the register value and the value.
+                // ***
+                returnValue = await this.WriteRegisterAsync(writeBuffer);
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<bool> SetFilterModeAsync(byte value)
+        {
+            bool returnValue = false;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[2] { REGISTER_FILTER_MODE, value };
+
+                // ***
+                // *** Write the register value and the value.
+                // ***
+                returnValue = await this.WriteRegisterAsync(writeBuffer);
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<ushort> GetFilterRejectsAsync()
+        {
+            ushort returnValue = 0;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[1] { REGISTER_FILTER_REJECTS };
+                await this.WriteAsync(writeBuffer);
+
+                // ***
+                // *** Read from the device.
+                // ***
+                byte[] readBuffer = new byte[2] { 0, 0 };
+                await this.ReadAsync(readBuffer);
+                returnValue = BitConverter.ToUInt16(readBuffer, 0);
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<bool> SetTemperatureCalibrationAsync(short offset, ushort gain)
+        {
+            bool returnValue = false;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The offset (in tenths) and gain (CalibrationGainOne
+                // *** is 1.0) are separate registers.
+                // ***
+                byte[] data = BitConverter.GetBytes(offset);
+                byte[] writeBuffer = new byte[3] { REGISTER_TEMPERATURE_OFFSET, data[0], data[1] };
+                returnValue = await this.WriteRegisterAsync(writeBuffer);
+
+                if (returnValue)
+                {
+                    data = BitConverter.GetBytes(gain);
+                    writeBuffer = new byte[3] { REGISTER_TEMPERATURE_GAIN, data[0], data[1] };
+                    returnValue = await this.WriteRegisterAsync(writeBuffer);
+                }
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<bool> SetHumidityCalibrationAsync(short offset, ushort gain)
+        {
+            bool returnValue = false;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The offset (in tenths) and gain (CalibrationGainOne
+                // *** is 1.0) are separate registers.
+                // ***
+                byte[] data = BitConverter.GetBytes(offset);
+                byte[] writeBuffer = new byte[3] { REGISTER_HUMIDITY_OFFSET, data[0], data[1] };
+                returnValue = await this.WriteRegisterAsync(writeBuffer);
+
+                if (returnValue)
+                {
+                    data = BitConverter.GetBytes(gain);
+                    writeBuffer = new byte[3] { REGISTER_HUMIDITY_GAIN, data[0], data[1] };
+                    returnValue = await this.WriteRegisterAsync(writeBuffer);
+                }
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<float> GetDewPointAsync()
+        {
+            float returnValue = 0;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[1] { REGISTER_DEW_POINT };
+                await this.WriteAsync(writeBuffer);
+
+                // ***
+                // *** Read from the device. The value is in tenths of a degree.
+                // ***
+                byte[] readBuffer = new byte[2] { 0, 0 };
+                await this.ReadAsync(readBuffer);
+                returnValue = BitConverter.ToInt16(readBuffer, 0) / 10f;
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<float> GetAbsoluteHumidityAsync()
+        {
+            float returnValue = 0;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[1] { REGISTER_ABSOLUTE_HUMIDITY };
+                await this.WriteAsync(writeBuffer);
+
+                // ***
+                // *** Read from the device. The value is in hundredths of a g/m^3.
+                // ***
+                byte[] readBuffer = new byte[2] { 0, 0 };
+                await this.ReadAsync(readBuffer);
+                returnValue = BitConverter.ToUInt16(readBuffer, 0) / 100f;
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<float> GetHeatIndexAsync()
+        {
+            float returnValue = 0;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[1] { REGISTER_HEAT_INDEX };
+                await this.WriteAsync(writeBuffer);
+
+                // ***
+                // *** Read from the device. The value is in tenths of a degree.
+                // ***
+                byte[] readBuffer = new byte[2] { 0, 0 };
+                await this.ReadAsync(readBuffer);
+                returnValue = BitConverter.ToInt16(readBuffer, 0) / 10f;
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<uint> GetClockFullTimeAsync()
+        {
+            uint returnValue = 0;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[1] { REGISTER_CLOCK_FULL_TIME };
+                await this.WriteAsync(writeBuffer);
+
+                // ***
+                // *** Read from the device. The value is the milliseconds spent at the full clock.
+                // ***
+                byte[] readBuffer = new byte[4] { 0, 0, 0, 0 };
+                await this.ReadAsync(readBuffer);
+                returnValue = BitConverter.ToUInt32(readBuffer, 0);
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<uint> GetClockIdleTimeAsync()
+        {
+            uint returnValue = 0;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[1] { REGISTER_CLOCK_IDLE_TIME };
+                await this.WriteAsync(writeBuffer);
+
+                // ***
+                // *** Read from the device. The value is the milliseconds spent at the idle clock.
+                // ***
+                byte[] readBuffer = new byte[4] { 0, 0, 0, 0 };
+                await this.ReadAsync(readBuffer);
+                returnValue = BitConverter.ToUInt32(readBuffer, 0);
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<byte> GetLogBlockCountAsync()
+        {
+            byte returnValue = 0;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[1] { REGISTER_LOG_CONTROL };
+                await this.WriteAsync(writeBuffer);
+
+                // ***
+                // *** Read from the device. The value is the number of blocks in the spill log.
+                // ***
+                byte[] readBuffer = new byte[1] { 0 };
+                await this.ReadAsync(readBuffer);
+                returnValue = readBuffer[0];
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<byte> GetChannelAsync()
+        {
+            byte returnValue = 0;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[1] { REGISTER_CHANNEL };
+                await this.WriteAsync(writeBuffer);
+
+                // ***
+                // *** Read from the device.
+                // ***
+                byte[] readBuffer = new byte[1] { 0 };
+                await this.ReadAsync(readBuffer);
+                returnValue = readBuffer[0];
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        // ***
+        // *** A breakout with more than one sensor has a bank of
+        // *** registers per channel. Every read and write after
+        // *** this goes to the bank of the selected channel.
+        // ***
+        public async Task<bool> SetChannelAsync(byte value)
+        {
+            bool returnValue = false;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[2] { REGISTER_CHANNEL, value };
+
+                // ***
+                // *** Write the register value and the value.
+                // ***
+                returnValue = await this.WriteRegisterAsync(writeBuffer);
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<byte> GetChannelCountAsync()
+        {
+            byte returnValue = 0;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[1] { REGISTER_CHANNEL_COUNT };
+                await this.WriteAsync(writeBuffer);
+
+                // ***
+                // *** Read from the device.
+                // ***
+                byte[] readBuffer = new byte[1] { 0 };
+                await this.ReadAsync(readBuffer);
+                returnValue = readBuffer[0];
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<byte[]> GetCaptureAsync()
+        {
+            byte[] returnValue = null;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID. Reading from the start of
+                // *** the capture block returns the result, timeout,
+                // *** shift, frame and pulse widths in one transfer.
+                // ***
+                byte[] writeBuffer = new byte[1] { REGISTER_CAPTURE_RESULT };
+                await this.WriteAsync(writeBuffer);
+
+                // ***
+                // *** Read from the device.
+                // ***
+                returnValue = new byte[REGISTER_SERIAL - REGISTER_CAPTURE_RESULT];
+                await this.ReadAsync(returnValue);
+            }
+            else
+            {
+                throw new DeviceNotInitializedException();
+            }
+
+            return returnValue;
+        }
+
+        public async Task<uint> GetSerialAsync()
+        {
+            uint returnValue = 0;
+
+            if (this.IsInitialized)
+            {
+                // ***
+                // *** The register ID
+                // ***
+                byte[] writeBuffer = new byte[1] { REGISTER_SERIAL };
+                await this.WriteAsync(writeBuffer);
+
+                // ***
+                // *** Read from the device.
+                // ***
+                byte[] readBuffer = new byte[4] { 0, 0, 0, 0 };
+                await this.ReadAsync(readBuffer);
+                returnValue = BitConverter.ToUInt32(readBuffer, 0);
             }
             else
             {